@@ -0,0 +1,47 @@
+include(../../synthclone.pri)
+
+# The benchmark program links the application sources directly, so that it can
+# drive sessions and plugins the same way the application does.
+include(../synthclone/sources.pri)
+
+################################################################################
+# Build
+################################################################################
+
+isEmpty(BUILDDIR) {
+    BUILDDIR = ../../build
+}
+
+isEmpty(MAKEDIR) {
+    MAKEDIR = ../../make
+}
+
+unix:!macx {
+    # See `../synthclone/synthclone.pro`.
+    LIB_BUILDDIR = $${BUILDDIR}/$${SYNTHCLONE_LIBRARY_SUFFIX}
+    LIB_VERSION = $${MAJOR_VERSION}.$${MINOR_VERSION}.$${REVISION}
+    LIBS += -lsamplerate $${LIB_BUILDDIR}/libsynthclone.so.$${LIB_VERSION}
+} else {
+    LIBS += -L$${BUILDDIR}/$${SYNTHCLONE_LIBRARY_SUFFIX} -lsamplerate \
+        -lsynthclone
+}
+
+CONFIG += console uitools
+DEFINES += SYNTHCLONE_MAJOR_VERSION=$${MAJOR_VERSION} \
+    SYNTHCLONE_MINOR_VERSION=$${MINOR_VERSION} \
+    SYNTHCLONE_PLUGIN_PATH=$${SYNTHCLONE_PLUGIN_INSTALL_PATH} \
+    SYNTHCLONE_REVISION=$${REVISION}
+DEPENDPATH += ../synthclone
+DESTDIR = $${BUILDDIR}/$${SYNTHCLONE_APP_SUFFIX}
+HEADERS += benchmark.h
+INCLUDEPATH += ../include ../synthclone
+MOC_DIR = $${MAKEDIR}/bench
+OBJECTS_DIR = $${MAKEDIR}/bench
+RCC_DIR = $${MAKEDIR}/bench
+RESOURCES += ../synthclone/synthclone.qrc
+SOURCES += benchmark.cpp \
+    main.cpp
+TARGET = synthclone-bench
+TEMPLATE = app
+VERSION = $${SYNTHCLONE_VERSION}
+VPATH += ../synthclone
@@ -0,0 +1,636 @@
+/*
+ * synthclone - Synthesizer-cloning software
+ * Copyright (C) 2011 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <QtCore/QDataStream>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QStringList>
+#include <QtCore/QTextStream>
+#include <QtXml/QDomDocument>
+
+#include <synthclone/error.h>
+#include <synthclone/samplecopier.h>
+#include <synthclone/sampleinputstream.h>
+#include <synthclone/sampleoutputstream.h>
+#include <synthclone/util.h>
+
+#include "benchmark.h"
+#include "sampleprofile.h"
+#include "sessionsampledata.h"
+#include "zonecomparer.h"
+
+using synthclone::getJSONString;
+using synthclone::getJSONValue;
+
+// Static functions
+
+static QDomElement
+createStateElement(QDomDocument &document, const QVariant &state)
+{
+    // See 'writeVariant()' in the application's 'util.cpp'.
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    stream << state;
+    QDomElement element = document.createElement("state");
+    element.appendChild(document.createTextNode(bytes.toBase64()));
+    return element;
+}
+
+void
+Benchmark::removeDirectory(const QString &path)
+{
+    QDir directory(path);
+    if (! directory.exists()) {
+        return;
+    }
+    QFileInfoList infos =
+        directory.entryInfoList(QDir::AllEntries | QDir::Hidden |
+                                QDir::NoDotAndDotDot | QDir::System);
+    for (int i = 0; i < infos.count(); i++) {
+        const QFileInfo &info = infos[i];
+        QString infoPath = info.absoluteFilePath();
+        if (info.isDir() && (! info.isSymLink())) {
+            removeDirectory(infoPath);
+        } else if (! QFile::remove(infoPath)) {
+            throw synthclone::Error(tr("failed to remove '%1'").arg(infoPath));
+        }
+    }
+    if (! directory.rmdir(directory.absolutePath())) {
+        throw synthclone::Error(tr("failed to remove '%1'").arg(path));
+    }
+}
+
+// Class definition
+
+Benchmark::Benchmark(Session &session, const QDir &directory,
+                     QObject *parent):
+    QObject(parent),
+    session(session)
+{
+    this->directory = directory;
+    iterations = 5;
+    zoneCount = 128;
+}
+
+Benchmark::~Benchmark()
+{
+    // Empty
+}
+
+void
+Benchmark::addResult(const QString &name, const QVariantMap &parameters,
+                     const QList<qint64> &times)
+{
+    Result result;
+    result.name = name;
+    result.parameters = parameters;
+    result.times = times;
+    results.append(result);
+}
+
+void
+Benchmark::generateSample(const QString &path,
+                          synthclone::SampleRate sampleRate,
+                          synthclone::SampleChannelCount channels,
+                          synthclone::SampleFrameCount frames)
+{
+    // The generated sample is a decaying sine wave, with a little silence at
+    // the beginning and end so that the trimmer has something to trim.
+    synthclone::Sample sample(path);
+    synthclone::SampleOutputStream stream(sample, sampleRate, channels);
+    synthclone::SampleFrameCount silenceFrames = frames / 10;
+    synthclone::SampleFrameCount toneFrames = frames - (silenceFrames * 2);
+    const synthclone::SampleFrameCount bufferFrames = 1024;
+    float *buffer = new float[bufferFrames * channels];
+    try {
+        for (synthclone::SampleFrameCount frame = 0; frame < frames; ) {
+            synthclone::SampleFrameCount count =
+                std::min(bufferFrames, frames - frame);
+            for (synthclone::SampleFrameCount i = 0; i < count; i++) {
+                synthclone::SampleFrameCount toneFrame =
+                    frame + i - silenceFrames;
+                float value = 0.0;
+                if ((toneFrame >= 0) && (toneFrame < toneFrames)) {
+                    float time = static_cast<float>(toneFrame) / sampleRate;
+                    float envelope = 1.0 - (static_cast<float>(toneFrame) /
+                                            toneFrames);
+                    value = envelope * 0.5 *
+                        std::sin(6.2831853 * 440.0 * time);
+                }
+                for (synthclone::SampleChannelCount j = 0; j < channels;
+                     j++) {
+                    buffer[(i * channels) + j] = value;
+                }
+            }
+            stream.write(buffer, count);
+            frame += count;
+        }
+    } catch (...) {
+        delete[] buffer;
+        throw;
+    }
+    delete[] buffer;
+    stream.close();
+}
+
+void
+Benchmark::generateSession(const QDir &directory)
+{
+    synthclone::SampleRate sampleRate = 44100;
+    synthclone::SampleChannelCount channels = 2;
+    Session::create(directory, sampleRate, channels);
+    if (! directory.exists("samples")) {
+        if (! directory.mkdir("samples")) {
+            throw synthclone::Error(tr("failed to create samples directory"));
+        }
+    }
+    QDir samplesDirectory(directory.absoluteFilePath("samples"));
+
+    QFile file(directory.absoluteFilePath("synthclone-session.xml"));
+    if (! file.open(QIODevice::ReadOnly)) {
+        throw synthclone::Error(file.errorString());
+    }
+    QDomDocument document;
+    QString message;
+    if (! document.setContent(&file, &message)) {
+        throw synthclone::Error(message);
+    }
+    file.close();
+    QDomElement documentElement = document.documentElement();
+
+    // Zones are given scattered note and velocity values, so that sorting
+    // the zones by either property actually moves zones around.
+    QDomElement zonesElement = documentElement.firstChildElement("zones");
+    for (int i = 0; i < zoneCount; i++) {
+        QString name = QString("zone-%1.wav").arg(i);
+        generateSample(samplesDirectory.absoluteFilePath(name), sampleRate,
+                       channels, sampleRate / 2);
+        QDomElement element = document.createElement("zone");
+        element.setAttribute("channel", 1);
+        element.setAttribute("dry-sample", name);
+        element.setAttribute("note", (i * 37) % 128);
+        element.setAttribute("release-time", "0.1");
+        element.setAttribute("sample-time", "0.4");
+        element.setAttribute("velocity", ((i * 53) % 127) + 1);
+        element.appendChild(document.createElement("controls"));
+        zonesElement.appendChild(element);
+    }
+
+    // Built-in effects and targets.  Plugins that weren't built are reported
+    // as load warnings, and are skipped.
+    QStringList effectIds;
+    QStringList effectNames;
+    effectIds << "com.googlecode.synthclone.plugins.fader"
+              << "com.googlecode.synthclone.plugins.reverser"
+              << "com.googlecode.synthclone.plugins.trimmer";
+    effectNames << "Fader" << "Reverser" << "Trimmer";
+    QStringList targetIds;
+    QStringList targetNames;
+    targetIds << "com.googlecode.synthclone.plugins.hydrogen"
+              << "com.googlecode.synthclone.plugins.renoise"
+              << "com.googlecode.synthclone.plugins.sfz";
+    targetNames << "Hydrogen" << "Renoise" << "SFZ";
+
+    QDomElement participantsElement =
+        documentElement.firstChildElement("participants");
+    QStringList ids = effectIds + targetIds;
+    for (int i = 0; i < ids.count(); i++) {
+        QDomElement element = document.createElement("participant");
+        element.setAttribute("id", ids[i]);
+        element.appendChild(createStateElement(document, QVariant()));
+        participantsElement.appendChild(element);
+    }
+
+    QDomElement effectsElement = documentElement.firstChildElement("effects");
+    for (int i = 0; i < effectIds.count(); i++) {
+        QVariantMap state;
+        state["name"] = effectNames[i];
+        QDomElement element = document.createElement("effect");
+        element.setAttribute("participant-id", effectIds[i]);
+        element.appendChild(createStateElement(document, state));
+        effectsElement.appendChild(element);
+    }
+
+    QDir targetsDirectory(this->directory.absoluteFilePath("targets"));
+    QDomElement targetsElement = documentElement.firstChildElement("targets");
+    for (int i = 0; i < targetIds.count(); i++) {
+        const QString &name = targetNames[i];
+        QVariantMap state;
+        state["instrumentName"] = "Benchmark";
+        state["kitName"] = "Benchmark";
+        state["name"] = name;
+        state["path"] = targetsDirectory.absoluteFilePath(name);
+        QDomElement element = document.createElement("target");
+        element.setAttribute("participant-id", targetIds[i]);
+        element.appendChild(createStateElement(document, state));
+        targetsElement.appendChild(element);
+    }
+
+    if (! file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        throw synthclone::Error(file.errorString());
+    }
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    document.save(stream, 1);
+    file.close();
+    if (file.error() != QFile::NoError) {
+        throw synthclone::Error(file.errorString());
+    }
+}
+
+int
+Benchmark::getIterations() const
+{
+    return iterations;
+}
+
+int
+Benchmark::getZoneCount() const
+{
+    return zoneCount;
+}
+
+void
+Benchmark::handleSessionLoadWarning(int line, int column,
+                                    const QString &message)
+{
+    QTextStream(stderr, QIODevice::WriteOnly) <<
+        tr("Session warning (line %1, column %2): %3\n").
+        arg(line).arg(column).arg(message);
+}
+
+void
+Benchmark::handleTargetBuild(const synthclone::Target */*target*/)
+{
+    targetTimer.start();
+}
+
+void
+Benchmark::handleTargetBuildCompletion(const synthclone::Target *target)
+{
+    targetTimes[target->getName()].append(targetTimer.nsecsElapsed());
+}
+
+void
+Benchmark::handleTargetBuildError(const synthclone::Target *target,
+                                  const QString &message)
+{
+    if (targetBuildErrorMessage.isEmpty()) {
+        targetBuildErrorMessage = tr("target '%1': %2").
+            arg(target->getName(), message);
+    }
+}
+
+void
+Benchmark::removeFiles()
+{
+    session.unload();
+    removeDirectory(directory.absoluteFilePath("samples"));
+    removeDirectory(directory.absoluteFilePath("session"));
+    removeDirectory(directory.absoluteFilePath("targets"));
+}
+
+void
+Benchmark::run()
+{
+    results.clear();
+    if (! directory.exists()) {
+        throw synthclone::Error(tr("'%1' does not exist").
+                                arg(directory.absolutePath()));
+    }
+    try {
+        synthclone::SampleRate sampleRates[] = {44100, 96000};
+        synthclone::SampleChannelCount channelCounts[] = {1, 2};
+        synthclone::SampleFrameCount seconds[] = {1, 10};
+        for (int i = 0; i < 2; i++) {
+            for (int j = 0; j < 2; j++) {
+                for (int k = 0; k < 2; k++) {
+                    runSampleBenchmarks(sampleRates[i], channelCounts[j],
+                                        sampleRates[i] * seconds[k]);
+                }
+            }
+        }
+        runSessionBenchmarks();
+    } catch (...) {
+        try {
+            removeFiles();
+        } catch (synthclone::Error &) {
+            // The original error is more useful.
+        }
+        throw;
+    }
+    removeFiles();
+}
+
+void
+Benchmark::runEffectBenchmarks()
+{
+    // Effects are run directly in this thread instead of through effect jobs,
+    // so that each effect can be timed on its own.  No effect jobs are queued
+    // while the benchmarks run.
+    int effectCount = session.getEffectCount();
+    for (int i = 0; i < effectCount; i++) {
+        synthclone::Effect *effect =
+            const_cast<synthclone::Effect *>(session.getEffect(i));
+        QList<qint64> times;
+        QElapsedTimer timer;
+        for (int j = 0; j < iterations; j++) {
+            const synthclone::Zone *zone =
+                session.getZone(j % session.getZoneCount());
+            synthclone::SampleInputStream
+                inputStream(*(zone->getDrySample()));
+            synthclone::Sample outputSample;
+            synthclone::SampleOutputStream
+                outputStream(outputSample, inputStream.getSampleRate(),
+                             inputStream.getChannels());
+            timer.start();
+            effect->process(*zone, inputStream, outputStream);
+            outputStream.close();
+            times.append(timer.nsecsElapsed());
+        }
+        QVariantMap parameters;
+        parameters["effect"] = effect->getName();
+        addResult("Effect::process", parameters, times);
+    }
+}
+
+void
+Benchmark::runSampleBenchmarks(synthclone::SampleRate sampleRate,
+                               synthclone::SampleChannelCount channels,
+                               synthclone::SampleFrameCount frames)
+{
+    if (! directory.exists("samples")) {
+        if (! directory.mkdir("samples")) {
+            throw synthclone::Error(tr("failed to create samples directory"));
+        }
+    }
+    QDir samplesDirectory(directory.absoluteFilePath("samples"));
+    QString path = samplesDirectory.absoluteFilePath
+        (QString("sample-%1-%2-%3.wav").arg(sampleRate).arg(channels).
+         arg(frames));
+    generateSample(path, sampleRate, channels, frames);
+    synthclone::Sample sample(path);
+
+    QVariantMap parameters;
+    parameters["channels"] = channels;
+    parameters["frames"] = frames;
+    parameters["sampleRate"] = sampleRate;
+
+    QElapsedTimer timer;
+    QList<qint64> times;
+
+    // SampleCopier::copy()
+    for (int i = 0; i < iterations; i++) {
+        synthclone::SampleInputStream inputStream(sample);
+        synthclone::Sample outputSample;
+        synthclone::SampleOutputStream
+            outputStream(outputSample, sampleRate, channels);
+        synthclone::SampleCopier copier;
+        timer.start();
+        copier.copy(inputStream, outputStream, frames);
+        outputStream.close();
+        times.append(timer.nsecsElapsed());
+    }
+    addResult("SampleCopier::copy", parameters, times);
+
+    // SessionSampleData::updateSample(), first as a plain copy into the
+    // session, and then with sample rate and channel count conversion.
+    SessionSampleData sessionSampleData;
+    sessionSampleData.setSampleDirectory(&samplesDirectory);
+    for (int i = 0; i < 2; i++) {
+        bool convert = i == 1;
+        sessionSampleData.setSampleChannelCount
+            ((! convert) ? channels : ((channels == 1) ? 2 : 1));
+        sessionSampleData.setSampleRate
+            ((! convert) ? sampleRate : ((sampleRate == 44100) ? 48000 :
+                                         44100));
+        times.clear();
+        for (int j = 0; j < iterations; j++) {
+            timer.start();
+            synthclone::Sample *newSample =
+                sessionSampleData.updateSample(sample, true);
+            times.append(timer.nsecsElapsed());
+            if (newSample && (newSample != &sample)) {
+                newSample->setTemporary(true);
+                delete newSample;
+            }
+        }
+        QVariantMap updateParameters = parameters;
+        updateParameters["conversion"] = convert;
+        addResult("SessionSampleData::updateSample", updateParameters,
+                  times);
+    }
+    sessionSampleData.setSampleDirectory(0);
+
+    // SampleProfile
+    times.clear();
+    for (int i = 0; i < iterations; i++) {
+        timer.start();
+        SampleProfile profile(sample);
+        times.append(timer.nsecsElapsed());
+    }
+    addResult("SampleProfile", parameters, times);
+
+    if (! QFile::remove(path)) {
+        throw synthclone::Error(tr("failed to remove '%1'").arg(path));
+    }
+}
+
+void
+Benchmark::runSessionBenchmarks()
+{
+    QDir sessionDirectory(directory.absoluteFilePath("session"));
+    generateSession(sessionDirectory);
+    connect(&session, SIGNAL(loadWarning(int, int, const QString &)),
+            SLOT(handleSessionLoadWarning(int, int, const QString &)));
+
+    QVariantMap parameters;
+    parameters["zones"] = zoneCount;
+
+    QElapsedTimer timer;
+    QList<qint64> times;
+
+    // Session::load()
+    for (int i = 0; i < iterations; i++) {
+        timer.start();
+        session.load(sessionDirectory);
+        times.append(timer.nsecsElapsed());
+    }
+    addResult("Session::load", parameters, times);
+
+    // Session::save()
+    times.clear();
+    for (int i = 0; i < iterations; i++) {
+        timer.start();
+        session.save();
+        times.append(timer.nsecsElapsed());
+    }
+    addResult("Session::save", parameters, times);
+
+    // Session::sortZones().  Zones are sorted by note and velocity in turn,
+    // so that every sort reorders the zones.
+    ZoneComparer noteComparer(ZoneComparer::PROPERTY_NOTE);
+    ZoneComparer velocityComparer(ZoneComparer::PROPERTY_VELOCITY);
+    times.clear();
+    for (int i = 0; i < iterations; i++) {
+        const ZoneComparer &comparer = (i % 2) ? velocityComparer :
+            noteComparer;
+        timer.start();
+        session.sortZones(comparer);
+        times.append(timer.nsecsElapsed());
+    }
+    addResult("Session::sortZones", parameters, times);
+
+    disconnect(&session, SIGNAL(loadWarning(int, int, const QString &)),
+               this, SLOT(handleSessionLoadWarning(int, int,
+                                                   const QString &)));
+
+    runEffectBenchmarks();
+    runTargetBenchmarks();
+}
+
+void
+Benchmark::runTargetBenchmarks()
+{
+    if (! session.getTargetCount()) {
+        return;
+    }
+
+    // Targets are built through the session, like they are in the
+    // application, and timed between the 'buildingTarget()' and
+    // 'targetBuilt()' signals.  Build output is removed before every
+    // iteration, so that build manifests don't turn later iterations into
+    // no-op builds.
+    connect(&session, SIGNAL(buildingTarget(const synthclone::Target *)),
+            SLOT(handleTargetBuild(const synthclone::Target *)));
+    connect(&session, SIGNAL(targetBuilt(const synthclone::Target *)),
+            SLOT(handleTargetBuildCompletion(const synthclone::Target *)));
+    connect(&session, SIGNAL(targetBuildError(const synthclone::Target *,
+                                              const QString &)),
+            SLOT(handleTargetBuildError(const synthclone::Target *,
+                                        const QString &)));
+    targetBuildErrorMessage.clear();
+    targetTimes.clear();
+    QString targetsPath = directory.absoluteFilePath("targets");
+    try {
+        for (int i = 0; i < iterations; i++) {
+            removeDirectory(targetsPath);
+            for (int j = 0; j < session.getTargetCount(); j++) {
+                QDir targetDirectory(targetsPath);
+                QString name = session.getTarget(j)->getName();
+                if (! targetDirectory.mkpath(name)) {
+                    throw synthclone::Error
+                        (tr("failed to create target directory '%1'").
+                         arg(targetDirectory.absoluteFilePath(name)));
+                }
+            }
+            session.buildTargets();
+            if (! targetBuildErrorMessage.isEmpty()) {
+                throw synthclone::Error(targetBuildErrorMessage);
+            }
+        }
+    } catch (...) {
+        disconnect(&session, 0, this, 0);
+        throw;
+    }
+    disconnect(&session, 0, this, 0);
+
+    QMap<QString, QList<qint64> >::const_iterator end =
+        targetTimes.constEnd();
+    for (QMap<QString, QList<qint64> >::const_iterator iter =
+             targetTimes.constBegin(); iter != end; iter++) {
+        QVariantMap parameters;
+        parameters["target"] = iter.key();
+        parameters["zones"] = zoneCount;
+        addResult("Target::build", parameters, iter.value());
+    }
+}
+
+void
+Benchmark::setIterations(int iterations)
+{
+    CONFIRM(iterations > 0, tr("'%1': invalid iteration count").
+            arg(iterations));
+    this->iterations = iterations;
+}
+
+void
+Benchmark::setZoneCount(int count)
+{
+    CONFIRM(count > 0, tr("'%1': invalid zone count").arg(count));
+    zoneCount = count;
+}
+
+void
+Benchmark::writeResults(QIODevice &device) const
+{
+    QTextStream stream(&device);
+    stream.setCodec("UTF-8");
+    stream << "{\n";
+    stream << "    \"version\": "
+           << getJSONString(QString("%1.%2.%3").
+                            arg(SYNTHCLONE_MAJOR_VERSION).
+                            arg(SYNTHCLONE_MINOR_VERSION).
+                            arg(SYNTHCLONE_REVISION))
+           << ",\n";
+    stream << "    \"iterations\": " << iterations << ",\n";
+    stream << "    \"results\": [";
+    for (int i = 0; i < results.count(); i++) {
+        const Result &result = results[i];
+        QList<qint64> times = result.times;
+        qSort(times);
+        int count = times.count();
+        qint64 total = 0;
+        for (int j = 0; j < count; j++) {
+            total += times[j];
+        }
+        stream << (i ? ",\n" : "\n") << "        {\n";
+        stream << "            \"name\": " << getJSONString(result.name)
+               << ",\n";
+        stream << "            \"parameters\": {";
+        QVariantMap::const_iterator end = result.parameters.constEnd();
+        for (QVariantMap::const_iterator iter =
+                 result.parameters.constBegin(); iter != end; iter++) {
+            if (iter != result.parameters.constBegin()) {
+                stream << ", ";
+            }
+            stream << getJSONString(iter.key()) << ": "
+                   << getJSONValue(iter.value());
+        }
+        stream << "},\n";
+        stream << "            \"iterations\": " << count;
+        if (count) {
+            stream << ",\n            \"min-ms\": "
+                   << getJSONValue(times.first() / 1000000.0)
+                   << ",\n            \"median-ms\": "
+                   << getJSONValue(times[count / 2] / 1000000.0)
+                   << ",\n            \"mean-ms\": "
+                   << getJSONValue((static_cast<double>(total) / count) /
+                                   1000000.0)
+                   << ",\n            \"max-ms\": "
+                   << getJSONValue(times.last() / 1000000.0);
+        }
+        stream << "\n        }";
+    }
+    stream << "\n    ]\n}\n";
+    stream.flush();
+}
@@ -0,0 +1,136 @@
+/*
+ * synthclone - Synthesizer-cloning software
+ * Copyright (C) 2011 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QIODevice>
+#include <QtCore/QList>
+#include <QtCore/QMap>
+#include <QtCore/QVariant>
+
+#include <synthclone/types.h>
+
+#include "session.h"
+
+// Times the operations that dominate sampling, effect, and target runs, using
+// synthetic samples and sessions generated in a scratch directory.  Each
+// operation is run a fixed number of times, and the timings are written as
+// JSON, so that results from different builds can be compared by scripts.
+
+class Benchmark: public QObject {
+
+    Q_OBJECT
+
+public:
+
+    Benchmark(Session &session, const QDir &directory, QObject *parent=0);
+
+    ~Benchmark();
+
+    int
+    getIterations() const;
+
+    int
+    getZoneCount() const;
+
+    // Runs every benchmark.  Errors are thrown as 'synthclone::Error' objects.
+    void
+    run();
+
+    void
+    writeResults(QIODevice &device) const;
+
+public slots:
+
+    void
+    setIterations(int iterations);
+
+    void
+    setZoneCount(int count);
+
+private slots:
+
+    void
+    handleSessionLoadWarning(int line, int column, const QString &message);
+
+    void
+    handleTargetBuild(const synthclone::Target *target);
+
+    void
+    handleTargetBuildCompletion(const synthclone::Target *target);
+
+    void
+    handleTargetBuildError(const synthclone::Target *target,
+                           const QString &message);
+
+private:
+
+    struct Result {
+        QString name;
+        QVariantMap parameters;
+        QList<qint64> times;
+    };
+
+    static void
+    removeDirectory(const QString &path);
+
+    void
+    addResult(const QString &name, const QVariantMap &parameters,
+              const QList<qint64> &times);
+
+    void
+    generateSample(const QString &path, synthclone::SampleRate sampleRate,
+                   synthclone::SampleChannelCount channels,
+                   synthclone::SampleFrameCount frames);
+
+    void
+    generateSession(const QDir &directory);
+
+    void
+    removeFiles();
+
+    void
+    runEffectBenchmarks();
+
+    void
+    runSampleBenchmarks(synthclone::SampleRate sampleRate,
+                        synthclone::SampleChannelCount channels,
+                        synthclone::SampleFrameCount frames);
+
+    void
+    runSessionBenchmarks();
+
+    void
+    runTargetBenchmarks();
+
+    QDir directory;
+    int iterations;
+    QList<Result> results;
+    Session &session;
+    QString targetBuildErrorMessage;
+    QMap<QString, QList<qint64> > targetTimes;
+    QElapsedTimer targetTimer;
+    int zoneCount;
+
+};
+
+#endif
@@ -0,0 +1,158 @@
+/*
+ * synthclone - Synthesizer-cloning software
+ * Copyright (C) 2011 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+
+#include <QtCore/QDebug>
+#include <QtCore/QFile>
+#include <QtCore/QTextStream>
+
+#include <synthclone/error.h>
+
+#include "benchmark.h"
+#include "controller.h"
+
+// Runs the benchmarks in a new scratch directory, which is created in the
+// given directory or in the temporary directory, and writes the timings as
+// JSON to stdout or to the given file.  Like `synthclone`, this program needs
+// a display (a virtual framebuffer like Xvfb will do), as the core application
+// objects are created in order to load plugins and sessions.
+
+int
+main(int argc, char **argv)
+{
+    Application application(argc, argv);
+    QStringList arguments = application.arguments();
+    QString errorMessage;
+
+    // The application name matches `synthclone`, so that plugin paths from
+    // the user's settings are used.
+    application.setApplicationName("synthclone");
+    application.setOrganizationDomain("synthclone.googlecode.com");
+    application.setOrganizationName("synthclone.googlecode.com");
+
+    // Command line arguments
+    int count = arguments.count();
+    QString directoryPath;
+    int iterations = 5;
+    bool ok = true;
+    QString outputPath;
+    int result = EXIT_FAILURE;
+    int zoneCount = 128;
+    for (int i = 1; ok && (i < count); i++) {
+        const QString &argument = arguments[i];
+        if (argument == "--directory") {
+            ok = ++i < count;
+            if (ok) {
+                directoryPath = arguments[i];
+            }
+        } else if (argument == "--iterations") {
+            ok = ++i < count;
+            if (ok) {
+                iterations = arguments[i].toInt(&ok);
+                ok = ok && (iterations > 0);
+            }
+        } else if (argument == "--output") {
+            ok = ++i < count;
+            if (ok) {
+                outputPath = arguments[i];
+            }
+        } else if (argument == "--zones") {
+            ok = ++i < count;
+            if (ok) {
+                zoneCount = arguments[i].toInt(&ok);
+                ok = ok && (zoneCount > 0);
+            }
+        } else {
+            ok = false;
+        }
+    }
+    if (! ok) {
+        QTextStream(stderr, QIODevice::WriteOnly) <<
+            application.tr("Usage: synthclone-bench [qt-args] "
+                           "[--directory parent-dir] [--iterations count] "
+                           "[--output file] [--zones count]\n");
+        return EXIT_FAILURE;
+    }
+
+    // Scratch directory.  The benchmarks remove the files they create, so
+    // they're always run in a new directory, which is created in the given
+    // directory (or the temporary directory) and removed afterwards.  An
+    // existing directory is never used, as `mkdir` fails if the directory
+    // exists.
+    QDir directory = directoryPath.isEmpty() ? QDir::temp() :
+        QDir(directoryPath);
+    QString temporaryName = QString("synthclone-bench-%1").
+        arg(application.applicationPid());
+    if (! directory.mkdir(temporaryName)) {
+        QTextStream(stderr) <<
+            application.tr("Error: failed to create scratch directory in "
+                           "'%1'\n").arg(directory.absolutePath());
+        return EXIT_FAILURE;
+    }
+    directory.cd(temporaryName);
+
+    try {
+
+        qDebug() << application.tr("Creating core application objects ...");
+        Controller controller(application);
+        controller.setBatchMode(true);
+        qDebug() << application.tr("Core application objects created.");
+
+        Benchmark benchmark(controller.getSession(), directory);
+        benchmark.setIterations(iterations);
+        benchmark.setZoneCount(zoneCount);
+        qDebug() << application.tr("Running benchmarks ...");
+        benchmark.run();
+
+        QFile file;
+        if (outputPath.isEmpty()) {
+            ok = file.open(stdout, QIODevice::WriteOnly);
+        } else {
+            file.setFileName(outputPath);
+            ok = file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+        }
+        if (! ok) {
+            throw synthclone::Error(file.errorString());
+        }
+        benchmark.writeResults(file);
+        file.close();
+        result = EXIT_SUCCESS;
+
+    } catch (synthclone::Error &e) {
+        errorMessage = e.getMessage();
+    } catch (std::exception &e) {
+        errorMessage = e.what();
+    }
+
+    directory.cdUp();
+    if (! directory.rmdir(temporaryName)) {
+        qWarning() << application.tr("failed to remove '%1'").
+            arg(directory.absoluteFilePath(temporaryName));
+    }
+
+    // Deal with errors.
+    if (! errorMessage.isEmpty()) {
+        QTextStream(stderr) << application.tr("Error: %1\n").arg(errorMessage);
+        result = EXIT_FAILURE;
+    }
+    return result;
+}
@@ -0,0 +1,213 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __SYNTHCLONE_BUILDMANIFEST_H__
+#define __SYNTHCLONE_BUILDMANIFEST_H__
+
+#include <QtCore/QByteArray>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QMap>
+#include <QtCore/QVariant>
+
+#include <synthclone/sample.h>
+#include <synthclone/zone.h>
+
+namespace synthclone {
+
+    /**
+     * Keeps track of the files created by a Target build, so that subsequent
+     * builds can skip files that don't need to be rebuilt, and remove files
+     * that are no longer part of the build.
+     *
+     * A manifest maps file names, relative to the directory that contains the
+     * manifest, to keys.  A key should be generated from everything that
+     * affects the contents of a file: the identity of source samples, zone
+     * parameters, and target settings.  A file is considered current if the
+     * previous build created the file with the same key, and the file hasn't
+     * been modified since.
+     */
+
+    class BuildManifest: public QObject {
+
+        Q_OBJECT
+
+    public:
+
+        /**
+         * Creates a key from data that affects the contents of a file.
+         *
+         * @param data
+         *   The data.  The data must be serializable with QDataStream.
+         *
+         * @returns
+         *   The key.
+         */
+
+        static QByteArray
+        getKey(const QVariant &data);
+
+        /**
+         * Gets data that identifies the contents of a sample.  The data can be
+         * used to create a key.
+         *
+         * @param sample
+         *   The sample.
+         *
+         * @returns
+         *   The sample data.
+         *
+         * @sa
+         *   getKey()
+         */
+
+        static QVariant
+        getSampleData(const Sample &sample);
+
+        /**
+         * Gets data that identifies the MIDI parameters and times of a zone,
+         * along with the sample that targets use to build the zone (the wet
+         * sample if there is one, and the dry sample otherwise).  The data can
+         * be used to create a key.
+         *
+         * @param zone
+         *   The zone.
+         *
+         * @returns
+         *   The zone data.
+         *
+         * @sa
+         *   getKey()
+         */
+
+        static QVariant
+        getZoneData(const Zone &zone);
+
+        /**
+         * Constructs a new BuildManifest object, and reads the manifest at the
+         * given path if it exists.  A manifest that can't be read is treated
+         * as if it were empty, which results in a full build.
+         *
+         * @param path
+         *   The path to the manifest file.
+         *
+         * @param parent
+         *   The parent object of the manifest.
+         */
+
+        explicit
+        BuildManifest(const QString &path, QObject *parent=0);
+
+        /**
+         * Destroys the BuildManifest object.  The manifest file is not written
+         * unless BuildManifest::save() is called.
+         */
+
+        ~BuildManifest();
+
+        /**
+         * Adds a file to the current build.
+         *
+         * @param fileName
+         *   The file name, relative to the manifest directory.
+         *
+         * @param key
+         *   The key that describes the contents of the file.
+         */
+
+        void
+        addFile(const QString &fileName, const QByteArray &key);
+
+        /**
+         * Gets the directory that contains the manifest.
+         *
+         * @returns
+         *   The directory.
+         */
+
+        QDir
+        getDirectory() const;
+
+        /**
+         * Gets the path to the manifest file.
+         *
+         * @returns
+         *   The path.
+         */
+
+        QString
+        getPath() const;
+
+        /**
+         * Checks whether or not a file created by the previous build can be
+         * kept as is.
+         *
+         * @param fileName
+         *   The file name, relative to the manifest directory.
+         *
+         * @param key
+         *   The key that describes the contents the file should have.
+         *
+         * @returns
+         *   A boolean indicating whether or not the file is current.
+         */
+
+        bool
+        isFileCurrent(const QString &fileName, const QByteArray &key) const;
+
+        /**
+         * Removes the files that were created by the previous build, but that
+         * haven't been added to the current build.  Files that aren't listed
+         * in the manifest are never removed.
+         */
+
+        void
+        removeStaleFiles();
+
+        /**
+         * Writes the files added to the current build to the manifest file.
+         * This should be called after the build succeeds.
+         */
+
+        void
+        save();
+
+    private:
+
+        struct FileData {
+            QByteArray key;
+            QDateTime modified;
+            qint64 size;
+        };
+
+        typedef QMap<QString, FileData> FileDataMap;
+
+        void
+        read();
+
+        QDir directory;
+        FileDataMap files;
+        FileDataMap previousFiles;
+        QString path;
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,195 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __SYNTHCLONE_CALLBACKHEALTH_H__
+#define __SYNTHCLONE_CALLBACKHEALTH_H__
+
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+namespace synthclone {
+
+    class CallbackMonitor;
+
+    /**
+     * Holds the health of a realtime audio callback, as read from a
+     * CallbackMonitor.  Sampler implementations that process audio in a
+     * realtime callback can use this to report how well the callback is
+     * keeping up.
+     *
+     * @sa
+     *   CallbackMonitor
+     */
+
+    class CallbackHealth {
+
+        friend class CallbackMonitor;
+
+    public:
+
+        /**
+         * The number of buckets in the load histogram.  Each of the first ten
+         * buckets covers a tenth of the callback period, and the last bucket
+         * counts cycles that took longer than the period.
+         */
+
+        static const int LOAD_HISTOGRAM_SIZE = 11;
+
+        /**
+         * Constructs a new CallbackHealth object with all counts set to 0.
+         */
+
+        CallbackHealth();
+
+        /**
+         * Destroys the CallbackHealth object.
+         */
+
+        ~CallbackHealth();
+
+        /**
+         * Gets the number of buffers whose usage is tracked.
+         *
+         * @returns
+         *   The buffer count.
+         *
+         * @sa
+         *   CallbackMonitor::addBuffer()
+         */
+
+        int
+        getBufferCount() const;
+
+        /**
+         * Gets the highest usage seen for a buffer.
+         *
+         * @param index
+         *   The buffer index.
+         *
+         * @returns
+         *   The high-water mark, in the range [0.0, 1.0].
+         */
+
+        float
+        getBufferHighWaterMark(int index) const;
+
+        /**
+         * Gets the name of a buffer.
+         *
+         * @param index
+         *   The buffer index.
+         *
+         * @returns
+         *   The buffer name.
+         */
+
+        QString
+        getBufferName(int index) const;
+
+        /**
+         * Gets the number of callback cycles that have been measured.
+         *
+         * @returns
+         *   The cycle count.
+         */
+
+        int
+        getCycleCount() const;
+
+        /**
+         * Gets the DSP load: the time spent in the callback, divided by the
+         * length of the periods that the callback processed.  The load is
+         * averaged over the cycles measured since the health was last read.
+         *
+         * @returns
+         *   The load.  1.0 or more means that the callback can't keep up.
+         */
+
+        float
+        getLoad() const;
+
+        /**
+         * Gets the load histogram.
+         *
+         * @returns
+         *   A vector of LOAD_HISTOGRAM_SIZE cycle counts.
+         */
+
+        QVector<int>
+        getLoadHistogram() const;
+
+        /**
+         * Gets the longest time spent in one callback cycle.
+         *
+         * @returns
+         *   The cycle time in microseconds.
+         */
+
+        int
+        getMaximumCycleTime() const;
+
+        /**
+         * Gets the number of MIDI messages that couldn't be sent because
+         * there wasn't room for them in the MIDI buffer.
+         *
+         * @returns
+         *   The failure count.
+         */
+
+        int
+        getMIDIFailureCount() const;
+
+        /**
+         * Gets the highest load of a single callback cycle.
+         *
+         * @returns
+         *   The peak load.
+         */
+
+        float
+        getPeakLoad() const;
+
+        /**
+         * Gets the number of xruns (buffer overruns and underruns) reported
+         * by the audio API.
+         *
+         * @returns
+         *   The xrun count.
+         */
+
+        int
+        getXrunCount() const;
+
+    private:
+
+        QStringList bufferNames;
+        QVector<float> bufferHighWaterMarks;
+        int cycleCount;
+        float load;
+        QVector<int> loadHistogram;
+        int maximumCycleTime;
+        int midiFailureCount;
+        float peakLoad;
+        int xrunCount;
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,185 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __SYNTHCLONE_CALLBACKMONITOR_H__
+#define __SYNTHCLONE_CALLBACKMONITOR_H__
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QList>
+
+#include <synthclone/callbackhealth.h>
+#include <synthclone/types.h>
+
+namespace synthclone {
+
+    /**
+     * Tracks the health of a realtime audio callback: the time spent in each
+     * cycle, the DSP load, xruns, MIDI buffer failures, and buffer
+     * high-water marks.
+     *
+     * Every method that's used from the callback is lock-free and doesn't
+     * allocate memory, so the callback stays realtime safe.  The health is
+     * read from another thread with CallbackMonitor::read().
+     */
+
+    class CallbackMonitor {
+
+    public:
+
+        /**
+         * Constructs a new CallbackMonitor object.
+         */
+
+        CallbackMonitor();
+
+        /**
+         * Destroys the CallbackMonitor object.
+         */
+
+        ~CallbackMonitor();
+
+        /**
+         * Adds a buffer to track the usage of.  Buffers must be added before
+         * the callback starts using the monitor.
+         *
+         * @param name
+         *   The name to show for the buffer.
+         *
+         * @returns
+         *   The buffer index, which is passed to
+         *   CallbackMonitor::updateBufferUsage().
+         */
+
+        int
+        addBuffer(const QString &name);
+
+        /**
+         * Counts a MIDI message that couldn't be sent.  This method is
+         * realtime safe.
+         */
+
+        void
+        addMIDIFailure();
+
+        /**
+         * Counts an xrun.  This method is realtime safe, and can be called
+         * from any thread.
+         */
+
+        void
+        addXrun();
+
+        /**
+         * Ends the measurement of a callback cycle.  This method is realtime
+         * safe.
+         *
+         * @param frames
+         *   The number of frames that the cycle processed.
+         *
+         * @param sampleRate
+         *   The sample rate of the frames.
+         */
+
+        void
+        endCycle(SampleFrameCount frames, SampleRate sampleRate);
+
+        /**
+         * Gets the number of xruns counted since the monitor was constructed.
+         * Unlike the count in the callback health, this count isn't cleared
+         * by CallbackMonitor::reset(), so two reads can be compared to find
+         * out whether an xrun occurred in between.  This method is realtime
+         * safe.
+         *
+         * @returns
+         *   The xrun count.
+         */
+
+        int
+        getXrunCount() const;
+
+        /**
+         * Reads the health of the callback.  The DSP load is averaged over
+         * the cycles measured since the last read, so this should be called
+         * at a regular interval.
+         *
+         * @returns
+         *   The callback health.
+         */
+
+        CallbackHealth
+        read();
+
+        /**
+         * Resets all counts and high-water marks.  Measurements made by the
+         * callback while the reset is in progress may be lost.
+         */
+
+        void
+        reset();
+
+        /**
+         * Starts the measurement of a callback cycle.  This method is
+         * realtime safe.
+         */
+
+        void
+        startCycle();
+
+        /**
+         * Records the usage of a buffer, and updates the buffer's high-water
+         * mark.  This method is realtime safe.
+         *
+         * @param index
+         *   The buffer index returned by CallbackMonitor::addBuffer().
+         *
+         * @param used
+         *   The amount of the buffer that's in use.
+         *
+         * @param size
+         *   The size of the buffer, in the same units as 'used'.
+         */
+
+        void
+        updateBufferUsage(int index, size_t used, size_t size);
+
+    private:
+
+        static void
+        updateMaximum(QAtomicInt &maximum, int value);
+
+        QList<QAtomicInt *> bufferHighWaterMarks;
+        QStringList bufferNames;
+        QAtomicInt busyTime;
+        QAtomicInt cycleCount;
+        qint64 cycleStartTime;
+        QAtomicInt loadHistogram[CallbackHealth::LOAD_HISTOGRAM_SIZE];
+        QAtomicInt maximumCycleTime;
+        QAtomicInt midiFailureCount;
+        QAtomicInt peakLoad;
+        QAtomicInt periodTime;
+        QAtomicInt resetXrunCount;
+        QElapsedTimer timer;
+        QAtomicInt xrunCount;
+
+    };
+
+}
+
+#endif
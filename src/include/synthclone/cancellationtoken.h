@@ -0,0 +1,129 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __SYNTHCLONE_CANCELLATIONTOKEN_H__
+#define __SYNTHCLONE_CANCELLATIONTOKEN_H__
+
+#include <QtCore/QAtomicInt>
+
+namespace synthclone {
+
+    /**
+     * Used to cancel a long running operation, like an effect job or a target
+     * build, from another thread.  The operation checks the token at points
+     * where it can safely stop, and raises a synthclone::Error when the token
+     * has been cancelled.
+     *
+     * `synthclone` makes the token for the current effect job or target build
+     * the current token of the thread that runs the operation.
+     * SampleInputStream::read() and SampleOutputStream::write() check the
+     * current token, so Effect and Target implementations that stream sample
+     * data are cancellable without any extra work.  Components that do a lot
+     * of work between reads and writes can call CancellationToken::check()
+     * with the current token themselves.  Components that hand work to other
+     * threads should make the token current in those threads as well.
+     */
+
+    class CancellationToken {
+
+    public:
+
+        /**
+         * Raises a synthclone::Error if the calling thread has a current
+         * token, and the token has been cancelled.
+         */
+
+        static void
+        checkCurrent();
+
+        /**
+         * Gets the current token of the calling thread.
+         *
+         * @returns
+         *   The current token, or 0 if the thread doesn't have a current
+         *   token.
+         */
+
+        static const CancellationToken *
+        getCurrent();
+
+        /**
+         * Sets the current token of the calling thread.
+         *
+         * @param token
+         *   The token, or 0 to clear the current token.  The token must
+         *   remain valid until it's no longer the current token.
+         */
+
+        static void
+        setCurrent(const CancellationToken *token);
+
+        /**
+         * Constructs a new CancellationToken object.
+         */
+
+        CancellationToken();
+
+        /**
+         * Destroys the CancellationToken object.
+         */
+
+        ~CancellationToken();
+
+        /**
+         * Cancels the operation that uses this token.  This method can be
+         * called from any thread.
+         */
+
+        void
+        cancel();
+
+        /**
+         * Raises a synthclone::Error if the token has been cancelled.
+         */
+
+        void
+        check() const;
+
+        /**
+         * Checks whether or not the token has been cancelled.
+         *
+         * @returns
+         *   A boolean indicating whether or not the token has been cancelled.
+         */
+
+        bool
+        isCancelled() const;
+
+        /**
+         * Resets the token, so that it can be used for another operation.
+         */
+
+        void
+        reset();
+
+    private:
+
+        QAtomicInt cancelled;
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,158 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __SYNTHCLONE_CAPTUREBUFFERPOOL_H__
+#define __SYNTHCLONE_CAPTUREBUFFERPOOL_H__
+
+#include <QtCore/QList>
+#include <QtCore/QMap>
+#include <QtCore/QMutex>
+
+namespace synthclone {
+
+    /**
+     * Keeps a pool of large sample buffers that are recycled between sampler
+     * jobs, so that starting a job doesn't need to allocate memory.
+     *
+     * Buffers are page-aligned, and every page is touched when the buffer is
+     * allocated, so the realtime callback never takes a page fault when it
+     * writes to a buffer for the first time.  Buffers can optionally be
+     * locked into memory so that they're never swapped out.
+     *
+     * Buffers are meant to be allocated ahead of time with
+     * CaptureBufferPool::reserve().  The pool can be used from more than one
+     * thread, but none of its methods are realtime safe.
+     */
+
+    class CaptureBufferPool {
+
+    public:
+
+        /**
+         * Constructs a new CaptureBufferPool object.
+         *
+         * @param locked
+         *   Whether or not buffers should be locked into memory.
+         */
+
+        explicit
+        CaptureBufferPool(bool locked=false);
+
+        /**
+         * Destroys the CaptureBufferPool object, and frees all of its
+         * buffers, including buffers that haven't been released.
+         */
+
+        ~CaptureBufferPool();
+
+        /**
+         * Takes a buffer from the pool.  If the pool doesn't contain a buffer
+         * that's large enough, then a new buffer is allocated.
+         *
+         * @param size
+         *   The number of samples the buffer must be able to hold.
+         *
+         * @returns
+         *   The buffer.  The buffer must be returned to the pool with
+         *   CaptureBufferPool::release().
+         */
+
+        float *
+        acquire(qint64 size);
+
+        /**
+         * Frees all of the buffers that are in the pool.  Buffers that have
+         * been acquired are not affected.
+         */
+
+        void
+        clear();
+
+        /**
+         * Gets the number of buffers that are in the pool.
+         *
+         * @returns
+         *   The buffer count.
+         */
+
+        int
+        getBufferCount() const;
+
+        /**
+         * Gets a boolean indicating whether or not buffers are locked into
+         * memory.
+         *
+         * @returns
+         *   The boolean.
+         */
+
+        bool
+        isLocked() const;
+
+        /**
+         * Returns a buffer to the pool.
+         *
+         * @param buffer
+         *   A buffer that was returned by CaptureBufferPool::acquire().
+         */
+
+        void
+        release(float *buffer);
+
+        /**
+         * Makes sure that the pool contains at least the given number of
+         * buffers that can hold the given number of samples.  Smaller buffers
+         * in the pool are replaced.
+         *
+         * @param count
+         *   The number of buffers.
+         *
+         * @param size
+         *   The number of samples each buffer must be able to hold.
+         */
+
+        void
+        reserve(int count, qint64 size);
+
+    private:
+
+        struct Buffer {
+            float *data;
+            qint64 size;
+        };
+
+        static Buffer
+        allocate(qint64 size, bool locked);
+
+        static void
+        deallocate(const Buffer &buffer, bool locked);
+
+        static qint64
+        getPageSize();
+
+        QMap<float *, qint64> acquiredBuffers;
+        QList<Buffer> buffers;
+        bool locked;
+        mutable QMutex mutex;
+
+    };
+
+}
+
+#endif
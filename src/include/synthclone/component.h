@@ -23,6 +23,8 @@
 #include <QtCore/QObject>
 #include <QtCore/QString>
 
+#include <synthclone/progressthrottle.h>
+
 namespace synthclone {
 
     /**
@@ -75,6 +77,10 @@ namespace synthclone {
          * Emitted by the Component to indicate progress in whatever operation
          * the Component is performing.
          *
+         * Components should call Component::reportProgress() instead of
+         * emitting this signal directly, as progress is often reported from
+         * another thread, and every emission is delivered to the GUI thread.
+         *
          * @param progress
          *   The 'progress' amount, which must be in the range [0.0, 1.0],
          *   where 0.0 and 1.0 are roughly equivalent to "just starting" and
@@ -124,9 +130,34 @@ namespace synthclone {
         virtual
         ~Component();
 
+        /**
+         * Reports progress in whatever operation the Component is performing.
+         * Progress is quantized to 0.1%, and intermediate values are emitted
+         * with Component::progressChanged() at most every 50 milliseconds, so
+         * this method can be called as often as is convenient (even for every
+         * frame).  A value that's held back is emitted shortly afterwards if
+         * no further progress is reported.  0.0 and 1.0 are always emitted.
+         * This method is lock-free, and can be called from any thread.
+         *
+         * @param progress
+         *   The 'progress' amount, in the range [0.0, 1.0].
+         */
+
+        void
+        reportProgress(float progress);
+
+    private slots:
+
+        void
+        flushProgress();
+
+        void
+        scheduleProgressFlush();
+
     private:
 
         QString name;
+        ProgressThrottle progressThrottle;
 
     };
 
@@ -29,7 +29,9 @@
 #include <synthclone/menuseparator.h>
 #include <synthclone/registration.h>
 #include <synthclone/sampler.h>
+#include <synthclone/stagemetrics.h>
 #include <synthclone/target.h>
+#include <synthclone/taskpool.h>
 #include <synthclone/zonecomparer.h>
 
 namespace synthclone {
@@ -384,6 +386,32 @@ namespace synthclone {
         virtual SessionState
         getSessionState() const = 0;
 
+        /**
+         * Gets metrics from the stage metrics list.  `synthclone` adds metrics
+         * to the list for every sampler job, for every effect run on a zone,
+         * and for every target build, in the order in which the stages
+         * finish.
+         *
+         * @param index
+         *   The index of the metrics to get.
+         *
+         * @returns
+         *   The StageMetrics object.
+         */
+
+        virtual StageMetrics
+        getStageMetrics(int index) const = 0;
+
+        /**
+         * Gets the count of StageMetrics objects in the stage metrics list.
+         *
+         * @returns
+         *   The count.
+         */
+
+        virtual int
+        getStageMetricsCount() const = 0;
+
         /**
          * Gets a Target from the Target list.
          *
@@ -420,6 +448,22 @@ namespace synthclone {
         virtual int
         getTargetIndex(const Target *target) const = 0;
 
+        /**
+         * Gets the TaskPool shared by `synthclone` and its participants.  The
+         * pool is sized to the machine, so components that want to do work
+         * in parallel should start tasks in this pool instead of creating
+         * their own threads.
+         *
+         * @returns
+         *   The TaskPool object.
+         *
+         * @sa
+         *   Task, TaskGroup
+         */
+
+        virtual TaskPool &
+        getTaskPool() = 0;
+
         /**
          * Gets a Zone.
          *
@@ -635,6 +679,18 @@ namespace synthclone {
 
     public slots:
 
+        /**
+         * Cancels the current EffectJob.  The job stops the next time the
+         * running Effect reads or writes sample data, its partial output is
+         * discarded, and its Zone is returned to Zone::STATUS_NORMAL.
+         *
+         * @sa
+         *   CancellationToken
+         */
+
+        virtual void
+        abortCurrentEffectJob() = 0;
+
         /**
          * Tells the Sampler to abort the current SamplerJob.
          */
@@ -642,6 +698,18 @@ namespace synthclone {
         virtual void
         abortCurrentSamplerJob() = 0;
 
+        /**
+         * Cancels the target build that's in progress.  The Target that's
+         * being built stops the next time it reads or writes sample data, and
+         * the remaining targets are skipped.
+         *
+         * @sa
+         *   CancellationToken
+         */
+
+        virtual void
+        abortTargetBuild() = 0;
+
         /**
          * Activates a Participant.  This allows a Participant object to
          * interact with the application.
@@ -955,6 +1023,28 @@ namespace synthclone {
         virtual void
         buildTargets() = 0;
 
+        /**
+         * Removes all metrics from the stage metrics list.  The list is also
+         * cleared when a session is unloaded.
+         */
+
+        virtual void
+        clearStageMetrics() = 0;
+
+        /**
+         * Creates an empty file in the session's samples directory.  A Sample
+         * that's written to the file in the session's sample format can be
+         * given to Zone::adoptDrySample() without the sample data being
+         * copied, which allows the sample data to be written outside of the
+         * GUI thread.
+         *
+         * @returns
+         *   The path to the new file.
+         */
+
+        virtual QString
+        createSampleFile() = 0;
+
         /**
          * Writes an empty `synthclone` session to a directory.
          *
@@ -2869,6 +2959,26 @@ namespace synthclone {
         sessionStateChanged(synthclone::SessionState state,
                             const QDir *directory);
 
+        /**
+         * Emitted when metrics are added to the stage metrics list.
+         *
+         * @param metrics
+         *   The StageMetrics object.
+         *
+         * @param index
+         *   The index of the metrics in the list.
+         */
+
+        void
+        stageMetricsAdded(const synthclone::StageMetrics &metrics, int index);
+
+        /**
+         * Emitted when the stage metrics list is cleared.
+         */
+
+        void
+        stageMetricsCleared();
+
         /**
          * Emitted when the visibility of the status property is changed.
          *
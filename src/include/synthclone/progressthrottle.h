@@ -0,0 +1,141 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __SYNTHCLONE_PROGRESSTHROTTLE_H__
+#define __SYNTHCLONE_PROGRESSTHROTTLE_H__
+
+#include <QtCore/QAtomicInt>
+
+namespace synthclone {
+
+    /**
+     * Limits the rate at which progress is reported.  Progress is quantized
+     * to a fixed resolution, and intermediate values are only reported if a
+     * minimum interval has passed since the last report.  Values that aren't
+     * reported are held back, so a burst of updates is coalesced into the
+     * latest value, which is reported by the next eligible update, or by
+     * flush() if no more updates arrive.  The start (0.0) and end (1.0) of an
+     * operation are always reported.
+     *
+     * ProgressThrottle::update() and ProgressThrottle::flush() are lock-free,
+     * and can be called from any thread.
+     *
+     * @sa
+     *   Component::reportProgress()
+     */
+
+    class ProgressThrottle {
+
+    public:
+
+        /**
+         * Constructs a new ProgressThrottle object.
+         *
+         * @param interval
+         *   The minimum number of milliseconds between reports of
+         *   intermediate values.
+         *
+         * @param resolution
+         *   The number of steps that progress is quantized to.
+         */
+
+        explicit
+        ProgressThrottle(int interval=50, int resolution=1000);
+
+        /**
+         * Destroys the ProgressThrottle object.
+         */
+
+        ~ProgressThrottle();
+
+        /**
+         * Reports the latest value that was held back by update(), if it
+         * hasn't been reported since.
+         *
+         * @param reportedProgress
+         *   If a value should be reported, then this is set to the quantized
+         *   progress.
+         *
+         * @returns
+         *   A boolean indicating whether or not a value should be reported.
+         */
+
+        bool
+        flush(float &reportedProgress);
+
+        /**
+         * Gets the minimum number of milliseconds between reports of
+         * intermediate values.
+         *
+         * @returns
+         *   The interval.
+         */
+
+        int
+        getInterval() const;
+
+        /**
+         * Forgets the last reported value, so that the next update is always
+         * reported.
+         */
+
+        void
+        reset();
+
+        /**
+         * Updates the progress.
+         *
+         * @param progress
+         *   The progress, in the range [0.0, 1.0].
+         *
+         * @param reportedProgress
+         *   If the update should be reported, then this is set to the
+         *   quantized progress.
+         *
+         * @param flushRequired
+         *   If this isn't 0, then it's set to true when the update is held
+         *   back and no flush is outstanding.  The caller should then call
+         *   flush() once the interval has passed, so that the last value of
+         *   a burst is reported even if no more updates arrive.
+         *
+         * @returns
+         *   A boolean indicating whether or not the update should be reported.
+         */
+
+        bool
+        update(float progress, float &reportedProgress,
+               bool *flushRequired=0);
+
+    private:
+
+        bool
+        report(int last, int value, int now, float &reportedProgress);
+
+        QAtomicInt flushPending;
+        int interval;
+        QAtomicInt lastTime;
+        QAtomicInt lastValue;
+        QAtomicInt pendingValue;
+        int resolution;
+
+    };
+
+}
+
+#endif
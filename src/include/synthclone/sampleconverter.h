@@ -0,0 +1,121 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __SYNTHCLONE_SAMPLECONVERTER_H__
+#define __SYNTHCLONE_SAMPLECONVERTER_H__
+
+#include <synthclone/sampleinputstream.h>
+#include <synthclone/sampleoutputstream.h>
+
+namespace synthclone {
+
+    /**
+     * Utility class that converts Sample data from a SampleInputStream to the
+     * sample rate and channel count of a SampleOutputStream, emitting
+     * SampleConverter::convertProgress events as it goes along.  Sample rate
+     * conversion is done with libsamplerate.  Channel conversion is only
+     * supported if the channel counts are equal, or if one of the streams is
+     * mono.
+     *
+     * Unlike SampleCopier, a SampleConverter is lightweight, and can be
+     * created on the stack of a worker thread.
+     */
+
+    class SampleConverter: public QObject {
+
+        Q_OBJECT
+
+    public:
+
+        /**
+         * Checks whether or not samples can be converted between the given
+         * channel counts.
+         *
+         * @param inputChannels
+         *   The channel count of the input stream.
+         *
+         * @param outputChannels
+         *   The channel count of the output stream.
+         *
+         * @returns
+         *   A boolean indicating whether or not conversion is possible.
+         */
+
+        static bool
+        canConvertChannels(SampleChannelCount inputChannels,
+                           SampleChannelCount outputChannels);
+
+        /**
+         * Constructs a new SampleConverter.
+         *
+         * @param parent
+         *   The parent object of the new SampleConverter object.
+         */
+
+        explicit
+        SampleConverter(QObject *parent=0);
+
+        /**
+         * Destroys the SampleConverter object.
+         */
+
+        ~SampleConverter();
+
+        /**
+         * Converts the remaining data in a SampleInputStream, and writes the
+         * converted data to a SampleOutputStream.
+         *
+         * @param inputStream
+         *   The SampleInputStream.
+         *
+         * @param outputStream
+         *   The SampleOutputStream.
+         *
+         * @returns
+         *   The total number of frames written to the output stream.
+         *
+         * @sa
+         *   canConvertChannels()
+         */
+
+        SampleFrameCount
+        convert(SampleInputStream &inputStream,
+                SampleOutputStream &outputStream);
+
+    signals:
+
+        /**
+         * Emitted when frames are being converted.
+         *
+         * @param framesConverted
+         *   The number of input frames converted thus far.
+         *
+         * @param totalFrames
+         *   The total number of input frames that will be converted.
+         */
+
+        void
+        convertProgress(synthclone::SampleFrameCount framesConverted,
+                        synthclone::SampleFrameCount totalFrames);
+
+    };
+
+}
+
+#endif
@@ -20,6 +20,7 @@
 #ifndef __SYNTHCLONE_SAMPLECOPIER_H__
 #define __SYNTHCLONE_SAMPLECOPIER_H__
 
+#include <synthclone/progressthrottle.h>
 #include <synthclone/sampleinputstream.h>
 #include <synthclone/sampleoutputstream.h>
 
@@ -28,7 +29,8 @@ namespace synthclone {
     /**
      * Utility class that copies Sample data from a SampleInputStream to a
      * SampleOutputStream, emitting SampleCopier::copyProgress events as it
-     * goes along.
+     * goes along.  Copies stop with a synthclone::Error when the current
+     * CancellationToken of the calling thread is cancelled.
      */
 
     class SampleCopier: public QObject {
@@ -79,7 +81,9 @@ namespace synthclone {
     signals:
 
         /**
-         * Emitted when frames are being copied.
+         * Emitted when frames are being copied.  The signal is emitted at
+         * most every 50 milliseconds while a copy is in progress, and once
+         * when the copy finishes.
          *
          * @param framesCopied
          *   The number of frames copied thus far.
@@ -95,6 +99,7 @@ namespace synthclone {
     private:
 
         float buffer[65536];
+        ProgressThrottle progressThrottle;
 
     };
 
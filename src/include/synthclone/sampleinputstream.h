@@ -20,6 +20,8 @@
 #ifndef __SYNTHCLONE_SAMPLEINPUTSTREAM_H__
 #define __SYNTHCLONE_SAMPLEINPUTSTREAM_H__
 
+#include <QtCore/QIODevice>
+
 #include <synthclone/sample.h>
 #include <synthclone/samplestream.h>
 
@@ -50,6 +52,23 @@ namespace synthclone {
         explicit
         SampleInputStream(const Sample &sample, QObject *parent=0);
 
+        /**
+         * Constructs a new sample input stream that reads from a QIODevice
+         * instead of a Sample.  This can be used to decode sample data that's
+         * already in memory with a QBuffer.
+         *
+         * @param device
+         *   The device to read from.  The device must be open for reading,
+         *   and must not be sequential, as decoders may need to seek.  The
+         *   device must outlive the stream.
+         *
+         * @param parent
+         *   The parent object of the new stream object.
+         */
+
+        explicit
+        SampleInputStream(QIODevice &device, QObject *parent=0);
+
         /**
          * Destroys the stream.
          */
@@ -57,7 +76,10 @@ namespace synthclone {
         ~SampleInputStream();
 
         /**
-         * Reads data from the stream.
+         * Reads data from the stream.  A synthclone::Error is raised if the
+         * current CancellationToken of the calling thread has been cancelled.
+         * The frames read are counted with the current StageMeter of the
+         * calling thread.
          *
          * @param buffer
          *   A buffer to read data into.  The buffer's size should be greater
@@ -20,6 +20,8 @@
 #ifndef __SYNTHCLONE_SAMPLEOUTPUTSTREAM_H__
 #define __SYNTHCLONE_SAMPLEOUTPUTSTREAM_H__
 
+#include <QtCore/QIODevice>
+
 #include <synthclone/sample.h>
 #include <synthclone/samplestream.h>
 
@@ -88,6 +90,41 @@ namespace synthclone {
                            EndianType endianType=ENDIANTYPE_FILE,
                            QObject *parent=0);
 
+        /**
+         * Creates a sample output stream object that writes to an I/O device
+         * instead of a Sample.  This can be used to encode sample data in
+         * memory with a QBuffer.
+         *
+         * @param device
+         *   The device to write to.  The device must be open for writing, and
+         *   must not be sequential, as encoders may need to seek in order to
+         *   write headers.  The device must outlive the stream.
+         *
+         * @param sampleRate
+         *   The sample rate to use.
+         *
+         * @param channels
+         *   The channel count.
+         *
+         * @param type
+         *   The format type.
+         *
+         * @param subType
+         *   The format sub-type.
+         *
+         * @param endianType
+         *   The format endian-type.
+         *
+         * @param parent
+         *   The parent object of the new stream.
+         */
+
+        SampleOutputStream(QIODevice &device, SampleRate sampleRate,
+                           SampleChannelCount channels, Type type,
+                           SubType subType,
+                           EndianType endianType=ENDIANTYPE_FILE,
+                           QObject *parent=0);
+
         /**
          * Destroys the stream.  This will close the stream if it isn't closed.
          */
@@ -96,7 +133,10 @@ namespace synthclone {
 
         /**
          * Writes 'frames' data to the stream.  The data is contained in
-         * 'buffer'.
+         * 'buffer'.  A synthclone::Error is raised if the current
+         * CancellationToken of the calling thread has been cancelled.  The
+         * frames written are counted with the current StageMeter of the
+         * calling thread.
          */
 
         void
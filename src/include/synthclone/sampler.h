@@ -103,7 +103,10 @@ namespace synthclone {
          *      given stream.  Whether or not this is done asynchronously or
          *      after all data is retrieved is up to the sampler
          *      implementation.
-         *   -# When sampling is complete, emit the jobCompleted() signal.
+         *   -# When sampling is complete, emit the jobCompleted() signal.  If
+         *      the captured audio may have been damaged (e.g. by an xrun or a
+         *      buffer overflow while retrieving data), emit the
+         *      jobCompromised() signal instead.
          *   .
          * If an error occurs during the sampling process:
          *   -# If MIDI messages have been sent, execute steps 7-10 above (if
@@ -150,6 +153,19 @@ namespace synthclone {
         void
         jobCompleted();
 
+        /**
+         * Emitted when a sampling job finishes, but the captured audio may
+         * have been damaged by an xrun or a buffer overflow.  All of the
+         * audio data must still be written to the stream; the session decides
+         * whether to keep the sample or to run the job again.
+         *
+         * @param message
+         *   A message describing what happened.
+         */
+
+        void
+        jobCompromised(const QString &message);
+
         /**
          * Emitted when a job cannot be completed due to an error.
          *
@@ -0,0 +1,232 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __SYNTHCLONE_STAGEMETER_H__
+#define __SYNTHCLONE_STAGEMETER_H__
+
+#include <QtCore/QDateTime>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMutex>
+
+#include <synthclone/types.h>
+
+namespace synthclone {
+
+    /**
+     * Measures a stage of work, like an effect processing a zone or a target
+     * build.  A meter records the wall time and CPU time between
+     * StageMeter::start() and StageMeter::stop(), along with the amount of
+     * sample data that's read and written while the meter is current.
+     *
+     * `synthclone` makes a meter current in the thread that runs a stage.
+     * SampleInputStream::read() and SampleOutputStream::write() count sample
+     * data with the current meter, so Effect and Target implementations are
+     * measured without any extra work.  Components that stream sample data in
+     * other threads should make the meter current in those threads as well
+     * (Task objects started from the thread take the meter with them).  CPU
+     * time only covers the thread that starts and stops the meter.
+     *
+     * Sample data is counted per thread without locking, and is added to the
+     * meter when the thread's current meter changes, or when the thread that
+     * started the meter stops it.  Counting costs a single atomic read when
+     * no thread has a current meter.
+     */
+
+    class StageMeter {
+
+    public:
+
+        /**
+         * Counts sample data read by the calling thread with the current
+         * meter, if the thread has a current meter.
+         *
+         * @param frames
+         *   The number of frames read.
+         *
+         * @param channels
+         *   The channel count of the frames.
+         */
+
+        static void
+        countRead(SampleFrameCount frames, SampleChannelCount channels);
+
+        /**
+         * Counts sample data written by the calling thread with the current
+         * meter, if the thread has a current meter.
+         *
+         * @param frames
+         *   The number of frames written.
+         *
+         * @param channels
+         *   The channel count of the frames.
+         */
+
+        static void
+        countWrite(SampleFrameCount frames, SampleChannelCount channels);
+
+        /**
+         * Gets the current meter of the calling thread.
+         *
+         * @returns
+         *   The current meter, or 0 if the thread doesn't have a current
+         *   meter.
+         */
+
+        static StageMeter *
+        getCurrent();
+
+        /**
+         * Sets the current meter of the calling thread.
+         *
+         * @param meter
+         *   The meter, or 0 to clear the current meter.  The meter must
+         *   remain valid until it's no longer the current meter.
+         */
+
+        static void
+        setCurrent(StageMeter *meter);
+
+        /**
+         * Constructs a new StageMeter object.
+         */
+
+        StageMeter();
+
+        /**
+         * Destroys the StageMeter object.  If the meter is current in the
+         * calling thread, then the thread no longer has a current meter.
+         */
+
+        ~StageMeter();
+
+        /**
+         * Gets the number of bytes of sample data read.  Sample data is
+         * counted as 32-bit floats, which is the format that streams hand to
+         * components, regardless of how the data is stored.
+         *
+         * @returns
+         *   The byte count.
+         */
+
+        qint64
+        getBytesRead() const;
+
+        /**
+         * Gets the number of bytes of sample data written.  Sample data is
+         * counted as 32-bit floats.
+         *
+         * @returns
+         *   The byte count.
+         */
+
+        qint64
+        getBytesWritten() const;
+
+        /**
+         * Gets the CPU time used by the thread that started the meter.
+         *
+         * @returns
+         *   The CPU time in microseconds, or -1 if CPU time can't be measured
+         *   on this platform.
+         */
+
+        qint64
+        getCPUTime() const;
+
+        /**
+         * Gets the number of sample frames read.
+         *
+         * @returns
+         *   The frame count.
+         */
+
+        SampleFrameCount
+        getFramesRead() const;
+
+        /**
+         * Gets the number of sample frames written.
+         *
+         * @returns
+         *   The frame count.
+         */
+
+        SampleFrameCount
+        getFramesWritten() const;
+
+        /**
+         * Gets the time at which the meter was started.
+         *
+         * @returns
+         *   The start time.
+         */
+
+        QDateTime
+        getStartTime() const;
+
+        /**
+         * Gets the wall time between StageMeter::start() and
+         * StageMeter::stop().  If the meter hasn't been stopped, then the
+         * wall time thus far is returned.
+         *
+         * @returns
+         *   The wall time in microseconds.
+         */
+
+        qint64
+        getWallTime() const;
+
+        /**
+         * Resets the meter, and starts measuring.  This should be called from
+         * the thread that runs the stage.
+         */
+
+        void
+        start();
+
+        /**
+         * Stops measuring.  This should be called from the thread that
+         * called StageMeter::start().
+         */
+
+        void
+        stop();
+
+    private:
+
+        void
+        addCounts(qint64 bytesRead, qint64 bytesWritten,
+                  SampleFrameCount framesRead, SampleFrameCount framesWritten);
+
+        qint64 bytesRead;
+        qint64 bytesWritten;
+        qint64 cpuTime;
+        SampleFrameCount framesRead;
+        SampleFrameCount framesWritten;
+        mutable QMutex mutex;
+        QDateTime startTime;
+        qint64 startCPUTime;
+        bool stopped;
+        QElapsedTimer timer;
+        qint64 wallTime;
+
+    };
+
+}
+
+#endif
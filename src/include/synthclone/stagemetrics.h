@@ -0,0 +1,250 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __SYNTHCLONE_STAGEMETRICS_H__
+#define __SYNTHCLONE_STAGEMETRICS_H__
+
+#include <QtCore/QDateTime>
+#include <QtCore/QString>
+
+#include <synthclone/stagemeter.h>
+
+namespace synthclone {
+
+    /**
+     * Holds the measurements taken for a stage of work: a sampler job, an
+     * effect processing a zone, or a target build.  `synthclone` records
+     * metrics for every stage it runs, and makes them available with
+     * Context::getStageMetrics().
+     *
+     * @sa
+     *   StageMeter
+     */
+
+    class StageMetrics {
+
+    public:
+
+        /**
+         * Stage types.
+         */
+
+        enum Stage {
+            STAGE_EFFECT = 0,
+            STAGE_SAMPLER_JOB = 1,
+            STAGE_TARGET_BUILD = 2
+        };
+
+        /**
+         * Constructs a new StageMetrics object.
+         *
+         * @param stage
+         *   The stage type.
+         *
+         * @param componentName
+         *   The name of the component that ran the stage.
+         *
+         * @param zoneIndex
+         *   The index of the zone that the stage was run on, or -1 if the
+         *   stage isn't tied to one zone.
+         */
+
+        StageMetrics(Stage stage=STAGE_EFFECT,
+                     const QString &componentName=QString(),
+                     int zoneIndex=-1);
+
+        /**
+         * Destroys the StageMetrics object.
+         */
+
+        ~StageMetrics();
+
+        /**
+         * Gets the number of bytes of sample data read during the stage.
+         *
+         * @returns
+         *   The byte count.
+         *
+         * @sa
+         *   StageMeter::getBytesRead()
+         */
+
+        qint64
+        getBytesRead() const;
+
+        /**
+         * Gets the number of bytes of sample data written during the stage.
+         *
+         * @returns
+         *   The byte count.
+         *
+         * @sa
+         *   StageMeter::getBytesWritten()
+         */
+
+        qint64
+        getBytesWritten() const;
+
+        /**
+         * Gets the name of the component that ran the stage.
+         *
+         * @returns
+         *   The component name.
+         */
+
+        QString
+        getComponentName() const;
+
+        /**
+         * Gets the CPU time used by the stage.
+         *
+         * @returns
+         *   The CPU time in microseconds, or -1 if the CPU time wasn't
+         *   measured.
+         */
+
+        qint64
+        getCPUTime() const;
+
+        /**
+         * Gets the number of sample frames read during the stage.
+         *
+         * @returns
+         *   The frame count.
+         */
+
+        SampleFrameCount
+        getFramesRead() const;
+
+        /**
+         * Gets the number of sample frames written during the stage.
+         *
+         * @returns
+         *   The frame count.
+         */
+
+        SampleFrameCount
+        getFramesWritten() const;
+
+        /**
+         * Gets the stage type.
+         *
+         * @returns
+         *   The stage type.
+         */
+
+        Stage
+        getStage() const;
+
+        /**
+         * Gets the time at which the stage started.
+         *
+         * @returns
+         *   The start time.
+         */
+
+        QDateTime
+        getStartTime() const;
+
+        /**
+         * Gets the wall time taken by the stage.
+         *
+         * @returns
+         *   The wall time in microseconds.
+         */
+
+        qint64
+        getWallTime() const;
+
+        /**
+         * Gets the index the zone had when the stage was run.
+         *
+         * @returns
+         *   The zone index, or -1 if the stage isn't tied to one zone.
+         */
+
+        int
+        getZoneIndex() const;
+
+        /**
+         * Sets the byte and frame counts.
+         *
+         * @param bytesRead
+         *   The number of bytes read.
+         *
+         * @param bytesWritten
+         *   The number of bytes written.
+         *
+         * @param framesRead
+         *   The number of frames read.
+         *
+         * @param framesWritten
+         *   The number of frames written.
+         */
+
+        void
+        setCounts(qint64 bytesRead, qint64 bytesWritten,
+                  SampleFrameCount framesRead, SampleFrameCount framesWritten);
+
+        /**
+         * Copies the times and counts measured by a meter.
+         *
+         * @param meter
+         *   The meter.  The meter should be stopped.
+         */
+
+        void
+        setMeasurements(const StageMeter &meter);
+
+        /**
+         * Sets the times.
+         *
+         * @param startTime
+         *   The time at which the stage started.
+         *
+         * @param wallTime
+         *   The wall time in microseconds.
+         *
+         * @param cpuTime
+         *   The CPU time in microseconds, or -1 if the CPU time wasn't
+         *   measured.
+         */
+
+        void
+        setTimes(const QDateTime &startTime, qint64 wallTime,
+                 qint64 cpuTime=-1);
+
+    private:
+
+        qint64 bytesRead;
+        qint64 bytesWritten;
+        QString componentName;
+        qint64 cpuTime;
+        SampleFrameCount framesRead;
+        SampleFrameCount framesWritten;
+        Stage stage;
+        QDateTime startTime;
+        qint64 wallTime;
+        int zoneIndex;
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,135 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __SYNTHCLONE_TASK_H__
+#define __SYNTHCLONE_TASK_H__
+
+#include <QtCore/QAtomicInt>
+
+namespace synthclone {
+
+    class CancellationToken;
+    class StageMeter;
+    class TaskGroup;
+
+    /**
+     * A unit of work that's run by a TaskPool.  Subclasses implement the
+     * run() method.  Tasks are started with TaskGroup::start(), and are owned
+     * by the group they're started in.
+     *
+     * The current CancellationToken and StageMeter of the thread that starts
+     * a task are made current while the task runs, so tasks started during an
+     * effect job or target build are cancelled along with the job or build,
+     * and their sample data is counted with the job or build.
+     *
+     * @sa
+     *   TaskGroup, TaskPool
+     */
+
+    class Task {
+
+        friend class TaskGroup;
+        friend class TaskPool;
+
+    public:
+
+        /**
+         * Constructs a new Task object.
+         */
+
+        Task();
+
+        /**
+         * Destroys the Task object.
+         */
+
+        virtual
+        ~Task();
+
+        /**
+         * Gets the progress of this task.
+         *
+         * @returns
+         *   The progress, in the range [0.0, 1.0].  A task that has finished
+         *   always has a progress of 1.0.
+         */
+
+        float
+        getProgress() const;
+
+        /**
+         * Checks whether or not this task has finished.  A task is finished
+         * after its run() method returns or raises an error, or after it's
+         * been skipped because it was cancelled before it started running.
+         *
+         * @returns
+         *   A boolean indicating whether or not the task has finished.
+         */
+
+        bool
+        isFinished() const;
+
+        /**
+         * Does the work of the task.  This method is called in a TaskPool
+         * thread.  If a synthclone::Error is raised, then the error is
+         * reported by TaskGroup::wait().
+         */
+
+        virtual void
+        run() = 0;
+
+    protected:
+
+        /**
+         * Checks whether or not the group this task belongs to, or the
+         * operation that started the task, has been cancelled.  Long running
+         * tasks should call this method periodically, and return early when
+         * it returns true.
+         *
+         * @returns
+         *   A boolean indicating whether or not the task has been cancelled.
+         */
+
+        bool
+        isCancelled() const;
+
+        /**
+         * Sets the progress of this task.  The progress is included in
+         * TaskGroup::getProgress().
+         *
+         * @param progress
+         *   The progress, in the range [0.0, 1.0].
+         */
+
+        void
+        setProgress(float progress);
+
+    private:
+
+        const CancellationToken *cancellationToken;
+        QAtomicInt finished;
+        TaskGroup *group;
+        QAtomicInt progress;
+        StageMeter *stageMeter;
+
+    };
+
+}
+
+#endif
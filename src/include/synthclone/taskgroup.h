@@ -0,0 +1,196 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __SYNTHCLONE_TASKGROUP_H__
+#define __SYNTHCLONE_TASKGROUP_H__
+
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QWaitCondition>
+
+#include <synthclone/task.h>
+#include <synthclone/taskpool.h>
+
+namespace synthclone {
+
+    /**
+     * A set of Task objects that are run by a TaskPool, and that can be waited
+     * for, cancelled, and monitored together.  The group owns the tasks that
+     * are started in it, and deletes them when the group is destroyed, so
+     * results can be read from the tasks after TaskGroup::wait() returns.
+     *
+     * @sa
+     *   Task, TaskPool
+     */
+
+    class TaskGroup: public QObject {
+
+        Q_OBJECT
+
+        friend class Task;
+        friend class TaskPool;
+
+    public:
+
+        /**
+         * Constructs a new TaskGroup object.
+         *
+         * @param pool
+         *   The pool that will run the tasks in this group.
+         *
+         * @param parent
+         *   The parent object of the new group.
+         */
+
+        explicit
+        TaskGroup(TaskPool &pool, QObject *parent=0);
+
+        /**
+         * Destroys the TaskGroup object.  Tasks that haven't started are
+         * cancelled, running tasks are waited for, and all tasks are deleted.
+         */
+
+        ~TaskGroup();
+
+        /**
+         * Gets the number of tasks in this group that have finished, including
+         * tasks that were skipped because the group was cancelled.
+         *
+         * @returns
+         *   The finished task count.
+         */
+
+        int
+        getFinishedCount() const;
+
+        /**
+         * Gets the aggregate progress of the tasks in this group.
+         *
+         * @returns
+         *   The average progress of the tasks in the group, in the range
+         *   [0.0, 1.0].  If the group is empty, then 1.0 is returned.
+         */
+
+        float
+        getProgress() const;
+
+        /**
+         * Gets the number of tasks that have been started in this group.
+         *
+         * @returns
+         *   The task count.
+         */
+
+        int
+        getTaskCount() const;
+
+        /**
+         * Checks whether or not the group has been cancelled.
+         *
+         * @returns
+         *   A boolean indicating whether or not the group has been cancelled.
+         */
+
+        bool
+        isCancelled() const;
+
+        /**
+         * Checks whether or not all of the tasks in this group have finished.
+         *
+         * @returns
+         *   A boolean indicating whether or not the group has finished.
+         */
+
+        bool
+        isFinished() const;
+
+        /**
+         * Adds a task to the group, and queues it in the pool.  The group
+         * takes ownership of the task.
+         *
+         * @param task
+         *   The task.
+         */
+
+        void
+        start(Task *task);
+
+        /**
+         * Waits for all of the tasks in this group to finish.  While waiting,
+         * the calling thread runs queued tasks from the pool, so groups can be
+         * waited for from within other tasks.
+         *
+         * If a task raised an error, then the first error is raised again as a
+         * synthclone::Error once the group has finished.
+         */
+
+        void
+        wait();
+
+        /**
+         * Waits up to 'msecs' milliseconds for the tasks in this group to
+         * finish, running queued tasks from the pool while waiting.  This is
+         * useful for reporting progress while waiting.  Errors aren't raised
+         * by this method; call TaskGroup::wait() once the group has finished.
+         *
+         * @param msecs
+         *   The maximum time to wait, in milliseconds.  A task that's run by
+         *   the calling thread can make the wait take longer.
+         *
+         * @returns
+         *   A boolean indicating whether or not the group has finished.
+         */
+
+        bool
+        waitForDone(int msecs);
+
+    public slots:
+
+        /**
+         * Cancels the group.  Tasks that haven't started yet are skipped, and
+         * running tasks see that they've been cancelled with
+         * Task::isCancelled().
+         */
+
+        void
+        cancel();
+
+    private:
+
+        void
+        finishTask(const QString *errorMessage);
+
+        void
+        waitForTasks();
+
+        QAtomicInt cancelled;
+        bool error;
+        QString errorMessage;
+        QWaitCondition finishedCondition;
+        int finishedCount;
+        mutable QMutex mutex;
+        TaskPool &pool;
+        QList<Task *> tasks;
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __SYNTHCLONE_TASKPOOL_H__
+#define __SYNTHCLONE_TASKPOOL_H__
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QWaitCondition>
+
+namespace synthclone {
+
+    class Task;
+    class TaskWorker;
+
+    /**
+     * A work-stealing thread pool.  Each pool thread has its own task queue.
+     * Tasks that are started from a pool thread are added to that thread's
+     * queue, and are run most-recent-first, which keeps data that's shared by
+     * related tasks in cache.  Threads that run out of work steal the oldest
+     * tasks from other threads' queues.
+     *
+     * `synthclone` creates one pool, sized to the machine, and shares it with
+     * participants through Context::getTaskPool(), so that components can run
+     * work in parallel without creating more threads than there are cores.
+     * Tasks are started with a TaskGroup.
+     *
+     * @sa
+     *   Task, TaskGroup
+     */
+
+    class TaskPool: public QObject {
+
+        Q_OBJECT
+
+        friend class TaskGroup;
+        friend class TaskWorker;
+
+    public:
+
+        /**
+         * Constructs a new TaskPool object.
+         *
+         * @param threadCount
+         *   The number of threads in the pool.  If the count is less than 1,
+         *   then the number of processor cores is used.
+         *
+         * @param parent
+         *   The parent object of the new pool.
+         */
+
+        explicit
+        TaskPool(int threadCount=0, QObject *parent=0);
+
+        /**
+         * Destroys the TaskPool object.  All task groups that use the pool
+         * must be destroyed before the pool is destroyed.
+         */
+
+        ~TaskPool();
+
+        /**
+         * Gets the number of threads in the pool.
+         *
+         * @returns
+         *   The thread count.
+         */
+
+        int
+        getThreadCount() const;
+
+    private:
+
+        struct Queue {
+            QMutex mutex;
+            QList<Task *> tasks;
+        };
+
+        void
+        execute(Task *task);
+
+        int
+        getCurrentWorkerIndex() const;
+
+        bool
+        runPendingTask();
+
+        void
+        runWorker(int index);
+
+        void
+        submit(Task *task);
+
+        Task *
+        takeTask(int index);
+
+        QWaitCondition idleCondition;
+        QMutex idleMutex;
+        QAtomicInt nextQueue;
+        int pendingCount;
+        QList<Queue *> queues;
+        bool stopping;
+        QList<TaskWorker *> workers;
+
+    };
+
+}
+
+#endif
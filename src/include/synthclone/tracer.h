@@ -0,0 +1,236 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __SYNTHCLONE_TRACER_H__
+#define __SYNTHCLONE_TRACER_H__
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QIODevice>
+#include <QtCore/QList>
+#include <QtCore/QMap>
+#include <QtCore/QMutex>
+#include <QtCore/QStringList>
+#include <QtCore/QVariant>
+
+namespace synthclone {
+
+    /**
+     * Records spans of work on a timeline, and writes them in the Chrome
+     * trace event format, which can be viewed with Perfetto or
+     * `chrome://tracing`.
+     *
+     * Tracing is optional.  `synthclone` records spans for session loads and
+     * saves, sampler job states, effect jobs and Effect::process() calls,
+     * SampleCopier copies, and target builds when a tracer is active.  Spans
+     * are tagged with the thread that did the work, and with the index of the
+     * zone that the work was done for, if there is one.  Components can add
+     * their own spans with TraceSpan objects.
+     *
+     * @sa
+     *   TraceSpan
+     */
+
+    class Tracer {
+
+    public:
+
+        /**
+         * Gets the active tracer.
+         *
+         * @returns
+         *   The active tracer, or 0 if tracing is disabled.
+         */
+
+        static Tracer *
+        getActive();
+
+        /**
+         * Sets the active tracer.
+         *
+         * @param tracer
+         *   The tracer, or 0 to disable tracing.  The tracer must remain
+         *   valid until it's no longer the active tracer, and until every
+         *   span started with it has ended.
+         */
+
+        static void
+        setActive(Tracer *tracer);
+
+        /**
+         * Constructs a new Tracer object.  Span times are measured from the
+         * time the tracer is constructed.
+         */
+
+        Tracer();
+
+        /**
+         * Destroys the Tracer object.
+         */
+
+        ~Tracer();
+
+        /**
+         * Adds a span to the timeline.  This method is thread-safe, but it
+         * allocates memory, so it must not be called from real-time threads.
+         * Real-time code should record times, and add spans later from
+         * another thread.
+         *
+         * @param category
+         *   The span category, like "effect" or "target".
+         *
+         * @param name
+         *   The span name.
+         *
+         * @param startTime
+         *   The start time of the span, as returned by Tracer::getTime().
+         *
+         * @param duration
+         *   The duration of the span in microseconds.
+         *
+         * @param zoneIndex
+         *   The index of the zone that the work was done for, or -1 if the
+         *   work isn't tied to one zone.
+         *
+         * @param arguments
+         *   Extra data to show with the span.  Numbers and strings are
+         *   supported.
+         *
+         * @param threadName
+         *   The name of the thread that did the work.  If the name is empty,
+         *   then the calling thread is used.  Otherwise, spans are grouped
+         *   with other spans that have the same thread name.
+         */
+
+        void
+        addSpan(const QString &category, const QString &name,
+                qint64 startTime, qint64 duration, int zoneIndex=-1,
+                const QVariantMap &arguments=QVariantMap(),
+                const QString &threadName=QString());
+
+        /**
+         * Removes all spans from the timeline.
+         */
+
+        void
+        clear();
+
+        /**
+         * Gets the number of spans on the timeline.
+         *
+         * @returns
+         *   The span count.
+         */
+
+        int
+        getSpanCount() const;
+
+        /**
+         * Gets the current time on the timeline.
+         *
+         * @returns
+         *   The number of microseconds since the tracer was constructed.
+         */
+
+        qint64
+        getTime() const;
+
+        /**
+         * Writes the timeline to a device as Chrome trace event JSON.
+         *
+         * @param device
+         *   The device to write to.
+         */
+
+        void
+        write(QIODevice &device) const;
+
+    private:
+
+        struct Span {
+            QVariantMap arguments;
+            QString category;
+            qint64 duration;
+            QString name;
+            qint64 startTime;
+            int threadId;
+        };
+
+        int
+        getThreadId(const QString &threadName);
+
+        mutable QMutex mutex;
+        QList<Span> spans;
+        QMap<Qt::HANDLE, int> threadHandleIds;
+        QMap<QString, int> threadNameIds;
+        QStringList threadNames;
+        QElapsedTimer timer;
+
+    };
+
+    /**
+     * Records a span from the time the TraceSpan object is constructed to the
+     * time it's destroyed, if a tracer is active.  Spans that are started in
+     * a thread while another span is open in the same thread are tagged with
+     * the zone index of the enclosing span, unless they're given their own.
+     *
+     * @sa
+     *   Tracer
+     */
+
+    class TraceSpan {
+
+    public:
+
+        /**
+         * Constructs a new TraceSpan object, and starts the span.
+         *
+         * @param category
+         *   The span category.
+         *
+         * @param name
+         *   The span name.
+         *
+         * @param zoneIndex
+         *   The index of the zone that the work is done for, or -1 to use
+         *   the zone index of the enclosing span.
+         */
+
+        TraceSpan(const char *category, const QString &name,
+                  int zoneIndex=-1);
+
+        /**
+         * Ends the span, and destroys the TraceSpan object.
+         */
+
+        ~TraceSpan();
+
+    private:
+
+        const char *category;
+        QString name;
+        TraceSpan *parent;
+        qint64 startTime;
+        Tracer *tracer;
+        int zoneIndex;
+
+    };
+
+}
+
+#endif
@@ -21,6 +21,7 @@
 #define __SYNTHCLONE_UTIL_H__
 
 #include <QtCore/QCoreApplication>
+#include <QtCore/QVariant>
 #include <QtGui/QWidget>
 
 #include <synthclone/sampleinputstream.h>
@@ -54,6 +55,31 @@ namespace synthclone {
     void
     _die(const char *path, const char *func, int line, const QString &message);
 
+    /**
+     * Finds the onset of the first sound in a block of interleaved audio.
+     * The onset is the first frame that contains a sample whose magnitude is
+     * at least a tenth (-20 dB) of the peak magnitude of the block.  This is
+     * meant for measuring the latency between a MIDI note-on message and the
+     * audio that it produces.
+     *
+     * @param buffer
+     *   The audio.
+     *
+     * @param frames
+     *   The number of frames in the buffer.
+     *
+     * @param channels
+     *   The number of channels in each frame.
+     *
+     * @returns
+     *   The index of the onset frame, or -1 if the peak magnitude is below
+     *   -60 dBFS, in which case the block is considered to be silent.
+     */
+
+    SampleFrameCount
+    findOnset(const float *buffer, SampleFrameCount frames,
+              SampleChannelCount channels);
+
     /**
      * Finds a child object of an object.  If the child object is not found,
      * then an error message is printed and the program is aborted.
@@ -79,6 +105,35 @@ namespace synthclone {
         return child;
     }
 
+    /**
+     * Gets a JSON string literal for a string.  Quotes, backslashes and
+     * control characters are escaped.
+     *
+     * @param str
+     *   The string.
+     *
+     * @returns
+     *   The JSON string literal, including the enclosing quotes.
+     */
+
+    QString
+    getJSONString(const QString &str);
+
+    /**
+     * Gets a JSON representation of a value.  Booleans and numbers are
+     * written as JSON literals (non-finite numbers as `null`), and any other
+     * value is written as a string literal.
+     *
+     * @param value
+     *   The value.
+     *
+     * @returns
+     *   The JSON representation of the value.
+     */
+
+    QString
+    getJSONValue(const QVariant &value);
+
     /**
      * Gets a string representation of a MIDI control.
      *
@@ -268,6 +268,24 @@ namespace synthclone {
 
     public slots:
 
+        /**
+         * Sets the dry Sample, and takes ownership of the Sample.  If the
+         * Sample is stored in a file created with Context::createSampleFile()
+         * in the session's sample format, then the Sample is used as is.
+         * Otherwise, the data in the Sample is copied as with setDrySample(),
+         * and the Sample is deleted.  The dry Sample will be set as fresh (not
+         * stale).
+         *
+         * @param sample
+         *   The sample to adopt.
+         *
+         * @sa
+         *   getDrySample(), setDrySample()
+         */
+
+        virtual void
+        adoptDrySample(synthclone::Sample *sample) = 0;
+
         /**
          * Sets the MIDI polyphonic aftertouch value.  The MIDI polyphonic
          * aftertouch value can be cleared by calling this method with
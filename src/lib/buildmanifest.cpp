@@ -0,0 +1,241 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDebug>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QXmlStreamReader>
+#include <QtCore/QXmlStreamWriter>
+
+#include <synthclone/buildmanifest.h>
+#include <synthclone/error.h>
+
+using synthclone::BuildManifest;
+
+// Static functions
+
+QByteArray
+BuildManifest::getKey(const QVariant &data)
+{
+    QByteArray bytes;
+    QDataStream stream(&bytes, QIODevice::WriteOnly);
+    stream << data;
+    return QCryptographicHash::hash(bytes, QCryptographicHash::Sha1);
+}
+
+QVariant
+BuildManifest::getSampleData(const Sample &sample)
+{
+    QString path = sample.getPath();
+    QFileInfo info(path);
+    QVariantList data;
+    data << path << info.size() << info.lastModified();
+    return data;
+}
+
+QVariant
+BuildManifest::getZoneData(const Zone &zone)
+{
+    QVariantMap data;
+    data["aftertouch"] = zone.getAftertouch();
+    data["channel"] = zone.getChannel();
+    data["channelPressure"] = zone.getChannelPressure();
+    data["note"] = zone.getNote();
+    data["releaseTime"] = zone.getReleaseTime();
+    data["sampleTime"] = zone.getSampleTime();
+    data["velocity"] = zone.getVelocity();
+
+    QVariantMap controlData;
+    const Zone::ControlMap &controlMap = zone.getControlMap();
+    Zone::ControlMap::const_iterator end = controlMap.constEnd();
+    for (Zone::ControlMap::const_iterator iter = controlMap.constBegin();
+         iter != end; iter++) {
+        controlData[QString::number(iter.key())] = iter.value();
+    }
+    data["controls"] = controlData;
+
+    const Sample *sample = zone.getWetSample();
+    if (! sample) {
+        sample = zone.getDrySample();
+    }
+    if (sample) {
+        data["sample"] = getSampleData(*sample);
+    }
+    return data;
+}
+
+// Class definition
+
+BuildManifest::BuildManifest(const QString &path, QObject *parent):
+    QObject(parent)
+{
+    QFileInfo info(path);
+    directory = info.absoluteDir();
+    this->path = info.absoluteFilePath();
+    read();
+}
+
+BuildManifest::~BuildManifest()
+{
+    // Empty
+}
+
+void
+BuildManifest::addFile(const QString &fileName, const QByteArray &key)
+{
+    FileData data;
+    data.key = key;
+    data.size = -1;
+    files.insert(fileName, data);
+}
+
+QDir
+BuildManifest::getDirectory() const
+{
+    return directory;
+}
+
+QString
+BuildManifest::getPath() const
+{
+    return path;
+}
+
+bool
+BuildManifest::isFileCurrent(const QString &fileName,
+                             const QByteArray &key) const
+{
+    FileDataMap::const_iterator iter = previousFiles.constFind(fileName);
+    if (iter == previousFiles.constEnd()) {
+        return false;
+    }
+    const FileData &data = iter.value();
+    if (data.key != key) {
+        return false;
+    }
+    QFileInfo info(directory.absoluteFilePath(fileName));
+    return info.isFile() && (info.size() == data.size) &&
+        (info.lastModified() == data.modified);
+}
+
+void
+BuildManifest::read()
+{
+    QFile file(path);
+    if (! file.exists()) {
+        return;
+    }
+    if (! file.open(QIODevice::ReadOnly)) {
+        qWarning() << tr("failed to open build manifest '%1': %2").
+            arg(path, file.errorString());
+        return;
+    }
+    QXmlStreamReader reader(&file);
+    FileDataMap previousFiles;
+    while (! reader.atEnd()) {
+        if (reader.readNext() != QXmlStreamReader::StartElement) {
+            continue;
+        }
+        if (reader.name() != QLatin1String("file")) {
+            continue;
+        }
+        QXmlStreamAttributes attributes = reader.attributes();
+        QString fileName = attributes.value("name").toString();
+        bool ok;
+        FileData data;
+        data.key = QByteArray::fromHex(attributes.value("key").toString().
+                                       toAscii());
+        data.modified = QDateTime::fromMSecsSinceEpoch
+            (attributes.value("modified").toString().toLongLong(&ok));
+        if (ok) {
+            data.size = attributes.value("size").toString().toLongLong(&ok);
+        }
+        if ((! ok) || fileName.isEmpty()) {
+            reader.raiseError(tr("invalid file entry"));
+            break;
+        }
+        previousFiles.insert(fileName, data);
+    }
+    if (reader.hasError()) {
+        qWarning() << tr("failed to read build manifest '%1': %2").
+            arg(path, reader.errorString());
+        return;
+    }
+    this->previousFiles = previousFiles;
+}
+
+void
+BuildManifest::removeStaleFiles()
+{
+    FileDataMap::const_iterator end = previousFiles.constEnd();
+    for (FileDataMap::const_iterator iter = previousFiles.constBegin();
+         iter != end; iter++) {
+        const QString &fileName = iter.key();
+        if (files.contains(fileName) || (! directory.exists(fileName))) {
+            continue;
+        }
+        if (! directory.remove(fileName)) {
+            throw Error(tr("failed to remove stale file '%1'").
+                        arg(directory.absoluteFilePath(fileName)));
+        }
+    }
+}
+
+void
+BuildManifest::save()
+{
+    QFile file(path);
+    if (! file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        throw Error(tr("failed to open build manifest '%1': %2").
+                    arg(path, file.errorString()));
+    }
+    QXmlStreamWriter writer(&file);
+    writer.setAutoFormatting(true);
+    writer.setCodec("UTF-8");
+    writer.writeStartDocument();
+    writer.writeStartElement("synthclone-build-manifest");
+    FileDataMap::iterator end = files.end();
+    for (FileDataMap::iterator iter = files.begin(); iter != end; iter++) {
+        const QString &fileName = iter.key();
+        QFileInfo info(directory.absoluteFilePath(fileName));
+        if (! info.isFile()) {
+            continue;
+        }
+        FileData &data = iter.value();
+        data.modified = info.lastModified();
+        data.size = info.size();
+        writer.writeEmptyElement("file");
+        writer.writeAttribute("name", fileName);
+        writer.writeAttribute("key", QString(data.key.toHex()));
+        writer.writeAttribute("modified",
+                              QString::number(data.modified.
+                                              toMSecsSinceEpoch()));
+        writer.writeAttribute("size", QString::number(data.size));
+    }
+    writer.writeEndElement();
+    writer.writeEndDocument();
+    file.close();
+    if (file.error() != QFile::NoError) {
+        throw Error(tr("failed to write build manifest '%1': %2").
+                    arg(path, file.errorString()));
+    }
+    previousFiles = files;
+}
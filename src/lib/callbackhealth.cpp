@@ -0,0 +1,102 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cassert>
+
+#include <synthclone/callbackhealth.h>
+
+using synthclone::CallbackHealth;
+
+CallbackHealth::CallbackHealth()
+{
+    cycleCount = 0;
+    load = 0.0;
+    loadHistogram.fill(0, LOAD_HISTOGRAM_SIZE);
+    maximumCycleTime = 0;
+    midiFailureCount = 0;
+    peakLoad = 0.0;
+    xrunCount = 0;
+}
+
+CallbackHealth::~CallbackHealth()
+{
+    // Empty
+}
+
+int
+CallbackHealth::getBufferCount() const
+{
+    return bufferNames.count();
+}
+
+float
+CallbackHealth::getBufferHighWaterMark(int index) const
+{
+    assert((index >= 0) && (index < bufferHighWaterMarks.count()));
+    return bufferHighWaterMarks[index];
+}
+
+QString
+CallbackHealth::getBufferName(int index) const
+{
+    assert((index >= 0) && (index < bufferNames.count()));
+    return bufferNames[index];
+}
+
+int
+CallbackHealth::getCycleCount() const
+{
+    return cycleCount;
+}
+
+float
+CallbackHealth::getLoad() const
+{
+    return load;
+}
+
+QVector<int>
+CallbackHealth::getLoadHistogram() const
+{
+    return loadHistogram;
+}
+
+int
+CallbackHealth::getMaximumCycleTime() const
+{
+    return maximumCycleTime;
+}
+
+int
+CallbackHealth::getMIDIFailureCount() const
+{
+    return midiFailureCount;
+}
+
+float
+CallbackHealth::getPeakLoad() const
+{
+    return peakLoad;
+}
+
+int
+CallbackHealth::getXrunCount() const
+{
+    return xrunCount;
+}
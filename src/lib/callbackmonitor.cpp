@@ -0,0 +1,173 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cassert>
+
+#include <synthclone/callbackmonitor.h>
+
+using synthclone::CallbackHealth;
+using synthclone::CallbackMonitor;
+
+// Loads and buffer usage are stored in thousandths, as there are no atomic
+// floats.
+
+// Static functions
+
+void
+CallbackMonitor::updateMaximum(QAtomicInt &maximum, int value)
+{
+    for (;;) {
+        int current = maximum;
+        if ((value <= current) || maximum.testAndSetOrdered(current, value)) {
+            break;
+        }
+    }
+}
+
+// Class definition
+
+CallbackMonitor::CallbackMonitor()
+{
+    cycleStartTime = 0;
+    timer.start();
+}
+
+CallbackMonitor::~CallbackMonitor()
+{
+    qDeleteAll(bufferHighWaterMarks);
+}
+
+int
+CallbackMonitor::addBuffer(const QString &name)
+{
+    bufferHighWaterMarks.append(new QAtomicInt(0));
+    bufferNames.append(name);
+    return bufferNames.count() - 1;
+}
+
+void
+CallbackMonitor::addMIDIFailure()
+{
+    midiFailureCount.fetchAndAddOrdered(1);
+}
+
+void
+CallbackMonitor::addXrun()
+{
+    xrunCount.fetchAndAddOrdered(1);
+}
+
+void
+CallbackMonitor::endCycle(SampleFrameCount frames, SampleRate sampleRate)
+{
+    if ((frames <= 0) || (! sampleRate)) {
+        return;
+    }
+    int cycleTime = static_cast<int>((timer.nsecsElapsed() - cycleStartTime) /
+                                     1000);
+    int period = static_cast<int>((static_cast<qint64>(frames) * 1000000) /
+                                  sampleRate);
+    if (period <= 0) {
+        return;
+    }
+    int load = static_cast<int>((static_cast<qint64>(cycleTime) * 1000) /
+                                period);
+    int bucket = load / 100;
+    if (bucket >= CallbackHealth::LOAD_HISTOGRAM_SIZE) {
+        bucket = CallbackHealth::LOAD_HISTOGRAM_SIZE - 1;
+    }
+    loadHistogram[bucket].fetchAndAddOrdered(1);
+    busyTime.fetchAndAddOrdered(cycleTime);
+    cycleCount.fetchAndAddOrdered(1);
+    periodTime.fetchAndAddOrdered(period);
+    updateMaximum(maximumCycleTime, cycleTime);
+    updateMaximum(peakLoad, load);
+}
+
+int
+CallbackMonitor::getXrunCount() const
+{
+    return xrunCount;
+}
+
+CallbackHealth
+CallbackMonitor::read()
+{
+    CallbackHealth health;
+    int count = bufferNames.count();
+    for (int i = 0; i < count; i++) {
+        health.bufferHighWaterMarks.append
+            (static_cast<int>(*(bufferHighWaterMarks[i])) / 1000.0);
+    }
+    health.bufferNames = bufferNames;
+    health.cycleCount = cycleCount;
+
+    // The load accumulators are reset on every read, which keeps them from
+    // overflowing.
+    int busyTime = this->busyTime.fetchAndStoreOrdered(0);
+    int periodTime = this->periodTime.fetchAndStoreOrdered(0);
+    health.load = periodTime ? static_cast<float>(busyTime) / periodTime : 0.0;
+
+    for (int i = 0; i < CallbackHealth::LOAD_HISTOGRAM_SIZE; i++) {
+        health.loadHistogram[i] = loadHistogram[i];
+    }
+    health.maximumCycleTime = maximumCycleTime;
+    health.midiFailureCount = midiFailureCount;
+    health.peakLoad = static_cast<int>(peakLoad) / 1000.0;
+    health.xrunCount = xrunCount - resetXrunCount;
+    return health;
+}
+
+void
+CallbackMonitor::reset()
+{
+    int count = bufferHighWaterMarks.count();
+    for (int i = 0; i < count; i++) {
+        bufferHighWaterMarks[i]->fetchAndStoreOrdered(0);
+    }
+    busyTime.fetchAndStoreOrdered(0);
+    cycleCount.fetchAndStoreOrdered(0);
+    for (int i = 0; i < CallbackHealth::LOAD_HISTOGRAM_SIZE; i++) {
+        loadHistogram[i].fetchAndStoreOrdered(0);
+    }
+    maximumCycleTime.fetchAndStoreOrdered(0);
+    midiFailureCount.fetchAndStoreOrdered(0);
+    peakLoad.fetchAndStoreOrdered(0);
+    periodTime.fetchAndStoreOrdered(0);
+
+    // The xrun count is never cleared, so that sampler jobs can compare it
+    // across a reset.
+    resetXrunCount.fetchAndStoreOrdered(xrunCount);
+}
+
+void
+CallbackMonitor::startCycle()
+{
+    cycleStartTime = timer.nsecsElapsed();
+}
+
+void
+CallbackMonitor::updateBufferUsage(int index, size_t used, size_t size)
+{
+    assert((index >= 0) && (index < bufferHighWaterMarks.count()));
+    if (size) {
+        updateMaximum(*(bufferHighWaterMarks.at(index)),
+                      static_cast<int>((used * 1000) / size));
+    }
+}
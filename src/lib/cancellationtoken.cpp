@@ -0,0 +1,101 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QThreadStorage>
+
+#include <synthclone/cancellationtoken.h>
+#include <synthclone/error.h>
+
+using synthclone::CancellationToken;
+
+// QThreadStorage deletes its values when a thread exits, so the current token
+// is stored indirectly.
+
+struct CurrentToken {
+    const CancellationToken *token;
+};
+
+static QThreadStorage<CurrentToken *> currentTokens;
+
+// Static functions
+
+void
+CancellationToken::checkCurrent()
+{
+    const CancellationToken *token = getCurrent();
+    if (token) {
+        token->check();
+    }
+}
+
+const CancellationToken *
+CancellationToken::getCurrent()
+{
+    return currentTokens.hasLocalData() ?
+        currentTokens.localData()->token : 0;
+}
+
+void
+CancellationToken::setCurrent(const CancellationToken *token)
+{
+    if (! currentTokens.hasLocalData()) {
+        currentTokens.setLocalData(new CurrentToken());
+    }
+    currentTokens.localData()->token = token;
+}
+
+// Class definition
+
+CancellationToken::CancellationToken()
+{
+    // Empty
+}
+
+CancellationToken::~CancellationToken()
+{
+    // Empty
+}
+
+void
+CancellationToken::cancel()
+{
+    cancelled.fetchAndStoreRelaxed(1);
+}
+
+void
+CancellationToken::check() const
+{
+    if (isCancelled()) {
+        throw Error(QCoreApplication::translate
+                    ("synthclone::CancellationToken", "operation cancelled"));
+    }
+}
+
+bool
+CancellationToken::isCancelled() const
+{
+    return static_cast<int>(cancelled);
+}
+
+void
+CancellationToken::reset()
+{
+    cancelled.fetchAndStoreRelaxed(0);
+}
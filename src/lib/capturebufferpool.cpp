@@ -0,0 +1,190 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QMutexLocker>
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <synthclone/capturebufferpool.h>
+#include <synthclone/error.h>
+
+using synthclone::CaptureBufferPool;
+
+// Static functions
+
+CaptureBufferPool::Buffer
+CaptureBufferPool::allocate(qint64 size, bool locked)
+{
+    qint64 pageSize = getPageSize();
+    qint64 byteCount = qMax(size, Q_INT64_C(1)) * sizeof(float);
+    byteCount = ((byteCount + pageSize - 1) / pageSize) * pageSize;
+    void *data = qMallocAligned(static_cast<size_t>(byteCount),
+                                static_cast<size_t>(pageSize));
+    if (! data) {
+        throw Error(QCoreApplication::translate
+                    ("synthclone::CaptureBufferPool",
+                     "failed to allocate %1 byte capture buffer").
+                    arg(byteCount));
+    }
+
+    // Writing to the buffer makes the operating system map every page now,
+    // rather than in the realtime callback.
+    std::memset(data, 0, static_cast<size_t>(byteCount));
+
+#ifdef Q_OS_UNIX
+    if (locked && mlock(data, static_cast<size_t>(byteCount))) {
+        qWarning() << QCoreApplication::translate
+            ("synthclone::CaptureBufferPool",
+             "failed to lock capture buffer into memory: %1").
+            arg(std::strerror(errno));
+    }
+#else
+    Q_UNUSED(locked);
+#endif
+
+    Buffer buffer;
+    buffer.data = static_cast<float *>(data);
+    buffer.size = byteCount / sizeof(float);
+    return buffer;
+}
+
+void
+CaptureBufferPool::deallocate(const Buffer &buffer, bool locked)
+{
+#ifdef Q_OS_UNIX
+    if (locked) {
+        munlock(buffer.data, static_cast<size_t>(buffer.size * sizeof(float)));
+    }
+#else
+    Q_UNUSED(locked);
+#endif
+    qFreeAligned(buffer.data);
+}
+
+qint64
+CaptureBufferPool::getPageSize()
+{
+#ifdef Q_OS_UNIX
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if (pageSize > 0) {
+        return pageSize;
+    }
+#endif
+    return 4096;
+}
+
+// Class definition
+
+CaptureBufferPool::CaptureBufferPool(bool locked)
+{
+    this->locked = locked;
+}
+
+CaptureBufferPool::~CaptureBufferPool()
+{
+    QList<float *> acquired = acquiredBuffers.keys();
+    for (int i = 0; i < acquired.count(); i++) {
+        release(acquired[i]);
+    }
+    clear();
+}
+
+float *
+CaptureBufferPool::acquire(qint64 size)
+{
+    QMutexLocker locker(&mutex);
+
+    // Use the smallest buffer that's large enough.
+    int index = -1;
+    for (int i = 0; i < buffers.count(); i++) {
+        qint64 bufferSize = buffers[i].size;
+        if ((bufferSize >= size) &&
+            ((index == -1) || (bufferSize < buffers[index].size))) {
+            index = i;
+        }
+    }
+    Buffer buffer = (index == -1) ? allocate(size, locked) :
+        buffers.takeAt(index);
+    acquiredBuffers.insert(buffer.data, buffer.size);
+    return buffer.data;
+}
+
+void
+CaptureBufferPool::clear()
+{
+    QMutexLocker locker(&mutex);
+    for (int i = 0; i < buffers.count(); i++) {
+        deallocate(buffers[i], locked);
+    }
+    buffers.clear();
+}
+
+int
+CaptureBufferPool::getBufferCount() const
+{
+    QMutexLocker locker(&mutex);
+    return buffers.count();
+}
+
+bool
+CaptureBufferPool::isLocked() const
+{
+    return locked;
+}
+
+void
+CaptureBufferPool::release(float *buffer)
+{
+    QMutexLocker locker(&mutex);
+    QMap<float *, qint64>::iterator iter = acquiredBuffers.find(buffer);
+    assert(iter != acquiredBuffers.end());
+    Buffer data;
+    data.data = buffer;
+    data.size = iter.value();
+    acquiredBuffers.erase(iter);
+    buffers.append(data);
+}
+
+void
+CaptureBufferPool::reserve(int count, qint64 size)
+{
+    assert(count >= 0);
+    assert(size >= 0);
+    QMutexLocker locker(&mutex);
+    int largeCount = 0;
+    for (int i = buffers.count() - 1; i >= 0; i--) {
+        if (buffers[i].size >= size) {
+            largeCount++;
+        } else {
+            deallocate(buffers.takeAt(i), locked);
+        }
+    }
+    for (; largeCount < count; largeCount++) {
+        buffers.append(allocate(size, locked));
+    }
+}
@@ -17,6 +17,8 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include <QtCore/QTimer>
+
 #include <synthclone/component.h>
 
 using synthclone::Component;
@@ -32,12 +34,43 @@ Component::~Component()
     // Empty
 }
 
+void
+Component::flushProgress()
+{
+    float reportedProgress;
+    if (progressThrottle.flush(reportedProgress)) {
+        emit progressChanged(reportedProgress);
+    }
+}
+
 QString
 Component::getName() const
 {
     return name;
 }
 
+void
+Component::reportProgress(float progress)
+{
+    bool flushRequired = false;
+    float reportedProgress;
+    if (progressThrottle.update(progress, reportedProgress, &flushRequired)) {
+        emit progressChanged(reportedProgress);
+    } else if (flushRequired) {
+        // Progress can be reported from threads without an event loop, so the
+        // flush timer is started in the component's thread.
+        QMetaObject::invokeMethod(this, "scheduleProgressFlush",
+                                  Qt::QueuedConnection);
+    }
+}
+
+void
+Component::scheduleProgressFlush()
+{
+    QTimer::singleShot(progressThrottle.getInterval(), this,
+                       SLOT(flushProgress()));
+}
+
 void
 Component::setName(const QString &name)
 {
@@ -16,6 +16,12 @@ CONFIG += uitools
 DESTDIR = $${BUILDDIR}/$${SYNTHCLONE_LIBRARY_SUFFIX}
 HEADERS += closeeventfilter.h \
     samplefile.h \
+    taskworker.h \
+    ../include/synthclone/buildmanifest.h \
+    ../include/synthclone/callbackhealth.h \
+    ../include/synthclone/callbackmonitor.h \
+    ../include/synthclone/cancellationtoken.h \
+    ../include/synthclone/capturebufferpool.h \
     ../include/synthclone/component.h \
     ../include/synthclone/context.h \
     ../include/synthclone/designerview.h \
@@ -28,8 +34,10 @@ HEADERS += closeeventfilter.h \
     ../include/synthclone/menuitem.h \
     ../include/synthclone/menuseparator.h \
     ../include/synthclone/participant.h \
+    ../include/synthclone/progressthrottle.h \
     ../include/synthclone/registration.h \
     ../include/synthclone/sample.h \
+    ../include/synthclone/sampleconverter.h \
     ../include/synthclone/samplecopier.h \
     ../include/synthclone/sampleinputstream.h \
     ../include/synthclone/sampleoutputstream.h \
@@ -37,19 +45,30 @@ HEADERS += closeeventfilter.h \
     ../include/synthclone/samplerjob.h \
     ../include/synthclone/samplestream.h \
     ../include/synthclone/semaphore.h \
+    ../include/synthclone/stagemeter.h \
+    ../include/synthclone/stagemetrics.h \
     ../include/synthclone/target.h \
+    ../include/synthclone/task.h \
+    ../include/synthclone/taskgroup.h \
+    ../include/synthclone/taskpool.h \
+    ../include/synthclone/tracer.h \
     ../include/synthclone/types.h \
     ../include/synthclone/util.h \
     ../include/synthclone/view.h \
     ../include/synthclone/zone.h \
     ../include/synthclone/zonecomparer.h
 INCLUDEPATH += ../include
-LIBS += -lsndfile
+LIBS += -lsamplerate -lsndfile
 MOC_DIR = $${MAKEDIR}/lib
 OBJECTS_DIR = $${MAKEDIR}/lib
 RCC_DIR = $${MAKEDIR}/lib
 RESOURCES += lib.qrc
-SOURCES += closeeventfilter.cpp \
+SOURCES += buildmanifest.cpp \
+    callbackhealth.cpp \
+    callbackmonitor.cpp \
+    cancellationtoken.cpp \
+    capturebufferpool.cpp \
+    closeeventfilter.cpp \
     component.cpp \
     context.cpp \
     designerview.cpp \
@@ -61,8 +80,10 @@ SOURCES += closeeventfilter.cpp \
     menuitem.cpp \
     menuseparator.cpp \
     participant.cpp \
+    progressthrottle.cpp \
     registration.cpp \
     sample.cpp \
+    sampleconverter.cpp \
     samplecopier.cpp \
     samplefile.cpp \
     sampleinputstream.cpp \
@@ -71,7 +92,14 @@ SOURCES += closeeventfilter.cpp \
     samplerjob.cpp \
     samplestream.cpp \
     semaphore.cpp \
+    stagemeter.cpp \
+    stagemetrics.cpp \
     target.cpp \
+    task.cpp \
+    taskgroup.cpp \
+    taskpool.cpp \
+    taskworker.cpp \
+    tracer.cpp \
     util.cpp \
     view.cpp \
     zone.cpp \
@@ -89,6 +117,7 @@ VER_PAT = $${REVISION}
 
 headers.files = $${HEADERS}
 headers.files -= closeeventfilter.h
+headers.files -= taskworker.h
 exists(../include/synthclone/config.h) {
     headers.files += ../include/synthclone/config.h
 }
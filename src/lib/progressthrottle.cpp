@@ -0,0 +1,109 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <QtCore/QDateTime>
+
+#include <synthclone/progressthrottle.h>
+
+using synthclone::ProgressThrottle;
+
+ProgressThrottle::ProgressThrottle(int interval, int resolution)
+{
+    this->interval = interval;
+    this->resolution = qMax(resolution, 1);
+    reset();
+}
+
+ProgressThrottle::~ProgressThrottle()
+{
+    // Empty
+}
+
+bool
+ProgressThrottle::flush(float &reportedProgress)
+{
+    flushPending.fetchAndStoreRelaxed(0);
+    int value = pendingValue.fetchAndStoreRelaxed(-1);
+    if (value == -1) {
+        return false;
+    }
+    int last = lastValue;
+    if (value == last) {
+        return false;
+    }
+    return report(last, value,
+                  static_cast<int>(QDateTime::currentMSecsSinceEpoch()),
+                  reportedProgress);
+}
+
+int
+ProgressThrottle::getInterval() const
+{
+    return interval;
+}
+
+bool
+ProgressThrottle::report(int last, int value, int now,
+                         float &reportedProgress)
+{
+    // If another thread reported a value in the meantime, then this value is
+    // coalesced into that one.
+    if (! lastValue.testAndSetOrdered(last, value)) {
+        return false;
+    }
+    lastTime.fetchAndStoreRelaxed(now);
+    reportedProgress = static_cast<float>(value) / resolution;
+    return true;
+}
+
+void
+ProgressThrottle::reset()
+{
+    lastValue.fetchAndStoreRelaxed(-1);
+    pendingValue.fetchAndStoreRelaxed(-1);
+}
+
+bool
+ProgressThrottle::update(float progress, float &reportedProgress,
+                         bool *flushRequired)
+{
+    int value = qBound(0, qRound(progress * resolution), resolution);
+    int last = lastValue;
+    if (value == last) {
+        return false;
+    }
+
+    // Millisecond times are truncated to 32 bits.  The difference between two
+    // truncated times is still correct, as long as the times are less than 24
+    // days apart.
+    int now = static_cast<int>(QDateTime::currentMSecsSinceEpoch());
+    if ((value != 0) && (value != resolution) && (last != -1) &&
+        ((now - static_cast<int>(lastTime)) < interval)) {
+        // Hold the value back until the next eligible update or flush.
+        pendingValue.fetchAndStoreRelaxed(value);
+        if (flushRequired && flushPending.testAndSetRelaxed(0, 1)) {
+            *flushRequired = true;
+        }
+        return false;
+    }
+
+    // This value supersedes any value that was held back.
+    pendingValue.fetchAndStoreRelaxed(-1);
+    return report(last, value, now, reportedProgress);
+}
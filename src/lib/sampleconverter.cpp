@@ -0,0 +1,162 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <samplerate.h>
+
+#include <QtCore/QScopedArrayPointer>
+
+#include <synthclone/error.h>
+#include <synthclone/sampleconverter.h>
+
+using synthclone::SampleConverter;
+
+// Static functions
+
+bool
+SampleConverter::canConvertChannels(SampleChannelCount inputChannels,
+                                    SampleChannelCount outputChannels)
+{
+    return (inputChannels == outputChannels) || (inputChannels == 1) ||
+        (outputChannels == 1);
+}
+
+// Class definition
+
+SampleConverter::SampleConverter(QObject *parent):
+    QObject(parent)
+{
+    // Empty
+}
+
+SampleConverter::~SampleConverter()
+{
+    // Empty
+}
+
+synthclone::SampleFrameCount
+SampleConverter::convert(SampleInputStream &inputStream,
+                         SampleOutputStream &outputStream)
+{
+    SampleChannelCount inputChannels = inputStream.getChannels();
+    SampleChannelCount channels = outputStream.getChannels();
+    if (! canConvertChannels(inputChannels, channels)) {
+        throw Error(tr("can't convert %1 channels to %2 channels").
+                    arg(inputChannels).arg(channels));
+    }
+
+    float *inputBuffer = new float[inputChannels * 512];
+    QScopedArrayPointer<float> inputBufferPtr(inputBuffer);
+    float *channelBuffer = new float[channels * 512];
+    QScopedArrayPointer<float> channelBufferPtr(channelBuffer);
+    float *convertBuffer = new float[channels * 512];
+    QScopedArrayPointer<float> convertBufferPtr(convertBuffer);
+
+    SampleRate inputSampleRate = inputStream.getSampleRate();
+    SampleRate sampleRate = outputStream.getSampleRate();
+    SRC_STATE *state = 0;
+    double ratio = 1.0;
+    if (inputSampleRate != sampleRate) {
+        ratio = static_cast<double>(sampleRate) / inputSampleRate;
+        if (! src_is_valid_ratio(ratio)) {
+            throw Error(tr("'%1': invalid conversion ratio").arg(ratio));
+        }
+        int result;
+        state = src_new(SRC_SINC_BEST_QUALITY, channels, &result);
+        if (! state) {
+            throw Error(src_strerror(result));
+        }
+    }
+
+    SampleFrameCount framesConverted = 0;
+    SampleFrameCount framesWritten = 0;
+    SampleFrameCount totalFrames =
+        inputStream.getFrames() -
+        inputStream.seek(0, SampleStream::OFFSET_CURRENT);
+    try {
+        for (;;) {
+            SampleFrameCount framesRead = inputStream.read(inputBuffer, 512);
+
+            // Channel conversion.
+            if (inputChannels == channels) {
+                qCopy(inputBuffer, inputBuffer + (framesRead * channels),
+                      channelBuffer);
+            } else if (channels == 1) {
+                for (int i = 0; i < framesRead; i++) {
+                    float n = 0.0;
+                    for (int j = 0; j < inputChannels; j++) {
+                        n += inputBuffer[(i * inputChannels) + j];
+                    }
+                    channelBuffer[i] = n / inputChannels;
+                }
+            } else {
+                for (int i = 0; i < framesRead; i++) {
+                    float n = inputBuffer[i];
+                    for (int j = 0; j < channels; j++) {
+                        channelBuffer[(i * channels) + j] = n;
+                    }
+                }
+            }
+
+            // Sample rate conversion.
+            if (! state) {
+                if (framesRead) {
+                    outputStream.write(channelBuffer, framesRead);
+                    framesWritten += framesRead;
+                }
+            } else {
+                SRC_DATA data;
+                data.data_in = channelBuffer;
+                data.end_of_input = framesRead ? 0 : 1;
+                data.input_frames = static_cast<long>(framesRead);
+                data.src_ratio = ratio;
+                do {
+                    data.data_out = convertBuffer;
+                    data.output_frames = 512;
+                    int result = src_process(state, &data);
+                    if (result) {
+                        throw Error(src_strerror(result));
+                    }
+                    SampleFrameCount framesGenerated =
+                        static_cast<SampleFrameCount>(data.output_frames_gen);
+                    if (framesGenerated) {
+                        outputStream.write(convertBuffer, framesGenerated);
+                        framesWritten += framesGenerated;
+                    }
+                    data.data_in += data.input_frames_used * channels;
+                    data.input_frames -= data.input_frames_used;
+                } while (data.input_frames ||
+                         (data.end_of_input && data.output_frames_gen));
+            }
+            if (! framesRead) {
+                break;
+            }
+            framesConverted += framesRead;
+            emit convertProgress(framesConverted, totalFrames);
+        }
+    } catch (...) {
+        if (state) {
+            src_delete(state);
+        }
+        throw;
+    }
+    if (state) {
+        src_delete(state);
+    }
+    return framesWritten;
+}
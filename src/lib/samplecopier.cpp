@@ -20,6 +20,7 @@
 #include <cassert>
 
 #include <synthclone/samplecopier.h>
+#include <synthclone/tracer.h>
 #include <synthclone/util.h>
 
 using synthclone::SampleCopier;
@@ -49,11 +50,14 @@ SampleCopier::copy(SampleInputStream &inputStream,
             qApp->tr("the sample rates of the streams are not equal"));
     CONFIRM(frames >= 0, tr("'%1': invalid frame count").arg(frames));
 
+    TraceSpan span("copy", "SampleCopier::copy()");
     SampleFrameCount framesRead;
     SampleFrameCount readSize = static_cast<SampleFrameCount>(65536 / channels);
     assert(readSize >= 1);
     SampleFrameCount framesLeft = frames;
     SampleFrameCount totalFramesProcessed = 0;
+    float progress;
+    progressThrottle.reset();
     for (; framesLeft > readSize; framesLeft -= readSize) {
         framesRead = inputStream.read(buffer, readSize);
         if (! framesRead) {
@@ -61,18 +65,24 @@ SampleCopier::copy(SampleInputStream &inputStream,
         }
         outputStream.write(buffer, framesRead);
         totalFramesProcessed += framesRead;
-        emit copyProgress(totalFramesProcessed, frames);
         if (framesRead != readSize) {
+            emit copyProgress(totalFramesProcessed, frames);
             return totalFramesProcessed;
         }
+        if (progressThrottle.update(static_cast<float>(totalFramesProcessed) /
+                                    static_cast<float>(frames), progress)) {
+            emit copyProgress(totalFramesProcessed, frames);
+        }
     }
     if (framesLeft) {
         framesRead = inputStream.read(buffer, framesLeft);
         if (framesRead) {
             outputStream.write(buffer, framesRead);
             totalFramesProcessed += framesRead;
-            emit copyProgress(totalFramesProcessed, frames);
         }
     }
+    if (totalFramesProcessed) {
+        emit copyProgress(totalFramesProcessed, frames);
+    }
     return totalFramesProcessed;
 }
@@ -31,6 +31,60 @@
 
 using synthclone::SampleFile;
 
+// Static functions
+
+sf_count_t
+SampleFile::getDeviceLength(void *device)
+{
+    return static_cast<sf_count_t>(static_cast<QIODevice *>(device)->size());
+}
+
+sf_count_t
+SampleFile::readDevice(void *buffer, sf_count_t count, void *device)
+{
+    qint64 result = static_cast<QIODevice *>(device)->
+        read(static_cast<char *>(buffer), static_cast<qint64>(count));
+    return static_cast<sf_count_t>(result == -1 ? 0 : result);
+}
+
+sf_count_t
+SampleFile::seekDevice(sf_count_t offset, int whence, void *device)
+{
+    QIODevice *d = static_cast<QIODevice *>(device);
+    qint64 position;
+    switch (whence) {
+    case SEEK_CUR:
+        position = d->pos() + offset;
+        break;
+    case SEEK_END:
+        position = d->size() + offset;
+        break;
+    case SEEK_SET:
+    default:
+        position = offset;
+    }
+    if (! d->seek(position)) {
+        return -1;
+    }
+    return static_cast<sf_count_t>(position);
+}
+
+sf_count_t
+SampleFile::tellDevice(void *device)
+{
+    return static_cast<sf_count_t>(static_cast<QIODevice *>(device)->pos());
+}
+
+sf_count_t
+SampleFile::writeDevice(const void *buffer, sf_count_t count, void *device)
+{
+    qint64 result = static_cast<QIODevice *>(device)->
+        write(static_cast<const char *>(buffer), static_cast<qint64>(count));
+    return static_cast<sf_count_t>(result == -1 ? 0 : result);
+}
+
+// Class definition
+
 SampleFile::SampleFile(const QString &path, QObject *parent):
     QObject(parent)
 {
@@ -49,11 +103,36 @@ SampleFile::SampleFile(const QString &path, QObject *parent):
     writeMode = false;
 }
 
+SampleFile::SampleFile(QIODevice &device, QObject *parent):
+    QObject(parent)
+{
+    CONFIRM(device.isReadable(), tr("device is not open for reading"));
+    CONFIRM(! device.isSequential(), tr("device is sequential"));
+    SF_VIRTUAL_IO virtualIO;
+    virtualIO.get_filelen = getDeviceLength;
+    virtualIO.read = readDevice;
+    virtualIO.seek = seekDevice;
+    virtualIO.tell = tellDevice;
+    virtualIO.write = writeDevice;
+    info.format = 0;
+    handle = sf_open_virtual(&virtualIO, SFM_READ, &info, &device);
+    if (! handle) {
+        QString message = tr("could not open input device for reading: %1").
+            arg(sf_strerror(0));
+        throw synthclone::Error(message);
+    }
+    closed = false;
+    framesWritten = false;
+    path = tr("input device");
+    totalFramesValid = false;
+    writeMode = false;
+}
+
 SampleFile::SampleFile(const QString &path, SampleRate sampleRate,
                        SampleChannelCount channels, QObject *parent):
     QObject(parent)
 {
-    initializeWriteMode(path, sampleRate, channels, SampleStream::TYPE_WAV,
+    initializeWriteMode(0, path, sampleRate, channels, SampleStream::TYPE_WAV,
                         SampleStream::SUBTYPE_FLOAT,
                         SampleStream::ENDIANTYPE_FILE);
 }
@@ -64,7 +143,20 @@ SampleFile::SampleFile(const QString &path, SampleRate sampleRate,
                        SampleStream::EndianType endianType, QObject *parent):
     QObject(parent)
 {
-    initializeWriteMode(path, sampleRate, channels, type, subType, endianType);
+    initializeWriteMode(0, path, sampleRate, channels, type, subType,
+                        endianType);
+}
+
+SampleFile::SampleFile(QIODevice &device, SampleRate sampleRate,
+                       SampleChannelCount channels, SampleStream::Type type,
+                       SampleStream::SubType subType,
+                       SampleStream::EndianType endianType, QObject *parent):
+    QObject(parent)
+{
+    CONFIRM(device.isWritable(), tr("device is not open for writing"));
+    CONFIRM(! device.isSequential(), tr("device is sequential"));
+    initializeWriteMode(&device, tr("output device"), sampleRate, channels,
+                        type, subType, endianType);
 }
 
 SampleFile::~SampleFile()
@@ -265,7 +357,8 @@ SampleFile::getType() const
 }
 
 void
-SampleFile::initializeWriteMode(const QString &path, SampleRate sampleRate,
+SampleFile::initializeWriteMode(QIODevice *device, const QString &path,
+                                SampleRate sampleRate,
                                 SampleChannelCount channels,
                                 SampleStream::Type type,
                                 SampleStream::SubType subType,
@@ -450,8 +543,18 @@ SampleFile::initializeWriteMode(const QString &path, SampleRate sampleRate,
     if (! sf_format_check(&info)) {
         throw Error(tr("format is not supported"));
     }
-    QByteArray pathBytes = path.toLocal8Bit();
-    handle = sf_open(pathBytes.data(), SFM_WRITE, &info);
+    if (device) {
+        SF_VIRTUAL_IO virtualIO;
+        virtualIO.get_filelen = getDeviceLength;
+        virtualIO.read = readDevice;
+        virtualIO.seek = seekDevice;
+        virtualIO.tell = tellDevice;
+        virtualIO.write = writeDevice;
+        handle = sf_open_virtual(&virtualIO, SFM_WRITE, &info, device);
+    } else {
+        QByteArray pathBytes = path.toLocal8Bit();
+        handle = sf_open(pathBytes.data(), SFM_WRITE, &info);
+    }
     if (! handle) {
         QString message = tr("could not open '%1' for writing: %2").arg(path).
             arg(sf_strerror(0));
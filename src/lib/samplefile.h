@@ -22,6 +22,8 @@
 
 #include <sndfile.h>
 
+#include <QtCore/QIODevice>
+
 #include <synthclone/samplestream.h>
 
 namespace synthclone {
@@ -35,6 +37,9 @@ namespace synthclone {
         explicit
         SampleFile(const QString &path, QObject *parent=0);
 
+        explicit
+        SampleFile(QIODevice &device, QObject *parent=0);
+
         SampleFile(const QString &path, SampleRate sampleRate,
                    SampleChannelCount channels, QObject *parent=0);
 
@@ -43,6 +48,11 @@ namespace synthclone {
                    SampleStream::SubType subType,
                    SampleStream::EndianType endianType, QObject *parent=0);
 
+        SampleFile(QIODevice &device, SampleRate sampleRate,
+                   SampleChannelCount channels, SampleStream::Type type,
+                   SampleStream::SubType subType,
+                   SampleStream::EndianType endianType, QObject *parent=0);
+
         ~SampleFile();
 
         virtual void
@@ -80,8 +90,24 @@ namespace synthclone {
 
     private:
 
+        static sf_count_t
+        getDeviceLength(void *device);
+
+        static sf_count_t
+        readDevice(void *buffer, sf_count_t count, void *device);
+
+        static sf_count_t
+        seekDevice(sf_count_t offset, int whence, void *device);
+
+        static sf_count_t
+        tellDevice(void *device);
+
+        static sf_count_t
+        writeDevice(const void *buffer, sf_count_t count, void *device);
+
         void
-        initializeWriteMode(const QString &path, SampleRate sampleRate,
+        initializeWriteMode(QIODevice *device, const QString &path,
+                            SampleRate sampleRate,
                             SampleChannelCount channels,
                             SampleStream::Type type,
                             SampleStream::SubType subType,
@@ -17,7 +17,9 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include <synthclone/cancellationtoken.h>
 #include <synthclone/sampleinputstream.h>
+#include <synthclone/stagemeter.h>
 
 #include "samplefile.h"
 
@@ -29,6 +31,12 @@ SampleInputStream::SampleInputStream(const Sample &sample, QObject *parent):
     file = new SampleFile(sample.getPath(), this);
 }
 
+SampleInputStream::SampleInputStream(QIODevice &device, QObject *parent):
+    SampleStream(parent)
+{
+    file = new SampleFile(device, this);
+}
+
 SampleInputStream::~SampleInputStream()
 {
     delete file;
@@ -37,5 +45,8 @@ SampleInputStream::~SampleInputStream()
 synthclone::SampleFrameCount
 SampleInputStream::read(float *buffer, SampleFrameCount frames)
 {
-    return file->read(buffer, frames);
+    CancellationToken::checkCurrent();
+    SampleFrameCount framesRead = file->read(buffer, frames);
+    StageMeter::countRead(framesRead, file->getChannels());
+    return framesRead;
 }
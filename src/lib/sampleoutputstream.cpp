@@ -17,7 +17,9 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include <synthclone/cancellationtoken.h>
 #include <synthclone/sampleoutputstream.h>
+#include <synthclone/stagemeter.h>
 
 #include "samplefile.h"
 
@@ -41,6 +43,17 @@ SampleOutputStream::SampleOutputStream(Sample &sample, SampleRate sampleRate,
                           endianType, this);
 }
 
+SampleOutputStream::SampleOutputStream(QIODevice &device,
+                                       SampleRate sampleRate,
+                                       SampleChannelCount channels, Type type,
+                                       SubType subType, EndianType endianType,
+                                       QObject *parent):
+    SampleStream(parent)
+{
+    file = new SampleFile(device, sampleRate, channels, type, subType,
+                          endianType, this);
+}
+
 SampleOutputStream::~SampleOutputStream()
 {
     delete file;
@@ -49,5 +62,7 @@ SampleOutputStream::~SampleOutputStream()
 void
 SampleOutputStream::write(const float *buffer, SampleFrameCount frames)
 {
+    CancellationToken::checkCurrent();
     file->write(buffer, frames);
+    StageMeter::countWrite(frames, file->getChannels());
 }
@@ -0,0 +1,316 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#if defined(SYNTHCLONE_PLATFORM_MACX)
+#include <mach/mach.h>
+#elif defined(SYNTHCLONE_PLATFORM_UNIX)
+#include <time.h>
+#elif defined(SYNTHCLONE_PLATFORM_WIN32)
+#include <windows.h>
+#endif
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QThreadStorage>
+
+#include <synthclone/stagemeter.h>
+
+using synthclone::StageMeter;
+
+// QThreadStorage deletes its values when a thread exits, so the current meter
+// is stored indirectly.  Sample data is counted in the thread's current meter
+// structure, and is added to the meter when the current meter changes, so
+// that counting doesn't require any locking.
+
+struct CurrentMeter {
+    qint64 bytesRead;
+    qint64 bytesWritten;
+    synthclone::SampleFrameCount framesRead;
+    synthclone::SampleFrameCount framesWritten;
+    StageMeter *meter;
+};
+
+static QThreadStorage<CurrentMeter *> currentMeters;
+
+// The number of threads that have a current meter.  Counting is skipped
+// without a thread storage lookup when no thread has a current meter.
+static QAtomicInt currentMeterCount;
+
+static void
+clearCounts(CurrentMeter *current)
+{
+    current->bytesRead = 0;
+    current->bytesWritten = 0;
+    current->framesRead = 0;
+    current->framesWritten = 0;
+}
+
+// Returns the current meter structure of the calling thread, or NULL if the
+// thread doesn't have a current meter.
+static CurrentMeter *
+getCurrentMeter()
+{
+    if (! static_cast<int>(currentMeterCount)) {
+        return 0;
+    }
+    if (! currentMeters.hasLocalData()) {
+        return 0;
+    }
+    CurrentMeter *current = currentMeters.localData();
+    return current->meter ? current : 0;
+}
+
+// Returns the CPU time used by the calling thread in microseconds, or -1 if
+// the CPU time can't be measured.
+static qint64
+getThreadCPUTime()
+{
+#if defined(SYNTHCLONE_PLATFORM_MACX)
+    mach_port_t thread = mach_thread_self();
+    thread_basic_info_data_t info;
+    mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
+    kern_return_t result =
+        thread_info(thread, THREAD_BASIC_INFO,
+                    reinterpret_cast<thread_info_t>(&info), &count);
+    mach_port_deallocate(mach_task_self(), thread);
+    if (result != KERN_SUCCESS) {
+        return -1;
+    }
+    return ((static_cast<qint64>(info.user_time.seconds) +
+             info.system_time.seconds) * 1000000) +
+        info.user_time.microseconds + info.system_time.microseconds;
+#elif defined(SYNTHCLONE_PLATFORM_UNIX) && defined(CLOCK_THREAD_CPUTIME_ID)
+    timespec time;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time)) {
+        return -1;
+    }
+    return (static_cast<qint64>(time.tv_sec) * 1000000) +
+        (time.tv_nsec / 1000);
+#elif defined(SYNTHCLONE_PLATFORM_WIN32)
+    FILETIME creationTime;
+    FILETIME exitTime;
+    FILETIME kernelTime;
+    FILETIME userTime;
+    if (! GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime,
+                         &kernelTime, &userTime)) {
+        return -1;
+    }
+
+    // FILETIME values are in 100 nanosecond units.
+    quint64 kernel = (static_cast<quint64>(kernelTime.dwHighDateTime) << 32) |
+        kernelTime.dwLowDateTime;
+    quint64 user = (static_cast<quint64>(userTime.dwHighDateTime) << 32) |
+        userTime.dwLowDateTime;
+    return static_cast<qint64>((kernel + user) / 10);
+#else
+    return -1;
+#endif
+}
+
+// Static functions
+
+void
+StageMeter::countRead(SampleFrameCount frames, SampleChannelCount channels)
+{
+    CurrentMeter *current = getCurrentMeter();
+    if (current && (frames > 0)) {
+        current->bytesRead +=
+            frames * channels * static_cast<qint64>(sizeof(float));
+        current->framesRead += frames;
+    }
+}
+
+void
+StageMeter::countWrite(SampleFrameCount frames, SampleChannelCount channels)
+{
+    CurrentMeter *current = getCurrentMeter();
+    if (current && (frames > 0)) {
+        current->bytesWritten +=
+            frames * channels * static_cast<qint64>(sizeof(float));
+        current->framesWritten += frames;
+    }
+}
+
+StageMeter *
+StageMeter::getCurrent()
+{
+    return currentMeters.hasLocalData() ?
+        currentMeters.localData()->meter : 0;
+}
+
+void
+StageMeter::setCurrent(StageMeter *meter)
+{
+    CurrentMeter *current;
+    if (currentMeters.hasLocalData()) {
+        current = currentMeters.localData();
+    } else {
+        current = new CurrentMeter();
+        clearCounts(current);
+        current->meter = 0;
+        currentMeters.setLocalData(current);
+    }
+    StageMeter *oldMeter = current->meter;
+    if (oldMeter == meter) {
+        return;
+    }
+    if (oldMeter) {
+        oldMeter->addCounts(current->bytesRead, current->bytesWritten,
+                            current->framesRead, current->framesWritten);
+        clearCounts(current);
+        currentMeterCount.deref();
+    }
+    if (meter) {
+        currentMeterCount.ref();
+    }
+    current->meter = meter;
+}
+
+// Class definition
+
+StageMeter::StageMeter()
+{
+    bytesRead = 0;
+    bytesWritten = 0;
+    cpuTime = -1;
+    framesRead = 0;
+    framesWritten = 0;
+    startCPUTime = -1;
+    stopped = false;
+    wallTime = 0;
+}
+
+StageMeter::~StageMeter()
+{
+    // A meter that's destroyed by stack unwinding may still be current.  Its
+    // uncounted data is dropped, as the meter can't be read anymore.
+    CurrentMeter *current = getCurrentMeter();
+    if (current && (current->meter == this)) {
+        clearCounts(current);
+        current->meter = 0;
+        currentMeterCount.deref();
+    }
+}
+
+void
+StageMeter::addCounts(qint64 bytesRead, qint64 bytesWritten,
+                      SampleFrameCount framesRead,
+                      SampleFrameCount framesWritten)
+{
+    QMutexLocker locker(&mutex);
+    this->bytesRead += bytesRead;
+    this->bytesWritten += bytesWritten;
+    this->framesRead += framesRead;
+    this->framesWritten += framesWritten;
+}
+
+qint64
+StageMeter::getBytesRead() const
+{
+    QMutexLocker locker(&mutex);
+    return bytesRead;
+}
+
+qint64
+StageMeter::getBytesWritten() const
+{
+    QMutexLocker locker(&mutex);
+    return bytesWritten;
+}
+
+qint64
+StageMeter::getCPUTime() const
+{
+    return cpuTime;
+}
+
+synthclone::SampleFrameCount
+StageMeter::getFramesRead() const
+{
+    QMutexLocker locker(&mutex);
+    return framesRead;
+}
+
+synthclone::SampleFrameCount
+StageMeter::getFramesWritten() const
+{
+    QMutexLocker locker(&mutex);
+    return framesWritten;
+}
+
+QDateTime
+StageMeter::getStartTime() const
+{
+    return startTime;
+}
+
+qint64
+StageMeter::getWallTime() const
+{
+    if (stopped) {
+        return wallTime;
+    }
+    return timer.isValid() ? timer.nsecsElapsed() / 1000 : 0;
+}
+
+void
+StageMeter::start()
+{
+    // Data counted by the calling thread before the meter was started isn't
+    // part of the stage.
+    CurrentMeter *current = getCurrentMeter();
+    if (current && (current->meter == this)) {
+        clearCounts(current);
+    }
+
+    QMutexLocker locker(&mutex);
+    bytesRead = 0;
+    bytesWritten = 0;
+    cpuTime = -1;
+    framesRead = 0;
+    framesWritten = 0;
+    startCPUTime = getThreadCPUTime();
+    startTime = QDateTime::currentDateTime();
+    stopped = false;
+    wallTime = 0;
+    timer.start();
+}
+
+void
+StageMeter::stop()
+{
+    wallTime = timer.nsecsElapsed() / 1000;
+
+    // Add the data counted by the calling thread, so that the counts are
+    // complete even if the meter is still current.
+    CurrentMeter *current = getCurrentMeter();
+    if (current && (current->meter == this)) {
+        addCounts(current->bytesRead, current->bytesWritten,
+                  current->framesRead, current->framesWritten);
+        clearCounts(current);
+    }
+
+    if (startCPUTime != -1) {
+        qint64 stopCPUTime = getThreadCPUTime();
+        if (stopCPUTime != -1) {
+            cpuTime = stopCPUTime - startCPUTime;
+        }
+    }
+    stopped = true;
+}
@@ -0,0 +1,129 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <synthclone/stagemetrics.h>
+
+using synthclone::StageMetrics;
+
+StageMetrics::StageMetrics(Stage stage, const QString &componentName,
+                           int zoneIndex)
+{
+    bytesRead = 0;
+    bytesWritten = 0;
+    this->componentName = componentName;
+    cpuTime = -1;
+    framesRead = 0;
+    framesWritten = 0;
+    this->stage = stage;
+    wallTime = 0;
+    this->zoneIndex = zoneIndex;
+}
+
+StageMetrics::~StageMetrics()
+{
+    // Empty
+}
+
+qint64
+StageMetrics::getBytesRead() const
+{
+    return bytesRead;
+}
+
+qint64
+StageMetrics::getBytesWritten() const
+{
+    return bytesWritten;
+}
+
+QString
+StageMetrics::getComponentName() const
+{
+    return componentName;
+}
+
+qint64
+StageMetrics::getCPUTime() const
+{
+    return cpuTime;
+}
+
+synthclone::SampleFrameCount
+StageMetrics::getFramesRead() const
+{
+    return framesRead;
+}
+
+synthclone::SampleFrameCount
+StageMetrics::getFramesWritten() const
+{
+    return framesWritten;
+}
+
+StageMetrics::Stage
+StageMetrics::getStage() const
+{
+    return stage;
+}
+
+QDateTime
+StageMetrics::getStartTime() const
+{
+    return startTime;
+}
+
+qint64
+StageMetrics::getWallTime() const
+{
+    return wallTime;
+}
+
+int
+StageMetrics::getZoneIndex() const
+{
+    return zoneIndex;
+}
+
+void
+StageMetrics::setCounts(qint64 bytesRead, qint64 bytesWritten,
+                        SampleFrameCount framesRead,
+                        SampleFrameCount framesWritten)
+{
+    this->bytesRead = bytesRead;
+    this->bytesWritten = bytesWritten;
+    this->framesRead = framesRead;
+    this->framesWritten = framesWritten;
+}
+
+void
+StageMetrics::setMeasurements(const StageMeter &meter)
+{
+    setCounts(meter.getBytesRead(), meter.getBytesWritten(),
+              meter.getFramesRead(), meter.getFramesWritten());
+    setTimes(meter.getStartTime(), meter.getWallTime(), meter.getCPUTime());
+}
+
+void
+StageMetrics::setTimes(const QDateTime &startTime, qint64 wallTime,
+                       qint64 cpuTime)
+{
+    this->cpuTime = cpuTime;
+    this->startTime = startTime;
+    this->wallTime = wallTime;
+}
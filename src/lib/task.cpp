@@ -0,0 +1,63 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <synthclone/cancellationtoken.h>
+#include <synthclone/task.h>
+#include <synthclone/taskgroup.h>
+
+using synthclone::Task;
+
+Task::Task()
+{
+    cancellationToken = 0;
+    group = 0;
+    stageMeter = 0;
+}
+
+Task::~Task()
+{
+    // Empty
+}
+
+float
+Task::getProgress() const
+{
+    return static_cast<float>(static_cast<int>(progress)) / 1000.0;
+}
+
+bool
+Task::isCancelled() const
+{
+    return (group && group->isCancelled()) ||
+        (cancellationToken && cancellationToken->isCancelled());
+}
+
+bool
+Task::isFinished() const
+{
+    // The acquire makes the results of the task visible to the caller.
+    return const_cast<QAtomicInt &>(finished).testAndSetAcquire(1, 1);
+}
+
+void
+Task::setProgress(float progress)
+{
+    int value = qRound(progress * 1000.0);
+    this->progress.fetchAndStoreRelaxed(qBound(0, value, 1000));
+}
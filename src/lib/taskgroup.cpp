@@ -0,0 +1,181 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cassert>
+
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMutexLocker>
+
+#include <synthclone/cancellationtoken.h>
+#include <synthclone/error.h>
+#include <synthclone/stagemeter.h>
+#include <synthclone/taskgroup.h>
+
+using synthclone::TaskGroup;
+
+TaskGroup::TaskGroup(TaskPool &pool, QObject *parent):
+    QObject(parent),
+    pool(pool)
+{
+    error = false;
+    finishedCount = 0;
+}
+
+TaskGroup::~TaskGroup()
+{
+    cancel();
+    waitForTasks();
+    qDeleteAll(tasks);
+}
+
+void
+TaskGroup::cancel()
+{
+    cancelled.fetchAndStoreRelaxed(1);
+}
+
+void
+TaskGroup::finishTask(const QString *errorMessage)
+{
+    QMutexLocker locker(&mutex);
+    if (errorMessage && (! error)) {
+        error = true;
+        this->errorMessage = *errorMessage;
+    }
+    finishedCount++;
+    finishedCondition.wakeAll();
+}
+
+int
+TaskGroup::getFinishedCount() const
+{
+    QMutexLocker locker(&mutex);
+    return finishedCount;
+}
+
+float
+TaskGroup::getProgress() const
+{
+    QMutexLocker locker(&mutex);
+    int count = tasks.count();
+    if (! count) {
+        return 1.0;
+    }
+    float progress = 0.0;
+    for (int i = 0; i < count; i++) {
+        progress += tasks[i]->getProgress();
+    }
+    return progress / static_cast<float>(count);
+}
+
+int
+TaskGroup::getTaskCount() const
+{
+    QMutexLocker locker(&mutex);
+    return tasks.count();
+}
+
+bool
+TaskGroup::isCancelled() const
+{
+    return static_cast<int>(cancelled);
+}
+
+bool
+TaskGroup::isFinished() const
+{
+    QMutexLocker locker(&mutex);
+    return finishedCount == tasks.count();
+}
+
+void
+TaskGroup::start(Task *task)
+{
+    assert(task);
+    assert(! task->group);
+    task->cancellationToken = CancellationToken::getCurrent();
+    task->finished.fetchAndStoreRelaxed(0);
+    task->group = this;
+    task->progress.fetchAndStoreRelaxed(0);
+    task->stageMeter = StageMeter::getCurrent();
+    mutex.lock();
+    tasks.append(task);
+    mutex.unlock();
+    pool.submit(task);
+}
+
+void
+TaskGroup::wait()
+{
+    waitForTasks();
+    QMutexLocker locker(&mutex);
+    if (error) {
+        throw Error(errorMessage);
+    }
+}
+
+bool
+TaskGroup::waitForDone(int msecs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (;;) {
+        mutex.lock();
+        bool finished = finishedCount == tasks.count();
+        mutex.unlock();
+        if (finished) {
+            return true;
+        }
+        qint64 remaining = msecs - timer.elapsed();
+        if (remaining <= 0) {
+            return false;
+        }
+        if (! pool.runPendingTask()) {
+            QMutexLocker locker(&mutex);
+            if (finishedCount != tasks.count()) {
+                finishedCondition.wait(&mutex, static_cast<unsigned long>
+                                       (qMin(remaining,
+                                             static_cast<qint64>(10))));
+            }
+        }
+    }
+}
+
+void
+TaskGroup::waitForTasks()
+{
+    for (;;) {
+        mutex.lock();
+        bool finished = finishedCount == tasks.count();
+        mutex.unlock();
+        if (finished) {
+            break;
+        }
+
+        // Help out with queued tasks instead of blocking a thread that could
+        // be doing useful work.  If there's nothing to run, then the remaining
+        // tasks are running in other threads.
+        if (! pool.runPendingTask()) {
+            QMutexLocker locker(&mutex);
+            if (finishedCount != tasks.count()) {
+                finishedCondition.wait(&mutex, 10);
+            }
+        }
+    }
+}
@@ -0,0 +1,198 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <cassert>
+#include <exception>
+
+#include <QtCore/QMutexLocker>
+#include <QtCore/QThread>
+
+#include <synthclone/cancellationtoken.h>
+#include <synthclone/error.h>
+#include <synthclone/stagemeter.h>
+#include <synthclone/task.h>
+#include <synthclone/taskgroup.h>
+
+#include "taskworker.h"
+
+using synthclone::Task;
+using synthclone::TaskPool;
+
+TaskPool::TaskPool(int threadCount, QObject *parent):
+    QObject(parent)
+{
+    if (threadCount < 1) {
+        threadCount = qMax(QThread::idealThreadCount(), 1);
+    }
+    pendingCount = 0;
+    stopping = false;
+    for (int i = 0; i < threadCount; i++) {
+        queues.append(new Queue());
+        workers.append(new TaskWorker(*this, i));
+    }
+    for (int i = 0; i < threadCount; i++) {
+        workers[i]->start();
+    }
+}
+
+TaskPool::~TaskPool()
+{
+    idleMutex.lock();
+    stopping = true;
+    idleCondition.wakeAll();
+    idleMutex.unlock();
+    for (int i = workers.count() - 1; i >= 0; i--) {
+        workers[i]->wait();
+    }
+    qDeleteAll(workers);
+    for (int i = queues.count() - 1; i >= 0; i--) {
+        assert(queues[i]->tasks.isEmpty());
+    }
+    qDeleteAll(queues);
+}
+
+void
+TaskPool::execute(Task *task)
+{
+    QString message;
+    bool failed = false;
+    if (! task->isCancelled()) {
+        // Waiting threads run tasks too, so the calling thread's token and
+        // meter are restored afterwards.
+        const CancellationToken *token = CancellationToken::getCurrent();
+        StageMeter *meter = StageMeter::getCurrent();
+        CancellationToken::setCurrent(task->cancellationToken);
+        StageMeter::setCurrent(task->stageMeter);
+        try {
+            task->run();
+        } catch (Error &e) {
+            failed = true;
+            message = e.getMessage();
+        } catch (std::exception &e) {
+            failed = true;
+            message = e.what();
+        }
+        CancellationToken::setCurrent(token);
+        StageMeter::setCurrent(meter);
+    }
+    task->progress.fetchAndStoreRelaxed(1000);
+    task->finished.fetchAndStoreRelease(1);
+    task->group->finishTask(failed ? &message : 0);
+}
+
+int
+TaskPool::getCurrentWorkerIndex() const
+{
+    QThread *thread = QThread::currentThread();
+    for (int i = workers.count() - 1; i >= 0; i--) {
+        if (workers[i] == thread) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int
+TaskPool::getThreadCount() const
+{
+    return workers.count();
+}
+
+bool
+TaskPool::runPendingTask()
+{
+    Task *task = takeTask(getCurrentWorkerIndex());
+    if (! task) {
+        return false;
+    }
+    execute(task);
+    return true;
+}
+
+void
+TaskPool::runWorker(int index)
+{
+    for (;;) {
+        Task *task = takeTask(index);
+        if (task) {
+            execute(task);
+            continue;
+        }
+        QMutexLocker locker(&idleMutex);
+        if (stopping) {
+            break;
+        }
+        if (! pendingCount) {
+            idleCondition.wait(&idleMutex);
+        }
+    }
+}
+
+void
+TaskPool::submit(Task *task)
+{
+    // Tasks started from a pool thread go to the front of that thread's
+    // queue.  Other tasks are spread across the queues.
+    int index = getCurrentWorkerIndex();
+    if (index == -1) {
+        index = (nextQueue.fetchAndAddRelaxed(1) & 0x7fffffff) %
+            queues.count();
+    }
+
+    // The pending count is incremented before the task is queued, so that an
+    // idle worker can't miss it.
+    idleMutex.lock();
+    pendingCount++;
+    idleMutex.unlock();
+
+    Queue *queue = queues[index];
+    queue->mutex.lock();
+    queue->tasks.append(task);
+    queue->mutex.unlock();
+    idleCondition.wakeOne();
+}
+
+Task *
+TaskPool::takeTask(int index)
+{
+    Task *task = 0;
+    int count = queues.count();
+    if (index != -1) {
+        Queue *queue = queues[index];
+        QMutexLocker locker(&queue->mutex);
+        if (! queue->tasks.isEmpty()) {
+            task = queue->tasks.takeLast();
+        }
+    }
+
+    // Steal the oldest task from another queue.
+    for (int i = 1; (! task) && (i <= count); i++) {
+        Queue *queue = queues[(index + i + count) % count];
+        QMutexLocker locker(&queue->mutex);
+        if (! queue->tasks.isEmpty()) {
+            task = queue->tasks.takeFirst();
+        }
+    }
+
+    if (task) {
+        QMutexLocker locker(&idleMutex);
+        pendingCount--;
+    }
+    return task;
+}
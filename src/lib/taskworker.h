@@ -0,0 +1,53 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __SYNTHCLONE_TASKWORKER_H__
+#define __SYNTHCLONE_TASKWORKER_H__
+
+#include <QtCore/QThread>
+
+#include <synthclone/taskpool.h>
+
+namespace synthclone {
+
+    class TaskWorker: public QThread {
+
+        Q_OBJECT
+
+    public:
+
+        TaskWorker(TaskPool &pool, int index, QObject *parent=0);
+
+        ~TaskWorker();
+
+    protected:
+
+        void
+        run();
+
+    private:
+
+        int index;
+        TaskPool &pool;
+
+    };
+
+}
+
+#endif
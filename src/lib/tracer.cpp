@@ -0,0 +1,215 @@
+/*
+ * libsynthclone - a plugin API for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This library is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your
+ * option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <QtCore/QAtomicPointer>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QTextStream>
+#include <QtCore/QThread>
+#include <QtCore/QThreadStorage>
+
+#include <synthclone/tracer.h>
+#include <synthclone/util.h>
+
+using synthclone::TraceSpan;
+using synthclone::Tracer;
+
+// QThreadStorage deletes its values when a thread exits, so the innermost
+// open span of each thread is stored indirectly.
+
+struct CurrentSpan {
+    TraceSpan *span;
+};
+
+static QAtomicPointer<Tracer> activeTracer;
+static QThreadStorage<CurrentSpan *> currentSpans;
+
+// Static functions
+
+Tracer *
+Tracer::getActive()
+{
+    return activeTracer;
+}
+
+void
+Tracer::setActive(Tracer *tracer)
+{
+    activeTracer.fetchAndStoreOrdered(tracer);
+}
+
+// Class definition
+
+Tracer::Tracer()
+{
+    timer.start();
+}
+
+Tracer::~Tracer()
+{
+    // Empty
+}
+
+void
+Tracer::addSpan(const QString &category, const QString &name,
+                qint64 startTime, qint64 duration, int zoneIndex,
+                const QVariantMap &arguments, const QString &threadName)
+{
+    Span span;
+    span.arguments = arguments;
+    if (zoneIndex != -1) {
+        span.arguments.insert("zone", zoneIndex + 1);
+    }
+    span.category = category;
+    span.duration = duration < 0 ? 0 : duration;
+    span.name = name;
+    span.startTime = startTime;
+
+    QMutexLocker locker(&mutex);
+    span.threadId = getThreadId(threadName);
+    spans.append(span);
+}
+
+void
+Tracer::clear()
+{
+    QMutexLocker locker(&mutex);
+    spans.clear();
+}
+
+int
+Tracer::getSpanCount() const
+{
+    QMutexLocker locker(&mutex);
+    return spans.count();
+}
+
+int
+Tracer::getThreadId(const QString &threadName)
+{
+    // Thread ids start at 1, as some trace viewers treat 0 specially.
+    if (! threadName.isEmpty()) {
+        int id = threadNameIds.value(threadName);
+        if (! id) {
+            threadNames.append(threadName);
+            id = threadNames.count();
+            threadNameIds.insert(threadName, id);
+        }
+        return id;
+    }
+    Qt::HANDLE handle = QThread::currentThreadId();
+    int id = threadHandleIds.value(handle);
+    if (! id) {
+        QThread *thread = QThread::currentThread();
+        QString name = thread->objectName();
+        if (name.isEmpty()) {
+            QCoreApplication *application = QCoreApplication::instance();
+            name = (application && (application->thread() == thread)) ?
+                QString("main") :
+                QString("thread %1").arg(threadHandleIds.count() + 1);
+        }
+        threadNames.append(name);
+        id = threadNames.count();
+        threadHandleIds.insert(handle, id);
+    }
+    return id;
+}
+
+qint64
+Tracer::getTime() const
+{
+    return timer.nsecsElapsed() / 1000;
+}
+
+void
+Tracer::write(QIODevice &device) const
+{
+    QMutexLocker locker(&mutex);
+    QTextStream stream(&device);
+    stream.setCodec("UTF-8");
+    stream << "{\n";
+    stream << "    \"displayTimeUnit\": \"ms\",\n";
+    stream << "    \"traceEvents\": [";
+    int threadCount = threadNames.count();
+    for (int i = 0; i < threadCount; i++) {
+        stream << (i ? ",\n" : "\n")
+               << "        {\"name\": \"thread_name\", \"ph\": \"M\", "
+               << "\"pid\": 1, \"tid\": " << (i + 1)
+               << ", \"args\": {\"name\": " << getJSONString(threadNames[i])
+               << "}}";
+    }
+    int spanCount = spans.count();
+    for (int i = 0; i < spanCount; i++) {
+        const Span &span = spans[i];
+        stream << ((i || threadCount) ? ",\n" : "\n")
+               << "        {\"name\": " << getJSONString(span.name)
+               << ", \"cat\": " << getJSONString(span.category)
+               << ", \"ph\": \"X\", \"ts\": " << span.startTime
+               << ", \"dur\": " << span.duration
+               << ", \"pid\": 1, \"tid\": " << span.threadId
+               << ", \"args\": {";
+        QVariantMap::const_iterator end = span.arguments.constEnd();
+        for (QVariantMap::const_iterator iter = span.arguments.constBegin();
+             iter != end; iter++) {
+            if (iter != span.arguments.constBegin()) {
+                stream << ", ";
+            }
+            stream << getJSONString(iter.key()) << ": "
+                   << getJSONValue(iter.value());
+        }
+        stream << "}}";
+    }
+    stream << ((threadCount || spanCount) ? "\n    ]\n}\n" : "]\n}\n");
+    stream.flush();
+}
+
+// TraceSpan
+
+TraceSpan::TraceSpan(const char *category, const QString &name,
+                     int zoneIndex)
+{
+    tracer = Tracer::getActive();
+    if (! tracer) {
+        return;
+    }
+    if (! currentSpans.hasLocalData()) {
+        CurrentSpan *currentSpan = new CurrentSpan();
+        currentSpan->span = 0;
+        currentSpans.setLocalData(currentSpan);
+    }
+    CurrentSpan *currentSpan = currentSpans.localData();
+    this->category = category;
+    this->name = name;
+    parent = currentSpan->span;
+    if ((zoneIndex == -1) && parent) {
+        zoneIndex = parent->zoneIndex;
+    }
+    this->zoneIndex = zoneIndex;
+    currentSpan->span = this;
+    startTime = tracer->getTime();
+}
+
+TraceSpan::~TraceSpan()
+{
+    if (tracer) {
+        tracer->addSpan(category, name, startTime,
+                        tracer->getTime() - startTime, zoneIndex);
+        currentSpans.localData()->span = parent;
+    }
+}
@@ -17,12 +17,14 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include <cassert>
 #include <cstdlib>
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDebug>
 #include <QtCore/QFile>
 #include <QtCore/QLocale>
+#include <QtCore/qnumeric.h>
 #include <QtUiTools/QUiLoader>
 
 #include <synthclone/util.h>
@@ -37,6 +39,91 @@ synthclone::_die(const char *path, const char *func, int line,
     abort();
 }
 
+synthclone::SampleFrameCount
+synthclone::findOnset(const float *buffer, SampleFrameCount frames,
+                      SampleChannelCount channels)
+{
+    SampleFrameCount size = frames * channels;
+    float peak = 0.0;
+    for (SampleFrameCount i = 0; i < size; i++) {
+        peak = qMax(peak, qAbs(buffer[i]));
+    }
+    if (peak < 0.001) {
+        return -1;
+    }
+    float threshold = peak / 10.0;
+    for (SampleFrameCount i = 0; i < size; i++) {
+        if (qAbs(buffer[i]) >= threshold) {
+            return i / channels;
+        }
+    }
+
+    // The peak itself is above the threshold.
+    assert(false);
+    return -1;
+}
+
+QString
+synthclone::getJSONString(const QString &str)
+{
+    QString result = "\"";
+    int length = str.length();
+    for (int i = 0; i < length; i++) {
+        QChar c = str[i];
+        switch (c.unicode()) {
+        case '"':
+            result += "\\\"";
+            break;
+        case '\\':
+            result += "\\\\";
+            break;
+        case '\n':
+            result += "\\n";
+            break;
+        case '\r':
+            result += "\\r";
+            break;
+        case '\t':
+            result += "\\t";
+            break;
+        default:
+            if (c.unicode() < 0x20) {
+                result += QString("\\u%1").arg(c.unicode(), 4, 16,
+                                               QChar('0'));
+            } else {
+                result += c;
+            }
+        }
+    }
+    return result + "\"";
+}
+
+QString
+synthclone::getJSONValue(const QVariant &value)
+{
+    switch (value.type()) {
+    case QVariant::Bool:
+        return value.toBool() ? "true" : "false";
+    case QVariant::Double:
+        {
+            // JSON has no representation for infinities or NaN.
+            double d = value.toDouble();
+            if (! qIsFinite(d)) {
+                return "null";
+            }
+            return QString::number(d, 'g', 12);
+        }
+    case QVariant::Int:
+    case QVariant::LongLong:
+    case QVariant::UInt:
+    case QVariant::ULongLong:
+        return value.toString();
+    default:
+        ;
+    }
+    return getJSONString(value.toString());
+}
+
 QString
 synthclone::getMIDIControlString(MIDIData control)
 {
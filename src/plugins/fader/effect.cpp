@@ -79,8 +79,8 @@ void
 Effect::handleCopyProgress(synthclone::SampleFrameCount current,
                            synthclone::SampleFrameCount /*total*/)
 {
-    emit progressChanged(static_cast<float>(copyStartFrame + current) /
-                         static_cast<float>(copyTotalFrames));
+    reportProgress(static_cast<float>(copyStartFrame + current) /
+                   static_cast<float>(copyTotalFrames));
 }
 
 
@@ -151,8 +151,8 @@ Effect::process(const synthclone::Zone &/*zone*/,
                 audioData[i] *= volume;
             }
             outputStream.write(audioData, 1);
-            emit progressChanged(static_cast<float>(currentFrame + 1) /
-                                 static_cast<float>(frames));
+            reportProgress(static_cast<float>(currentFrame + 1) /
+                           static_cast<float>(frames));
         }
     }
     synthclone::SampleFrameCount fadeOutStartFrame = frames - fadeOutFrames;
@@ -194,11 +194,11 @@ Effect::process(const synthclone::Zone &/*zone*/,
                 audioData[i] *= volume;
             }
             outputStream.write(audioData, 1);
-            emit progressChanged(static_cast<float>(currentFrame + 1) /
-                                 static_cast<float>(frames));
+            reportProgress(static_cast<float>(currentFrame + 1) /
+                           static_cast<float>(frames));
         }
     }
-    emit progressChanged(0.0);
+    reportProgress(0.0);
     emit statusChanged("");
 
     qDebug() << "/Effect::process";
@@ -18,32 +18,117 @@
  */
 
 #include <cassert>
+#include <cerrno>
 #include <stdexcept>
 
 #include <archive_entry.h>
+#include <zlib.h>
 
 #include <QtCore/QDebug>
 
+#include <synthclone/cancellationtoken.h>
 #include <synthclone/error.h>
 
 #include "archivewriter.h"
 
-ArchiveWriter::ArchiveWriter(const QString &path, QObject *parent):
-    QObject(parent)
+// Static functions
+
+int
+ArchiveWriter::handleClose(archive *arch, void *data)
+{
+    ArchiveWriter *writer = static_cast<ArchiveWriter *>(data);
+    try {
+        writer->finishBlocks();
+    } catch (synthclone::Error &e) {
+        archive_set_error(arch, EIO, "%s",
+                          e.getMessage().toLocal8Bit().constData());
+        writer->file.close();
+        return ARCHIVE_FATAL;
+    }
+    writer->file.close();
+    return ARCHIVE_OK;
+}
+
+ssize_t
+ArchiveWriter::handleWrite(archive *arch, void *data, const void *buffer,
+                           size_t length)
 {
+    ArchiveWriter *writer = static_cast<ArchiveWriter *>(data);
+    try {
+        writer->input.append(static_cast<const char *>(buffer),
+                             static_cast<int>(length));
+
+        // pigz uses 128 KB blocks by default.
+        while (writer->input.count() >= 131072) {
+            writer->startBlock(writer->input.left(131072), false);
+            writer->input.remove(0, 131072);
+        }
+    } catch (synthclone::Error &e) {
+        archive_set_error(arch, EIO, "%s",
+                          e.getMessage().toLocal8Bit().constData());
+        return -1;
+    }
+    return static_cast<ssize_t>(length);
+}
+
+// Class definition
+
+ArchiveWriter::ArchiveWriter(const QString &path,
+                             CompressionLevel compressionLevel,
+                             synthclone::TaskPool &taskPool,
+                             QObject *parent):
+    QObject(parent),
+    blockGroup(taskPool),
+    file(path)
+{
+    switch (compressionLevel) {
+    case COMPRESSIONLEVEL_NONE:
+        this->compressionLevel = Z_NO_COMPRESSION;
+        break;
+    case COMPRESSIONLEVEL_FASTEST:
+        this->compressionLevel = Z_BEST_SPEED;
+        break;
+    case COMPRESSIONLEVEL_DEFAULT:
+        this->compressionLevel = Z_DEFAULT_COMPRESSION;
+        break;
+    case COMPRESSIONLEVEL_BEST:
+        this->compressionLevel = Z_BEST_COMPRESSION;
+        break;
+    default:
+        assert(false);
+    }
+    crc = crc32(0, Z_NULL, 0);
+    inputSize = 0;
+
+    // Blocks are queued a short distance ahead of the block that's being
+    // written, which bounds the memory used by compressed data.
+    maximumPendingBlockCount = taskPool.getThreadCount() * 2;
+
+    if (! file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        throw synthclone::Error(tr("could not open '%1': %2").
+                                arg(path, file.errorString()));
+    }
+
+    // Write the gzip header.  The modification time isn't set, and the
+    // operating system is set to Unix.
+    static const char header[] = {
+        '\x1f', '\x8b', '\x08', '\x00', '\x00', '\x00', '\x00', '\x00', '\x00',
+        '\x03'
+    };
+    write(QByteArray(header, sizeof(header)));
+
     arch = archive_write_new();
     if (! arch) {
         throw std::bad_alloc();
     }
     try {
-        if (archive_write_set_compression_gzip(arch) != ARCHIVE_OK) {
+        if (archive_write_set_compression_none(arch) != ARCHIVE_OK) {
             throw synthclone::Error(archive_error_string(arch));
         }
         if (archive_write_set_format_pax_restricted(arch) != ARCHIVE_OK) {
             throw synthclone::Error(archive_error_string(arch));
         }
-        QByteArray pathBytes = path.toLocal8Bit();
-        if (archive_write_open_filename(arch, pathBytes.constData()) !=
+        if (archive_write_open(arch, this, 0, handleWrite, handleClose) !=
             ARCHIVE_OK) {
             throw synthclone::Error(archive_error_string(arch));
         }
@@ -71,10 +156,73 @@ void
 ArchiveWriter::close()
 {
     assert(! closed);
+    closed = true;
     if (archive_write_close(arch) != ARCHIVE_OK) {
         throw synthclone::Error(archive_error_string(arch));
     }
-    closed = true;
+}
+
+void
+ArchiveWriter::finishBlocks()
+{
+    startBlock(input, true);
+    input.clear();
+    writeBlocks(0);
+
+    // Write the gzip trailer, which contains the CRC and the size of the
+    // uncompressed data, modulo 2^32, in little-endian order.
+    QByteArray trailer(8, '\0');
+    for (int i = 0; i < 4; i++) {
+        trailer[i] = static_cast<char>((crc >> (i * 8)) & 0xff);
+        trailer[i + 4] = static_cast<char>((inputSize >> (i * 8)) & 0xff);
+    }
+    write(trailer);
+}
+
+void
+ArchiveWriter::startBlock(const QByteArray &data, bool last)
+{
+    GzipBlock *block =
+        new GzipBlock(data, dictionary, compressionLevel, last);
+    blocks.append(block);
+    blockGroup.start(block);
+
+    // Each block is primed with the last 32 KB of the previous block.
+    dictionary = data.right(32768);
+
+    writeBlocks(maximumPendingBlockCount);
+}
+
+void
+ArchiveWriter::write(const QByteArray &data)
+{
+    if (file.write(data) != data.count()) {
+        throw synthclone::Error(tr("could not write to '%1': %2").
+                                arg(file.fileName(), file.errorString()));
+    }
+}
+
+void
+ArchiveWriter::writeBlocks(int pendingBlockCount)
+{
+    while (blocks.count() > pendingBlockCount) {
+        GzipBlock *block = blocks.takeFirst();
+        while (! block->isFinished()) {
+            blockGroup.waitForDone(100);
+        }
+        QByteArray output = block->takeOutput();
+        if (output.isNull()) {
+            // The block either failed, or was skipped because the build was
+            // cancelled.
+            blockGroup.wait();
+            synthclone::CancellationToken::checkCurrent();
+            assert(false);
+        }
+        write(output);
+        quint32 size = block->getSize();
+        crc = crc32_combine(crc, block->getCRC(), size);
+        inputSize += size;
+    }
 }
 
 void
@@ -22,7 +22,21 @@
 
 #include <archive.h>
 
+#include <QtCore/QFile>
+#include <QtCore/QList>
+
+#include <synthclone/taskgroup.h>
+#include <synthclone/taskpool.h>
+
 #include "archiveheader.h"
+#include "gzipblock.h"
+#include "types.h"
+
+// Writes a gzip-compressed tar archive.  libarchive writes the uncompressed
+// tar data to the archive writer, which splits the data into blocks that are
+// compressed in parallel, and writes the compressed blocks to the archive file
+// in order as a single gzip member.  The blocks are compressed in the shared
+// task pool, and are owned by the block group.
 
 class ArchiveWriter: public QObject {
 
@@ -30,7 +44,8 @@ class ArchiveWriter: public QObject {
 
 public:
 
-    ArchiveWriter(const QString &path, QObject *parent=0);
+    ArchiveWriter(const QString &path, CompressionLevel compressionLevel,
+                  synthclone::TaskPool &taskPool, QObject *parent=0);
 
     ~ArchiveWriter();
 
@@ -45,8 +60,35 @@ public:
 
 private:
 
+    static int
+    handleClose(archive *arch, void *data);
+
+    static ssize_t
+    handleWrite(archive *arch, void *data, const void *buffer, size_t length);
+
+    void
+    finishBlocks();
+
+    void
+    startBlock(const QByteArray &data, bool last);
+
+    void
+    write(const QByteArray &data);
+
+    void
+    writeBlocks(int pendingBlockCount);
+
     archive *arch;
+    synthclone::TaskGroup blockGroup;
+    QList<GzipBlock *> blocks;
     bool closed;
+    int compressionLevel;
+    quint32 crc;
+    QByteArray dictionary;
+    QFile file;
+    QByteArray input;
+    quint32 inputSize;
+    int maximumPendingBlockCount;
 
 };
 
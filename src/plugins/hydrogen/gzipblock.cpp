@@ -0,0 +1,132 @@
+/*
+ * libsynthclone_hydrogen - Hydrogen target plugin for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <zlib.h>
+
+#include <QtCore/QCoreApplication>
+
+#include <synthclone/error.h>
+
+#include "gzipblock.h"
+
+GzipBlock::GzipBlock(const QByteArray &data, const QByteArray &dictionary,
+                     int level, bool last)
+{
+    crc = 0;
+    this->data = data;
+    this->dictionary = dictionary;
+    this->last = last;
+    this->level = level;
+    size = static_cast<quint32>(data.count());
+}
+
+GzipBlock::~GzipBlock()
+{
+    // Empty
+}
+
+quint32
+GzipBlock::getCRC() const
+{
+    return crc;
+}
+
+quint32
+GzipBlock::getSize() const
+{
+    return size;
+}
+
+void
+GzipBlock::run()
+{
+    crc = crc32(crc32(0, Z_NULL, 0),
+                reinterpret_cast<const Bytef *>(data.constData()),
+                static_cast<uInt>(data.count()));
+
+    z_stream stream;
+    stream.next_in = Z_NULL;
+    stream.avail_in = 0;
+    stream.opaque = Z_NULL;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+
+    // Raw deflate data is written, as the gzip header and trailer are written
+    // by the archive writer.
+    int result = deflateInit2(&stream, level, Z_DEFLATED, -15, 8,
+                              Z_DEFAULT_STRATEGY);
+    if (result != Z_OK) {
+        throw synthclone::Error
+            (QCoreApplication::translate
+             ("GzipBlock", "failed to initialize compressor: %1").
+             arg(stream.msg ? stream.msg : zError(result)));
+    }
+    if (! dictionary.isEmpty()) {
+        deflateSetDictionary
+            (&stream, reinterpret_cast<const Bytef *>(dictionary.constData()),
+             static_cast<uInt>(dictionary.count()));
+    }
+    stream.next_in =
+        reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    stream.avail_in = static_cast<uInt>(data.count());
+
+    // Blocks other than the last block are ended with a sync flush, which
+    // aligns the end of the block to a byte boundary without ending the
+    // deflate stream.
+    int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+    int outputSize =
+        static_cast<int>(deflateBound(&stream, stream.avail_in)) + 16;
+    QByteArray output;
+    output.resize(outputSize);
+    int written = 0;
+    for (;;) {
+        stream.next_out = reinterpret_cast<Bytef *>(output.data() + written);
+        stream.avail_out = static_cast<uInt>(outputSize - written);
+        result = deflate(&stream, flush);
+        written = outputSize - static_cast<int>(stream.avail_out);
+        if ((result != Z_OK) && (result != Z_STREAM_END) &&
+            (result != Z_BUF_ERROR)) {
+            QString message = QCoreApplication::translate
+                ("GzipBlock", "failed to compress data: %1").
+                arg(stream.msg ? stream.msg : zError(result));
+            deflateEnd(&stream);
+            throw synthclone::Error(message);
+        }
+        if (last ? (result == Z_STREAM_END) : (stream.avail_out != 0)) {
+            break;
+        }
+        outputSize *= 2;
+        output.resize(outputSize);
+    }
+    deflateEnd(&stream);
+    output.resize(written);
+    this->output = output;
+
+    // The input data isn't needed after the block is compressed.
+    data = QByteArray();
+    dictionary = QByteArray();
+}
+
+QByteArray
+GzipBlock::takeOutput()
+{
+    QByteArray output = this->output;
+    this->output = QByteArray();
+    return output;
+}
@@ -0,0 +1,69 @@
+/*
+ * libsynthclone_hydrogen - Hydrogen target plugin for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __GZIPBLOCK_H__
+#define __GZIPBLOCK_H__
+
+#include <QtCore/QByteArray>
+
+#include <synthclone/task.h>
+
+// Compresses one block of a gzip member.  Blocks are compressed in parallel
+// and concatenated in order, in the same way as `pigz`: each block is primed
+// with the last 32 KB of the previous block, and ends on a byte boundary, so
+// the concatenated blocks form a single deflate stream that any gzip reader
+// can decompress.  Blocks are run in the shared task pool.
+
+class GzipBlock: public synthclone::Task {
+
+public:
+
+    GzipBlock(const QByteArray &data, const QByteArray &dictionary, int level,
+              bool last);
+
+    ~GzipBlock();
+
+    quint32
+    getCRC() const;
+
+    quint32
+    getSize() const;
+
+    void
+    run();
+
+    // Takes the compressed data from the block, so that the memory used by
+    // the data is released as soon as the data is written.  The data is null
+    // if the block failed or was cancelled.
+    QByteArray
+    takeOutput();
+
+private:
+
+    quint32 crc;
+    QByteArray data;
+    QByteArray dictionary;
+    bool last;
+    int level;
+    QByteArray output;
+    quint32 size;
+
+};
+
+#endif
@@ -7,16 +7,18 @@ include(../plugins.pri)
 HEADERS += archiveheader.h \
     archivereader.h \
     archivewriter.h \
+    gzipblock.h \
     importer.h \
+    layerdecoder.h \
+    layerencoder.h \
     participant.h \
     plugin.h \
     target.h \
     targetview.h \
-    temporarydir.h \
     types.h \
     velocitycomparer.h \
     zonekey.h
-LIBS += -larchive
+LIBS += -larchive -lz
 MOC_DIR = $${MAKEDIR}/plugins/hydrogen
 OBJECTS_DIR = $${MAKEDIR}/plugins/hydrogen
 RCC_DIR = $${MAKEDIR}/plugins/hydrogen
@@ -24,12 +26,14 @@ RESOURCES += hydrogen.qrc
 SOURCES += archiveheader.cpp \
     archivereader.cpp \
     archivewriter.cpp \
+    gzipblock.cpp \
     importer.cpp \
+    layerdecoder.cpp \
+    layerencoder.cpp \
     participant.cpp \
     plugin.cpp \
     target.cpp \
     targetview.cpp \
-    temporarydir.cpp \
     velocitycomparer.cpp \
     zonekey.cpp
 TARGET = $$qtLibraryTarget(synthclone_hydrogen)
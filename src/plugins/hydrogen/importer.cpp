@@ -23,183 +23,230 @@
 #include <QtCore/QFile>
 
 #include <synthclone/error.h>
-#include <synthclone/sampleinputstream.h>
 
 #include "archivereader.h"
 #include "importer.h"
-#include "temporarydir.h"
 
 Importer::Importer(QObject *parent):
     QObject(parent)
 {
+    channels = 1;
+    directory = false;
     path = "";
+    sampleRate = synthclone::SAMPLE_RATE_NOT_SET;
 }
 
 Importer::~Importer()
 {
-    // Empty
+    clearDecoders();
 }
 
-QString
-Importer::getPath() const
+void
+Importer::addLayer(QList<Layer> &layers, const QDomElement &element,
+                   synthclone::MIDIData note, synthclone::MIDIData velocity)
 {
-    return path;
+    // If there is no filename element, then we're done.
+    QDomElement filenameElement = element.firstChildElement("filename");
+    if (filenameElement.isNull()) {
+        return;
+    }
+    QString fileName = QFileInfo(filenameElement.text()).fileName();
+    LayerDecoder *decoder = decoderMap.value(fileName, 0);
+    if ((! decoder) && directory) {
+        decoder = new LayerDecoder(kitDir.absoluteFilePath(fileName),
+                                   sampleRate, channels);
+        startDecoder(decoder, fileName);
+    }
+    Layer layer;
+    layer.decoder = decoder;
+    layer.element = element;
+    layer.note = note;
+    layer.velocity = velocity;
+    layers.append(layer);
 }
 
 void
-Importer::import()
+Importer::clearDecoders()
 {
-    QDir kitDir;
-    TemporaryDir *tempDir;
-    QScopedPointer<TemporaryDir> tempDirPtr;
-    if (QFileInfo(path).isDir()) {
-        kitDir.setPath(path);
-    } else {
-
-        // Extract data from archive into temporary directory.
-        ArchiveReader archiveReader(path);
-        tempDir = new TemporaryDir(this);
-        tempDirPtr.reset(tempDir);
-        kitDir.setPath(tempDir->getPath());
-        char readBuffer[8192];
+    // The decoder group owns the decoders, and waits for any running decoders
+    // before deleting them.
+    decoderGroup.reset();
+    decoders.clear();
+    decoderMap.clear();
+}
+
+QByteArray
+Importer::extractArchive(int maximumPendingCount)
+{
+    // Archive members are read into memory and decoded by layer decoders as
+    // they're extracted, so that the kit isn't written to disk before it's
+    // decoded.  Only a bounded number of members are held in memory at once.
+    ArchiveReader archiveReader(path);
+    QByteArray kitData;
+    int waitCount = 0;
+    char readBuffer[8192];
+    for (;;) {
+        const ArchiveHeader *header = archiveReader.readHeader();
+        if (! header) {
+            break;
+        }
+        if (! header->isFile()) {
+            continue;
+        }
+        QString fileName = QFileInfo(header->getPath()).fileName();
+        QByteArray data;
+        data.reserve(static_cast<int>(header->getSize()));
         for (;;) {
-            const ArchiveHeader *header = archiveReader.readHeader();
-            if (! header) {
+            size_t bytesRead = archiveReader.readData(readBuffer, 8192);
+            if (! bytesRead) {
                 break;
             }
-            if (! header->isFile()) {
-                continue;
-            }
-            QString headerPath = QFileInfo(header->getPath()).fileName();
-            QFile file(kitDir.absoluteFilePath(headerPath));
-            if (! file.open(QIODevice::WriteOnly)) {
-                throw synthclone::Error(file.errorString());
-            }
-            for (;;) {
-                size_t bytesRead = archiveReader.readData(readBuffer, 8192);
-                if (! bytesRead) {
-                    break;
-                }
-                size_t bytesWritten = file.write(readBuffer, bytesRead);
-                assert(bytesRead == bytesWritten);
-            }
-            file.close();
+            data.append(readBuffer, static_cast<int>(bytesRead));
         }
-    }
-
-    // Parse the drumkit.xml file
-    QFile kitFile(kitDir.absoluteFilePath("drumkit.xml"));
-    if (! kitFile.open(QIODevice::ReadOnly)) {
-        throw synthclone::Error(kitFile.errorString());
-    }
-    QDomDocument document;
-    int column;
-    int line;
-    QString message;
-    bool result = document.setContent(&kitFile, &message, &line, &column);
-    kitFile.close();
-    if (! result) {
-        message = tr("'%1': error in drumkit.xml at line %2, column %3: %4").
-            arg(path).arg(line).arg(column).arg(message);
-        throw synthclone::Error(message);
-    }
-
-    // Walk through the drumkit.xml file, creating zones for each layer.
-    QDomElement element = document.documentElement();
-    if (element.tagName() != "drumkit_info") {
-        message = tr("'%1': drumkit.xml: no 'drumkit_info' element");
-        throw synthclone::Error(message);
-    }
-    element = element.firstChildElement("instrumentList");
-    if (element.isNull()) {
-        message = tr("'%1' drumkit.xml: no 'instrumentList' element");
-        throw synthclone::Error(message);
-    }
-    synthclone::MIDIData note;
-    for (element = element.firstChildElement("instrument"), note = 0;
-         ! element.isNull();
-         element = element.nextSiblingElement("instrument"),
-         note = (note + 1) % 128) {
-        QDomElement layerElement = element.firstChildElement("layer");
-        if (layerElement.isNull()) {
-            importSample(kitDir, element, note, 127);
+        if (fileName == "drumkit.xml") {
+            kitData = data;
             continue;
         }
-        for (; ! layerElement.isNull();
-             layerElement = layerElement.nextSiblingElement("layer")) {
-            QDomElement maxElement = layerElement.firstChildElement("max");
-            synthclone::MIDIData velocity;
-            if (maxElement.isNull()) {
-                qWarning() << "'layer' element doesn't contain 'max' element - "
-                    "assuming velocity of 127";
-                velocity = 127;
-            } else {
-                QString strValue = maxElement.text();
-                bool success;
-                float value = strValue.toFloat(&success);
-                if (! success) {
-                    qWarning() << "'layer' element contains non-float 'max' "
-                        "element - assuming velocity of 127";
-                    velocity = 127;
-                } else if (value > 1.0) {
-                    qWarning() << "'layer' element contains 'max' value that's "
-                        "too large - assuming velocity of 127";
-                    velocity = 127;
-                } else if (value < 0.0) {
-                    qWarning() << "'layer' element contains 'max' value that's "
-                        "too small - assuming velocity of 0";
-                    velocity = 0;
-                } else {
-                    velocity = static_cast<synthclone::MIDIData>(value * 127.0);
-                }
-            }
-            importSample(kitDir, layerElement, note, velocity);
+        for (; (decoders.count() - waitCount) >= maximumPendingCount;
+             waitCount++) {
+            waitForDecoder(decoders[waitCount]);
         }
+        startDecoder(new LayerDecoder(data, fileName, sampleRate, channels),
+                     fileName);
     }
+    if (kitData.isNull()) {
+        throw synthclone::Error(tr("'%1': archive does not contain a "
+                                   "drumkit.xml file").arg(path));
+    }
+    return kitData;
+}
+
+QString
+Importer::getPath() const
+{
+    return path;
 }
 
 void
-Importer::importSample(const QDir &kitDir, const QDomElement &element,
-                       synthclone::MIDIData note, synthclone::MIDIData velocity)
+Importer::import(synthclone::TaskPool &taskPool,
+                 synthclone::SampleRate sampleRate,
+                 synthclone::SampleChannelCount channels)
 {
-    // If there is no filename element, then we're done.
-    QDomElement filenameElement = element.firstChildElement("filename");
-    if (filenameElement.isNull()) {
-        return;
-    }
+    this->channels = channels;
+    this->sampleRate = sampleRate;
+    decoderGroup.reset(new synthclone::TaskGroup(taskPool));
+    QList<Layer> layers;
     try {
-        synthclone::Sample sample
-            (kitDir.absoluteFilePath(QFileInfo(filenameElement.text()).
-                                     fileName()));
-        synthclone::SampleInputStream stream(sample);
-
-        // Check the total time consumed by the sample.  If it isn't in the
-        // acceptable range for `synthclone` dry samples, then raise a
-        // `synthclone::Error`.
-        synthclone::SampleRate sampleRate = stream.getSampleRate();
-        synthclone::SampleTime time = stream.getFrames() /
-            static_cast<synthclone::SampleTime>(sampleRate);
+        QByteArray kitData;
+        if (QFileInfo(path).isDir()) {
+            directory = true;
+            kitDir.setPath(path);
+            QFile kitFile(kitDir.absoluteFilePath("drumkit.xml"));
+            if (! kitFile.open(QIODevice::ReadOnly)) {
+                throw synthclone::Error(kitFile.errorString());
+            }
+            kitData = kitFile.readAll();
+            kitFile.close();
+        } else {
+            directory = false;
+            kitData = extractArchive(taskPool.getThreadCount() * 2);
+        }
+
+        // Parse the drumkit.xml file
+        QDomDocument document;
+        int column;
+        int line;
         QString message;
-        if (time > synthclone::SAMPLE_TIME_MAXIMUM) {
-            message = tr("%1: sample time is %2, which is greater than %3 "
-                         "seconds").
-                arg(path).arg(time).arg(synthclone::SAMPLE_TIME_MAXIMUM);
+        if (! document.setContent(kitData, &message, &line, &column)) {
+            message = tr("'%1': error in drumkit.xml at line %2, column %3: "
+                         "%4").arg(path).arg(line).arg(column).arg(message);
             throw synthclone::Error(message);
         }
-        if (time < synthclone::SAMPLE_TIME_MINIMUM) {
-            message = tr("%1: sample time is %2, which is less than %3 "
-                         "seconds").
-                arg(path).arg(time).arg(synthclone::SAMPLE_TIME_MINIMUM);
+
+        // Walk through the drumkit.xml file, collecting the layers.
+        QDomElement element = document.documentElement();
+        if (element.tagName() != "drumkit_info") {
+            message = tr("'%1': drumkit.xml: no 'drumkit_info' element");
             throw synthclone::Error(message);
         }
+        element = element.firstChildElement("instrumentList");
+        if (element.isNull()) {
+            message = tr("'%1' drumkit.xml: no 'instrumentList' element");
+            throw synthclone::Error(message);
+        }
+        synthclone::MIDIData note;
+        for (element = element.firstChildElement("instrument"), note = 0;
+             ! element.isNull();
+             element = element.nextSiblingElement("instrument"),
+             note = (note + 1) % 128) {
+            QDomElement layerElement = element.firstChildElement("layer");
+            if (layerElement.isNull()) {
+                addLayer(layers, element, note, 127);
+                continue;
+            }
+            for (; ! layerElement.isNull();
+                 layerElement = layerElement.nextSiblingElement("layer")) {
+                QDomElement maxElement = layerElement.firstChildElement("max");
+                synthclone::MIDIData velocity;
+                if (maxElement.isNull()) {
+                    qWarning() << "'layer' element doesn't contain 'max' "
+                        "element - assuming velocity of 127";
+                    velocity = 127;
+                } else {
+                    QString strValue = maxElement.text();
+                    bool success;
+                    float value = strValue.toFloat(&success);
+                    if (! success) {
+                        qWarning() << "'layer' element contains non-float "
+                            "'max' element - assuming velocity of 127";
+                        velocity = 127;
+                    } else if (value > 1.0) {
+                        qWarning() << "'layer' element contains 'max' value "
+                            "that's too large - assuming velocity of 127";
+                        velocity = 127;
+                    } else if (value < 0.0) {
+                        qWarning() << "'layer' element contains 'max' value "
+                            "that's too small - assuming velocity of 0";
+                        velocity = 0;
+                    } else {
+                        velocity =
+                            static_cast<synthclone::MIDIData>(value * 127.0);
+                    }
+                }
+                addLayer(layers, layerElement, note, velocity);
+            }
+        }
 
-        emit layerImported(note, velocity, time, sample);
-    } catch (synthclone::Error &e) {
-        qWarning() << tr("%1, line %2, column %3: %4").
-            arg(kitDir.absoluteFilePath("drumkit.xml")).
-            arg(element.lineNumber()).arg(element.columnNumber()).
-            arg(e.getMessage());
+        // Emit the layers in drumkit order as their decoders finish.
+        QString kitPath = directory ?
+            kitDir.absoluteFilePath("drumkit.xml") :
+            QString("%1/drumkit.xml").arg(path);
+        for (int i = 0; i < layers.count(); i++) {
+            const Layer &layer = layers[i];
+            LayerDecoder *decoder = layer.decoder;
+            if (! decoder) {
+                message = tr("archive does not contain '%1'").
+                    arg(QFileInfo(layer.element.firstChildElement("filename").
+                                  text()).fileName());
+            } else {
+                waitForDecoder(decoder);
+                synthclone::Sample *sample = decoder->getSample();
+                if (sample) {
+                    emit layerImported(layer.note, layer.velocity,
+                                       decoder->getTime(), *sample);
+                    continue;
+                }
+                message = decoder->getErrorMessage();
+            }
+            qWarning() << tr("%1, line %2, column %3: %4").
+                arg(kitPath).arg(layer.element.lineNumber()).
+                arg(layer.element.columnNumber()).arg(message);
+        }
+    } catch (...) {
+        clearDecoders();
+        throw;
     }
+    clearDecoders();
 }
 
 void
@@ -210,3 +257,19 @@ Importer::setPath(const QString &path)
         emit pathChanged(path);
     }
 }
+
+void
+Importer::startDecoder(LayerDecoder *decoder, const QString &fileName)
+{
+    decoders.append(decoder);
+    decoderMap.insert(fileName, decoder);
+    decoderGroup->start(decoder);
+}
+
+void
+Importer::waitForDecoder(LayerDecoder *decoder)
+{
+    while (! decoder->isFinished()) {
+        decoderGroup->waitForDone(100);
+    }
+}
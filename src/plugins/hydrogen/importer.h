@@ -21,13 +21,20 @@
 #define __IMPORTER_H__
 
 #include <QtCore/QDir>
+#include <QtCore/QList>
+#include <QtCore/QMap>
 #include <QtCore/QObject>
+#include <QtCore/QScopedPointer>
 #include <QtCore/QString>
 #include <QtXml/QDomDocument>
 
 #include <synthclone/sample.h>
+#include <synthclone/taskgroup.h>
+#include <synthclone/taskpool.h>
 #include <synthclone/types.h>
 
+#include "layerdecoder.h"
+
 class Importer: public QObject {
 
     Q_OBJECT
@@ -45,7 +52,8 @@ public:
 public slots:
 
     void
-    import();
+    import(synthclone::TaskPool &taskPool, synthclone::SampleRate sampleRate,
+           synthclone::SampleChannelCount channels);
 
     void
     setPath(const QString &path);
@@ -61,11 +69,39 @@ signals:
 
 private:
 
+    struct Layer {
+        LayerDecoder *decoder;
+        QDomElement element;
+        synthclone::MIDIData note;
+        synthclone::MIDIData velocity;
+    };
+
+    typedef QMap<QString, LayerDecoder *> LayerDecoderMap;
+
+    void
+    addLayer(QList<Layer> &layers, const QDomElement &element,
+             synthclone::MIDIData note, synthclone::MIDIData velocity);
+
     void
-    importSample(const QDir &kitDir, const QDomElement &element,
-                 synthclone::MIDIData note, synthclone::MIDIData velocity);
+    clearDecoders();
 
+    QByteArray
+    extractArchive(int maximumPendingCount);
+
+    void
+    startDecoder(LayerDecoder *decoder, const QString &fileName);
+
+    void
+    waitForDecoder(LayerDecoder *decoder);
+
+    synthclone::SampleChannelCount channels;
+    QScopedPointer<synthclone::TaskGroup> decoderGroup;
+    LayerDecoderMap decoderMap;
+    QList<LayerDecoder *> decoders;
+    bool directory;
+    QDir kitDir;
     QString path;
+    synthclone::SampleRate sampleRate;
 
 };
 
@@ -0,0 +1,156 @@
+/*
+ * libsynthclone_hydrogen - Hydrogen target plugin for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <QtCore/QBuffer>
+#include <QtCore/QCoreApplication>
+
+#include <synthclone/error.h>
+#include <synthclone/sampleconverter.h>
+#include <synthclone/sampleoutputstream.h>
+
+#include "layerdecoder.h"
+
+LayerDecoder::LayerDecoder(const QByteArray &data, const QString &name,
+                           synthclone::SampleRate sampleRate,
+                           synthclone::SampleChannelCount channels)
+{
+    this->channels = channels;
+    this->data = data;
+    error = false;
+    this->name = name;
+    this->sampleRate = sampleRate;
+    time = 0.0;
+}
+
+LayerDecoder::LayerDecoder(const QString &path,
+                           synthclone::SampleRate sampleRate,
+                           synthclone::SampleChannelCount channels)
+{
+    this->channels = channels;
+    error = false;
+    name = path;
+    this->path = path;
+    this->sampleRate = sampleRate;
+    time = 0.0;
+}
+
+LayerDecoder::~LayerDecoder()
+{
+    // Empty
+}
+
+void
+LayerDecoder::convert(synthclone::SampleInputStream &inputStream)
+{
+    // If the session sample rate isn't set yet, then the session will take
+    // the sample rate of the first sample that's added to it.
+    synthclone::SampleRate outputSampleRate =
+        sampleRate == synthclone::SAMPLE_RATE_NOT_SET ?
+        inputStream.getSampleRate() : sampleRate;
+    if (! synthclone::SampleConverter::canConvertChannels
+        (inputStream.getChannels(), channels)) {
+        QString message = QCoreApplication::translate
+            ("LayerDecoder", "%1: can't convert %2 channels to %3 channels").
+            arg(name).arg(inputStream.getChannels()).arg(channels);
+        throw synthclone::Error(message);
+    }
+    sample.reset(new synthclone::Sample());
+    synthclone::SampleOutputStream outputStream(*sample, outputSampleRate,
+                                                channels);
+    synthclone::SampleConverter converter;
+    converter.convert(inputStream, outputStream);
+    outputStream.close();
+}
+
+void
+LayerDecoder::decode(synthclone::SampleInputStream &inputStream)
+{
+    // Check the total time consumed by the sample.  If it isn't in the
+    // acceptable range for `synthclone` dry samples, then raise a
+    // `synthclone::Error`.
+    synthclone::SampleRate inputSampleRate = inputStream.getSampleRate();
+    time = inputStream.getFrames() /
+        static_cast<synthclone::SampleTime>(inputSampleRate);
+    QString message;
+    if (time > synthclone::SAMPLE_TIME_MAXIMUM) {
+        message = QCoreApplication::translate
+            ("LayerDecoder", "%1: sample time is %2, which is greater than %3 "
+             "seconds").
+            arg(name).arg(time).arg(synthclone::SAMPLE_TIME_MAXIMUM);
+        throw synthclone::Error(message);
+    }
+    if (time < synthclone::SAMPLE_TIME_MINIMUM) {
+        message = QCoreApplication::translate
+            ("LayerDecoder", "%1: sample time is %2, which is less than %3 "
+             "seconds").
+            arg(name).arg(time).arg(synthclone::SAMPLE_TIME_MINIMUM);
+        throw synthclone::Error(message);
+    }
+    convert(inputStream);
+}
+
+QString
+LayerDecoder::getErrorMessage() const
+{
+    return errorMessage;
+}
+
+synthclone::Sample *
+LayerDecoder::getSample() const
+{
+    return sample.data();
+}
+
+synthclone::SampleTime
+LayerDecoder::getTime() const
+{
+    return time;
+}
+
+bool
+LayerDecoder::hasError() const
+{
+    return error;
+}
+
+void
+LayerDecoder::run()
+{
+    try {
+        if (path.isEmpty()) {
+            QBuffer buffer(&data);
+            if (! buffer.open(QIODevice::ReadOnly)) {
+                throw synthclone::Error(buffer.errorString());
+            }
+            synthclone::SampleInputStream inputStream(buffer);
+            decode(inputStream);
+        } else {
+            synthclone::Sample inputSample(path);
+            synthclone::SampleInputStream inputStream(inputSample);
+            decode(inputStream);
+        }
+    } catch (synthclone::Error &e) {
+        errorMessage = e.getMessage();
+        error = true;
+        sample.reset();
+    }
+
+    // The encoded data isn't needed after the sample is decoded.
+    data = QByteArray();
+}
@@ -0,0 +1,88 @@
+/*
+ * libsynthclone_hydrogen - Hydrogen target plugin for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __LAYERDECODER_H__
+#define __LAYERDECODER_H__
+
+#include <QtCore/QByteArray>
+#include <QtCore/QScopedPointer>
+
+#include <synthclone/sample.h>
+#include <synthclone/sampleinputstream.h>
+#include <synthclone/task.h>
+#include <synthclone/types.h>
+
+// Decodes a layer sample, validates the sample time, and converts the sample
+// to the session sample rate and channel count.  Archive members are decoded
+// straight from memory as they're extracted; kit directory samples are
+// decoded from their files.  Layer decoders are run in the shared task pool,
+// and the importer waits for each decoder in drumkit order before emitting
+// layers.
+
+class LayerDecoder: public synthclone::Task {
+
+public:
+
+    LayerDecoder(const QByteArray &data, const QString &name,
+                 synthclone::SampleRate sampleRate,
+                 synthclone::SampleChannelCount channels);
+
+    LayerDecoder(const QString &path, synthclone::SampleRate sampleRate,
+                 synthclone::SampleChannelCount channels);
+
+    ~LayerDecoder();
+
+    QString
+    getErrorMessage() const;
+
+    // Returns the decoded sample, or NULL if the sample couldn't be decoded or
+    // the decoder was cancelled.  The sample is owned by the decoder.
+    synthclone::Sample *
+    getSample() const;
+
+    synthclone::SampleTime
+    getTime() const;
+
+    bool
+    hasError() const;
+
+    void
+    run();
+
+private:
+
+    void
+    convert(synthclone::SampleInputStream &inputStream);
+
+    void
+    decode(synthclone::SampleInputStream &inputStream);
+
+    synthclone::SampleChannelCount channels;
+    QByteArray data;
+    bool error;
+    QString errorMessage;
+    QString name;
+    QString path;
+    QScopedPointer<synthclone::Sample> sample;
+    synthclone::SampleRate sampleRate;
+    synthclone::SampleTime time;
+
+};
+
+#endif
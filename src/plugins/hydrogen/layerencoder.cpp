@@ -0,0 +1,78 @@
+/*
+ * libsynthclone_hydrogen - Hydrogen target plugin for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <QtCore/QBuffer>
+
+#include <synthclone/error.h>
+#include <synthclone/samplecopier.h>
+#include <synthclone/sampleinputstream.h>
+#include <synthclone/sampleoutputstream.h>
+
+#include "layerencoder.h"
+
+LayerEncoder::LayerEncoder(const synthclone::Sample &sample,
+                           const QString &path,
+                           synthclone::SampleStream::Type type,
+                           synthclone::SampleStream::SubType subType):
+    sample(sample)
+{
+    this->path = path;
+    this->subType = subType;
+    this->type = type;
+}
+
+LayerEncoder::~LayerEncoder()
+{
+    // Empty
+}
+
+QString
+LayerEncoder::getPath() const
+{
+    return path;
+}
+
+void
+LayerEncoder::run()
+{
+    // The data is only stored once it's completely encoded, so that a failed
+    // encoder leaves no data behind.
+    QByteArray data;
+    QBuffer buffer(&data);
+    if (! buffer.open(QIODevice::ReadWrite)) {
+        throw synthclone::Error(buffer.errorString());
+    }
+    synthclone::SampleInputStream inputStream(sample);
+    synthclone::SampleOutputStream outputStream
+        (buffer, inputStream.getSampleRate(), inputStream.getChannels(), type,
+         subType);
+    synthclone::SampleCopier copier;
+    copier.copy(inputStream, outputStream, inputStream.getFrames());
+    outputStream.close();
+    buffer.close();
+    this->data = data;
+}
+
+QByteArray
+LayerEncoder::takeData()
+{
+    QByteArray data = this->data;
+    this->data = QByteArray();
+    return data;
+}
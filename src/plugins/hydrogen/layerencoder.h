@@ -0,0 +1,66 @@
+/*
+ * libsynthclone_hydrogen - Hydrogen target plugin for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __LAYERENCODER_H__
+#define __LAYERENCODER_H__
+
+#include <QtCore/QByteArray>
+
+#include <synthclone/sample.h>
+#include <synthclone/samplestream.h>
+#include <synthclone/task.h>
+
+// Encodes a layer sample into memory.  Layer encoders are run in the shared
+// task pool, and the target waits for each encoder in archive order before
+// handing the encoded data to the archive writer, so no intermediate files are
+// created.
+
+class LayerEncoder: public synthclone::Task {
+
+public:
+
+    LayerEncoder(const synthclone::Sample &sample, const QString &path,
+                 synthclone::SampleStream::Type type,
+                 synthclone::SampleStream::SubType subType);
+
+    ~LayerEncoder();
+
+    QString
+    getPath() const;
+
+    void
+    run();
+
+    // Takes the encoded data from the encoder, so that the memory used by the
+    // data is released as soon as the data is written to the archive.  The
+    // data is null if the encoder failed or was cancelled.
+    QByteArray
+    takeData();
+
+private:
+
+    QByteArray data;
+    QString path;
+    const synthclone::Sample &sample;
+    synthclone::SampleStream::SubType subType;
+    synthclone::SampleStream::Type type;
+
+};
+
+#endif
@@ -94,9 +94,12 @@ Participant::activate(synthclone::Context &context, const QVariant &/*state*/)
 Target *
 Participant::addTarget()
 {
-    Target *target = new Target(tr("Hydrogen"), this);
+    Target *target = new Target(tr("Hydrogen"), context->getTaskPool(),
+                                this);
     connect(target, SIGNAL(authorChanged(QString)),
             context, SLOT(setSessionModified()));
+    connect(target, SIGNAL(compressionLevelChanged(CompressionLevel)),
+            context, SLOT(setSessionModified()));
     connect(target, SIGNAL(infoChanged(QString)),
             context, SLOT(setSessionModified()));
     connect(target, SIGNAL(kitNameChanged(QString)),
@@ -134,6 +137,7 @@ Participant::configureTarget(Target *target)
 {
     assert(! configuredTarget);
     targetView.setAuthor(target->getAuthor());
+    targetView.setCompressionLevel(target->getCompressionLevel());
     targetView.setInfo(target->getInfo());
     targetView.setKitName(target->getKitName());
     targetView.setLayerAlgorithm(target->getLayerAlgorithm());
@@ -144,6 +148,8 @@ Participant::configureTarget(Target *target)
 
     connect(target, SIGNAL(authorChanged(const QString &)),
             &targetView, SLOT(setAuthor(const QString &)));
+    connect(target, SIGNAL(compressionLevelChanged(CompressionLevel)),
+            &targetView, SLOT(setCompressionLevel(CompressionLevel)));
     connect(target, SIGNAL(infoChanged(const QString &)),
             &targetView, SLOT(setInfo(const QString &)));
     connect(target, SIGNAL(kitNameChanged(const QString &)),
@@ -161,6 +167,9 @@ Participant::configureTarget(Target *target)
 
     connect(&targetView, SIGNAL(authorChangeRequest(const QString &)),
             target, SLOT(setAuthor(const QString &)));
+    connect(&targetView,
+            SIGNAL(compressionLevelChangeRequest(CompressionLevel)),
+            target, SLOT(setCompressionLevel(CompressionLevel)));
     connect(&targetView, SIGNAL(infoChangeRequest(const QString &)),
             target, SLOT(setInfo(const QString &)));
     connect(&targetView, SIGNAL(kitNameChangeRequest(const QString &)),
@@ -279,6 +288,25 @@ Participant::getState(const synthclone::Target *target) const
     }
     map["sampleFormat"] = formatStr;
 
+    QString compressionStr;
+    switch (t->getCompressionLevel()) {
+    case COMPRESSIONLEVEL_NONE:
+        compressionStr = "NONE";
+        break;
+    case COMPRESSIONLEVEL_FASTEST:
+        compressionStr = "FASTEST";
+        break;
+    case COMPRESSIONLEVEL_DEFAULT:
+        compressionStr = "DEFAULT";
+        break;
+    case COMPRESSIONLEVEL_BEST:
+        compressionStr = "BEST";
+        break;
+    default:
+        assert(false);
+    }
+    map["compressionLevel"] = compressionStr;
+
     return map;
 }
 
@@ -328,7 +356,8 @@ Participant::handleImportViewPathSelection(const QStringList &paths)
     importer.setPath(path);
     importView.setVisible(false);
     if (path.count()) {
-        importer.import();
+        importer.import(context->getTaskPool(), context->getSampleRate(),
+                        context->getSampleChannelCount());
     }
 }
 
@@ -365,6 +394,9 @@ Participant::handleTargetViewCloseRequest()
 {
     disconnect(configuredTarget, SIGNAL(authorChanged(const QString &)),
                &targetView, SLOT(setAuthor(const QString &)));
+    disconnect(configuredTarget,
+               SIGNAL(compressionLevelChanged(CompressionLevel)),
+               &targetView, SLOT(setCompressionLevel(CompressionLevel)));
     disconnect(configuredTarget, SIGNAL(infoChanged(const QString &)),
                &targetView, SLOT(setInfo(const QString &)));
     disconnect(configuredTarget, SIGNAL(kitNameChanged(const QString &)),
@@ -383,6 +415,9 @@ Participant::handleTargetViewCloseRequest()
 
     disconnect(&targetView, SIGNAL(authorChangeRequest(const QString &)),
                configuredTarget, SLOT(setAuthor(const QString &)));
+    disconnect(&targetView,
+               SIGNAL(compressionLevelChangeRequest(CompressionLevel)),
+               configuredTarget, SLOT(setCompressionLevel(CompressionLevel)));
     disconnect(&targetView, SIGNAL(infoChangeRequest(const QString &)),
                configuredTarget, SLOT(setInfo(const QString &)));
     disconnect(&targetView, SIGNAL(kitNameChangeRequest(const QString &)),
@@ -429,6 +464,14 @@ Participant::restoreTarget(const QVariant &state)
     target->setName(map.value("name", "").toString());
     target->setPath(map.value("path", "").toString());
 
+    QString compressionStr =
+        map.value("compressionLevel", "DEFAULT").toString();
+    target->setCompressionLevel
+        (compressionStr == "NONE" ? COMPRESSIONLEVEL_NONE :
+         compressionStr == "FASTEST" ? COMPRESSIONLEVEL_FASTEST :
+         compressionStr == "BEST" ? COMPRESSIONLEVEL_BEST :
+         COMPRESSIONLEVEL_DEFAULT);
+
     QString algorithmStr =
         map.value("layerAlgorithm", "LINEAR_INTERPOLATION").toString();
     target->setLayerAlgorithm
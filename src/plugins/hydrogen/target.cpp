@@ -21,17 +21,35 @@
 
 #include <QtCore/QFileInfo>
 #include <QtCore/QLocale>
+#include <QtCore/QScopedPointer>
 
+#include <synthclone/buildmanifest.h>
+#include <synthclone/cancellationtoken.h>
 #include <synthclone/error.h>
-#include <synthclone/samplecopier.h>
+#include <synthclone/taskgroup.h>
 #include <synthclone/util.h>
 
 #include "target.h"
 #include "velocitycomparer.h"
 
-Target::Target(const QString &name, QObject *parent):
-    synthclone::Target(name, parent)
+struct LayerEncoderListDestructor {
+
+    static void
+    cleanup(QList<LayerEncoder *> *layerEncoders)
+    {
+        if (layerEncoders) {
+            qDeleteAll(*layerEncoders);
+        }
+    }
+
+};
+
+Target::Target(const QString &name, synthclone::TaskPool &taskPool,
+               QObject *parent):
+    synthclone::Target(name, parent),
+    taskPool(taskPool)
 {
+    compressionLevel = COMPRESSIONLEVEL_DEFAULT;
     layerAlgorithm = LAYERALGORITHM_LINEAR_INTERPOLATION;
     sampleFormat = SAMPLEFORMAT_FLAC_24BIT;
 }
@@ -44,7 +62,7 @@ Target::~Target()
 void
 Target::build(const QList<synthclone::Zone *> &zones)
 {
-    emit progressChanged(0.0);
+    reportProgress(0.0);
     QString message;
     if (path.isEmpty()) {
         message = tr("the build path is not set");
@@ -64,9 +82,6 @@ Target::build(const QList<synthclone::Zone *> &zones)
         message = tr("'%1' is not a valid kit name").arg(kitName);
         throw synthclone::Error(message);
     }
-    ArchiveWriter archiveWriter
-        (directory.absoluteFilePath(QString("%1.h2drumkit").arg(kitName)));
-
     // This plugin builds different instruments for every different combination
     // of channel, note, channel pressure, aftertouch, and control values.  If
     // one or more zones have the same above data, then they will become layers
@@ -77,7 +92,7 @@ Target::build(const QList<synthclone::Zone *> &zones)
     int zoneCount = zones.count();
     QMultiMap<ZoneKey, const synthclone::Zone *> zoneMap;
     for (int i = 0; i < zoneCount; i++) {
-        emit progressChanged((static_cast<float>(i) / zoneCount) * 0.5);
+        reportProgress((static_cast<float>(i) / zoneCount) * 0.25);
         synthclone::Zone *zone = zones[i];
         const synthclone::Sample *sample = zone->getWetSample();
         if (! sample) {
@@ -91,7 +106,33 @@ Target::build(const QList<synthclone::Zone *> &zones)
         }
         zoneMap.insert(ZoneKey(*zone), zone);
     }
-    emit progressChanged(0.5);
+    reportProgress(0.25);
+
+    // The kit archive is only rebuilt if the zones or target settings have
+    // changed since the last build.
+    QString archiveName = QString("%1.h2drumkit").arg(kitName);
+    synthclone::BuildManifest manifest
+        (directory.absoluteFilePath(QString("%1.manifest").arg(archiveName)));
+    QVariantList keyData;
+    keyData << getName() << author << static_cast<int>(compressionLevel)
+            << info << kitName << license << static_cast<int>(layerAlgorithm)
+            << static_cast<int>(sampleFormat);
+    QMultiMap<ZoneKey, const synthclone::Zone *>::const_iterator end =
+        zoneMap.constEnd();
+    for (QMultiMap<ZoneKey, const synthclone::Zone *>::const_iterator iter =
+             zoneMap.constBegin(); iter != end; iter++) {
+        keyData << synthclone::BuildManifest::getZoneData(*(iter.value()));
+    }
+    QByteArray key = synthclone::BuildManifest::getKey(keyData);
+    if (manifest.isFileCurrent(archiveName, key)) {
+        emit statusChanged(tr("'%1' is up to date.").arg(archiveName));
+        reportProgress(0.0);
+        emit statusChanged("Idle.");
+        return;
+    }
+    manifest.addFile(archiveName, key);
+    ArchiveWriter archiveWriter(directory.absoluteFilePath(archiveName),
+                                compressionLevel, taskPool);
 
     QList<ZoneKey> keys = zoneMap.uniqueKeys();
     int instrumentCount = keys.count();
@@ -117,16 +158,24 @@ Target::build(const QList<synthclone::Zone *> &zones)
     writeElement(confWriter, "license", license);
     confWriter.writeStartElement("instrumentList");
 
+    // Layer samples are encoded into memory by layer encoders, which are run
+    // in the shared task pool after the instrument list is written.  Encoders
+    // that haven't been started are deleted with the encoder list.
+
+    QList<LayerEncoder *> layerEncoders;
+    QScopedPointer<QList<LayerEncoder *>, LayerEncoderListDestructor>
+        layerEncodersPtr(&layerEncoders);
+
     emit statusChanged(tr("Writing instrument list ..."));
     int layerOverflows = 0;
     for (int i = 0; i < instrumentCount; i++) {
         float startProgress =
-            ((static_cast<float>(i) / instrumentCount) * 0.5) + 0.5;
+            ((static_cast<float>(i) / instrumentCount) * 0.25) + 0.25;
         float endProgress =
-            ((static_cast<float>(i + 1) / instrumentCount) * 0.5) + 0.5;
+            ((static_cast<float>(i + 1) / instrumentCount) * 0.25) + 0.25;
         float difference = endProgress - startProgress;
 
-        emit progressChanged(startProgress);
+        reportProgress(startProgress);
         emit statusChanged(tr("Writing instrument %1 of %2 ...").
                            arg(locale.toString(i + 1),
                                locale.toString(instrumentCount)));
@@ -163,8 +212,8 @@ Target::build(const QList<synthclone::Zone *> &zones)
 
         // Write instrument layer data.
         for (int j = 0; j < layerCount - 1; j++) {
-            emit progressChanged(((static_cast<float>(j) / layerCount) *
-                                  difference) + startProgress);
+            reportProgress(((static_cast<float>(j) / layerCount) *
+                            difference) + startProgress);
             emit statusChanged(tr("Writing layer %1 of %2 for instrument %3 "
                                   "of %4 ...").
                                arg(locale.toString(j + 1),
@@ -191,18 +240,12 @@ Target::build(const QList<synthclone::Zone *> &zones)
             default:
                 assert(false);
             }
-            try {
-                writeLayer(archiveWriter, confWriter, i, j, lowVelocity,
-                           highVelocity, currentZone);
-            } catch (...) {
-                emit progressChanged(0.0);
-                emit statusChanged("Idle.");
-                throw;
-            }
+            writeLayer(confWriter, layerEncoders, i, j, lowVelocity,
+                       highVelocity, currentZone);
             lowVelocity = highVelocity;
         }
-        emit progressChanged(((static_cast<float>(layerCount - 1) /
-                               layerCount) * difference) + startProgress);
+        reportProgress(((static_cast<float>(layerCount - 1) /
+                         layerCount) * difference) + startProgress);
         emit statusChanged(tr("Writing layer %1 of %2 for instrument %3 of "
                               "%4 ...").
                            arg(locale.toString(layerCount),
@@ -210,14 +253,8 @@ Target::build(const QList<synthclone::Zone *> &zones)
                                locale.toString(i + 1),
                                locale.toString(instrumentCount)));
 
-        try {
-            writeLayer(archiveWriter, confWriter, i, layerCount - 1,
-                       lowVelocity, 1.0, zones[layerCount - 1]);
-        } catch (...) {
-            emit progressChanged(0.0);
-            emit statusChanged("Idle.");
-            throw;
-        }
+        writeLayer(confWriter, layerEncoders, i, layerCount - 1, lowVelocity,
+                   1.0, zones[layerCount - 1]);
         confWriter.writeEndElement();
     }
     confWriter.writeEndElement();
@@ -225,12 +262,57 @@ Target::build(const QList<synthclone::Zone *> &zones)
     confWriter.writeEndElement();
     confWriter.writeEndDocument();
 
+    // Encode the layer samples, and write them to the archive in instrument
+    // order.  Only a bounded number of encoders are queued ahead of the
+    // encoder that's being written, which bounds the amount of memory that's
+    // used for encoded samples.
+    emit statusChanged(tr("Writing layer samples ..."));
+    synthclone::TaskGroup layerEncoderGroup(taskPool);
+    int layerEncoderCount = layerEncoders.count();
+    QList<LayerEncoder *> queuedEncoders;
+    int queueSize = taskPool.getThreadCount() * 2;
+    try {
+        for (int i = 0; i < layerEncoderCount; i++) {
+            reportProgress(((static_cast<float>(i) /
+                             layerEncoderCount) * 0.5) + 0.5);
+
+            // Started encoders are owned by the task group.
+            while ((! layerEncoders.isEmpty()) &&
+                   (queuedEncoders.count() <= queueSize)) {
+                LayerEncoder *layerEncoder = layerEncoders.takeFirst();
+                layerEncoderGroup.start(layerEncoder);
+                queuedEncoders.append(layerEncoder);
+            }
+            LayerEncoder *layerEncoder = queuedEncoders.takeFirst();
+            while (! layerEncoder->isFinished()) {
+                layerEncoderGroup.waitForDone(100);
+            }
+            QByteArray data = layerEncoder->takeData();
+            if (data.isNull()) {
+                // The encoder either failed, or was skipped because the build
+                // was cancelled.
+                layerEncoderGroup.wait();
+                synthclone::CancellationToken::checkCurrent();
+                assert(false);
+            }
+            archiveWriter.writeHeader(ArchiveHeader(layerEncoder->getPath(),
+                                                    data.count()));
+            archiveWriter.writeData(data);
+        }
+    } catch (...) {
+        reportProgress(0.0);
+        emit statusChanged("Idle.");
+        throw;
+    }
+
     // Add the configuration to the archive writer.
     QByteArray configurationBytes = configuration.toLocal8Bit();
     ArchiveHeader header(QString("%1/drumkit.xml").arg(kitName),
                          configurationBytes.count());
     archiveWriter.writeHeader(header);
     archiveWriter.writeData(configurationBytes);
+    archiveWriter.close();
+    manifest.save();
 
     if (layerOverflows) {
         message = tr("%1 instruments contained more than %2 layers.  Hydrogen "
@@ -240,7 +322,7 @@ Target::build(const QList<synthclone::Zone *> &zones)
         emit buildWarning(message);
     }
 
-    emit progressChanged(0.0);
+    reportProgress(0.0);
     emit statusChanged("Idle.");
 }
 
@@ -250,6 +332,12 @@ Target::getAuthor() const
     return author;
 }
 
+CompressionLevel
+Target::getCompressionLevel() const
+{
+    return compressionLevel;
+}
+
 QString
 Target::getInfo() const
 {
@@ -295,6 +383,15 @@ Target::setAuthor(const QString &author)
     }
 }
 
+void
+Target::setCompressionLevel(CompressionLevel level)
+{
+    if (compressionLevel != level) {
+        compressionLevel = level;
+        emit compressionLevelChanged(level);
+    }
+}
+
 void
 Target::setInfo(const QString &info)
 {
@@ -359,9 +456,10 @@ Target::writeElement(QXmlStreamWriter &writer, const QString &name,
 }
 
 void
-Target::writeLayer(ArchiveWriter &archiveWriter, QXmlStreamWriter &confWriter,
-                   int instrument, int layer, float lowVelocity,
-                   float highVelocity, const synthclone::Zone *zone)
+Target::writeLayer(QXmlStreamWriter &confWriter,
+                   QList<LayerEncoder *> &layerEncoders, int instrument,
+                   int layer, float lowVelocity, float highVelocity,
+                   const synthclone::Zone *zone)
 {
     synthclone::SampleStream::SubType sampleStreamSubType;
     synthclone::SampleStream::Type sampleStreamType;
@@ -451,37 +549,9 @@ Target::writeLayer(ArchiveWriter &archiveWriter, QXmlStreamWriter &confWriter,
         assert(sample);
     }
 
-    synthclone::Sample outSample;
-    synthclone::SampleInputStream inputStream(*sample);
-    synthclone::SampleChannelCount channels = inputStream.getChannels();
-    synthclone::SampleOutputStream outputStream
-        (outSample, inputStream.getSampleRate(), channels, sampleStreamType,
-         sampleStreamSubType);
-    synthclone::SampleCopier copier;
-    copier.copy(inputStream, outputStream, inputStream.getFrames());
-    outputStream.close();
-
-    // Write sample to archive.
-    QString path = outSample.getPath();
-    QFileInfo info(path);
-    assert(info.exists());
-    assert(info.isFile());
-    ArchiveHeader header(QString("%1/%2").arg(kitName, sampleName),
-                         info.size());
-    archiveWriter.writeHeader(header);
-    QFile file(path);
-    if (! file.open(QFile::ReadOnly)) {
-        QString message = tr("could not open '%1': %2").
-            arg(path, file.errorString());
-        throw synthclone::Error(message);
-    }
-    for (;;) {
-        QByteArray data = file.read(8192);
-        if (data.isEmpty()) {
-            break;
-        }
-        archiveWriter.writeData(data);
-    }
+    layerEncoders.append
+        (new LayerEncoder(*sample, QString("%1/%2").arg(kitName, sampleName),
+                          sampleStreamType, sampleStreamSubType));
 
     confWriter.writeStartElement("layer");
     writeElement(confWriter, "filename", sampleName);
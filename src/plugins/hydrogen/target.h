@@ -24,8 +24,10 @@
 #include <QtCore/QXmlStreamWriter>
 
 #include <synthclone/target.h>
+#include <synthclone/taskpool.h>
 
 #include "archivewriter.h"
+#include "layerencoder.h"
 #include "types.h"
 #include "zonekey.h"
 
@@ -36,13 +38,17 @@ class Target: public synthclone::Target {
 public:
 
     explicit
-    Target(const QString &name, QObject *parent=0);
+    Target(const QString &name, synthclone::TaskPool &taskPool,
+           QObject *parent=0);
 
     ~Target();
 
     QString
     getAuthor() const;
 
+    CompressionLevel
+    getCompressionLevel() const;
+
     QString
     getInfo() const;
 
@@ -69,6 +75,9 @@ public slots:
     void
     setAuthor(const QString &author);
 
+    void
+    setCompressionLevel(CompressionLevel level);
+
     void
     setInfo(const QString &info);
 
@@ -92,6 +101,9 @@ signals:
     void
     authorChanged(const QString &author);
 
+    void
+    compressionLevelChanged(CompressionLevel level);
+
     void
     infoChanged(const QString &info);
 
@@ -117,17 +129,20 @@ private:
                  const QString &value);
 
     void
-    writeLayer(ArchiveWriter &archiveWriter, QXmlStreamWriter &confWriter,
-               int instrument, int layer, float lowVelocity,
-               float highVelocity, const synthclone::Zone *zone);
+    writeLayer(QXmlStreamWriter &confWriter,
+               QList<LayerEncoder *> &layerEncoders, int instrument, int layer,
+               float lowVelocity, float highVelocity,
+               const synthclone::Zone *zone);
 
     QString author;
+    CompressionLevel compressionLevel;
     QString info;
     QString kitName;
     LayerAlgorithm layerAlgorithm;
     QString license;
     QString path;
     SampleFormat sampleFormat;
+    synthclone::TaskPool &taskPool;
 
 };
 
@@ -36,6 +36,11 @@ TargetView::TargetView(QObject *parent):
     closeButton = synthclone::getChild<QPushButton>(widget, "closeButton");
     connect(closeButton, SIGNAL(clicked()), SIGNAL(closeRequest()));
 
+    compressionLevelComboBox = synthclone::getChild<QComboBox>
+        (widget, "compressionLevelComboBox");
+    connect(compressionLevelComboBox, SIGNAL(currentIndexChanged(int)),
+            SLOT(handleCompressionLevelChange(int)));
+
     info = synthclone::getChild<QPlainTextEdit>(widget, "info");
     connect(info, SIGNAL(textChanged()), SLOT(handleInfoChange()));
 
@@ -75,6 +80,12 @@ TargetView::~TargetView()
     // Empty
 }
 
+void
+TargetView::handleCompressionLevelChange(int index)
+{
+    emit compressionLevelChangeRequest(static_cast<CompressionLevel>(index));
+}
+
 void
 TargetView::handleInfoChange()
 {
@@ -99,6 +110,12 @@ TargetView::setAuthor(const QString &author)
     this->author->setText(author);
 }
 
+void
+TargetView::setCompressionLevel(CompressionLevel level)
+{
+    compressionLevelComboBox->setCurrentIndex(static_cast<int>(level));
+}
+
 void
 TargetView::setInfo(const QString &info)
 {
@@ -45,6 +45,9 @@ public slots:
     void
     setAuthor(const QString &author);
 
+    void
+    setCompressionLevel(CompressionLevel level);
+
     void
     setInfo(const QString &info);
 
@@ -71,6 +74,9 @@ signals:
     void
     authorChangeRequest(const QString &author);
 
+    void
+    compressionLevelChangeRequest(CompressionLevel level);
+
     void
     infoChangeRequest(const QString &info);
 
@@ -97,6 +103,9 @@ signals:
 
 private slots:
 
+    void
+    handleCompressionLevelChange(int index);
+
     void
     handleInfoChange();
 
@@ -110,6 +119,7 @@ private:
 
     QLineEdit *author;
     QPushButton *closeButton;
+    QComboBox *compressionLevelComboBox;
     QPlainTextEdit *info;
     QLineEdit *kitName;
     QComboBox *layerAlgorithmComboBox;
@@ -20,6 +20,13 @@
 #ifndef __TYPES_H__
 #define __TYPES_H__
 
+enum CompressionLevel {
+    COMPRESSIONLEVEL_NONE = 0,
+    COMPRESSIONLEVEL_FASTEST = 1,
+    COMPRESSIONLEVEL_DEFAULT = 2,
+    COMPRESSIONLEVEL_BEST = 3
+};
+
 enum LayerAlgorithm {
     LAYERALGORITHM_LINEAR_INTERPOLATION = 0,
     LAYERALGORITHM_MAXIMUM = 1,
@@ -0,0 +1,116 @@
+/*
+ * libsynthclone_jack - JACK Audio Connection Kit sampler plugin for
+ * `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <synthclone/util.h>
+
+#include "healthview.h"
+
+// Static functions
+
+static QString
+getPercentageString(float value)
+{
+    return QString("%1%").arg(value * 100.0, 0, 'f', 1);
+}
+
+// Class definition
+
+HealthView::HealthView(QObject *parent):
+    synthclone::DesignerView(":/synthclone/plugins/jack/healthview.ui",
+                             parent)
+{
+    QWidget *widget = getRootWidget();
+
+    bufferTree = synthclone::getChild<QTreeWidget>(widget, "bufferTree");
+
+    closeButton = synthclone::getChild<QPushButton>(widget, "closeButton");
+    connect(closeButton, SIGNAL(clicked()), SIGNAL(closeRequest()));
+
+    cycleCountLabel = synthclone::getChild<QLabel>(widget, "cycleCountLabel");
+
+    // Each of the first buckets covers a range of the callback period.  The
+    // last bucket counts the cycles that overran the period.
+    loadHistogramTree =
+        synthclone::getChild<QTreeWidget>(widget, "loadHistogramTree");
+    int lastBucket = synthclone::CallbackHealth::LOAD_HISTOGRAM_SIZE - 1;
+    for (int i = 0; i <= lastBucket; i++) {
+        QStringList columns;
+        columns << ((i == lastBucket) ? tr(">= %1%").arg(i * 10) :
+                    tr("%1% - %2%").arg(i * 10).arg((i + 1) * 10))
+                << QString();
+        QTreeWidgetItem *item = new QTreeWidgetItem(columns);
+        item->setTextAlignment(1, Qt::AlignRight | Qt::AlignVCenter);
+        loadHistogramTree->addTopLevelItem(item);
+    }
+
+    loadLabel = synthclone::getChild<QLabel>(widget, "loadLabel");
+    maximumCycleTimeLabel =
+        synthclone::getChild<QLabel>(widget, "maximumCycleTimeLabel");
+    midiFailureCountLabel =
+        synthclone::getChild<QLabel>(widget, "midiFailureCountLabel");
+    peakLoadLabel = synthclone::getChild<QLabel>(widget, "peakLoadLabel");
+
+    resetButton = synthclone::getChild<QPushButton>(widget, "resetButton");
+    connect(resetButton, SIGNAL(clicked()), SIGNAL(resetRequest()));
+
+    xrunCountLabel = synthclone::getChild<QLabel>(widget, "xrunCountLabel");
+
+    setHealth(synthclone::CallbackHealth());
+}
+
+HealthView::~HealthView()
+{
+    // Empty
+}
+
+void
+HealthView::setHealth(const synthclone::CallbackHealth &health)
+{
+    cycleCountLabel->setText(QString::number(health.getCycleCount()));
+    loadLabel->setText(getPercentageString(health.getLoad()));
+    maximumCycleTimeLabel->setText
+        (tr("%1 ms").arg(health.getMaximumCycleTime() / 1000.0, 0, 'f', 3));
+    midiFailureCountLabel->setText
+        (QString::number(health.getMIDIFailureCount()));
+    peakLoadLabel->setText(getPercentageString(health.getPeakLoad()));
+    xrunCountLabel->setText(QString::number(health.getXrunCount()));
+
+    QVector<int> histogram = health.getLoadHistogram();
+    for (int i = 0; i < histogram.count(); i++) {
+        loadHistogramTree->topLevelItem(i)->
+            setText(1, QString::number(histogram[i]));
+    }
+
+    int count = health.getBufferCount();
+    if (bufferTree->topLevelItemCount() != count) {
+        bufferTree->clear();
+        for (int i = 0; i < count; i++) {
+            QTreeWidgetItem *item = new QTreeWidgetItem();
+            item->setTextAlignment(1, Qt::AlignRight | Qt::AlignVCenter);
+            bufferTree->addTopLevelItem(item);
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        QTreeWidgetItem *item = bufferTree->topLevelItem(i);
+        item->setText(0, health.getBufferName(i));
+        item->setText(1,
+                      getPercentageString(health.getBufferHighWaterMark(i)));
+    }
+}
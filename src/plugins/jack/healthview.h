@@ -0,0 +1,69 @@
+/*
+ * libsynthclone_jack - JACK Audio Connection Kit sampler plugin for
+ * `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __HEALTHVIEW_H__
+#define __HEALTHVIEW_H__
+
+#include <QtGui/QLabel>
+#include <QtGui/QPushButton>
+#include <QtGui/QTreeWidget>
+
+#include <synthclone/callbackhealth.h>
+#include <synthclone/designerview.h>
+
+// Shows the health of the JACK process callback.
+
+class HealthView: public synthclone::DesignerView {
+
+    Q_OBJECT
+
+public:
+
+    explicit
+    HealthView(QObject *parent=0);
+
+    ~HealthView();
+
+public slots:
+
+    void
+    setHealth(const synthclone::CallbackHealth &health);
+
+signals:
+
+    void
+    resetRequest();
+
+private:
+
+    QTreeWidget *bufferTree;
+    QPushButton *closeButton;
+    QLabel *cycleCountLabel;
+    QTreeWidget *loadHistogramTree;
+    QLabel *loadLabel;
+    QLabel *maximumCycleTimeLabel;
+    QLabel *midiFailureCountLabel;
+    QLabel *peakLoadLabel;
+    QPushButton *resetButton;
+    QLabel *xrunCountLabel;
+
+};
+
+#endif
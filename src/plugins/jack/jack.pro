@@ -5,17 +5,21 @@ include(../plugins.pri)
 ################################################################################
 
 HEADERS += eventthread.h \
+    healthview.h \
     participant.h \
+    playbackthread.h \
     plugin.h \
     sampler.h \
     sampleratechangeview.h
-LIBS += -ljack
+LIBS += -ljack -lsamplerate
 MOC_DIR = $${MAKEDIR}/plugins/jack
 OBJECTS_DIR = $${MAKEDIR}/plugins/jack
 RCC_DIR = $${MAKEDIR}/plugins/jack
 RESOURCES += jack.qrc
 SOURCES += eventthread.cpp \
+    healthview.cpp \
     participant.cpp \
+    playbackthread.cpp \
     plugin.cpp \
     sampler.cpp \
     sampleratechangeview.cpp
@@ -18,6 +18,8 @@
  * Ave, Cambridge, MA 02139, USA.
  */
 
+#include <cassert>
+
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDebug>
 
@@ -51,16 +53,27 @@ Participant::Participant(QObject *parent):
     synthclone::Participant(tr("JACK"), 0, 0, 1, "Devin Anderson",
                             tr("Sampling via the JACK Audio Connection Kit"),
                             parent),
-    addSamplerAction(tr("JACK Sampler"))
+    addSamplerAction(tr("JACK Sampler")),
+    healthAction(tr("Callback Health")),
+    measureLatencyAction(tr("Measure Latency"))
 {
     jack_set_error_function(&ignoreMessage);
     jack_set_info_function(&ignoreMessage);
     connect(&addSamplerAction, SIGNAL(triggered()),
             SLOT(handleSamplerAdditionRequest()));
+    connect(&healthAction, SIGNAL(triggered()),
+            SLOT(handleHealthActionTrigger()));
+    connect(&healthView, SIGNAL(closeRequest()),
+            SLOT(handleHealthViewCloseRequest()));
+    connect(&measureLatencyAction, SIGNAL(triggered()),
+            SLOT(handleMeasureLatencyActionTrigger()));
     connect(&sampleRateChangeView, SIGNAL(closeRequest()),
             SLOT(handleSampleRateChangeViewCloseRequest()));
+    connect(&sampleRateChangeView, SIGNAL(resampleRequest()),
+            SLOT(handleSampleRateChangeViewResampleRequest()));
     connect(&sampleRateChangeView, SIGNAL(sampleRateChangeRequest()),
             SLOT(handleSampleRateChangeViewChangeRequest()));
+    captureLatency = 0;
     context = 0;
 }
 
@@ -77,7 +90,7 @@ Participant::activate(synthclone::Context &context, const QVariant &/*state*/)
 }
 
 void
-Participant::addSampler(bool convertSampleRate)
+Participant::addSampler(SampleRateMode sampleRateMode)
 {
     jack_set_error_function(&handleError);
     jack_set_info_function(&handleInfo);
@@ -90,7 +103,7 @@ Participant::addSampler(bool convertSampleRate)
         synthclone::SampleRate sessionSampleRate = context->getSampleRate();
         if (! ((serverSampleRate == sessionSampleRate) ||
                (sessionSampleRate == synthclone::SAMPLE_RATE_NOT_SET) ||
-               convertSampleRate)) {
+               (sampleRateMode != SAMPLE_RATE_MODE_ASK))) {
             sampleRateChangeView.setVisible(true);
         } else {
             connect(sampler, SIGNAL(fatalError(QString)),
@@ -102,13 +115,44 @@ Participant::addSampler(bool convertSampleRate)
                                         jack_session_event_t *)),
                     SLOT(handleSessionEvent(jack_client_t *,
                                             jack_session_event_t *)));
+            connect(sampler,
+                    SIGNAL(healthChanged(const synthclone::CallbackHealth &)),
+                    &healthView,
+                    SLOT(setHealth(const synthclone::CallbackHealth &)));
+            connect(&healthView, SIGNAL(resetRequest()),
+                    sampler, SLOT(resetHealth()));
+            connect(sampler, SIGNAL(latencyMeasured(int)),
+                    SLOT(handleLatencyMeasurement(int)));
+            connect(sampler,
+                    SIGNAL(latencyMeasurementError(const QString &)),
+                    SLOT(handleLatencyMeasurementError(const QString &)));
+            connect(&measureLatencyAction, SIGNAL(triggered()),
+                    sampler, SLOT(measureLatency()));
+            sampler->setCaptureLatency(captureLatency);
             sampler->activate(context->getSampleChannelCount());
-            context->setSampleRate(serverSampleRate);
+            sampler->reserveCaptureBuffers(getMaximumSampleTime());
+
+            // If the sample rates differ and the session's sample rate is
+            // kept, then the sampler resamples audio as it's played and
+            // captured.
+            if ((sessionSampleRate == synthclone::SAMPLE_RATE_NOT_SET) ||
+                (sampleRateMode == SAMPLE_RATE_MODE_CONVERT)) {
+                context->setSampleRate(serverSampleRate);
+            }
             const synthclone::Registration &registration =
                 context->addSampler(sampler);
             connect(&registration, SIGNAL(unregistered(QObject *)),
                     SLOT(handleSamplerUnregistration(QObject *)));
+            context->addMenuAction(&healthAction, sampler);
+            context->addMenuAction(&measureLatencyAction, sampler);
+            connect(context,
+                    SIGNAL(samplerJobAdded(const synthclone::SamplerJob *,
+                                           int)),
+                    sampler,
+                    SLOT(reserveCaptureBuffers
+                         (const synthclone::SamplerJob *)));
             samplerPtr.take();
+            captureLatency = 0;
             sessionId.clear();
             return;
         }
@@ -126,10 +170,24 @@ Participant::deactivate(synthclone::Context &context)
     this->context = 0;
 }
 
+synthclone::SampleTime
+Participant::getMaximumSampleTime() const
+{
+    synthclone::SampleTime sampleTime = 0.0;
+    for (int i = context->getZoneCount() - 1; i >= 0; i--) {
+        sampleTime = qMax(sampleTime, context->getZone(i)->getSampleTime());
+    }
+    return sampleTime;
+}
+
 QVariant
-Participant::getState(const synthclone::Sampler */*sampler*/) const
+Participant::getState(const synthclone::Sampler *sampler) const
 {
+    const Sampler *s = qobject_cast<const Sampler *>(sampler);
+    assert(s);
     QVariantMap map;
+    map.insert("captureLatency", s->getCaptureLatency());
+    map.insert("resample", s->getSampleRate() != context->getSampleRate());
     if (! sessionId.isEmpty()) {
         map.insert("sessionId", sessionId);
     }
@@ -143,31 +201,64 @@ Participant::handleFatalError(const QString &message)
     context->reportError(message);
 }
 
+void
+Participant::handleHealthActionTrigger()
+{
+    healthView.setVisible(true);
+}
+
+void
+Participant::handleHealthViewCloseRequest()
+{
+    healthView.setVisible(false);
+}
+
 void
 Participant::handleJACKSampleRateChange()
 {
+    // The sampler resamples audio when the sample rates differ, so it can
+    // stay registered.  A job that's running when the sample rate changes
+    // fails, and can be run again.
     Sampler *sampler = qobject_cast<Sampler *>(sender());
     if (sampler->getSampleRate() != context->getSampleRate()) {
-        context->removeSampler();
-
-        // XXX: Do more than this.  Offer to change the sample rate of the
-        // session and restart the sampler.
-        context->reportError(tr("The sampler has been removed.  The JACK "
-                                "server sample rate has changed."));
+        qWarning() << tr("The JACK server sample rate has changed.  Audio "
+                         "will be resampled to the session's sample rate.");
     }
 }
 
+void
+Participant::handleLatencyMeasurement(int latency)
+{
+    Sampler *sampler = qobject_cast<Sampler *>(sender());
+    sampler->setCaptureLatency(latency);
+    measureLatencyAction.setEnabled(true);
+}
+
+void
+Participant::handleLatencyMeasurementError(const QString &message)
+{
+    measureLatencyAction.setEnabled(true);
+    context->reportError(tr("Failed to measure latency: %1").arg(message));
+}
+
+void
+Participant::handleMeasureLatencyActionTrigger()
+{
+    // The action is enabled again when the measurement is finished.
+    measureLatencyAction.setEnabled(false);
+}
+
 void
 Participant::handleSamplerAdditionRequest()
 {
-    addSampler(false);
+    addSampler(SAMPLE_RATE_MODE_ASK);
 }
 
 void
 Participant::handleSampleRateChangeViewChangeRequest()
 {
     sampleRateChangeView.setVisible(false);
-    addSampler(true);
+    addSampler(SAMPLE_RATE_MODE_CONVERT);
 }
 
 void
@@ -176,9 +267,19 @@ Participant::handleSampleRateChangeViewCloseRequest()
     sampleRateChangeView.setVisible(false);
 }
 
+void
+Participant::handleSampleRateChangeViewResampleRequest()
+{
+    sampleRateChangeView.setVisible(false);
+    addSampler(SAMPLE_RATE_MODE_RESAMPLE);
+}
+
 void
 Participant::handleSamplerUnregistration(QObject *obj)
 {
+    healthView.setVisible(false);
+    healthView.setHealth(synthclone::CallbackHealth());
+    measureLatencyAction.setEnabled(true);
     delete qobject_cast<Sampler *>(obj);
     jack_set_error_function(&ignoreMessage);
     jack_set_info_function(&ignoreMessage);
@@ -216,6 +317,10 @@ Participant::handleSessionEvent(jack_client_t *client,
 void
 Participant::restoreSampler(const QVariant &state)
 {
-    sessionId = state.toMap().value("sessionId", QByteArray()).toByteArray();
-    addSampler(false);
+    QVariantMap map = state.toMap();
+    captureLatency = qMax(map.value("captureLatency", 0).toLongLong(),
+                          static_cast<qlonglong>(0));
+    sessionId = map.value("sessionId", QByteArray()).toByteArray();
+    addSampler(map.value("resample", false).toBool() ?
+               SAMPLE_RATE_MODE_RESAMPLE : SAMPLE_RATE_MODE_ASK);
 }
@@ -23,6 +23,7 @@
 
 #include <synthclone/participant.h>
 
+#include "healthview.h"
 #include "sampler.h"
 #include "sampleratechangeview.h"
 
@@ -52,20 +53,35 @@ public:
 private slots:
 
     void
-    addSampler(bool convertSampleRate);
+    handleFatalError(const QString &message);
 
     void
-    handleFatalError(const QString &message);
+    handleHealthActionTrigger();
+
+    void
+    handleHealthViewCloseRequest();
 
     void
     handleJACKSampleRateChange();
 
+    void
+    handleLatencyMeasurement(int latency);
+
+    void
+    handleLatencyMeasurementError(const QString &message);
+
+    void
+    handleMeasureLatencyActionTrigger();
+
     void
     handleSamplerAdditionRequest();
 
     void
     handleSampleRateChangeViewChangeRequest();
 
+    void
+    handleSampleRateChangeViewResampleRequest();
+
     void
     handleSampleRateChangeViewCloseRequest();
 
@@ -77,6 +93,14 @@ private slots:
 
 private:
 
+    // Decides what happens when the JACK server's sample rate differs from
+    // the session's sample rate.
+    enum SampleRateMode {
+        SAMPLE_RATE_MODE_ASK,
+        SAMPLE_RATE_MODE_CONVERT,
+        SAMPLE_RATE_MODE_RESAMPLE
+    };
+
     static void
     handleError(const char *message);
 
@@ -86,8 +110,18 @@ private:
     static void
     ignoreMessage(const char *message);
 
+    void
+    addSampler(SampleRateMode sampleRateMode);
+
+    synthclone::SampleTime
+    getMaximumSampleTime() const;
+
     synthclone::MenuAction addSamplerAction;
+    synthclone::SampleFrameCount captureLatency;
     synthclone::Context *context;
+    synthclone::MenuAction healthAction;
+    HealthView healthView;
+    synthclone::MenuAction measureLatencyAction;
     SampleRateChangeView sampleRateChangeView;
     QByteArray sessionId;
 
@@ -0,0 +1,53 @@
+/*
+ * libsynthclone_jack - JACK Audio Connection Kit sampler plugin for
+ * `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __PLAYBACKTHREAD_H__
+#define __PLAYBACKTHREAD_H__
+
+#include <QtCore/QThread>
+
+class Sampler;
+
+// Reads the sample that's being played into the sampler's playback buffer,
+// so that the process callback never has to wait for the disk.
+
+class PlaybackThread: public QThread {
+
+    Q_OBJECT
+
+public:
+
+    explicit
+    PlaybackThread(Sampler *sampler, QObject *parent=0);
+
+    ~PlaybackThread();
+
+protected:
+
+    void
+    run();
+
+private:
+
+    Sampler *sampler;
+
+};
+
+#endif
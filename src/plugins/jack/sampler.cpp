@@ -32,6 +32,8 @@
 #include <synthclone/error.h>
 #include <synthclone/sampleinputstream.h>
 #include <synthclone/sampleoutputstream.h>
+#include <synthclone/tracer.h>
+#include <synthclone/util.h>
 
 #include "sampler.h"
 
@@ -53,8 +55,10 @@ static const char *ERROR_NAME_NOT_UNIQUE =
     QT_TR_NOOP("The given client name is not unique");
 static const char *ERROR_NO_SUCH_CLIENT =
     QT_TR_NOOP("The requested client does not exist");
+static const char *ERROR_PLAYBACK_READ =
+    QT_TR_NOOP("Failed to read the sample that's being played");
 static const char *ERROR_SAMPLE_RATE =
-    QT_TR_NOOP("JACK's sample rate differs from the sample's sample rate");
+    QT_TR_NOOP("JACK's sample rate changed while the job was running");
 static const char *ERROR_SERVER_COMMUNICATION =
     QT_TR_NOOP("Communication error with JACK server");
 static const char *ERROR_SERVER_FAILURE =
@@ -68,6 +72,25 @@ static const char *ERROR_VERSION =
 static const char *ERROR_ZOMBIE =
     QT_TR_NOOP("The JACK server has zombified this JACK client");
 
+// Latency is measured by playing a note on the first MIDI channel, and
+// capturing a second of audio.
+static const synthclone::MIDIData LATENCY_NOTE = 60;
+static const synthclone::SampleTime LATENCY_TIME = 1.0;
+static const synthclone::MIDIData LATENCY_VELOCITY = 127;
+
+// Samples are played from a ring buffer that holds a little over a second of
+// audio.  The first few frames are read before the job is started, and the
+// playback thread reads the rest of the sample in large blocks.
+static const jack_nframes_t PLAYBACK_BLOCK_FRAMES = 8192;
+static const jack_nframes_t PLAYBACK_BUFFER_FRAMES = 65536;
+static const jack_nframes_t PLAYBACK_PRELOAD_FRAMES = 4096;
+
+// When JACK's sample rate differs from the session's sample rate, samples are
+// converted as they're played by a converter that can keep up with JACK, and
+// captured audio is converted with the best converter after it's captured.
+static const int CAPTURE_CONVERTER_TYPE = SRC_SINC_BEST_QUALITY;
+static const int PLAYBACK_CONVERTER_TYPE = SRC_SINC_MEDIUM_QUALITY;
+
 struct ClientDestructor {
 
     static void
@@ -126,11 +149,28 @@ Sampler::handleShutdownEvent(jack_status_t code, const char *reason, void *ptr)
     sampler->handleShutdownEvent(code, reason);
 }
 
+int
+Sampler::handleXRunEvent(void *ptr)
+{
+    Sampler *sampler = static_cast<Sampler *>(ptr);
+    assert(sampler);
+    return sampler->handleXRunEvent();
+}
+
+long
+Sampler::readPlaybackInput(void *ptr, float **data)
+{
+    Sampler *sampler = static_cast<Sampler *>(ptr);
+    return sampler->readPlaybackInput(data);
+}
+
 // Class definition
 
 Sampler::Sampler(const QString &name, const char *sessionId, QObject *parent):
     synthclone::Sampler(name, parent),
-    eventThread(this)
+    captureBufferPool(true),
+    eventThread(this),
+    playbackThread(this)
 {
     QByteArray jackNameByteArray = tr("synthclone").toLocal8Bit();
     const char *jackName = jackNameByteArray.constData();
@@ -180,9 +220,28 @@ Sampler::Sampler(const QString &name, const char *sessionId, QObject *parent):
     if (jack_set_session_callback(client, handleSessionEvent, this)) {
         throw synthclone::Error(tr("failed to set JACK session callback"));
     }
+    if (jack_set_xrun_callback(client, handleXRunEvent, this)) {
+        throw synthclone::Error(tr("failed to set JACK xrun callback"));
+    }
     jack_on_info_shutdown(client, handleShutdownEvent, this);
 
+    processEventBufferIndex =
+        callbackMonitor.addBuffer(tr("Process event buffer"));
+    healthTimer.setInterval(500);
+    connect(&healthTimer, SIGNAL(timeout()), SLOT(handleHealthTimeout()));
+
     active = false;
+    captureLatency = 0;
+    latencyBuffer = 0;
+    latencyFrames = 0;
+    playbackBlock = 0;
+    playbackBuffer = 0;
+    playbackConverter = 0;
+    playbackFramesRemaining = 0;
+    playbackInputBlock = 0;
+    playbackRatio = 1.0;
+    playbackStream = 0;
+    playbackThreadTerminating = false;
     clientPtr.take();
     commandBufferPtr.take();
     priorityEventBufferPtr.take();
@@ -191,6 +250,7 @@ Sampler::Sampler(const QString &name, const char *sessionId, QObject *parent):
 
 Sampler::~Sampler()
 {
+    healthTimer.stop();
     if (active) {
         QMutexLocker locker(&activeMutex);
         if (jack_client_close(client)) {
@@ -206,6 +266,14 @@ Sampler::~Sampler()
     sendPriorityEvent(event);
     eventThread.wait();
 
+    // Terminate the playback thread.
+    {
+        QMutexLocker locker(&playbackMutex);
+        playbackThreadTerminating = true;
+    }
+    playbackSemaphore.post();
+    playbackThread.wait();
+
     jack_ringbuffer_free(commandBuffer);
     jack_ringbuffer_free(priorityEventBuffer);
     jack_ringbuffer_free(processEventBuffer);
@@ -240,6 +308,26 @@ Sampler::activate(synthclone::SampleChannelCount channels)
         midiPort = openPort(midiPortName.constData(), JACK_DEFAULT_MIDI_TYPE,
                             JackPortIsOutput);
 
+        jobSampleBuffers = new jack_default_audio_sample_t *[channels];
+        QScopedArrayPointer<jack_default_audio_sample_t *>
+            jobSampleBuffersPtr(jobSampleBuffers);
+
+        playbackBlock = new float[PLAYBACK_BLOCK_FRAMES * channels];
+        QScopedArrayPointer<float> playbackBlockPtr(playbackBlock);
+        playbackInputBlock = new float[PLAYBACK_BLOCK_FRAMES * channels];
+        QScopedArrayPointer<float> playbackInputBlockPtr(playbackInputBlock);
+        playbackBuffer = jack_ringbuffer_create
+            (PLAYBACK_BUFFER_FRAMES * channels *
+             sizeof(jack_default_audio_sample_t));
+        if (! playbackBuffer) {
+            throw std::bad_alloc();
+        }
+        QScopedPointer<jack_ringbuffer_t, RingbufferDestructor>
+            playbackBufferPtr(playbackBuffer);
+        if (jack_ringbuffer_mlock(playbackBuffer)) {
+            qWarning() << tr("failed to lock playback buffer into memory");
+        }
+
         active = true;
         this->channels = channels;
         idle = true;
@@ -249,10 +337,16 @@ Sampler::activate(synthclone::SampleChannelCount channels)
             throw synthclone::Error(tr("failed to activate JACK client"));
         }
         eventThread.start();
+        healthTimer.start();
+        playbackThread.start();
 
         inputPortsPtr.take();
+        jobSampleBuffersPtr.take();
         monitorPortsPtr.take();
         outputPortsPtr.take();
+        playbackBlockPtr.take();
+        playbackBufferPtr.take();
+        playbackInputBlockPtr.take();
     } catch (...) {
         closePorts();
         throw;
@@ -265,6 +359,26 @@ Sampler::clean()
     delete[] inputPorts;
     delete[] monitorPorts;
     delete[] outputPorts;
+    delete[] jobSampleBuffers;
+
+    latencyMeasurementRequested.fetchAndStoreOrdered(0);
+    float *buffer = latencyBuffer.fetchAndStoreOrdered(0);
+    if (buffer) {
+        captureBufferPool.release(buffer);
+    }
+
+    QMutexLocker locker(&playbackMutex);
+    playbackStream = 0;
+    delete[] playbackBlock;
+    playbackBlock = 0;
+    jack_ringbuffer_free(playbackBuffer);
+    playbackBuffer = 0;
+    if (playbackConverter) {
+        src_delete(playbackConverter);
+        playbackConverter = 0;
+    }
+    delete[] playbackInputBlock;
+    playbackInputBlock = 0;
 }
 
 void
@@ -282,6 +396,44 @@ Sampler::closePorts()
     }
 }
 
+void
+Sampler::fillPlaybackBuffer(jack_nframes_t frames)
+{
+    // The caller must hold the playback mutex.
+    size_t frameSize = channels * sizeof(jack_default_audio_sample_t);
+    while (playbackStream && frames) {
+        jack_nframes_t blockFrames = qMin(frames, PLAYBACK_BLOCK_FRAMES);
+        if ((jack_ringbuffer_write_space(playbackBuffer) / frameSize) <
+            blockFrames) {
+            break;
+        }
+        synthclone::SampleFrameCount count;
+        try {
+            count = readPlaybackStream(playbackBlock, blockFrames);
+        } catch (synthclone::Error &e) {
+            qWarning() << e.getMessage();
+            playbackFailed.fetchAndStoreOrdered(1);
+            playbackStream = 0;
+            break;
+        }
+        jack_ringbuffer_write(playbackBuffer,
+                              reinterpret_cast<const char *>(playbackBlock),
+                              count * frameSize);
+        if (static_cast<jack_nframes_t>(count) < blockFrames) {
+            // End of stream.
+            playbackStream = 0;
+            break;
+        }
+        frames -= blockFrames;
+    }
+}
+
+synthclone::SampleFrameCount
+Sampler::getCaptureLatency() const
+{
+    return captureLatency;
+}
+
 synthclone::SampleChannelCount
 Sampler::getChannelCount() const
 {
@@ -311,9 +463,16 @@ Sampler::getSampleRate() const
     return static_cast<synthclone::SampleRate>(jack_get_sample_rate(client));
 }
 
+void
+Sampler::handleHealthTimeout()
+{
+    emit healthChanged(callbackMonitor.read());
+}
+
 int
 Sampler::handleProcessEvent(jack_nframes_t frames)
 {
+    callbackMonitor.startCycle();
     size_t copySize = frames * sizeof(jack_default_audio_sample_t);
     for (synthclone::SampleChannelCount i = 0; i < channels; i++) {
         memcpy(jack_port_get_buffer(monitorPorts[i], frames),
@@ -323,9 +482,14 @@ Sampler::handleProcessEvent(jack_nframes_t frames)
     jack_midi_clear_buffer(midiBuffer);
 
     jack_nframes_t copyFrames;
+    ProcessEvent event;
+    size_t frameSize;
+    jack_nframes_t inputOffset;
     const synthclone::SamplerJob *job;
     synthclone::MIDIData midiChannel;
     jack_nframes_t nextFrame;
+    jack_nframes_t readableFrames;
+    jack_ringbuffer_data_t readVector[2];
     float **sampleBuffers;
     jack_nframes_t totalFrames;
     bool writeSilence = true;
@@ -336,6 +500,16 @@ Sampler::handleProcessEvent(jack_nframes_t frames)
     // Waiting for commands
     case STATE_IDLE:
     idle:
+        if (latencyMeasurementRequested.fetchAndStoreOrdered(0)) {
+            currentFrame = 0;
+            if (! sendMIDIMessage(midiBuffer, 0x90, LATENCY_NOTE,
+                                  LATENCY_VELOCITY)) {
+                state = STATE_LATENCY_ERROR;
+                goto latencyError;
+            }
+            state = STATE_LATENCY_MEASURE;
+            break;
+        }
         while (jack_ringbuffer_read_space(commandBuffer) >= sizeof(Command)) {
             jack_ringbuffer_read(commandBuffer, (char *) &command,
                                  sizeof(Command));
@@ -344,6 +518,10 @@ Sampler::handleProcessEvent(jack_nframes_t frames)
                 aborted = false;
                 currentFrame = 0;
                 errorMessage = 0;
+                command.compromised = false;
+                command.releaseTime = 0;
+                command.sampleTime = 0;
+                command.startTime = jack_get_time();
                 if (job->getType() == synthclone::SamplerJob::TYPE_SAMPLE) {
                     state = STATE_SAMPLE_SEND_PRE_MIDI;
                     goto sampleSendPreMIDI;
@@ -366,34 +544,59 @@ Sampler::handleProcessEvent(jack_nframes_t frames)
         if (state == STATE_ERROR) {
             goto error;
         }
-        nextFrame = currentFrame + frames;
-        sampleBuffers = command.sampleBuffers;
         totalFrames = command.totalSampleFrames;
+        copyFrames = qMin(frames, totalFrames - currentFrame);
+        frameSize = channels * sizeof(jack_default_audio_sample_t);
+        readableFrames = jack_ringbuffer_read_space(playbackBuffer) /
+            frameSize;
+        if (readableFrames < copyFrames) {
+            if (playbackFailed) {
+                setProcessErrorState(ERROR_PLAYBACK_READ);
+                goto error;
+            }
+
+            // The playback thread has fallen behind.  Play what we have, and
+            // fill the rest of the cycle with silence.
+            copyFrames = readableFrames;
+        }
         writeSilence = false;
-        if (nextFrame >= totalFrames) {
-            copyFrames = totalFrames - currentFrame;
-            copySize = copyFrames * sizeof(jack_default_audio_sample_t);
+
+        // The ring buffer contains interleaved frames.  The readable data may
+        // be split into two parts, and a frame may be split between them.
+        jack_ringbuffer_get_read_vector(playbackBuffer, readVector);
+        {
+            jack_default_audio_sample_t *firstPart =
+                reinterpret_cast<jack_default_audio_sample_t *>
+                (readVector[0].buf);
+            jack_default_audio_sample_t *secondPart =
+                reinterpret_cast<jack_default_audio_sample_t *>
+                (readVector[1].buf);
+            size_t firstPartSize =
+                readVector[0].len / sizeof(jack_default_audio_sample_t);
             for (synthclone::SampleChannelCount i = 0; i < channels; i++) {
                 jack_default_audio_sample_t *outputBuffer =
                     static_cast<jack_default_audio_sample_t *>
                     (jack_port_get_buffer(outputPorts[i], frames));
-                memcpy(outputBuffer, sampleBuffers[i] + currentFrame, copySize);
-                for (synthclone::SampleFrameCount j = copyFrames;
-                     j < totalFrames; j++) {
+                jack_nframes_t j;
+                for (j = 0; j < copyFrames; j++) {
+                    size_t index = (j * channels) + i;
+                    outputBuffer[j] = (index < firstPartSize) ?
+                        firstPart[index] : secondPart[index - firstPartSize];
+                }
+                for (; j < frames; j++) {
                     outputBuffer[j] = 0.0;
                 }
             }
+        }
+        jack_ringbuffer_read_advance(playbackBuffer, copyFrames * frameSize);
+        playbackSemaphore.post();
+        currentFrame += copyFrames;
+        if (currentFrame >= totalFrames) {
             sendProgressEvent(1.0);
             state = STATE_COMPLETED;
             goto completed;
         }
-        copySize = frames * sizeof(jack_default_audio_sample_t);
-        for (synthclone::SampleChannelCount i = 0; i < channels; i++) {
-            memcpy(jack_port_get_buffer(outputPorts[i], frames),
-                   sampleBuffers[i] + currentFrame, copySize);
-        }
-        currentFrame = nextFrame;
-        sendProgressEvent(static_cast<float>(nextFrame) / totalFrames);
+        sendProgressEvent(static_cast<float>(currentFrame) / totalFrames);
         break;
 
     // Four states for executing 'sample' command.
@@ -441,7 +644,8 @@ Sampler::handleProcessEvent(jack_nframes_t frames)
                 }
             }
         }
-        // XXX: Skip frames if there's latency.  How do we determine that?
+        command.sampleTime = jack_get_time();
+        command.xrunCount = callbackMonitor.getXrunCount();
         state = STATE_SAMPLE;
         break;
 
@@ -456,14 +660,26 @@ Sampler::handleProcessEvent(jack_nframes_t frames)
         default:
             ;
         }
-        nextFrame = currentFrame + frames;
+
+        // Skip the input that was captured before the sound produced by the
+        // note-on message arrived.
+        inputOffset = qMin(frames, command.skipFrames);
+        command.skipFrames -= inputOffset;
+        if (inputOffset == frames) {
+            break;
+        }
+
+        nextFrame = currentFrame + (frames - inputOffset);
         sampleBuffers = command.sampleBuffers;
         totalFrames = command.totalSampleFrames;
         if (nextFrame < totalFrames) {
-            copySize = frames * sizeof(jack_default_audio_sample_t);
+            copySize = (frames - inputOffset) *
+                sizeof(jack_default_audio_sample_t);
             for (synthclone::SampleChannelCount i = 0; i < channels; i++) {
                 memcpy(sampleBuffers[i] + currentFrame,
-                       jack_port_get_buffer(inputPorts[i], frames), copySize);
+                       static_cast<jack_default_audio_sample_t *>
+                       (jack_port_get_buffer(inputPorts[i], frames)) +
+                       inputOffset, copySize);
             }
             currentFrame = nextFrame;
             sendProgressEvent(static_cast<float>(currentFrame) /
@@ -474,10 +690,18 @@ Sampler::handleProcessEvent(jack_nframes_t frames)
         copySize = copyFrames * sizeof(jack_default_audio_sample_t);
         for (synthclone::SampleChannelCount i = 0; i < channels; i++) {
             memcpy(sampleBuffers[i] + currentFrame,
-                   jack_port_get_buffer(inputPorts[i], frames), copySize);
+                   static_cast<jack_default_audio_sample_t *>
+                   (jack_port_get_buffer(inputPorts[i], frames)) + inputOffset,
+                   copySize);
         }
         sendProgressEvent(static_cast<float>(totalFrames) /
                           (totalFrames + command.totalReleaseFrames));
+
+        // If an xrun occurred while sampling, then the captured audio has a
+        // gap in it.
+        command.compromised =
+            callbackMonitor.getXrunCount() != command.xrunCount;
+
     sampleSendNoteOff:
         zone = command.job->getZone();
         if (! sendMIDIMessage(midiBuffer, 0x80 | (zone->getChannel() - 1),
@@ -486,6 +710,7 @@ Sampler::handleProcessEvent(jack_nframes_t frames)
             goto error;
         }
         currentFrame = 0;
+        command.releaseTime = jack_get_time();
         state = STATE_SAMPLE_RELEASE;
         break;
 
@@ -561,6 +786,52 @@ Sampler::handleProcessEvent(jack_nframes_t frames)
         }
         break;
 
+    // Three states for measuring latency.  The capture starts in the cycle
+    // after the note-on message is sent, just like it does for 'sample'
+    // commands, so that the measured latency is the number of frames that
+    // should be skipped when sampling.
+    case STATE_LATENCY_MEASURE:
+        copyFrames = qMin(frames, latencyFrames - currentFrame);
+        for (synthclone::SampleChannelCount i = 0; i < channels; i++) {
+            jack_default_audio_sample_t *inputBuffer =
+                static_cast<jack_default_audio_sample_t *>
+                (jack_port_get_buffer(inputPorts[i], frames));
+            float *buffer = latencyBuffer;
+            for (jack_nframes_t j = 0; j < copyFrames; j++) {
+                buffer[((currentFrame + j) * channels) + i] = inputBuffer[j];
+            }
+        }
+        currentFrame += copyFrames;
+        if (currentFrame < latencyFrames) {
+            break;
+        }
+        if (! (sendMIDIMessage(midiBuffer, 0x80, LATENCY_NOTE,
+                               LATENCY_VELOCITY) &&
+               sendMIDIMessage(midiBuffer, 0xb0, 0x78, 0))) {
+            state = STATE_LATENCY_ERROR;
+            goto latencyError;
+        }
+        state = STATE_LATENCY_MEASURED;
+        // Fallthrough on purpose.
+
+    case STATE_LATENCY_MEASURED:
+        event.type = ProcessEvent::TYPE_LATENCY_MEASURED;
+        if (sendProcessEvent(event)) {
+            state = STATE_IDLE;
+            goto idle;
+        }
+        break;
+
+    case STATE_LATENCY_ERROR:
+    latencyError:
+        event.data.message = errorMessage;
+        event.type = ProcessEvent::TYPE_LATENCY_ERROR;
+        if (sendProcessEvent(event)) {
+            state = STATE_IDLE;
+            goto idle;
+        }
+        break;
+
     }
     if (writeSilence) {
         void *firstBuffer = jack_port_get_buffer(outputPorts[0], frames);
@@ -574,6 +845,7 @@ Sampler::handleProcessEvent(jack_nframes_t frames)
                    frames * sizeof(jack_default_audio_sample_t));
         }
     }
+    callbackMonitor.endCycle(frames, jack_get_sample_rate(client));
     return 0;
 }
 
@@ -604,6 +876,13 @@ Sampler::handleShutdownEvent(jack_status_t status, const char */*reason*/)
     sendPriorityEvent(event);
 }
 
+int
+Sampler::handleXRunEvent()
+{
+    callbackMonitor.addXrun();
+    return 0;
+}
+
 jack_port_t **
 Sampler::initializeAudioPorts(const QString &prefix, JackPortFlags flags,
                               synthclone::SampleChannelCount channels)
@@ -621,11 +900,37 @@ Sampler::initializeAudioPorts(const QString &prefix, JackPortFlags flags,
     return ports;
 }
 
+void
+Sampler::measureLatency()
+{
+    assert(active);
+    if (latencyBuffer) {
+        // A measurement is already being made.
+        return;
+    }
+    jack_nframes_t frames = static_cast<jack_nframes_t>
+        (LATENCY_TIME * jack_get_sample_rate(client));
+    float *buffer;
+    try {
+        buffer = captureBufferPool.acquire(frames * channels);
+    } catch (synthclone::Error &e) {
+        emit latencyMeasurementError(e.getMessage());
+        return;
+    }
+
+    // The buffer and frame count are published before the measurement is
+    // requested, so the process thread sees both when it sees the request.
+    latencyFrames = frames;
+    latencyBuffer.fetchAndStoreOrdered(buffer);
+    latencyMeasurementRequested.fetchAndStoreOrdered(1);
+}
+
 void
 Sampler::monitorEvents()
 {
     Command *command;
     const synthclone::SamplerJob *job;
+    QString writeError;
     for (;;) {
         eventSemaphore.wait();
 
@@ -652,6 +957,10 @@ Sampler::monitorEvents()
                         clean();
                     }
                 }
+
+                // The health timer belongs to the sampler's thread.
+                QMetaObject::invokeMethod(&healthTimer, "stop",
+                                          Qt::QueuedConnection);
                 emit fatalError(event.data.message);
                 continue;
             case PriorityEvent::TYPE_TERMINATE:
@@ -670,52 +979,89 @@ Sampler::monitorEvents()
                              sizeof(ProcessEvent));
         switch (event.type) {
         case ProcessEvent::TYPE_ABORTED:
+            command = &(event.data.command);
+            traceCommand(*command);
+            releaseJobResources(*command);
             idle = true;
             emit statusChanged(tr("Idle."));
             emit jobAborted();
-            emit progressChanged(0.0);
-            command = &(event.data.command);
+            reportProgress(0.0);
             break;
         case ProcessEvent::TYPE_COMPLETE:
             command = &(event.data.command);
+            traceCommand(*command);
             job = command->job;
+            writeError.clear();
             if (job->getType() == synthclone::SamplerJob::TYPE_SAMPLE) {
-                synthclone::SampleOutputStream *stream =
-                    qobject_cast<synthclone::SampleOutputStream *>
-                    (command->stream);
-                float **sampleBuffers = command->sampleBuffers;
-                float *streamBuffer = new float[channels];
-                for (jack_nframes_t i = 0; i < command->totalSampleFrames;
-                     i++) {
-                    for (synthclone::SampleChannelCount j = 0; j < channels;
-                         j++) {
-                        streamBuffer[j] = sampleBuffers[j][i];
-                    }
-                    stream->write(streamBuffer, 1);
+                try {
+                    writeCapturedData(*command);
+                } catch (synthclone::Error &e) {
+                    writeError = e.getMessage();
                 }
-                delete[] streamBuffer;
             }
+            releaseJobResources(*command);
             idle = true;
             emit statusChanged(tr("Idle."));
-            emit jobCompleted();
-            emit progressChanged(0.0);
+            if (! writeError.isEmpty()) {
+                emit jobError(writeError);
+            } else if (command->compromised) {
+                emit jobCompromised(tr("an xrun occurred while sampling"));
+            } else {
+                emit jobCompleted();
+            }
+            reportProgress(0.0);
             break;
         case ProcessEvent::TYPE_ERROR:
+            command = &(event.data.error.command);
+            traceCommand(*command);
+            releaseJobResources(*command);
             idle = true;
             emit statusChanged(tr("Idle."));
             emit jobError(event.data.error.message);
-            command = &(event.data.error.command);
             break;
+        case ProcessEvent::TYPE_LATENCY_ERROR:
+            {
+                float *buffer = latencyBuffer.fetchAndStoreOrdered(0);
+                if (buffer) {
+                    captureBufferPool.release(buffer);
+                }
+            }
+            emit latencyMeasurementError(event.data.message);
+            continue;
+        case ProcessEvent::TYPE_LATENCY_MEASURED:
+            {
+                // The frame count is read before the buffer is taken back,
+                // as 'measureLatency()' may start another measurement as soon
+                // as the buffer is cleared.
+                jack_nframes_t frames = latencyFrames;
+                float *buffer = latencyBuffer.fetchAndStoreOrdered(0);
+                if (! buffer) {
+                    // The sampler was shut down.
+                    continue;
+                }
+                synthclone::SampleFrameCount latency =
+                    synthclone::findOnset(buffer, frames, channels);
+                captureBufferPool.release(buffer);
+                if (latency == -1) {
+                    emit latencyMeasurementError
+                        (tr("no sound was captured while the test note was "
+                            "played"));
+                } else {
+                    if (idle) {
+                        emit statusChanged
+                            (tr("Measured latency: %1 frames").
+                             arg(QLocale::system().toString(latency)));
+                    }
+                    emit latencyMeasured(static_cast<int>(latency));
+                }
+            }
+            continue;
         case ProcessEvent::TYPE_PROGRESS:
-            emit progressChanged(event.data.progress);
+            reportProgress(event.data.progress);
             continue;
         default:
             assert(false);
         }
-        for (synthclone::SampleChannelCount i = 0; i < channels; i++) {
-            delete[] command->sampleBuffers[i];
-        }
-        delete[] command->sampleBuffers;
     }
 }
 
@@ -731,6 +1077,110 @@ Sampler::openPort(const char *name, const char *type, JackPortFlags flags)
     return port;
 }
 
+void
+Sampler::readPlaybackData()
+{
+    for (;;) {
+        playbackSemaphore.wait();
+        QMutexLocker locker(&playbackMutex);
+        if (playbackThreadTerminating) {
+            break;
+        }
+        fillPlaybackBuffer(PLAYBACK_BUFFER_FRAMES);
+    }
+}
+
+long
+Sampler::readPlaybackInput(float **data)
+{
+    // Called by the playback converter.  Exceptions can't be thrown through
+    // libsamplerate, so read errors are passed on in 'playbackError'.
+    *data = playbackInputBlock;
+    try {
+        return static_cast<long>
+            (playbackStream->read(playbackInputBlock, PLAYBACK_BLOCK_FRAMES));
+    } catch (synthclone::Error &e) {
+        playbackError = e.getMessage();
+    }
+    return 0;
+}
+
+synthclone::SampleFrameCount
+Sampler::readPlaybackStream(float *buffer, jack_nframes_t frames)
+{
+    // The caller must hold the playback mutex.
+    if (! playbackConverter) {
+        return playbackStream->read(buffer, frames);
+    }
+
+    // The converter doesn't generate exactly as many frames as the job
+    // expects, so extra frames are dropped, and missing frames at the end of
+    // the sample are replaced with silence.
+    frames = qMin(frames, playbackFramesRemaining);
+    long count = src_callback_read(playbackConverter, playbackRatio,
+                                   static_cast<long>(frames), buffer);
+    if (! playbackError.isEmpty()) {
+        throw synthclone::Error(playbackError);
+    }
+    int result = src_error(playbackConverter);
+    if (result) {
+        throw synthclone::Error(src_strerror(result));
+    }
+    long end = static_cast<long>(frames) * channels;
+    for (long i = count * channels; i < end; i++) {
+        buffer[i] = 0.0;
+    }
+    playbackFramesRemaining -= frames;
+    return frames;
+}
+
+void
+Sampler::releaseJobResources(const Command &command)
+{
+    if (command.job->getType() == synthclone::SamplerJob::TYPE_SAMPLE) {
+        for (synthclone::SampleChannelCount i = 0; i < channels; i++) {
+            captureBufferPool.release(command.sampleBuffers[i]);
+        }
+    } else {
+        // The session may destroy the stream as soon as it knows that the job
+        // is finished, so the playback thread has to stop reading it first.
+        QMutexLocker locker(&playbackMutex);
+        playbackStream = 0;
+        if (playbackConverter) {
+            src_delete(playbackConverter);
+            playbackConverter = 0;
+        }
+    }
+}
+
+void
+Sampler::reserveCaptureBuffers(synthclone::SampleTime sampleTime)
+{
+    assert(active);
+    captureBufferPool.reserve(channels, static_cast<qint64>
+                              (sampleTime * jack_get_sample_rate(client)));
+}
+
+void
+Sampler::reserveCaptureBuffers(const synthclone::SamplerJob *job)
+{
+    if (active && (job->getType() == synthclone::SamplerJob::TYPE_SAMPLE)) {
+        try {
+            reserveCaptureBuffers(job->getZone()->getSampleTime());
+        } catch (synthclone::Error &e) {
+            // The buffers will be allocated when the job is started.
+            qWarning() << e.getMessage();
+        }
+    }
+}
+
+void
+Sampler::resetHealth()
+{
+    callbackMonitor.reset();
+    emit healthChanged(callbackMonitor.read());
+}
+
 void
 Sampler::sendCommand(const Command &command)
 {
@@ -743,6 +1193,7 @@ Sampler::sendCommand(const Command &command)
 bool
 Sampler::sendJobFinalizationEvent(ProcessEvent::Type type)
 {
+    command.endTime = jack_get_time();
     ProcessEvent event;
     memcpy(static_cast<void *>(&(event.data.command)),
            static_cast<void *>(&command), sizeof(Command));
@@ -768,6 +1219,7 @@ Sampler::sendMIDIMessage(void *midiBuffer, synthclone::MIDIData status,
     }
     jack_midi_data_t *event = jack_midi_event_reserve(midiBuffer, 0, size);
     if (! event) {
+        callbackMonitor.addMIDIFailure();
         jack_midi_clear_buffer(midiBuffer);
         setProcessErrorState(ERROR_MIDI_EVENT_RESERVE);
         return false;
@@ -793,6 +1245,7 @@ Sampler::sendPriorityEvent(const PriorityEvent &event)
 bool
 Sampler::sendProcessErrorEvent()
 {
+    command.endTime = jack_get_time();
     ProcessEvent event;
     memcpy(static_cast<void *>(&(event.data.error.command)),
            static_cast<void *>(&command), sizeof(Command));
@@ -811,6 +1264,10 @@ Sampler::sendProcessEvent(const ProcessEvent &event)
                               sizeof(ProcessEvent));
         eventSemaphore.post();
     }
+    size_t used = jack_ringbuffer_read_space(processEventBuffer);
+    callbackMonitor.updateBufferUsage
+        (processEventBufferIndex, used,
+         used + jack_ringbuffer_write_space(processEventBuffer));
     return result;
 }
 
@@ -823,6 +1280,13 @@ Sampler::sendProgressEvent(float progress)
     sendProcessEvent(event);
 }
 
+void
+Sampler::setCaptureLatency(synthclone::SampleFrameCount latency)
+{
+    assert(latency >= 0);
+    captureLatency = latency;
+}
+
 void
 Sampler::setProcessErrorState(const char *message)
 {
@@ -836,51 +1300,127 @@ Sampler::startJob(const synthclone::SamplerJob &job,
 {
     assert(idle);
     assert(stream.getChannels() == channels);
-    assert(stream.getSampleRate() == getSampleRate());
     Command command;
-    jack_default_audio_sample_t **sampleBuffers;
     jack_nframes_t sampleFrames;
-    jack_nframes_t sampleRate = static_cast<jack_nframes_t>
-        (stream.getSampleRate());
+    jack_nframes_t sampleRate = jack_get_sample_rate(client);
+    synthclone::SampleRate streamSampleRate = stream.getSampleRate();
     const synthclone::Zone *zone = job.getZone();
+
+    // If the stream's sample rate differs from JACK's sample rate, then the
+    // playback thread converts samples to JACK's sample rate as they're
+    // played, and captured audio is converted to the stream's sample rate
+    // when the job is finished.
+    double ratio = static_cast<double>(sampleRate) / streamSampleRate;
+    if (! src_is_valid_ratio(ratio)) {
+        throw synthclone::Error(tr("'%1': invalid conversion ratio").
+                                arg(ratio));
+    }
+
     if (job.getType() == synthclone::SamplerJob::TYPE_SAMPLE) {
         jack_nframes_t releaseFrames = static_cast<jack_nframes_t>
             (zone->getReleaseTime() * sampleRate);
         sampleFrames = static_cast<jack_nframes_t>
             (zone->getSampleTime() * sampleRate);
-        sampleBuffers = new jack_default_audio_sample_t *[channels];
-        for (synthclone::SampleChannelCount i = 0; i < channels; i++) {
-            sampleBuffers[i] = new jack_default_audio_sample_t[sampleFrames];
+        synthclone::SampleChannelCount acquired = 0;
+        try {
+            for (; acquired < channels; acquired++) {
+                jobSampleBuffers[acquired] =
+                    captureBufferPool.acquire(sampleFrames);
+            }
+        } catch (...) {
+            // Return the buffers that were acquired before the failure.
+            for (synthclone::SampleChannelCount i = 0; i < acquired; i++) {
+                captureBufferPool.release(jobSampleBuffers[i]);
+                jobSampleBuffers[i] = 0;
+            }
+            throw;
         }
         emit statusChanged(tr("Sampling ..."));
         command.totalReleaseFrames = releaseFrames;
     } else {
-        sampleFrames = static_cast<jack_nframes_t>(stream.getFrames());
-        sampleBuffers = new jack_default_audio_sample_t *[channels];
-        for (synthclone::SampleChannelCount i = 0; i < channels; i++) {
-            sampleBuffers[i] = new jack_default_audio_sample_t[sampleFrames];
-        }
-        synthclone::SampleInputStream *inputStream =
-            qobject_cast<synthclone::SampleInputStream *>(&stream);
-        float *buffer = new float[channels];
-        for (synthclone::SampleFrameCount i = 0; i < sampleFrames; i++) {
-            synthclone::SampleFrameCount count = inputStream->read(buffer, 1);
-            assert(count == 1);
-            for (synthclone::SampleChannelCount j = 0; j < channels; j++) {
-                sampleBuffers[j][i] = buffer[j];
+        synthclone::SampleFrameCount streamFrames = stream.getFrames();
+        SRC_STATE *converter = 0;
+        if (sampleRate == streamSampleRate) {
+            sampleFrames = static_cast<jack_nframes_t>(streamFrames);
+        } else {
+            sampleFrames = static_cast<jack_nframes_t>
+                (floor((streamFrames * ratio) + 0.5));
+            int result;
+            converter = src_callback_new(readPlaybackInput,
+                                         PLAYBACK_CONVERTER_TYPE, channels,
+                                         &result, this);
+            if (! converter) {
+                throw synthclone::Error(src_strerror(result));
             }
         }
-        delete[] buffer;
+
+        // Preload the head of the sample, and let the playback thread read
+        // the rest while the sample is playing.
+        {
+            QMutexLocker locker(&playbackMutex);
+            jack_ringbuffer_reset(playbackBuffer);
+            playbackConverter = converter;
+            playbackError.clear();
+            playbackFailed.fetchAndStoreOrdered(0);
+            playbackFramesRemaining = sampleFrames;
+            playbackRatio = ratio;
+            playbackStream =
+                qobject_cast<synthclone::SampleInputStream *>(&stream);
+            fillPlaybackBuffer(PLAYBACK_PRELOAD_FRAMES);
+        }
+        playbackSemaphore.post();
         emit statusChanged(tr("Playing sample ..."));
     }
     command.job = &job;
-    command.sampleBuffers = sampleBuffers;
+    command.sampleBuffers = jobSampleBuffers;
+    command.sampleRate = sampleRate;
+    command.skipFrames = static_cast<jack_nframes_t>(captureLatency);
     command.stream = &stream;
     command.totalSampleFrames = sampleFrames;
     idle = false;
     sendCommand(command);
 }
 
+void
+Sampler::traceCommand(const Command &command)
+{
+    synthclone::Tracer *tracer = synthclone::Tracer::getActive();
+    if (! tracer) {
+        return;
+    }
+
+    // Convert JACK times, which are in microseconds, to tracer times.
+    qint64 offset = tracer->getTime() - static_cast<qint64>(jack_get_time());
+    const synthclone::Zone *zone = command.job->getZone();
+    QVariantMap arguments;
+    arguments["channel"] = static_cast<int>(zone->getChannel());
+    arguments["note"] = static_cast<int>(zone->getNote());
+    arguments["velocity"] = static_cast<int>(zone->getVelocity());
+    QString threadName = "JACK process";
+
+    jack_time_t endTime = command.endTime;
+    jack_time_t startTime = command.startTime;
+    if (command.job->getType() != synthclone::SamplerJob::TYPE_SAMPLE) {
+        tracer->addSpan("sampler", "play", startTime + offset,
+                        endTime - startTime, -1, arguments, threadName);
+        return;
+    }
+    jack_time_t releaseTime = command.releaseTime;
+    jack_time_t sampleTime = command.sampleTime;
+    tracer->addSpan("sampler", "pre-MIDI", startTime + offset,
+                    (sampleTime ? sampleTime : endTime) - startTime, -1,
+                    arguments, threadName);
+    if (sampleTime) {
+        tracer->addSpan("sampler", "sample", sampleTime + offset,
+                        (releaseTime ? releaseTime : endTime) - sampleTime, -1,
+                        arguments, threadName);
+    }
+    if (releaseTime) {
+        tracer->addSpan("sampler", "release", releaseTime + offset,
+                        endTime - releaseTime, -1, arguments, threadName);
+    }
+}
+
 void
 Sampler::updateCommandState()
 {
@@ -892,7 +1432,55 @@ Sampler::updateCommandState()
         if (! aborted) {
             state = STATE_ABORT;
         }
-    } else if (command.stream->getSampleRate() != getSampleRate()) {
+    } else if (command.sampleRate != jack_get_sample_rate(client)) {
         setProcessErrorState(ERROR_SAMPLE_RATE);
     }
 }
+
+void
+Sampler::writeCapturedData(const Command &command)
+{
+    synthclone::SampleOutputStream *stream =
+        qobject_cast<synthclone::SampleOutputStream *>(command.stream);
+    jack_nframes_t frames = command.totalSampleFrames;
+    const float **channelData = new const float *[channels];
+    QScopedArrayPointer<const float *> channelDataPtr(channelData);
+    QScopedArrayPointer<float> convertedDataPtr;
+    synthclone::SampleRate sampleRate = stream->getSampleRate();
+    if (sampleRate == command.sampleRate) {
+        for (synthclone::SampleChannelCount i = 0; i < channels; i++) {
+            channelData[i] = command.sampleBuffers[i];
+        }
+    } else {
+
+        // The captured channels aren't interleaved, so each channel is
+        // converted separately.
+        double ratio = static_cast<double>(sampleRate) / command.sampleRate;
+        long convertedFrames = static_cast<long>(ceil(frames * ratio)) + 1;
+        float *convertedData = new float[channels * convertedFrames];
+        convertedDataPtr.reset(convertedData);
+        SRC_DATA data;
+        data.input_frames = static_cast<long>(frames);
+        data.output_frames = convertedFrames;
+        data.src_ratio = ratio;
+        for (synthclone::SampleChannelCount i = 0; i < channels; i++) {
+            data.data_in = command.sampleBuffers[i];
+            data.data_out = convertedData + (i * convertedFrames);
+            int result = src_simple(&data, CAPTURE_CONVERTER_TYPE, 1);
+            if (result) {
+                throw synthclone::Error(src_strerror(result));
+            }
+            channelData[i] = data.data_out;
+        }
+        frames = static_cast<jack_nframes_t>(data.output_frames_gen);
+    }
+
+    float *streamBuffer = new float[channels];
+    QScopedArrayPointer<float> streamBufferPtr(streamBuffer);
+    for (jack_nframes_t i = 0; i < frames; i++) {
+        for (synthclone::SampleChannelCount j = 0; j < channels; j++) {
+            streamBuffer[j] = channelData[j][i];
+        }
+        stream->write(streamBuffer, 1);
+    }
+}
@@ -24,20 +24,29 @@
 #include <jack/jack.h>
 #include <jack/ringbuffer.h>
 #include <jack/session.h>
+#include <samplerate.h>
 
+#include <QtCore/QAtomicInt>
+#include <QtCore/QAtomicPointer>
 #include <QtCore/QDir>
 #include <QtCore/QMutex>
+#include <QtCore/QTimer>
 
+#include <synthclone/callbackmonitor.h>
+#include <synthclone/capturebufferpool.h>
+#include <synthclone/sampleinputstream.h>
 #include <synthclone/sampler.h>
 #include <synthclone/semaphore.h>
 
 #include "eventthread.h"
+#include "playbackthread.h"
 
 class Sampler: public synthclone::Sampler {
 
     Q_OBJECT
 
     friend class EventThread;
+    friend class PlaybackThread;
 
 public:
 
@@ -55,35 +64,91 @@ public:
     void
     deactivate();
 
+    synthclone::SampleFrameCount
+    getCaptureLatency() const;
+
     synthclone::SampleChannelCount
     getChannelCount() const;
 
     synthclone::SampleRate
     getSampleRate() const;
 
+    // Makes sure that starting a sampling job that's up to 'sampleTime'
+    // seconds long doesn't need to allocate memory.
+    void
+    reserveCaptureBuffers(synthclone::SampleTime sampleTime);
+
     void
     startJob(const synthclone::SamplerJob &job,
              synthclone::SampleStream &stream);
 
+public slots:
+
+    // Plays a test note, and captures the sound it produces.  The offset of
+    // the onset in the captured audio is reported with 'latencyMeasured()'.
+    // If a job is being run, then the measurement is made after the job is
+    // finished.
+    void
+    measureLatency();
+
+    // Reserves capture buffers for a job when the job is queued, rather than
+    // when the job is started.
+    void
+    reserveCaptureBuffers(const synthclone::SamplerJob *job);
+
+    void
+    resetHealth();
+
+    // Sets the number of frames that are skipped at the start of every
+    // capture, so that captured onsets are at the start of the sample.
+    void
+    setCaptureLatency(synthclone::SampleFrameCount latency);
+
 signals:
 
     void
     fatalError(const QString &message);
 
+    void
+    healthChanged(const synthclone::CallbackHealth &health);
+
+    void
+    latencyMeasured(int latency);
+
+    void
+    latencyMeasurementError(const QString &message);
+
     void
     sampleRateChanged();
 
     void
     sessionEvent(jack_client_t *client, jack_session_event_t *event);
 
+private slots:
+
+    void
+    handleHealthTimeout();
+
 private:
 
+    // The times are set by the process thread with 'jack_get_time()', so
+    // that the states of the job can be traced after the job is finished.  A
+    // time is 0 if the job never reached the state.  'sampleRate' is JACK's
+    // sample rate when the job was started; frame counts are in JACK frames.
     struct Command {
+        bool compromised;
+        jack_time_t endTime;
         const synthclone::SamplerJob *job;
+        jack_time_t releaseTime;
         jack_default_audio_sample_t **sampleBuffers;
+        jack_nframes_t sampleRate;
+        jack_time_t sampleTime;
+        jack_nframes_t skipFrames;
+        jack_time_t startTime;
         synthclone::SampleStream *stream;
         jack_nframes_t totalReleaseFrames;
         jack_nframes_t totalSampleFrames;
+        int xrunCount;
     };
 
     struct PriorityEvent {
@@ -110,6 +175,8 @@ private:
             TYPE_ABORTED,
             TYPE_COMPLETE,
             TYPE_ERROR,
+            TYPE_LATENCY_ERROR,
+            TYPE_LATENCY_MEASURED,
             TYPE_PROGRESS
         };
 
@@ -121,6 +188,7 @@ private:
                 const char *message;
             } error;
             Command command;
+            const char *message;
             float progress;
         } data;
     };
@@ -130,6 +198,9 @@ private:
         STATE_COMPLETED,
         STATE_ERROR,
         STATE_IDLE,
+        STATE_LATENCY_ERROR,
+        STATE_LATENCY_MEASURE,
+        STATE_LATENCY_MEASURED,
         STATE_PLAY,
         STATE_SAMPLE,
         STATE_SAMPLE_SEND_PRE_MIDI,
@@ -150,6 +221,12 @@ private:
     static void
     handleShutdownEvent(jack_status_t code, const char *reason, void *ptr);
 
+    static int
+    handleXRunEvent(void *ptr);
+
+    static long
+    readPlaybackInput(void *ptr, float **data);
+
     // Members
 
     void
@@ -161,6 +238,9 @@ private:
     void
     closePorts();
 
+    void
+    fillPlaybackBuffer(jack_nframes_t frames);
+
     const char *
     getErrorMessage(jack_status_t status) const;
 
@@ -176,6 +256,9 @@ private:
     void
     handleShutdownEvent(jack_status_t code, const char *reason);
 
+    int
+    handleXRunEvent();
+
     jack_port_t **
     initializeAudioPorts(const QString &prefix, JackPortFlags flags,
                          synthclone::SampleChannelCount channels);
@@ -189,6 +272,18 @@ private:
     jack_port_t *
     openPort(const char *name, const char *type, JackPortFlags flags);
 
+    void
+    readPlaybackData();
+
+    long
+    readPlaybackInput(float **data);
+
+    synthclone::SampleFrameCount
+    readPlaybackStream(float *buffer, jack_nframes_t frames);
+
+    void
+    releaseJobResources(const Command &command);
+
     void
     sendCommand(const Command &command);
 
@@ -215,12 +310,21 @@ private:
     void
     setProcessErrorState(const char *message);
 
+    void
+    traceCommand(const Command &command);
+
     void
     updateCommandState();
 
+    void
+    writeCapturedData(const Command &command);
+
     bool aborted;
     volatile bool active;
     QMutex activeMutex;
+    synthclone::CallbackMonitor callbackMonitor;
+    synthclone::CaptureBufferPool captureBufferPool;
+    synthclone::SampleFrameCount captureLatency;
     synthclone::SampleChannelCount channels;
     jack_client_t *client;
     Command command;
@@ -229,13 +333,32 @@ private:
     const char *errorMessage;
     synthclone::Semaphore eventSemaphore;
     EventThread eventThread;
+    QTimer healthTimer;
     bool idle;
     jack_port_t **inputPorts;
+    jack_default_audio_sample_t **jobSampleBuffers;
+    QAtomicPointer<float> latencyBuffer;
+    jack_nframes_t latencyFrames;
+    QAtomicInt latencyMeasurementRequested;
     jack_port_t *midiPort;
     jack_port_t **monitorPorts;
     jack_port_t **outputPorts;
+    float *playbackBlock;
+    jack_ringbuffer_t *playbackBuffer;
+    SRC_STATE *playbackConverter;
+    QString playbackError;
+    QAtomicInt playbackFailed;
+    jack_nframes_t playbackFramesRemaining;
+    float *playbackInputBlock;
+    QMutex playbackMutex;
+    double playbackRatio;
+    synthclone::Semaphore playbackSemaphore;
+    synthclone::SampleInputStream *playbackStream;
+    PlaybackThread playbackThread;
+    bool playbackThreadTerminating;
     jack_ringbuffer_t *priorityEventBuffer;
     jack_ringbuffer_t *processEventBuffer;
+    int processEventBufferIndex;
     int progress;
     QList<jack_port_t *> registeredPorts;
     State state;
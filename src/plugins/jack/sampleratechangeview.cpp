@@ -35,6 +35,10 @@ SampleRateChangeView::SampleRateChangeView(QObject *parent):
         (widget, "changeSampleRateButton");
     connect(changeSampleRateButton, SIGNAL(clicked()),
             SIGNAL(sampleRateChangeRequest()));
+
+    resampleButton = synthclone::getChild<QPushButton>(widget,
+                                                       "resampleButton");
+    connect(resampleButton, SIGNAL(clicked()), SIGNAL(resampleRequest()));
 }
 
 SampleRateChangeView::~SampleRateChangeView()
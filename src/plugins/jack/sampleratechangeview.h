@@ -39,6 +39,9 @@ public:
 
 signals:
 
+    void
+    resampleRequest();
+
     void
     sampleRateChangeRequest();
 
@@ -46,6 +49,7 @@ private:
 
     QPushButton *cancelButton;
     QPushButton *changeSampleRateButton;
+    QPushButton *resampleButton;
 
 };
 
@@ -46,7 +46,12 @@ Participant::~Participant()
 void
 Participant::activate(synthclone::Context &context, const QVariant &/*state*/)
 {
-    world = new LV2World(this);
+    // The LV2 world is created the first time the participant is activated,
+    // and is kept for later sessions, so that the LV2 plugin directories are
+    // only scanned once per process.
+    if (! world) {
+        world = new LV2World(this);
+    }
     this->context = &context;
     addPluginActions();
     effectView.setSampleChannelCount(context.getSampleChannelCount());
@@ -416,7 +421,6 @@ Participant::deactivate(synthclone::Context &context)
     }
     removePluginActions();
     this->context = 0;
-    delete world;
 }
 
 QVariant
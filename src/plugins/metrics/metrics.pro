@@ -0,0 +1,17 @@
+include(../plugins.pri)
+
+################################################################################
+# Build
+################################################################################
+
+HEADERS += participant.h \
+    plugin.h \
+    view.h
+MOC_DIR = $${MAKEDIR}/plugins/metrics
+OBJECTS_DIR = $${MAKEDIR}/plugins/metrics
+RCC_DIR = $${MAKEDIR}/plugins/metrics
+RESOURCES += metrics.qrc
+SOURCES += participant.cpp \
+    plugin.cpp \
+    view.cpp
+TARGET = $$qtLibraryTarget(synthclone_metrics)
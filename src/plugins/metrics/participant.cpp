@@ -0,0 +1,246 @@
+/*
+ * libsynthclone_metrics - Stage metrics plugin for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include <cassert>
+
+#include <QtCore/QFile>
+#include <QtCore/QTextStream>
+
+#include <synthclone/util.h>
+
+#include "participant.h"
+
+using synthclone::getJSONString;
+
+static const char *TIME_FORMAT = "yyyy-MM-ddThh:mm:ss.zzz";
+
+// Static functions
+
+static QString
+getCSVString(const QString &str)
+{
+    if (! (str.contains(',') || str.contains('"') || str.contains('\n'))) {
+        return str;
+    }
+    QString result = str;
+    result.replace("\"", "\"\"");
+    return QString("\"%1\"").arg(result);
+}
+
+static QString
+getStageId(synthclone::StageMetrics::Stage stage)
+{
+    switch (stage) {
+    case synthclone::StageMetrics::STAGE_EFFECT:
+        return "effect";
+    case synthclone::StageMetrics::STAGE_SAMPLER_JOB:
+        return "sampler-job";
+    case synthclone::StageMetrics::STAGE_TARGET_BUILD:
+        return "target-build";
+    }
+    assert(false);
+    return QString();
+}
+
+// Class definition
+
+Participant::Participant(QObject *parent):
+    synthclone::Participant(tr("Stage Metrics"), 0, 0, 1, "Devin Anderson",
+                            tr("Shows and exports timing and throughput "
+                               "metrics for sampler jobs, effects, and "
+                               "target builds"),
+                            parent),
+    metricsAction(tr("Stage Metrics"))
+{
+    fileView.setFilesVisible(true);
+    fileView.setOperation(synthclone::FileSelectionView::OPERATION_SAVE);
+    fileView.setSelectionFilter
+        (synthclone::FileSelectionView::SELECTIONFILTER_ANY_FILE);
+    fileView.setTitle(tr("Export Stage Metrics (CSV or JSON)"));
+    connect(&fileView, SIGNAL(closeRequest()),
+            SLOT(handleFileViewCloseRequest()));
+    connect(&fileView, SIGNAL(pathsSelected(const QStringList &)),
+            SLOT(handleFileViewPathSelection(const QStringList &)));
+
+    connect(&metricsAction, SIGNAL(triggered()), SLOT(handleViewShow()));
+
+    connect(&view, SIGNAL(closeRequest()), SLOT(handleViewCloseRequest()));
+    connect(&view, SIGNAL(exportRequest()), SLOT(handleViewExportRequest()));
+
+    context = 0;
+}
+
+Participant::~Participant()
+{
+    // Empty
+}
+
+void
+Participant::activate(synthclone::Context &context, const QVariant &/*state*/)
+{
+    view.clearMetrics();
+    int count = context.getStageMetricsCount();
+    for (int i = 0; i < count; i++) {
+        view.addMetrics(context.getStageMetrics(i));
+    }
+    connect(&context,
+            SIGNAL(stageMetricsAdded(const synthclone::StageMetrics &, int)),
+            &view, SLOT(addMetrics(const synthclone::StageMetrics &)));
+    connect(&context, SIGNAL(stageMetricsCleared()),
+            &view, SLOT(clearMetrics()));
+    connect(&view, SIGNAL(clearRequest()), &context,
+            SLOT(clearStageMetrics()));
+    context.addMenuAction(&metricsAction, synthclone::MENU_TOOLS);
+    this->context = &context;
+}
+
+void
+Participant::deactivate(synthclone::Context &context)
+{
+    context.removeMenuAction(&metricsAction);
+    disconnect(&context,
+               SIGNAL(stageMetricsAdded(const synthclone::StageMetrics &,
+                                        int)),
+               &view, SLOT(addMetrics(const synthclone::StageMetrics &)));
+    disconnect(&context, SIGNAL(stageMetricsCleared()),
+               &view, SLOT(clearMetrics()));
+    disconnect(&view, SIGNAL(clearRequest()), &context,
+               SLOT(clearStageMetrics()));
+    fileView.setVisible(false);
+    view.setVisible(false);
+    this->context = 0;
+}
+
+void
+Participant::handleFileViewCloseRequest()
+{
+    fileView.setVisible(false);
+}
+
+void
+Participant::handleFileViewPathSelection(const QStringList &paths)
+{
+    assert(paths.count() == 1);
+    fileView.setVisible(false);
+    QString path = paths[0];
+    QFile file(path);
+    if (! file.open(QIODevice::WriteOnly | QIODevice::Truncate |
+                    QIODevice::Text)) {
+        context->reportError(tr("failed to open '%1': %2").
+                             arg(path, file.errorString()));
+        return;
+    }
+
+    // The format is picked with the file extension.
+    if (path.endsWith(".json", Qt::CaseInsensitive)) {
+        writeJSON(file);
+    } else {
+        writeCSV(file);
+    }
+    file.close();
+    if (file.error() != QFile::NoError) {
+        context->reportError(tr("failed to write '%1': %2").
+                             arg(path, file.errorString()));
+    }
+}
+
+void
+Participant::handleViewCloseRequest()
+{
+    view.setVisible(false);
+}
+
+void
+Participant::handleViewExportRequest()
+{
+    fileView.setVisible(true);
+}
+
+void
+Participant::handleViewShow()
+{
+    view.setVisible(true);
+}
+
+void
+Participant::writeCSV(QIODevice &device)
+{
+    QTextStream stream(&device);
+    stream.setCodec("UTF-8");
+    stream << "stage,component,zone,start,wall-us,cpu-us,frames-read,"
+        "frames-written,bytes-read,bytes-written\n";
+    int count = context->getStageMetricsCount();
+    for (int i = 0; i < count; i++) {
+        synthclone::StageMetrics metrics = context->getStageMetrics(i);
+        int zoneIndex = metrics.getZoneIndex();
+        qint64 cpuTime = metrics.getCPUTime();
+        stream << getStageId(metrics.getStage()) << ','
+               << getCSVString(metrics.getComponentName()) << ','
+               << (zoneIndex == -1 ? QString() :
+                   QString::number(zoneIndex + 1)) << ','
+               << metrics.getStartTime().toString(TIME_FORMAT) << ','
+               << metrics.getWallTime() << ','
+               << (cpuTime < 0 ? QString() : QString::number(cpuTime))
+               << ',' << metrics.getFramesRead() << ','
+               << metrics.getFramesWritten() << ','
+               << metrics.getBytesRead() << ','
+               << metrics.getBytesWritten() << '\n';
+    }
+    stream.flush();
+}
+
+void
+Participant::writeJSON(QIODevice &device)
+{
+    QTextStream stream(&device);
+    stream.setCodec("UTF-8");
+    stream << "[";
+    int count = context->getStageMetricsCount();
+    for (int i = 0; i < count; i++) {
+        synthclone::StageMetrics metrics = context->getStageMetrics(i);
+        int zoneIndex = metrics.getZoneIndex();
+        qint64 cpuTime = metrics.getCPUTime();
+        stream << (i ? ",\n" : "\n") << "    {\n";
+        stream << "        \"stage\": "
+               << getJSONString(getStageId(metrics.getStage())) << ",\n";
+        stream << "        \"component\": "
+               << getJSONString(metrics.getComponentName()) << ",\n";
+        stream << "        \"zone\": "
+               << (zoneIndex == -1 ? QString("null") :
+                   QString::number(zoneIndex + 1)) << ",\n";
+        stream << "        \"start\": "
+               << getJSONString(metrics.getStartTime().
+                                toString(TIME_FORMAT)) << ",\n";
+        stream << "        \"wall-us\": " << metrics.getWallTime() << ",\n";
+        stream << "        \"cpu-us\": "
+               << (cpuTime < 0 ? QString("null") : QString::number(cpuTime))
+               << ",\n";
+        stream << "        \"frames-read\": " << metrics.getFramesRead()
+               << ",\n";
+        stream << "        \"frames-written\": " << metrics.getFramesWritten()
+               << ",\n";
+        stream << "        \"bytes-read\": " << metrics.getBytesRead()
+               << ",\n";
+        stream << "        \"bytes-written\": " << metrics.getBytesWritten()
+               << "\n    }";
+    }
+    stream << (count ? "\n]\n" : "]\n");
+    stream.flush();
+}
@@ -0,0 +1,80 @@
+/*
+ * libsynthclone_metrics - Stage metrics plugin for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#ifndef __PARTICIPANT_H__
+#define __PARTICIPANT_H__
+
+#include <QtCore/QIODevice>
+
+#include <synthclone/fileselectionview.h>
+#include <synthclone/participant.h>
+
+#include "view.h"
+
+class Participant: public synthclone::Participant {
+
+    Q_OBJECT
+
+public:
+
+    explicit
+    Participant(QObject *parent=0);
+
+    ~Participant();
+
+    void
+    activate(synthclone::Context &context, const QVariant &state=QVariant());
+
+    void
+    deactivate(synthclone::Context &context);
+
+private slots:
+
+    void
+    handleFileViewCloseRequest();
+
+    void
+    handleFileViewPathSelection(const QStringList &paths);
+
+    void
+    handleViewCloseRequest();
+
+    void
+    handleViewExportRequest();
+
+    void
+    handleViewShow();
+
+private:
+
+    void
+    writeCSV(QIODevice &device);
+
+    void
+    writeJSON(QIODevice &device);
+
+    synthclone::Context *context;
+    synthclone::FileSelectionView fileView;
+    synthclone::MenuAction metricsAction;
+    View view;
+
+};
+
+#endif
@@ -1,5 +1,5 @@
 /*
- * libsynthclone_hydrogen - Hydrogen target plugin for `synthclone`
+ * libsynthclone_metrics - Stage metrics plugin for `synthclone`
  * Copyright (C) 2013 Devin Anderson
  *
  * This program is free software; you can redistribute it and/or modify it
@@ -17,32 +17,34 @@
  * Ave, Cambridge, MA 02139, USA.
  */
 
-#ifndef __TEMPORARYDIR_H__
-#define __TEMPORARYDIR_H__
+#ifndef __PLUGIN_H__
+#define __PLUGIN_H__
 
-#include <QtCore/QObject>
-#include <QtCore/QString>
+#include <synthclone/iplugin.h>
 
-class TemporaryDir: public QObject {
+#include "participant.h"
+
+class Plugin: public QObject, public synthclone::IPlugin {
 
     Q_OBJECT
+    Q_INTERFACES(synthclone::IPlugin)
 
 public:
 
     explicit
-    TemporaryDir(QObject *parent=0);
+    Plugin(QObject *parent=0);
 
-    ~TemporaryDir();
+    ~Plugin();
 
-    QString
-    getPath() const;
+    QByteArray
+    getId() const;
 
-private:
+    synthclone::Participant *
+    getParticipant();
 
-    void
-    remove(const QString &path);
+private:
 
-    QString path;
+    Participant participant;
 
 };
 
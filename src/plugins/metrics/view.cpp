@@ -0,0 +1,109 @@
+/*
+ * libsynthclone_metrics - Stage metrics plugin for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+
+#include <synthclone/util.h>
+
+#include "view.h"
+
+// Static functions
+
+static QString
+getMillisecondsString(qint64 microseconds)
+{
+    return microseconds < 0 ? QString() :
+        QString::number(microseconds / 1000.0, 'f', 3);
+}
+
+static QString
+getStageString(synthclone::StageMetrics::Stage stage)
+{
+    switch (stage) {
+    case synthclone::StageMetrics::STAGE_EFFECT:
+        return View::tr("Effect");
+    case synthclone::StageMetrics::STAGE_SAMPLER_JOB:
+        return View::tr("Sampler Job");
+    case synthclone::StageMetrics::STAGE_TARGET_BUILD:
+        return View::tr("Target Build");
+    }
+    return QString();
+}
+
+// Class definition
+
+View::View(QObject *parent):
+    DesignerView(":/synthclone/plugins/metrics/view.ui", parent)
+{
+    QWidget *widget = getRootWidget();
+
+    clearButton = synthclone::getChild<QPushButton>(widget, "clearButton");
+    connect(clearButton, SIGNAL(clicked()), SIGNAL(clearRequest()));
+
+    closeButton = synthclone::getChild<QPushButton>(widget, "closeButton");
+    connect(closeButton, SIGNAL(clicked()), SIGNAL(closeRequest()));
+
+    exportButton = synthclone::getChild<QPushButton>(widget, "exportButton");
+    connect(exportButton, SIGNAL(clicked()), SIGNAL(exportRequest()));
+
+    metricsTree = synthclone::getChild<QTreeWidget>(widget, "metricsTree");
+}
+
+View::~View()
+{
+    // Empty
+}
+
+void
+View::addMetrics(const synthclone::StageMetrics &metrics)
+{
+    // Throughput is the amount of sample data handled per second of wall
+    // time, whichever way the data went.
+    qint64 wallTime = metrics.getWallTime();
+    synthclone::SampleFrameCount frames =
+        metrics.getFramesRead() + metrics.getFramesWritten();
+    QString throughput = wallTime > 0 ?
+        QString::number((frames * 1000000.0) / wallTime, 'f', 0) :
+        QString();
+    int zoneIndex = metrics.getZoneIndex();
+
+    QStringList columns;
+    columns << getStageString(metrics.getStage())
+            << metrics.getComponentName()
+            << (zoneIndex == -1 ? QString() : QString::number(zoneIndex + 1))
+            << metrics.getStartTime().toString("hh:mm:ss.zzz")
+            << getMillisecondsString(wallTime)
+            << getMillisecondsString(metrics.getCPUTime())
+            << QString::number(metrics.getFramesRead())
+            << QString::number(metrics.getFramesWritten())
+            << QString::number(metrics.getBytesRead())
+            << QString::number(metrics.getBytesWritten())
+            << throughput;
+    QTreeWidgetItem *item = new QTreeWidgetItem(columns);
+    for (int i = 2; i < columns.count(); i++) {
+        item->setTextAlignment(i, Qt::AlignRight | Qt::AlignVCenter);
+    }
+    metricsTree->addTopLevelItem(item);
+    metricsTree->scrollToItem(item);
+}
+
+void
+View::clearMetrics()
+{
+    metricsTree->clear();
+}
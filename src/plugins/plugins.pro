@@ -10,6 +10,9 @@ isEmpty(SKIP_JACK_PLUGIN) {
 isEmpty(SKIP_LV2_PLUGIN) {
     SUBDIRS += lv2
 }
+isEmpty(SKIP_METRICS_PLUGIN) {
+    SUBDIRS += metrics
+}
 isEmpty(SKIP_PORTMEDIA_PLUGIN) {
     SUBDIRS += portmedia
 }
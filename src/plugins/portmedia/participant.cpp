@@ -24,15 +24,25 @@
 #include <synthclone/error.h>
 
 #include "participant.h"
+#include "types.h"
 
 Participant::Participant(QObject *parent):
     synthclone::Participant(tr("Port Media"), 0, 0, 1, "Devin Anderson",
                             tr("Sampling via PortAudio/PortMIDI"), parent),
-    addSamplerAction(tr("PortMedia Sampler"))
+    addSamplerAction(tr("PortMedia Sampler")),
+    healthAction(tr("Callback Health")),
+    measureLatencyAction(tr("Measure Latency"))
 {
     connect(&addSamplerAction, SIGNAL(triggered()),
             SLOT(handleAddSamplerActionTrigger()));
 
+    connect(&healthAction, SIGNAL(triggered()),
+            SLOT(handleHealthActionTrigger()));
+    connect(&healthView, SIGNAL(closeRequest()),
+            SLOT(handleHealthViewCloseRequest()));
+    connect(&measureLatencyAction, SIGNAL(triggered()),
+            SLOT(handleMeasureLatencyActionTrigger()));
+
     connect(&samplerView, SIGNAL(addRequest()),
             SLOT(handleAddSamplerRequest()));
     connect(&samplerView, SIGNAL(closeRequest()),
@@ -90,6 +100,7 @@ Participant::activate(synthclone::Context &context, const QVariant &/*state*/)
         samplerView.addMIDIDevice(i, sampler->getMIDIDeviceName(i));
     }
     samplerView.setMIDIDevice(sampler->getMIDIDeviceIndex());
+    samplerView.setMIDILatency(sampler->getMIDILatency());
 
     samplerView.setSampleChannelCount(channels);
     for (synthclone::SampleChannelCount i = 0; i < channels; i++) {
@@ -120,6 +131,8 @@ Participant::activate(synthclone::Context &context, const QVariant &/*state*/)
             sampler, SLOT(setAudioOutputDeviceIndex(int)));
     connect(&samplerView, SIGNAL(midiDeviceChangeRequest(int)),
             sampler, SLOT(setMIDIDeviceIndex(int)));
+    connect(&samplerView, SIGNAL(midiLatencyChangeRequest(int)),
+            sampler, SLOT(setMIDILatency(int)));
     connect(&samplerView, SIGNAL(nameChangeRequest(const QString &)),
 	    sampler, SLOT(setName(const QString &)));
 
@@ -164,9 +177,23 @@ Participant::activate(synthclone::Context &context, const QVariant &/*state*/)
             SLOT(setSampleChannelCount(synthclone::SampleChannelCount)));
     connect(sampler, SIGNAL(midiDeviceIndexChanged(int)),
             &samplerView, SLOT(setMIDIDevice(int)));
+    connect(sampler, SIGNAL(midiLatencyChanged(int)),
+            &samplerView, SLOT(setMIDILatency(int)));
     connect(sampler, SIGNAL(nameChanged(const QString &)),
             &samplerView, SLOT(setName(const QString &)));
 
+    connect(sampler,
+            SIGNAL(healthChanged(const synthclone::CallbackHealth &)),
+            &healthView, SLOT(setHealth(const synthclone::CallbackHealth &)));
+    connect(&healthView, SIGNAL(resetRequest()), sampler, SLOT(resetHealth()));
+
+    connect(sampler, SIGNAL(latencyMeasured(int)),
+            SLOT(handleLatencyMeasurement(int)));
+    connect(sampler, SIGNAL(latencyMeasurementError(const QString &)),
+            SLOT(handleLatencyMeasurementError(const QString &)));
+    connect(&measureLatencyAction, SIGNAL(triggered()),
+            sampler, SLOT(measureLatency()));
+
     connect(sampler, SIGNAL(midiError(const QString &)),
             SLOT(handleMIDIError(const QString &)));
     connect(sampler, SIGNAL(sampleRateChanged(synthclone::SampleRate)),
@@ -185,6 +212,7 @@ bool
 Participant::addSampler()
 {
     try {
+        sampler->reserveCaptureBuffers(getMaximumSampleTime());
         sampler->activate();
     } catch (synthclone::Error &e) {
         context->reportError(e.getMessage());
@@ -195,6 +223,12 @@ Participant::addSampler()
         context->addSampler(sampler);
     connect(&registration, SIGNAL(unregistered(QObject *)),
             SLOT(handleSamplerUnregistration(QObject *)));
+    context->addMenuAction(&healthAction, sampler);
+    context->addMenuAction(&measureLatencyAction, sampler);
+    connect(context,
+            SIGNAL(samplerJobAdded(const synthclone::SamplerJob *, int)),
+            sampler,
+            SLOT(reserveCaptureBuffers(const synthclone::SamplerJob *)));
     return true;
 }
 
@@ -220,6 +254,16 @@ Participant::deactivate(synthclone::Context &context)
     sampler = 0;
 }
 
+synthclone::SampleTime
+Participant::getMaximumSampleTime() const
+{
+    synthclone::SampleTime sampleTime = 0.0;
+    for (int i = context->getZoneCount() - 1; i >= 0; i--) {
+        sampleTime = qMax(sampleTime, context->getZone(i)->getSampleTime());
+    }
+    return sampleTime;
+}
+
 QVariant
 Participant::getState(const synthclone::Sampler *sampler) const
 {
@@ -227,6 +271,8 @@ Participant::getState(const synthclone::Sampler *sampler) const
     const Sampler *s = qobject_cast<const Sampler *>(sampler);
     assert(s);
 
+    map["captureLatency"] = s->getCaptureLatency();
+
     int index = s->getAudioAPIIndex();
     map["audioAPIIndex"] = index;
     map["audioAPIName"] = s->getAudioAPIName(index);
@@ -252,6 +298,7 @@ Participant::getState(const synthclone::Sampler *sampler) const
     index = s->getMIDIDeviceIndex();
     map["midiDeviceIndex"] = index;
     map["midiDeviceName"] = s->getMIDIDeviceName(index);
+    map["midiLatency"] = s->getMIDILatency();
 
     return map;
 }
@@ -290,6 +337,39 @@ Participant::handleChannelCountChange(synthclone::SampleChannelCount count)
     sampler->setChannels(count);
 }
 
+void
+Participant::handleHealthActionTrigger()
+{
+    healthView.setVisible(true);
+}
+
+void
+Participant::handleHealthViewCloseRequest()
+{
+    healthView.setVisible(false);
+}
+
+void
+Participant::handleLatencyMeasurement(int latency)
+{
+    sampler->setCaptureLatency(latency);
+    measureLatencyAction.setEnabled(true);
+}
+
+void
+Participant::handleLatencyMeasurementError(const QString &message)
+{
+    measureLatencyAction.setEnabled(true);
+    context->reportError(tr("Failed to measure latency: %1").arg(message));
+}
+
+void
+Participant::handleMeasureLatencyActionTrigger()
+{
+    // The action is enabled again when the measurement is finished.
+    measureLatencyAction.setEnabled(false);
+}
+
 void
 Participant::handleMIDIError(const QString &message)
 {
@@ -301,7 +381,14 @@ Participant::handleMIDIError(const QString &message)
 void
 Participant::handleSamplerUnregistration(QObject *obj)
 {
-    qobject_cast<Sampler *>(obj)->deactivate();
+    Sampler *s = qobject_cast<Sampler *>(obj);
+    disconnect(context,
+               SIGNAL(samplerJobAdded(const synthclone::SamplerJob *, int)),
+               s, SLOT(reserveCaptureBuffers(const synthclone::SamplerJob *)));
+    s->deactivate();
+    s->resetHealth();
+    healthView.setVisible(false);
+    measureLatencyAction.setEnabled(true);
     addSamplerAction.setEnabled(true);
 }
 
@@ -326,12 +413,14 @@ Participant::handleSessionSampleRateChange(synthclone::SampleRate sampleRate)
 void
 Participant::restoreSampler(const QVariant &state)
 {
+    synthclone::SampleFrameCount captureLatency;
     synthclone::SampleChannelCount channels = context->getSampleChannelCount();
     QVariantList channelMap;
     int count;
     synthclone::SampleChannelCount deviceChannelCount;
     QStringList errorMessages;
     int index;
+    int latency;
     QLocale locale = QLocale::system();
     const QVariantMap map = state.toMap();
     QString name;
@@ -344,7 +433,7 @@ Participant::restoreSampler(const QVariant &state)
     if ((! success) || (index < 0)) {
         errorMessages.append(tr("non-integer API index '%1'").
                              arg(value.toString()));
-        goto findMIDIDevice;
+        goto findMIDILatency;
     }
     count = sampler->getAudioAPICount();
     name = map.value("audioAPIName", "").toString();
@@ -368,7 +457,7 @@ Participant::restoreSampler(const QVariant &state)
         }
     }
     errorMessages.append(tr("could not find PortAudio API '%1'").arg(name));
-    goto findMIDIDevice;
+    goto findMIDILatency;
 
 findAudioInputDevice:
     value = map.value("audioInputDeviceIndex", "");
@@ -444,7 +533,7 @@ findAudioOutputDevice:
     if ((! success) || (index < 0)) {
         errorMessages.append(tr("non-integer audio output device index '%1'").
                              arg(value.toString()));
-        goto findMIDIDevice;
+        goto findMIDILatency;
     }
     count = sampler->getAudioOutputDeviceCount();
     name = map.value("audioOutputDeviceName", "").toString();
@@ -469,7 +558,7 @@ findAudioOutputDevice:
     }
     errorMessages.append(tr("could not find PortAudio output device '%1'").
                          arg(name));
-    goto findMIDIDevice;
+    goto findMIDILatency;
 
 loadAudioOutputChannelMap:
     channelMap = map.value("audioOutputChannels", "").toList();
@@ -505,7 +594,33 @@ loadAudioOutputChannelMap:
              static_cast<synthclone::SampleChannelCount>(index));
     }
 
-findMIDIDevice:
+findMIDILatency:
+
+    // Sessions saved before the MIDI latency was configurable don't contain
+    // a latency, in which case the current latency is kept.
+    if (map.contains("midiLatency")) {
+        value = map.value("midiLatency");
+        latency = value.toInt(&success);
+        if ((! success) || (latency < MIDI_LATENCY_MINIMUM) ||
+            (latency > MIDI_LATENCY_MAXIMUM)) {
+            errorMessages.append(tr("invalid MIDI latency '%1'").
+                                 arg(value.toString()));
+        } else {
+            sampler->setMIDILatency(latency);
+        }
+    }
+
+    // Sessions saved before latency could be measured don't contain a capture
+    // latency, in which case no frames are skipped.
+    value = map.value("captureLatency", 0);
+    captureLatency = value.toLongLong(&success);
+    if ((! success) || (captureLatency < 0)) {
+        errorMessages.append(tr("invalid capture latency '%1'").
+                             arg(value.toString()));
+    } else {
+        sampler->setCaptureLatency(captureLatency);
+    }
+
     value = map.value("midiDeviceIndex", "");
     index = value.toInt(&success);
     if ((! success) || (index < 0)) {
@@ -22,6 +22,7 @@
 
 #include <synthclone/participant.h>
 
+#include "healthview.h"
 #include "sampler.h"
 #include "samplerview.h"
 
@@ -62,6 +63,21 @@ private slots:
     void
     handleChannelCountChange(synthclone::SampleChannelCount channels);
 
+    void
+    handleHealthActionTrigger();
+
+    void
+    handleHealthViewCloseRequest();
+
+    void
+    handleLatencyMeasurement(int latency);
+
+    void
+    handleLatencyMeasurementError(const QString &message);
+
+    void
+    handleMeasureLatencyActionTrigger();
+
     void
     handleMIDIError(const QString &message);
 
@@ -79,8 +95,14 @@ private:
     bool
     addSampler();
 
+    synthclone::SampleTime
+    getMaximumSampleTime() const;
+
     synthclone::MenuAction addSamplerAction;
     synthclone::Context *context;
+    synthclone::MenuAction healthAction;
+    HealthView healthView;
+    synthclone::MenuAction measureLatencyAction;
     Sampler *sampler;
     SamplerView samplerView;
 
@@ -6,6 +6,7 @@ include(../plugins.pri)
 
 HEADERS += channelmapdelegate.h \
     eventthread.h \
+    healthview.h \
     midithread.h \
     participant.h \
     plugin.h \
@@ -21,6 +22,7 @@ RCC_DIR = $${MAKEDIR}/plugins/portmedia
 RESOURCES += portmedia.qrc
 SOURCES += channelmapdelegate.cpp \
     eventthread.cpp \
+    healthview.cpp \
     midithread.cpp \
     participant.cpp \
     plugin.cpp \
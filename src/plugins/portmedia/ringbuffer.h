@@ -64,6 +64,19 @@ public:
         PaUtil_FlushRingBuffer(&ringBuffer);
     }
 
+    size_t
+    getReadableCount() const
+    {
+        return static_cast<size_t>
+            (PaUtil_GetRingBufferReadAvailable(&ringBuffer));
+    }
+
+    size_t
+    getSize() const
+    {
+        return static_cast<size_t>(ringBuffer.bufferSize);
+    }
+
     bool
     isReadable() const
     {
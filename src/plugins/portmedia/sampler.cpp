@@ -22,28 +22,52 @@
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDebug>
+#include <QtCore/QLocale>
+#include <QtCore/QStringList>
 
 #include <synthclone/error.h>
 #include <synthclone/sampleinputstream.h>
 #include <synthclone/sampleoutputstream.h>
+#include <synthclone/tracer.h>
+#include <synthclone/util.h>
 
 #include "sampler.h"
+#include "types.h"
 
 static const char *ERROR_MIDI_BUFFER = "The MIDI ringbuffer is full";
+static const char *ERROR_SAMPLE_RATE = "The sample rate is not set";
+
+// Latency is measured by playing a note on the first MIDI channel, and
+// capturing a second of audio.
+static const synthclone::MIDIData LATENCY_NOTE = 60;
+static const synthclone::SampleTime LATENCY_TIME = 1.0;
+static const synthclone::MIDIData LATENCY_VELOCITY = 127;
 
 // Callbacks
 
 int
 Sampler::handleProcessEvent(const void *input, void *output,
                             unsigned long frames,
-                            const PaStreamCallbackTimeInfo */*timeInfo*/,
+                            const PaStreamCallbackTimeInfo *timeInfo,
                             PaStreamCallbackFlags statusFlags, void *userData)
 {
     Sampler *sampler = static_cast<Sampler *>(userData);
     assert(sampler);
     return sampler->handleProcessEvent(static_cast<const float *>(input),
                                        static_cast<float *>(output), frames,
-                                       statusFlags);
+                                       timeInfo, statusFlags);
+}
+
+PmTimestamp
+Sampler::getMIDITime(void *userData)
+{
+    Sampler *sampler = static_cast<Sampler *>(userData);
+    assert(sampler);
+
+    // PortMidi schedules messages against the PortAudio stream clock, which
+    // is the clock that the audio callback uses to timestamp messages.
+    return static_cast<PmTimestamp>
+        (Pa_GetStreamTime(sampler->audioStream) * 1000.0);
 }
 
 // Class implementation
@@ -51,6 +75,7 @@ Sampler::handleProcessEvent(const void *input, void *output,
 Sampler::Sampler(const QString &name, synthclone::SampleChannelCount channels,
                  synthclone::SampleRate sampleRate, QObject *parent):
     synthclone::Sampler(name, parent),
+    captureBufferPool(true),
     commandBuffer(2),
     eventBuffer(64),
     eventThread(this),
@@ -204,18 +229,35 @@ Sampler::Sampler(const QString &name, synthclone::SampleChannelCount channels,
     }
 
     aborted = false;
+    audioInputLatency = 0.0;
     audioStream = 0;
+    captureLatency = 0;
+    command.compromised = false;
+    command.endTime = -1.0;
     command.job = 0;
+    command.releaseTime = -1.0;
     command.sampleBuffer = 0;
+    command.sampleTime = -1.0;
+    command.skipFrames = 0;
+    command.startTime = -1.0;
     command.stream = 0;
     command.totalReleaseFrames = 0;
     command.totalSampleFrames = 0;
     currentFrame = 0;
     errorMessage = 0;
+    eventBufferIndex = callbackMonitor.addBuffer(tr("Event buffer"));
     idle = true;
+    latencyBuffer = 0;
+    latencyFrames = 0;
+    midiBufferIndex = callbackMonitor.addBuffer(tr("MIDI buffer"));
+    midiLatency = MIDI_LATENCY_DEFAULT;
     midiStream = 0;
     progress = 0;
     state = STATE_IDLE;
+    streamTime = 0.0;
+
+    healthTimer.setInterval(500);
+    connect(&healthTimer, SIGNAL(timeout()), SLOT(handleHealthTimeout()));
 }
 
 Sampler::~Sampler()
@@ -256,49 +298,56 @@ Sampler::activate()
     eventBuffer.flush();
     midiBuffer.flush();
 
-    PmError pmError = Pm_OpenOutput(&midiStream,
-                                    midiDevices[midiDeviceIndex].id, 0, 0, 0,
-                                    0, 0);
-    if (pmError != pmNoError) {
-        throw synthclone::Error(tr("failed to open MIDI stream: %1").
-                                arg(Pm_GetErrorText(pmError)));
+    PaStreamParameters inputParameters;
+    const AudioDeviceData &inputData = getAudioInputDeviceData();
+    const PaDeviceInfo *info = inputData.info;
+    int inputChannels = info->maxInputChannels;
+    inputParameters.channelCount = inputChannels;
+    inputParameters.device = inputData.index;
+    inputParameters.hostApiSpecificStreamInfo = 0;
+    inputParameters.sampleFormat = paFloat32;
+    inputParameters.suggestedLatency = info->defaultHighInputLatency;
+
+    // If the sample rate isn't set, then take the sample rate from the given
+    // default sample rate for the input device.
+    synthclone::SampleRate streamSampleRate = sampleRate;
+    if (sampleRate == synthclone::SAMPLE_RATE_NOT_SET) {
+        streamSampleRate = static_cast<synthclone::SampleRate>
+            (info->defaultSampleRate);
     }
-    try {
-        PaStreamParameters inputParameters;
-        const AudioDeviceData &inputData = getAudioInputDeviceData();
-        const PaDeviceInfo *info = inputData.info;
-        int inputChannels = info->maxInputChannels;
-        inputParameters.channelCount = inputChannels;
-        inputParameters.device = inputData.index;
-        inputParameters.hostApiSpecificStreamInfo = 0;
-        inputParameters.sampleFormat = paFloat32;
-        inputParameters.suggestedLatency = info->defaultHighInputLatency;
-
-        // If the sample rate isn't set, then take the sample rate from the
-        // given default sample rate for the input device.
-        synthclone::SampleRate streamSampleRate = sampleRate;
-        if (sampleRate == synthclone::SAMPLE_RATE_NOT_SET) {
-            streamSampleRate = static_cast<synthclone::SampleRate>
-                (info->defaultSampleRate);
-        }
 
-        PaStreamParameters outputParameters;
-        const AudioDeviceData &outputData = getAudioOutputDeviceData();
-        info = outputData.info;
-        int outputChannels = info->maxOutputChannels;
-        outputParameters.channelCount = outputChannels;
-        outputParameters.device = outputData.index;
-        outputParameters.hostApiSpecificStreamInfo = 0;
-        outputParameters.sampleFormat = paFloat32;
-        outputParameters.suggestedLatency = info->defaultHighOutputLatency;
-
-        PaError paError = Pa_OpenStream(&audioStream, &inputParameters,
-                                        &outputParameters, streamSampleRate,
-                                        paFramesPerBufferUnspecified, paNoFlag,
-                                        handleProcessEvent, this);
-        if (paError != paNoError) {
-            throw synthclone::Error(tr("failed to open audio stream: %1").
-                                    arg(Pa_GetErrorText(paError)));
+    PaStreamParameters outputParameters;
+    const AudioDeviceData &outputData = getAudioOutputDeviceData();
+    info = outputData.info;
+    int outputChannels = info->maxOutputChannels;
+    outputParameters.channelCount = outputChannels;
+    outputParameters.device = outputData.index;
+    outputParameters.hostApiSpecificStreamInfo = 0;
+    outputParameters.sampleFormat = paFloat32;
+    outputParameters.suggestedLatency = info->defaultHighOutputLatency;
+
+    // The audio stream is opened first, as its clock is the time base for
+    // the MIDI stream.
+    PaError paError = Pa_OpenStream(&audioStream, &inputParameters,
+                                    &outputParameters, streamSampleRate,
+                                    paFramesPerBufferUnspecified, paNoFlag,
+                                    handleProcessEvent, this);
+    if (paError != paNoError) {
+        throw synthclone::Error(tr("failed to open audio stream: %1").
+                                arg(Pa_GetErrorText(paError)));
+    }
+    try {
+        const PaStreamInfo *streamInfo = Pa_GetStreamInfo(audioStream);
+        assert(streamInfo);
+        audioInputLatency = streamInfo->inputLatency;
+
+        PmError pmError = Pm_OpenOutput(&midiStream,
+                                        midiDevices[midiDeviceIndex].id, 0,
+                                        midiBuffer.getSize(), getMIDITime,
+                                        this, midiLatency);
+        if (pmError != pmNoError) {
+            throw synthclone::Error(tr("failed to open MIDI stream: %1").
+                                    arg(Pm_GetErrorText(pmError)));
         }
         try {
             idle = true;
@@ -316,14 +365,15 @@ Sampler::activate()
 
             eventThread.start();
             midiThread.start();
+            healthTimer.start();
             active = true;
 
         } catch (...) {
-            Pa_CloseStream(audioStream);
+            Pm_Close(midiStream);
             throw;
         }
     } catch (...) {
-        Pm_Close(midiStream);
+        Pa_CloseStream(audioStream);
         throw;
     }
 }
@@ -350,9 +400,10 @@ Sampler::copyData(const float *input, float *output, unsigned long totalFrames,
 void
 Sampler::deactivate()
 {
+    healthTimer.stop();
+
     // Stop audio processing
     Pa_StopStream(audioStream);
-    Pa_CloseStream(audioStream);
 
     // Send signals to terminate threads
     eventSemaphore.post();
@@ -362,8 +413,18 @@ Sampler::deactivate()
     eventThread.wait();
     midiThread.wait();
 
-    // Now, the MIDI stream can be closed
+    // Now, the MIDI stream can be closed.  The audio stream is closed last,
+    // as the MIDI stream gets its time from the audio stream.
     Pm_Close(midiStream);
+    Pa_CloseStream(audioStream);
+
+    // Abandon a latency measurement that hasn't finished.
+    latencyMeasurementRequested.fetchAndStoreOrdered(0);
+    float *buffer = latencyBuffer.fetchAndStoreOrdered(0);
+    if (buffer) {
+        captureBufferPool.release(buffer);
+    }
+
     active = false;
 }
 
@@ -490,12 +551,38 @@ Sampler::getAudioOutputDeviceName(int index) const
     return getAudioOutputDeviceData(index).info->name;
 }
 
+synthclone::SampleFrameCount
+Sampler::getCaptureLatency() const
+{
+    return captureLatency;
+}
+
 synthclone::SampleChannelCount
 Sampler::getChannels() const
 {
     return channels;
 }
 
+unsigned long
+Sampler::getInputOffset(const PaStreamCallbackTimeInfo *timeInfo,
+                        unsigned long frames) const
+{
+    // Gets the number of frames at the start of the current input buffer
+    // that were captured before 'command.sampleTime'.  Some host APIs don't
+    // report ADC times, in which case the time is estimated from the stream's
+    // input latency.
+    PaTime inputTime = timeInfo->inputBufferAdcTime;
+    if (inputTime <= 0.0) {
+        inputTime = streamTime - audioInputLatency;
+    }
+    if ((inputTime >= command.sampleTime) ||
+        (sampleRate == synthclone::SAMPLE_RATE_NOT_SET)) {
+        return 0;
+    }
+    double offset = ceil((command.sampleTime - inputTime) * sampleRate);
+    return offset >= frames ? frames : static_cast<unsigned long>(offset);
+}
+
 int
 Sampler::getMIDIDeviceCount() const
 {
@@ -515,33 +602,64 @@ Sampler::getMIDIDeviceName(int index) const
     return midiDevices[index].info->name;
 }
 
+int
+Sampler::getMIDILatency() const
+{
+    return midiLatency;
+}
+
+PaTime
+Sampler::getMIDIOutputTime() const
+{
+    // MIDI messages that are queued in the current cycle reach the device
+    // 'midiLatency' milliseconds after their timestamps.
+    return (static_cast<PmTimestamp>(streamTime * 1000.0) + midiLatency) /
+        1000.0;
+}
+
 synthclone::SampleRate
 Sampler::getSampleRate() const
 {
     return sampleRate;
 }
 
+void
+Sampler::handleHealthTimeout()
+{
+    emit healthChanged(callbackMonitor.read());
+}
+
 int
 Sampler::handleProcessEvent(const float *input, float *output,
                             unsigned long frames,
+                            const PaStreamCallbackTimeInfo *timeInfo,
                             PaStreamCallbackFlags statusFlags)
 {
+    callbackMonitor.startCycle();
+    streamTime = timeInfo->currentTime;
+    Event event;
     bool genericCopy = true;
     const synthclone::SamplerJob *job;
     synthclone::MIDIData midiChannel;
     synthclone::SampleFrameCount processedFrames;
+    unsigned long recordFrames;
+    unsigned long startFrame;
     const synthclone::Zone *zone;
 
     if (statusFlags & paInputOverflow) {
+        callbackMonitor.addXrun();
         sendSimpleEvent(Event::TYPE_INPUT_OVERFLOW);
     }
     if (statusFlags & paInputUnderflow) {
+        callbackMonitor.addXrun();
         sendSimpleEvent(Event::TYPE_INPUT_UNDERFLOW);
     }
     if (statusFlags & paOutputOverflow) {
+        callbackMonitor.addXrun();
         sendSimpleEvent(Event::TYPE_OUTPUT_OVERFLOW);
     }
     if (statusFlags & paOutputUnderflow) {
+        callbackMonitor.addXrun();
         sendSimpleEvent(Event::TYPE_OUTPUT_UNDERFLOW);
     }
 
@@ -550,6 +668,19 @@ Sampler::handleProcessEvent(const float *input, float *output,
     // Waiting for commands
     case STATE_IDLE:
     idle:
+        if (latencyMeasurementRequested.fetchAndStoreOrdered(0)) {
+            command.job = 0;
+            command.sampleBuffer = latencyBuffer;
+            command.totalSampleFrames = latencyFrames;
+            currentFrame = 0;
+            if (! sendMIDIMessage(0x90, LATENCY_NOTE, LATENCY_VELOCITY)) {
+                state = STATE_LATENCY_ERROR;
+                goto latencyError;
+            }
+            command.sampleTime = getMIDIOutputTime();
+            state = STATE_LATENCY_MEASURE;
+            break;
+        }
         while (commandBuffer.isReadable()) {
             commandBuffer.read(command);
             job = command.job;
@@ -557,6 +688,10 @@ Sampler::handleProcessEvent(const float *input, float *output,
                 aborted = false;
                 currentFrame = 0;
                 errorMessage = 0;
+                command.compromised = false;
+                command.releaseTime = -1.0;
+                command.sampleTime = -1.0;
+                command.startTime = streamTime;
                 if (job->getType() == synthclone::SamplerJob::TYPE_SAMPLE) {
                     state = STATE_SAMPLE_SEND_PRE_MIDI;
                     goto sampleSendPreMIDI;
@@ -601,6 +736,13 @@ Sampler::handleProcessEvent(const float *input, float *output,
         if (state == STATE_ERROR) {
             goto error;
         }
+
+        // The note-on time is converted from frames, which requires a sample
+        // rate.  Fail before any MIDI messages are sent.
+        if (sampleRate == synthclone::SAMPLE_RATE_NOT_SET) {
+            setErrorState(ERROR_SAMPLE_RATE);
+            goto error;
+        }
         zone = command.job->getZone();
 
         {
@@ -634,6 +776,8 @@ Sampler::handleProcessEvent(const float *input, float *output,
                 }
             }
         }
+        command.sampleTime = getMIDIOutputTime() +
+            (static_cast<PaTime>(command.skipFrames) / sampleRate);
         state = STATE_SAMPLE;
         break;
 
@@ -648,16 +792,32 @@ Sampler::handleProcessEvent(const float *input, float *output,
         default:
             ;
         }
+
+        // Input that was dropped or padded by PortAudio leaves a gap in the
+        // captured audio.
+        if (statusFlags & (paInputOverflow | paInputUnderflow)) {
+            command.compromised = true;
+        }
+
+        // Skip the input that was captured before the sound produced by the
+        // note-on message arrived, so that the onset is always at the start
+        // of the sample.
         genericCopy = false;
-        processedFrames = recordData(input, output, frames);
-        if (static_cast<unsigned long>(processedFrames) >= frames) {
-            currentFrame += frames;
+        startFrame = currentFrame ? 0 : getInputOffset(timeInfo, frames);
+        copyData(input, output, startFrame, 0);
+        recordFrames = frames - startFrame;
+        processedFrames =
+            recordData(input + (startFrame * audioInputDeviceChannelCount),
+                       output + (startFrame * audioOutputDeviceChannelCount),
+                       recordFrames);
+        if (static_cast<unsigned long>(processedFrames) >= recordFrames) {
+            currentFrame += recordFrames;
             sendProgressEvent(static_cast<float>(currentFrame) /
                               (command.totalSampleFrames +
                                command.totalReleaseFrames));
             break;
         }
-        copyData(input, output, frames, processedFrames);
+        copyData(input, output, frames, startFrame + processedFrames);
         sendProgressEvent(static_cast<float>(command.totalSampleFrames) /
                           (command.totalSampleFrames +
                            command.totalReleaseFrames));
@@ -669,6 +829,7 @@ Sampler::handleProcessEvent(const float *input, float *output,
             goto error;
         }
         currentFrame = 0;
+        command.releaseTime = streamTime;
         state = STATE_SAMPLE_RELEASE;
         break;
 
@@ -744,10 +905,55 @@ Sampler::handleProcessEvent(const float *input, float *output,
             goto idle;
         }
         break;
+
+    // Three states for measuring latency.  The capture is aligned with the
+    // note-on message just like it is for 'sample' commands, so that the
+    // measured latency is the number of frames that should be skipped when
+    // sampling.
+    case STATE_LATENCY_MEASURE:
+        genericCopy = false;
+        startFrame = currentFrame ? 0 : getInputOffset(timeInfo, frames);
+        copyData(input, output, startFrame, 0);
+        recordFrames = frames - startFrame;
+        processedFrames =
+            recordData(input + (startFrame * audioInputDeviceChannelCount),
+                       output + (startFrame * audioOutputDeviceChannelCount),
+                       recordFrames);
+        currentFrame += processedFrames;
+        if (currentFrame < command.totalSampleFrames) {
+            break;
+        }
+        copyData(input, output, frames, startFrame + processedFrames);
+        if (! (sendMIDIMessage(0x80, LATENCY_NOTE, LATENCY_VELOCITY) &&
+               sendMIDIMessage(0xb0, 0x78, 0))) {
+            state = STATE_LATENCY_ERROR;
+            goto latencyError;
+        }
+        state = STATE_LATENCY_MEASURED;
+        // Fallthrough on purpose.
+
+    case STATE_LATENCY_MEASURED:
+        if (sendSimpleEvent(Event::TYPE_LATENCY_MEASURED)) {
+            state = STATE_IDLE;
+            goto idle;
+        }
+        break;
+
+    case STATE_LATENCY_ERROR:
+    latencyError:
+        event.data.message = errorMessage;
+        event.type = Event::TYPE_LATENCY_ERROR;
+        if (sendEvent(event)) {
+            state = STATE_IDLE;
+            goto idle;
+        }
+        break;
     }
     if (genericCopy) {
         copyData(input, output, frames, 0);
     }
+    callbackMonitor.endCycle(static_cast<synthclone::SampleFrameCount>(frames),
+                             sampleRate);
     return paContinue;
 }
 
@@ -767,6 +973,36 @@ Sampler::isActive() const
     return active;
 }
 
+void
+Sampler::measureLatency()
+{
+    assert(active);
+    if (latencyBuffer) {
+        // A measurement is already being made.
+        return;
+    }
+    if (sampleRate == synthclone::SAMPLE_RATE_NOT_SET) {
+        emit latencyMeasurementError
+            (tr("latency can't be measured until the sample rate is set"));
+        return;
+    }
+    synthclone::SampleFrameCount frames =
+        static_cast<synthclone::SampleFrameCount>(LATENCY_TIME * sampleRate);
+    float *buffer;
+    try {
+        buffer = captureBufferPool.acquire(channels * frames);
+    } catch (synthclone::Error &e) {
+        emit latencyMeasurementError(e.getMessage());
+        return;
+    }
+
+    // The buffer and frame count are published before the measurement is
+    // requested, so the audio callback sees both when it sees the request.
+    latencyFrames = frames;
+    latencyBuffer.fetchAndStoreOrdered(buffer);
+    latencyMeasurementRequested.fetchAndStoreOrdered(1);
+}
+
 void
 Sampler::monitorEvents()
 {
@@ -781,14 +1017,16 @@ Sampler::monitorEvents()
         eventBuffer.read(event);
         switch (event.type) {
         case Event::TYPE_ABORTED:
+            command = &(event.data.command);
+            traceCommand(*command);
             idle = true;
             emit statusChanged(tr("Idle."));
             emit jobAborted();
-            emit progressChanged(0.0);
-            command = &(event.data.command);
+            reportProgress(0.0);
             break;
         case Event::TYPE_COMPLETE:
             command = &(event.data.command);
+            traceCommand(*command);
             job = command->job;
             if (job->getType() == synthclone::SamplerJob::TYPE_SAMPLE) {
                 synthclone::SampleOutputStream *stream =
@@ -799,15 +1037,58 @@ Sampler::monitorEvents()
             }
             idle = true;
             emit statusChanged(tr("Idle."));
-            emit jobCompleted();
-            emit progressChanged(0.0);
+            if (command->compromised) {
+                emit jobCompromised(tr("an input overflow or underflow "
+                                       "occurred while sampling"));
+            } else {
+                emit jobCompleted();
+            }
+            reportProgress(0.0);
             break;
         case Event::TYPE_ERROR:
+            command = &(event.data.error.command);
+            traceCommand(*command);
             idle = true;
             emit statusChanged(tr("Idle."));
             emit jobError(event.data.error.message);
-            command = &(event.data.error.command);
             break;
+        case Event::TYPE_LATENCY_ERROR:
+            {
+                float *buffer = latencyBuffer.fetchAndStoreOrdered(0);
+                if (buffer) {
+                    captureBufferPool.release(buffer);
+                }
+            }
+            emit latencyMeasurementError(event.data.message);
+            continue;
+        case Event::TYPE_LATENCY_MEASURED:
+            {
+                // The frame count is read before the buffer is taken back,
+                // as 'measureLatency()' may start another measurement as soon
+                // as the buffer is cleared.
+                synthclone::SampleFrameCount frames = latencyFrames;
+                float *buffer = latencyBuffer.fetchAndStoreOrdered(0);
+                if (! buffer) {
+                    // The sampler was deactivated.
+                    continue;
+                }
+                synthclone::SampleFrameCount latency =
+                    synthclone::findOnset(buffer, frames, channels);
+                captureBufferPool.release(buffer);
+                if (latency == -1) {
+                    emit latencyMeasurementError
+                        (tr("no sound was captured while the test note was "
+                            "played"));
+                } else {
+                    if (idle) {
+                        emit statusChanged
+                            (tr("Measured latency: %1 frames").
+                             arg(QLocale::system().toString(latency)));
+                    }
+                    emit latencyMeasured(static_cast<int>(latency));
+                }
+            }
+            continue;
         case Event::TYPE_INPUT_OVERFLOW:
             qWarning() << "PortMedia input overflow detected.";
             continue;
@@ -821,12 +1102,12 @@ Sampler::monitorEvents()
             qWarning() << "PortMedia output underflow detected.";
             continue;
         case Event::TYPE_PROGRESS:
-            emit progressChanged(event.data.progress);
+            reportProgress(event.data.progress);
             continue;
         default:
             assert(false);
         }
-        delete[] command->sampleBuffer;
+        captureBufferPool.release(command->sampleBuffer);
     }
 }
 
@@ -892,9 +1173,9 @@ Sampler::runMIDI()
         if (! midiBuffer.isReadable()) {
             break;
         }
-        PmMessage message;
-        midiBuffer.read(message);
-        PmError pmError = Pm_WriteShort(midiStream, 0, message);
+        PmEvent event;
+        midiBuffer.read(event);
+        PmError pmError = Pm_Write(midiStream, &event, 1);
         if (pmError != pmNoError) {
             QString s(Pm_GetErrorText(pmError));
             emit midiError(s);
@@ -902,6 +1183,33 @@ Sampler::runMIDI()
     }
 }
 
+void
+Sampler::reserveCaptureBuffers(synthclone::SampleTime sampleTime)
+{
+    captureBufferPool.reserve(1, static_cast<qint64>
+                              (sampleTime * sampleRate) * channels);
+}
+
+void
+Sampler::reserveCaptureBuffers(const synthclone::SamplerJob *job)
+{
+    if (active && (job->getType() == synthclone::SamplerJob::TYPE_SAMPLE)) {
+        try {
+            reserveCaptureBuffers(job->getZone()->getSampleTime());
+        } catch (synthclone::Error &e) {
+            // The buffer will be allocated when the job is started.
+            qWarning() << e.getMessage();
+        }
+    }
+}
+
+void
+Sampler::resetHealth()
+{
+    callbackMonitor.reset();
+    emit healthChanged(callbackMonitor.read());
+}
+
 void
 Sampler::sendCommand(const Command &command)
 {
@@ -912,6 +1220,7 @@ Sampler::sendCommand(const Command &command)
 bool
 Sampler::sendErrorEvent()
 {
+    command.endTime = streamTime;
     Event event;
     memcpy(static_cast<void *>(&(event.data.error.command)),
            static_cast<void *>(&command), sizeof(Command));
@@ -927,12 +1236,16 @@ Sampler::sendEvent(const Event &event)
     if (result) {
         eventSemaphore.post();
     }
+    callbackMonitor.updateBufferUsage(eventBufferIndex,
+                                      eventBuffer.getReadableCount(),
+                                      eventBuffer.getSize());
     return result;
 }
 
 bool
 Sampler::sendJobFinalizationEvent(Event::Type type)
 {
+    command.endTime = streamTime;
     Event event;
     memcpy(static_cast<void *>(&(event.data.command)),
            static_cast<void *>(&command), sizeof(Command));
@@ -950,19 +1263,27 @@ Sampler::sendMIDIMessage(synthclone::MIDIData status,
                          synthclone::MIDIData data2)
 {
     if (! midiBuffer.isWritable()) {
+        callbackMonitor.addMIDIFailure();
         setErrorState(ERROR_MIDI_BUFFER);
         return false;
     }
     assert(data1 < 0x80);
-    PmMessage message;
+    PmEvent event;
     if (data2 == synthclone::MIDI_VALUE_NOT_SET) {
-        message = Pm_Message(status, data1, 0);
+        event.message = Pm_Message(status, data1, 0);
     } else {
         assert(data2 < 0x80);
-        message = Pm_Message(status, data1, data2);
+        event.message = Pm_Message(status, data1, data2);
     }
-    bool sent = midiBuffer.write(message);
+
+    // PortMidi sends the message 'midiLatency' milliseconds after this time,
+    // regardless of when the MIDI thread gets around to writing it.
+    event.timestamp = static_cast<PmTimestamp>(streamTime * 1000.0);
+    bool sent = midiBuffer.write(event);
     assert(sent);
+    callbackMonitor.updateBufferUsage(midiBufferIndex,
+                                      midiBuffer.getReadableCount(),
+                                      midiBuffer.getSize());
     midiSemaphore.post();
     return true;
 }
@@ -1091,6 +1412,13 @@ Sampler::setAudioOutputDeviceIndex(int index)
     }
 }
 
+void
+Sampler::setCaptureLatency(synthclone::SampleFrameCount latency)
+{
+    assert(latency >= 0);
+    captureLatency = latency;
+}
+
 void
 Sampler::setChannels(synthclone::SampleChannelCount channels)
 {
@@ -1152,6 +1480,18 @@ Sampler::setMIDIDeviceIndex(int index)
     }
 }
 
+void
+Sampler::setMIDILatency(int latency)
+{
+    assert(! active);
+    assert((latency >= MIDI_LATENCY_MINIMUM) &&
+           (latency <= MIDI_LATENCY_MAXIMUM));
+    if (latency != midiLatency) {
+        midiLatency = latency;
+        emit midiLatencyChanged(latency);
+    }
+}
+
 void
 Sampler::setSampleRate(synthclone::SampleRate sampleRate)
 {
@@ -1180,27 +1520,81 @@ Sampler::startJob(const synthclone::SamplerJob &job,
         synthclone::SampleFrameCount releaseFrames =
             zone->getReleaseTime() * sampleRate;
         sampleFrames = zone->getSampleTime() * sampleRate;
-        sampleBuffer = new float[channels * sampleFrames];
+        sampleBuffer = captureBufferPool.acquire(channels * sampleFrames);
         emit statusChanged(tr("Sampling ..."));
         command.totalReleaseFrames = releaseFrames;
     } else {
         sampleFrames = stream.getFrames();
-        sampleBuffer = new float[channels * sampleFrames];
+        sampleBuffer = captureBufferPool.acquire(channels * sampleFrames);
         synthclone::SampleInputStream *inputStream =
             qobject_cast<synthclone::SampleInputStream *>(&stream);
-        synthclone::SampleFrameCount count =
-            inputStream->read(sampleBuffer, sampleFrames);
+        synthclone::SampleFrameCount count;
+        try {
+            count = inputStream->read(sampleBuffer, sampleFrames);
+        } catch (...) {
+            captureBufferPool.release(sampleBuffer);
+            throw;
+        }
         assert(count == sampleFrames);
         emit statusChanged(tr("Playing sample ..."));
     }
     command.job = &job;
     command.sampleBuffer = sampleBuffer;
+    command.skipFrames = captureLatency;
     command.stream = &stream;
     command.totalSampleFrames = sampleFrames;
     idle = false;
     sendCommand(command);
 }
 
+void
+Sampler::traceCommand(const Command &command)
+{
+    synthclone::Tracer *tracer = synthclone::Tracer::getActive();
+    if (! tracer) {
+        return;
+    }
+
+    // Convert stream times, which are in seconds, to tracer times.
+    double offset = (static_cast<double>(tracer->getTime()) / 1000000.0) -
+        Pa_GetStreamTime(audioStream);
+    const synthclone::Zone *zone = command.job->getZone();
+    QVariantMap arguments;
+    arguments["channel"] = static_cast<int>(zone->getChannel());
+    arguments["note"] = static_cast<int>(zone->getNote());
+    arguments["velocity"] = static_cast<int>(zone->getVelocity());
+    QString threadName = "PortAudio callback";
+
+    PaTime endTime = command.endTime;
+    PaTime startTime = command.startTime;
+    QList<PaTime> times;
+    QStringList names;
+    if (command.job->getType() != synthclone::SamplerJob::TYPE_SAMPLE) {
+        names << "play";
+        times << startTime;
+    } else {
+        names << "pre-MIDI";
+        times << startTime;
+        if (command.sampleTime >= 0.0) {
+            names << "sample";
+            times << command.sampleTime;
+        }
+        if (command.releaseTime >= 0.0) {
+            names << "release";
+            times << command.releaseTime;
+        }
+    }
+    times << endTime;
+    for (int i = 0; i < names.count(); i++) {
+        qint64 spanStartTime =
+            static_cast<qint64>((times[i] + offset) * 1000000.0);
+        qint64 duration =
+            static_cast<qint64>((times[i + 1] - times[i]) * 1000000.0);
+        tracer->addSpan("sampler", names[i], spanStartTime, duration, -1,
+                        arguments, threadName);
+    }
+}
+
 void
 Sampler::updateCommandState()
 {
@@ -23,8 +23,13 @@
 #include <portaudio.h>
 #include <portmidi.h>
 
+#include <QtCore/QAtomicInt>
+#include <QtCore/QAtomicPointer>
 #include <QtCore/QList>
+#include <QtCore/QTimer>
 
+#include <synthclone/callbackmonitor.h>
+#include <synthclone/capturebufferpool.h>
 #include <synthclone/sampler.h>
 #include <synthclone/semaphore.h>
 
@@ -101,6 +106,9 @@ public:
     QString
     getAudioOutputDeviceName(int index) const;
 
+    synthclone::SampleFrameCount
+    getCaptureLatency() const;
+
     synthclone::SampleChannelCount
     getChannels() const;
 
@@ -113,14 +121,37 @@ public:
     QString
     getMIDIDeviceName(int index) const;
 
+    int
+    getMIDILatency() const;
+
     synthclone::SampleRate
     getSampleRate() const;
 
     bool
     isActive() const;
 
+    // Makes sure that starting a sampling job that's up to 'sampleTime'
+    // seconds long doesn't need to allocate memory.
+    void
+    reserveCaptureBuffers(synthclone::SampleTime sampleTime);
+
 public slots:
 
+    // Plays a test note, and captures the sound it produces.  The offset of
+    // the onset in the captured audio is reported with 'latencyMeasured()'.
+    // If a job is being run, then the measurement is made after the job is
+    // finished.
+    void
+    measureLatency();
+
+    // Reserves a capture buffer for a job when the job is queued, rather than
+    // when the job is started.
+    void
+    reserveCaptureBuffers(const synthclone::SamplerJob *job);
+
+    void
+    resetHealth();
+
     void
     setAudioAPIIndex(int index);
 
@@ -138,12 +169,24 @@ public slots:
     void
     setAudioOutputDeviceIndex(int index);
 
+    // Sets the number of frames that are skipped at the start of every
+    // capture, in addition to the frames that precede the note-on message.
+    void
+    setCaptureLatency(synthclone::SampleFrameCount latency);
+
     void
     setChannels(synthclone::SampleChannelCount channels);
 
     void
     setMIDIDeviceIndex(int index);
 
+    // Sets the delay, in milliseconds, between the time a MIDI message is
+    // queued by the audio callback and the time it's sent to the device.  The
+    // delay must be large enough to cover the scheduling jitter of the MIDI
+    // thread; in exchange, captured onsets end up at a fixed offset.
+    void
+    setMIDILatency(int latency);
+
     void
     setSampleRate(synthclone::SampleRate sampleRate);
 
@@ -185,15 +228,32 @@ signals:
     void
     channelsChanged(synthclone::SampleChannelCount channels);
 
+    void
+    healthChanged(const synthclone::CallbackHealth &health);
+
+    void
+    latencyMeasured(int latency);
+
+    void
+    latencyMeasurementError(const QString &message);
+
     void
     midiDeviceIndexChanged(int index);
 
     void
     midiError(const QString &message);
 
+    void
+    midiLatencyChanged(int latency);
+
     void
     sampleRateChanged(synthclone::SampleRate sampleRate);
 
+private slots:
+
+    void
+    handleHealthTimeout();
+
 private:
 
     struct AudioDeviceData {
@@ -221,9 +281,21 @@ private:
 
     typedef QList<MIDIDeviceData> MIDIDeviceDataList;
 
+    // The times are PortAudio stream times, set by the audio callback so that
+    // the states of the job can be traced after the job is finished.  A time
+    // is negative if the job never reached the state.  'sampleTime' is the
+    // time at which the note-on message is scheduled to reach the device,
+    // plus 'skipFrames' frames of capture latency; input that precedes it
+    // isn't captured.
     struct Command {
+        bool compromised;
+        PaTime endTime;
         const synthclone::SamplerJob *job;
+        PaTime releaseTime;
         float *sampleBuffer;
+        PaTime sampleTime;
+        synthclone::SampleFrameCount skipFrames;
+        PaTime startTime;
         synthclone::SampleStream *stream;
         synthclone::SampleFrameCount totalReleaseFrames;
         synthclone::SampleFrameCount totalSampleFrames;
@@ -237,6 +309,8 @@ private:
             TYPE_ERROR,
             TYPE_INPUT_OVERFLOW,
             TYPE_INPUT_UNDERFLOW,
+            TYPE_LATENCY_ERROR,
+            TYPE_LATENCY_MEASURED,
             TYPE_OUTPUT_OVERFLOW,
             TYPE_OUTPUT_UNDERFLOW,
             TYPE_PROGRESS
@@ -250,6 +324,7 @@ private:
                 const char *message;
             } error;
             Command command;
+            const char *message;
             float progress;
         } data;
     };
@@ -259,6 +334,9 @@ private:
         STATE_COMPLETED,
         STATE_ERROR,
         STATE_IDLE,
+        STATE_LATENCY_ERROR,
+        STATE_LATENCY_MEASURE,
+        STATE_LATENCY_MEASURED,
         STATE_PLAY,
         STATE_SAMPLE,
         STATE_SAMPLE_SEND_PRE_MIDI,
@@ -272,6 +350,9 @@ private:
                        const PaStreamCallbackTimeInfo *timeInfo,
                        PaStreamCallbackFlags statusFlags, void *userData);
 
+    static PmTimestamp
+    getMIDITime(void *userData);
+
     // Members
 
     void
@@ -290,8 +371,16 @@ private:
     const AudioDeviceData &
     getAudioOutputDeviceData(int index) const;
 
+    unsigned long
+    getInputOffset(const PaStreamCallbackTimeInfo *timeInfo,
+                   unsigned long frames) const;
+
+    PaTime
+    getMIDIOutputTime() const;
+
     int
     handleProcessEvent(const float *input, float *output, unsigned long frames,
+                       const PaStreamCallbackTimeInfo *timeInfo,
                        PaStreamCallbackFlags statusFlags);
 
     void
@@ -334,6 +423,9 @@ private:
     void
     setErrorState(const char *message);
 
+    void
+    traceCommand(const Command &command);
+
     void
     updateCommandState();
 
@@ -344,28 +436,40 @@ private:
     synthclone::SampleChannelCount *audioInputChannelIndices;
     synthclone::SampleChannelCount audioInputDeviceChannelCount;
     int audioInputDeviceIndex;
+    PaTime audioInputLatency;
     synthclone::SampleChannelCount *audioOutputChannelIndices;
     synthclone::SampleChannelCount audioOutputDeviceChannelCount;
     int audioOutputDeviceIndex;
     PaStream *audioStream;
+    synthclone::CallbackMonitor callbackMonitor;
+    synthclone::CaptureBufferPool captureBufferPool;
+    synthclone::SampleFrameCount captureLatency;
     synthclone::SampleChannelCount channels;
     Command command;
     RingBuffer<Command> commandBuffer;
     synthclone::SampleFrameCount currentFrame;
     const char *errorMessage;
     RingBuffer<Event> eventBuffer;
+    int eventBufferIndex;
     synthclone::Semaphore eventSemaphore;
     EventThread eventThread;
+    QTimer healthTimer;
     bool idle;
-    RingBuffer<PmMessage> midiBuffer;
+    QAtomicPointer<float> latencyBuffer;
+    synthclone::SampleFrameCount latencyFrames;
+    QAtomicInt latencyMeasurementRequested;
+    RingBuffer<PmEvent> midiBuffer;
+    int midiBufferIndex;
     MIDIDeviceDataList midiDevices;
     int midiDeviceIndex;
+    int midiLatency;
     synthclone::Semaphore midiSemaphore;
     PortMidiStream *midiStream;
     MIDIThread midiThread;
     int progress;
     synthclone::SampleRate sampleRate;
     State state;
+    PaTime streamTime;
 
 };
 
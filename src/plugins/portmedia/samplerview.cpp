@@ -90,6 +90,11 @@ SamplerView::SamplerView(QObject *parent):
     connect(midiDevice, SIGNAL(activated(int)),
             SIGNAL(midiDeviceChangeRequest(int)));
 
+    midiLatency = synthclone::getChild<QSpinBox>(rootWidget, "midiLatency");
+    midiLatency->setRange(MIDI_LATENCY_MINIMUM, MIDI_LATENCY_MAXIMUM);
+    connect(midiLatency, SIGNAL(valueChanged(int)),
+            SIGNAL(midiLatencyChangeRequest(int)));
+
     name = synthclone::getChild<QLineEdit>(rootWidget, "name");
     connect(name, SIGNAL(textEdited(const QString &)),
             SIGNAL(nameChangeRequest(const QString &)));
@@ -245,6 +250,12 @@ SamplerView::setMIDIDevice(int index)
     midiDevice->setCurrentIndex(index);
 }
 
+void
+SamplerView::setMIDILatency(int latency)
+{
+    midiLatency->setValue(latency);
+}
+
 void
 SamplerView::setModelData(int row, int column, const QVariant &value, int role)
 {
@@ -23,6 +23,7 @@
 #include <QtGui/QComboBox>
 #include <QtGui/QLineEdit>
 #include <QtGui/QPushButton>
+#include <QtGui/QSpinBox>
 #include <QtGui/QStandardItemModel>
 #include <QtGui/QTableView>
 
@@ -94,6 +95,9 @@ public slots:
     void
     setMIDIDevice(int index);
 
+    void
+    setMIDILatency(int latency);
+
     void
     setName(const QString &name);
 
@@ -125,6 +129,9 @@ signals:
     void
     midiDeviceChangeRequest(int index);
 
+    void
+    midiLatencyChangeRequest(int latency);
+
     void
     nameChangeRequest(const QString &name);
 
@@ -143,6 +150,7 @@ private:
     QTableView *channelMapTableView;
     QPushButton *closeButton;
     QComboBox *midiDevice;
+    QSpinBox *midiLatency;
     QLineEdit *name;
 
 };
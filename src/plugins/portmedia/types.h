@@ -26,4 +26,10 @@ enum ChannelMapTableColumn {
     CHANNELMAPTABLECOLUMN_TOTAL = 2
 };
 
+// The delay, in milliseconds, that PortMidi adds to the time at which a MIDI
+// message is queued before the message is sent to the device.
+const int MIDI_LATENCY_DEFAULT = 20;
+const int MIDI_LATENCY_MAXIMUM = 1000;
+const int MIDI_LATENCY_MINIMUM = 1;
+
 #endif
@@ -19,37 +19,28 @@
 
 #include <cassert>
 #include <cerrno>
+#include <cstring>
 
+#include <QtCore/QBuffer>
+#include <QtCore/QDebug>
 #include <QtCore/QFileInfo>
-#include <QtCore/QTemporaryFile>
 
 #include <synthclone/error.h>
+#include <synthclone/samplecopier.h>
+#include <synthclone/sampleinputstream.h>
+#include <synthclone/sampleoutputstream.h>
+#include <synthclone/util.h>
 
 #include "archivewriter.h"
 
 // Static data
 
-struct ArchiveDestructor {
-
-    static void
-    cleanup(zip *archive)
-    {
-        if (archive) {
-            if (zip_close(archive) == -1) {
-                throw synthclone::Error(QString("zip_close(): %1").
-                                        arg(zip_strerror(archive)));
-            }
-        }
-    }
-
-};
-
 zip_int64_t
-ArchiveWriter::handleSourceCommand(void *writer, void *data,
+ArchiveWriter::handleSourceCommand(void *source, void *data,
                                    zip_uint64_t length, zip_source_cmd command)
 {
-    return static_cast<ArchiveWriter *>(writer)->
-        handleSourceCommand(data, length, command);
+    Source *s = static_cast<Source *>(source);
+    return s->writer->handleSourceCommand(*s, data, length, command);
 }
 
 // Class definition
@@ -65,94 +56,127 @@ ArchiveWriter::ArchiveWriter(const QString &path, const QString &instrumentName,
                                     arg(path).arg(file.errorString()));
         }
     }
+    QByteArray pathBytes = path.toLocal8Bit();
+    int error;
+    archive = zip_open(pathBytes.constData(), ZIP_CREATE, &error);
+    if (! archive) {
+        char errorMessage[1024];
+        zip_error_to_str(errorMessage, 1024, error, errno);
+        throw synthclone::Error(tr("failed to open zip archive '%1': %2").
+                                arg(path).arg(errorMessage));
+    }
     fileCount = 0;
+    sampleCount = 0;
     this->instrumentName = instrumentName;
     this->path = path;
+    samplesWritten = 0;
 }
 
 ArchiveWriter::~ArchiveWriter()
 {
-    // Empty
+    if (archive) {
+        discard();
+    }
+    qDeleteAll(sources);
 }
 
 void
 ArchiveWriter::addConfiguration(const QString &configuration)
 {
-    QTemporaryFile tempFile;
-    if (! tempFile.open()) {
-        throw synthclone::Error(tr("failed to open temporary file: %1").
-                                arg(tempFile.errorString()));
-    }
-    tempFile.write(configuration.toLocal8Bit());
-    tempFile.close();
-
-    addFile(tempFile.fileName(), "Instrument.xml", ZIP_CM_STORE);
-    //addFile(tempFile.fileName(), "Instrument.xml", ZIP_CM_DEFLATE);
+    Source *source = new Source();
+    source->data = configuration.toLocal8Bit();
+    source->sample = 0;
+    addSource(source, "Instrument.xml");
 }
 
 void
-ArchiveWriter::addFile(const QString &path, const QString &entry,
-                       zip_uint16_t compressionMethod)
+ArchiveWriter::addSample(const QString &name, const synthclone::Sample &sample)
 {
-    // Open the archive.
-    QByteArray pathBytes = this->path.toLocal8Bit();
-    int error;
-    zip *archive = zip_open(pathBytes.constData(), ZIP_CREATE, &error);
-    if (! archive) {
-        char errorMessage[1024];
-        zip_error_to_str(errorMessage, 1024, error, errno);
-        throw synthclone::Error(tr("failed to open zip archive '%1': %2").
-                                arg(this->path).arg(errorMessage));
+    QString n = QString::number(fileCount);
+    if (n.count() == 1) {
+        n = "0" + n;
     }
-    QScopedPointer<zip, ArchiveDestructor> archivePtr(archive);
+    QString entry = QString("SampleData/Sample%1 (%2).flac").arg(n).arg(name);
+    Source *source = new Source();
+    source->sample = &sample;
+    addSource(source, entry);
+    sampleCount++;
+}
+
+void
+ArchiveWriter::addSource(Source *source, const QString &entry)
+{
+    CONFIRM(archive, tr("archive has already been committed"));
+
+    source->position = 0;
+    source->systemError = 0;
+    source->writer = this;
+    source->zipError = ZIP_ER_OK;
+    sources.append(source);
 
-    // Prepare the source.
-    zip_source *source = zip_source_function(archive, handleSourceCommand,
-                                             this);
-    if (! source) {
+    zip_source *zipSource = zip_source_function(archive, handleSourceCommand,
+                                                source);
+    if (! zipSource) {
         throw synthclone::Error(tr("zip_source_function(): %1").
                                 arg(zip_strerror(archive)));
     }
-    sourceCompressionMethod = compressionMethod;
-    sourceFile = new QFile(path);
-    QScopedPointer<QFile> sourceFilePtr(sourceFile);
-
-    // Add the source.
     QByteArray entryBytes = entry.toLocal8Bit();
-    zip_int64_t result = zip_add(archive, entryBytes.constData(), source);
+    zip_int64_t result = zip_add(archive, entryBytes.constData(), zipSource);
     if (result == -1) {
-        zip_source_free(source);
-        sourceFile = 0;
+        zip_source_free(zipSource);
         throw synthclone::Error(tr("zip_add(): %1").arg(zip_strerror(archive)));
     }
-
-    // Closing the archive gets the file added to the archive.
-    archivePtr.reset();
-
     fileCount++;
 }
 
 void
-ArchiveWriter::addSample(const QString &name, const synthclone::Sample &sample)
+ArchiveWriter::commit()
 {
-    QString n = QString::number(fileCount);
-    if (n.count() == 1) {
-        n = "0" + n;
+    CONFIRM(archive, tr("archive has already been committed"));
+
+    // libzip reads every source and writes the archive when it's closed.
+    samplesWritten = 0;
+    if (zip_close(archive) == -1) {
+        QString message = sourceErrorMessage.isEmpty() ?
+            QString("zip_close(): %1").arg(zip_strerror(archive)) :
+            sourceErrorMessage;
+        discard();
+        throw synthclone::Error(message);
     }
-    QString entry = QString("SampleData/Sample%1 (%2).flac").arg(n).arg(name);
-    addFile(sample.getPath(), entry, ZIP_CM_STORE);
+    archive = 0;
+}
+
+void
+ArchiveWriter::discard()
+{
+    assert(archive);
+
+    // Reverting all changes before closing the archive makes sure that
+    // nothing gets written.
+    zip_unchange_all(archive);
+    if (zip_close(archive) == -1) {
+        qWarning() << tr("failed to discard zip archive '%1': %2").
+            arg(path, zip_strerror(archive));
+    }
+    archive = 0;
 }
 
 zip_int64_t
-ArchiveWriter::handleSourceCommand(void *data, zip_uint64_t length,
-                                   zip_source_cmd command)
+ArchiveWriter::handleSourceCommand(Source &source, void *data,
+                                   zip_uint64_t length, zip_source_cmd command)
 {
     int *errors;
-    qint64 readResult;
+    qint64 readSize;
     struct zip_stat *statData;
     switch (command) {
     case ZIP_SOURCE_CLOSE:
-        sourceFile->close();
+        if (source.sample) {
+            // Free the encoded sample.
+            source.data = QByteArray();
+            samplesWritten++;
+            emit progressChanged(static_cast<float>(samplesWritten) /
+                                 sampleCount);
+        }
         break;
 
     case ZIP_SOURCE_ERROR:
@@ -160,35 +184,59 @@ ArchiveWriter::handleSourceCommand(void *data, zip_uint64_t length,
             return -1;
         }
         errors = static_cast<int *>(data);
-        errors[0] = sourceZipError;
-        errors[1] = sourceSystemError;
+        errors[0] = source.zipError;
+        errors[1] = source.systemError;
         return sizeof(int) * 2;
 
     case ZIP_SOURCE_FREE:
         break;
 
     case ZIP_SOURCE_OPEN:
-        if (! sourceFile->open(QIODevice::ReadOnly)) {
-            sourceZipError = ZIP_ER_OPEN;
-            sourceSystemError = errno;
-            return -1;
+        source.position = 0;
+        if (source.sample) {
+            // Encode the sample in memory.  Errors can't be thrown through
+            // libzip, so they're stored and reported after the commit fails.
+            try {
+                QBuffer buffer(&source.data);
+                buffer.open(QIODevice::ReadWrite | QIODevice::Truncate);
+                synthclone::SampleInputStream inputStream(*(source.sample));
+                synthclone::SampleOutputStream outputStream
+                    (buffer, inputStream.getSampleRate(),
+                     inputStream.getChannels(),
+                     synthclone::SampleStream::TYPE_FLAC,
+                     synthclone::SampleStream::SUBTYPE_PCM_24);
+                synthclone::SampleCopier copier;
+                copier.copy(inputStream, outputStream,
+                            inputStream.getFrames());
+                outputStream.close();
+            } catch (synthclone::Error &e) {
+                sourceErrorMessage = e.getMessage();
+                source.systemError = 0;
+                source.zipError = ZIP_ER_READ;
+                return -1;
+            }
         }
         break;
 
     case ZIP_SOURCE_READ:
-        readResult = sourceFile->read(static_cast<char *>(data), length);
-        if (readResult == -1) {
-            sourceZipError = ZIP_ER_READ;
-            sourceSystemError = errno;
-        }
-        return static_cast<zip_int64_t>(readResult);
+        readSize = qMin(static_cast<qint64>(length),
+                        source.data.count() - source.position);
+        memcpy(data, source.data.constData() + source.position,
+               static_cast<size_t>(readSize));
+        source.position += readSize;
+        return static_cast<zip_int64_t>(readSize);
 
     case ZIP_SOURCE_STAT:
         statData = static_cast<struct zip_stat *>(data);
         zip_stat_init(statData);
-        statData->comp_method = sourceCompressionMethod;
-        statData->size = QFileInfo(*sourceFile).size();
-        statData->valid |= ZIP_STAT_COMP_METHOD | ZIP_STAT_SIZE;
+        statData->comp_method = ZIP_CM_STORE;
+        statData->valid |= ZIP_STAT_COMP_METHOD;
+        if (! source.sample) {
+            // The size of an encoded sample isn't known until the sample is
+            // opened.
+            statData->size = static_cast<zip_uint64_t>(source.data.count());
+            statData->valid |= ZIP_STAT_SIZE;
+        }
         return sizeof(struct zip_stat);
 
     default:
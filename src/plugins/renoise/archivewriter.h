@@ -22,10 +22,17 @@
 
 #include <zip.h>
 
-#include <QtCore/QFile>
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
 
 #include <synthclone/sample.h>
 
+// Writes a Renoise instrument archive.  The archive is opened once, entries
+// are added as the instrument is built, and the archive is written when
+// 'commit()' is called.  Samples are encoded to FLAC in memory as libzip reads
+// them during the commit, so only one encoded sample is held in memory at a
+// time, and no temporary files are created.
+
 class ArchiveWriter: public QObject {
 
     Q_OBJECT
@@ -43,27 +50,47 @@ public:
     void
     addSample(const QString &fileName, const synthclone::Sample &sample);
 
-private:
+    void
+    commit();
+
+signals:
 
     void
-    addFile(const QString &path, const QString &entry,
-            zip_uint16_t compressionMethod);
+    progressChanged(float progress);
+
+private:
+
+    struct Source {
+        QByteArray data;
+        qint64 position;
+        const synthclone::Sample *sample;
+        int systemError;
+        ArchiveWriter *writer;
+        int zipError;
+    };
 
     static zip_int64_t
-    handleSourceCommand(void *writer, void *data, zip_uint64_t length,
+    handleSourceCommand(void *source, void *data, zip_uint64_t length,
                         zip_source_cmd command);
 
+    void
+    addSource(Source *source, const QString &entry);
+
+    void
+    discard();
+
     zip_int64_t
-    handleSourceCommand(void *data, zip_uint64_t length,
+    handleSourceCommand(Source &source, void *data, zip_uint64_t length,
                         zip_source_cmd command);
 
+    zip *archive;
     int fileCount;
     QString instrumentName;
     QString path;
-    zip_uint16_t sourceCompressionMethod;
-    QFile *sourceFile;
-    int sourceSystemError;
-    int sourceZipError;
+    int sampleCount;
+    int samplesWritten;
+    QString sourceErrorMessage;
+    QList<Source *> sources;
 
 };
 
@@ -19,10 +19,11 @@
 
 #include <cassert>
 
+#include <QtCore/QFileInfo>
 #include <QtCore/QLocale>
 
+#include <synthclone/buildmanifest.h>
 #include <synthclone/error.h>
-#include <synthclone/samplecopier.h>
 #include <synthclone/util.h>
 
 #include "target.h"
@@ -45,7 +46,7 @@ Target::~Target()
 void
 Target::build(const QList<synthclone::Zone *> &zones)
 {
-    emit progressChanged(0.0);
+    reportProgress(0.0);
     QString message;
     if (path.isEmpty()) {
         message = tr("the build path is not set");
@@ -56,6 +57,28 @@ Target::build(const QList<synthclone::Zone *> &zones)
         throw synthclone::Error(message);
     }
 
+    // The instrument is only rebuilt if the zones or target settings have
+    // changed since the last build.
+    QFileInfo archiveInfo(path);
+    QString archiveName = archiveInfo.fileName();
+    synthclone::BuildManifest
+        manifest(archiveInfo.absoluteDir().
+                 absoluteFilePath(QString("%1.manifest").arg(archiveName)));
+    QVariantList keyData;
+    keyData << drumKit << instrumentName << static_cast<int>(layerAlgorithm)
+            << static_cast<int>(pitchInterpolation);
+    for (int i = 0; i < zones.count(); i++) {
+        keyData << synthclone::BuildManifest::getZoneData(*(zones[i]));
+    }
+    QByteArray key = synthclone::BuildManifest::getKey(keyData);
+    if (manifest.isFileCurrent(archiveName, key)) {
+        emit statusChanged(tr("'%1' is up to date.").arg(archiveName));
+        reportProgress(0.0);
+        emit statusChanged("Idle.");
+        return;
+    }
+    manifest.addFile(archiveName, key);
+
     ArchiveWriter archiveWriter(path, instrumentName);
     QString configuration;
     QXmlStreamWriter confWriter(&configuration);
@@ -110,7 +133,7 @@ Target::build(const QList<synthclone::Zone *> &zones)
     QMultiMap<ZoneKey, synthclone::Zone *> zoneMap;
     confWriter.writeStartElement("Samples");
     for (int i = 0; i < zoneCount; i++) {
-        emit progressChanged((static_cast<float>(i) / zoneCount) * 0.5);
+        reportProgress((static_cast<float>(i) / zoneCount) * 0.25);
         synthclone::Zone *zone = zones[i];
 
         const synthclone::Sample *sample = zone->getWetSample();
@@ -162,7 +185,7 @@ Target::build(const QList<synthclone::Zone *> &zones)
         zoneMap.insert(ZoneKey(*zone), zone);
     }
     confWriter.writeEndElement();
-    emit progressChanged(0.5);
+    reportProgress(0.25);
 
     QList<ZoneKey> keys = zoneMap.uniqueKeys();
     int keyCount = keys.count();
@@ -184,12 +207,13 @@ Target::build(const QList<synthclone::Zone *> &zones)
     emit statusChanged(tr("Writing note mappings ..."));
     synthclone::MIDIData lowNote = 0;
     for (int i = 0; i < keyCount; i++) {
-        float startProgress = ((static_cast<float>(i) / keyCount) * 0.5) + 0.5;
-        float endProgress = ((static_cast<float>(i + 1) / keyCount) * 0.5) +
-            0.5;
+        float startProgress =
+            ((static_cast<float>(i) / keyCount) * 0.25) + 0.25;
+        float endProgress =
+            ((static_cast<float>(i + 1) / keyCount) * 0.25) + 0.25;
         float difference = endProgress - startProgress;
 
-        emit progressChanged(startProgress);
+        reportProgress(startProgress);
         emit statusChanged(tr("Writing note %1 of %2 ...").
                            arg(locale.toString(i + 1),
                                locale.toString(keyCount)));
@@ -212,8 +236,8 @@ Target::build(const QList<synthclone::Zone *> &zones)
         synthclone::Zone *currentZone;
         synthclone::MIDIData lowVelocity = 0;
         for (int j = 0; j < layerCount - 1; j++) {
-            emit progressChanged(((static_cast<float>(j) / layerCount) *
-                                  difference) + startProgress);
+            reportProgress(((static_cast<float>(j) / layerCount) *
+                            difference) + startProgress);
             emit statusChanged(tr("Writing layer %1 of %2 for note %3 of %4 "
                                   "...").
                                arg(locale.toString(j + 1),
@@ -246,8 +270,8 @@ Target::build(const QList<synthclone::Zone *> &zones)
             lowVelocity = highVelocity;
         }
 
-        emit progressChanged(((static_cast<float>(layerCount - 1) /
-                               layerCount) * difference) + startProgress);
+        reportProgress(((static_cast<float>(layerCount - 1) /
+                         layerCount) * difference) + startProgress);
         emit statusChanged(tr("Writing layer %1 of %2 for note %3 of %4 ...").
                            arg(locale.toString(layerCount),
                                locale.toString(layerCount),
@@ -292,7 +316,14 @@ Target::build(const QList<synthclone::Zone *> &zones)
 
     archiveWriter.addConfiguration(configuration);
 
-    emit progressChanged(0.0);
+    // Samples are encoded as the archive is committed.
+    emit statusChanged(tr("Writing archive ..."));
+    connect(&archiveWriter, SIGNAL(progressChanged(float)),
+            SLOT(handleArchiveWriterProgressChange(float)));
+    archiveWriter.commit();
+    manifest.save();
+
+    reportProgress(0.0);
     emit statusChanged("Idle.");
 }
 
@@ -320,6 +351,12 @@ Target::getPitchInterpolation() const
     return pitchInterpolation;
 }
 
+void
+Target::handleArchiveWriterProgressChange(float progress)
+{
+    reportProgress((progress * 0.5) + 0.5);
+}
+
 bool
 Target::isDrumKit() const
 {
@@ -410,18 +447,8 @@ Target::writeSample(ArchiveWriter &archiveWriter, QXmlStreamWriter &confWriter,
     }
 
     synthclone::MIDIData note = zone->getNote();
-    synthclone::Sample outSample;
-    synthclone::SampleInputStream inputStream(*sample);
-    synthclone::SampleChannelCount channels = inputStream.getChannels();
-    synthclone::SampleOutputStream outputStream
-        (outSample, inputStream.getSampleRate(), channels,
-         synthclone::SampleStream::TYPE_FLAC,
-         synthclone::SampleStream::SUBTYPE_PCM_24);
-    synthclone::SampleCopier copier;
-    copier.copy(inputStream, outputStream, inputStream.getFrames());
-    outputStream.close();
     QString sampleName = tr("%1-%2").arg(note).arg(zone->getVelocity());
-    archiveWriter.addSample(sampleName, outSample);
+    archiveWriter.addSample(sampleName, *sample);
 
     QString interpolation;
     switch (pitchInterpolation) {
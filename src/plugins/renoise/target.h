@@ -92,6 +92,11 @@ signals:
     void
     pitchInterpolationChanged(PitchInterpolation interpolation);
 
+private slots:
+
+    void
+    handleArchiveWriterProgressChange(float progress);
+
 private:
 
     void
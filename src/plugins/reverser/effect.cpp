@@ -43,16 +43,16 @@ Effect::process(const synthclone::Zone &/*zone*/,
     QScopedArrayPointer<float> dataPtr(new float[inputStream.getChannels()]);
     float *data = dataPtr.data();
     synthclone::SampleFrameCount totalFrames = inputStream.getFrames();
-    emit progressChanged(0.0);
+    reportProgress(0.0);
     emit statusChanged(tr("Reversing sample ..."));
     for (synthclone::SampleFrameCount i = totalFrames - 1; i >= 0; i--) {
         inputStream.seek(i, synthclone::SampleStream::OFFSET_START);
         synthclone::SampleFrameCount n = inputStream.read(data, 1);
         assert(n == 1);
         outputStream.write(data, 1);
-        emit progressChanged(static_cast<float>(totalFrames - i) /
-                             static_cast<float>(totalFrames));
+        reportProgress(static_cast<float>(totalFrames - i) /
+                       static_cast<float>(totalFrames));
     }
-    emit progressChanged(0.0);
+    reportProgress(0.0);
     emit statusChanged("");
 }
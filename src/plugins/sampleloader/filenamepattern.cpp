@@ -0,0 +1,176 @@
+/*
+ * libsynthclone_sampleloader - Sample file loading plugin for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cassert>
+
+#include <synthclone/error.h>
+
+#include "filenamepattern.h"
+
+FilenamePattern::Mapping::Mapping()
+{
+    channel = synthclone::MIDI_VALUE_NOT_SET;
+    note = synthclone::MIDI_VALUE_NOT_SET;
+    velocity = synthclone::MIDI_VALUE_NOT_SET;
+}
+
+FilenamePattern::FilenamePattern(const QString &pattern, int middleCOctave)
+{
+    QString expression;
+    int length = pattern.length();
+    for (int i = 0; i < length; i++) {
+        QChar c = pattern[i];
+        if (c == '*') {
+            expression.append(".*");
+            continue;
+        }
+        if (c == '?') {
+            expression.append(".");
+            continue;
+        }
+        if (c != '{') {
+            expression.append(QRegExp::escape(QString(c)));
+            continue;
+        }
+        int end = pattern.indexOf('}', i + 1);
+        if (end == -1) {
+            throw synthclone::Error(tr("'%1': unterminated token").
+                                    arg(pattern));
+        }
+        QString name = pattern.mid(i + 1, end - (i + 1)).toLower();
+        Token token;
+        token.control = 0;
+        if (name == "channel") {
+            token.type = TOKENTYPE_CHANNEL;
+            expression.append("(\\d{1,2})");
+        } else if (name == "note") {
+            token.type = TOKENTYPE_NOTE;
+            expression.append("([a-g][#b]?-?\\d|\\d{1,3})");
+        } else if (name == "velocity") {
+            token.type = TOKENTYPE_VELOCITY;
+            expression.append("(\\d{1,3})");
+        } else if (name.startsWith("cc")) {
+            bool success;
+            int control = name.mid(2).toInt(&success);
+            if ((! success) || (control < 0) || (control > 127)) {
+                throw synthclone::Error(tr("'%1': invalid control token "
+                                           "'%2'").arg(pattern, name));
+            }
+            token.control = static_cast<synthclone::MIDIData>(control);
+            token.type = TOKENTYPE_CONTROL;
+            expression.append("(\\d{1,3})");
+        } else {
+            throw synthclone::Error(tr("'%1': unknown token '%2'").
+                                    arg(pattern, name));
+        }
+        tokens.append(token);
+        i = end;
+    }
+    this->middleCOctave = middleCOctave;
+    this->pattern = pattern;
+    regExp = QRegExp(expression, Qt::CaseInsensitive, QRegExp::RegExp2);
+    if (! regExp.isValid()) {
+        throw synthclone::Error(tr("'%1': %2").
+                                arg(pattern, regExp.errorString()));
+    }
+}
+
+FilenamePattern::~FilenamePattern()
+{
+    // Empty
+}
+
+QString
+FilenamePattern::getPattern() const
+{
+    return pattern;
+}
+
+bool
+FilenamePattern::match(const QString &name, Mapping &mapping) const
+{
+    QRegExp regExp(this->regExp);
+    if (! regExp.exactMatch(name)) {
+        return false;
+    }
+    Mapping result;
+    for (int i = 0; i < tokens.count(); i++) {
+        const Token &token = tokens[i];
+        QString value = regExp.cap(i + 1);
+        switch (token.type) {
+        case TOKENTYPE_CHANNEL:
+            result.channel = parseValue(name, value, 1, 16);
+            break;
+        case TOKENTYPE_CONTROL:
+            result.controlMap[token.control] = parseValue(name, value, 0, 127);
+            break;
+        case TOKENTYPE_NOTE:
+            result.note = parseNote(name, value);
+            break;
+        case TOKENTYPE_VELOCITY:
+            // Zones can't have a velocity of 0, which is a MIDI note off.
+            result.velocity = parseValue(name, value, 1, 127);
+            break;
+        default:
+            assert(false);
+        }
+    }
+    mapping = result;
+    return true;
+}
+
+synthclone::MIDIData
+FilenamePattern::parseNote(const QString &name, const QString &value) const
+{
+    QChar letter = value[0].toLower();
+    if (letter.isDigit()) {
+        return parseValue(name, value, 0, 127);
+    }
+
+    // Pitch classes for the letters 'a' through 'g'.
+    static const int pitchClasses[] = { 9, 11, 0, 2, 4, 5, 7 };
+    int note = pitchClasses[letter.toAscii() - 'a'];
+    int octaveIndex = 1;
+    if (value[1] == '#') {
+        note++;
+        octaveIndex++;
+    } else if (value[1].toLower() == 'b') {
+        note--;
+        octaveIndex++;
+    }
+    int octave = value.mid(octaveIndex).toInt();
+    note += 60 + ((octave - middleCOctave) * 12);
+    if ((note < 0) || (note > 127)) {
+        throw synthclone::Error(tr("%1: '%2' is not a valid MIDI note").
+                                arg(name, value));
+    }
+    return static_cast<synthclone::MIDIData>(note);
+}
+
+synthclone::MIDIData
+FilenamePattern::parseValue(const QString &name, const QString &value,
+                            int minimum, int maximum) const
+{
+    int n = value.toInt();
+    if ((n < minimum) || (n > maximum)) {
+        throw synthclone::Error(tr("%1: '%2' is not in the range [%3, %4]").
+                                arg(name, value).arg(minimum).arg(maximum));
+    }
+    return static_cast<synthclone::MIDIData>(n);
+}
@@ -0,0 +1,104 @@
+/*
+ * libsynthclone_sampleloader - Sample file loading plugin for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __FILENAMEPATTERN_H__
+#define __FILENAMEPATTERN_H__
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QList>
+#include <QtCore/QRegExp>
+
+#include <synthclone/zone.h>
+
+// Maps sample filenames to zone parameters.  A pattern is matched against the
+// complete base name of a sample file (the name without its directory and
+// extension), ignoring case.  Patterns can contain these tokens:
+//
+//     {note}      - a MIDI note number, or a note name like 'C3' or 'F#-1'
+//     {velocity}  - a MIDI velocity (1-127)
+//     {channel}   - a MIDI channel (1-16)
+//     {ccN}       - the value of MIDI control N (0-127)
+//     *           - any sequence of characters
+//     ?           - any single character
+//
+// All other characters are matched literally.  For example, the pattern
+// '*_{note}_v{velocity}_rr*' matches 'Pad_C3_v96_rr2'.
+
+class FilenamePattern {
+
+    Q_DECLARE_TR_FUNCTIONS(FilenamePattern)
+
+public:
+
+    // Zone parameters parsed from a filename.  Parameters that aren't part
+    // of the pattern are set to synthclone::MIDI_VALUE_NOT_SET.
+    struct Mapping {
+        synthclone::MIDIData channel;
+        synthclone::Zone::ControlMap controlMap;
+        synthclone::MIDIData note;
+        synthclone::MIDIData velocity;
+
+        Mapping();
+    };
+
+    // 'middleCOctave' is the octave number that note names use for middle C
+    // (MIDI note 60).  Raises a `synthclone::Error` if the pattern is
+    // invalid.
+    FilenamePattern(const QString &pattern, int middleCOctave);
+
+    ~FilenamePattern();
+
+    QString
+    getPattern() const;
+
+    // Matches a complete base name against the pattern.  Returns false if the
+    // name doesn't match, and raises a `synthclone::Error` if the name
+    // matches, but contains an invalid value.
+    bool
+    match(const QString &name, Mapping &mapping) const;
+
+private:
+
+    enum TokenType {
+        TOKENTYPE_CHANNEL,
+        TOKENTYPE_CONTROL,
+        TOKENTYPE_NOTE,
+        TOKENTYPE_VELOCITY
+    };
+
+    struct Token {
+        synthclone::MIDIData control;
+        TokenType type;
+    };
+
+    synthclone::MIDIData
+    parseNote(const QString &name, const QString &value) const;
+
+    synthclone::MIDIData
+    parseValue(const QString &name, const QString &value, int minimum,
+               int maximum) const;
+
+    int middleCOctave;
+    QString pattern;
+    QRegExp regExp;
+    QList<Token> tokens;
+
+};
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ * libsynthclone_sampleloader - Sample file loading plugin for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <synthclone/util.h>
+
+#include "folderimportview.h"
+
+FolderImportView::FolderImportView(QObject *parent):
+    synthclone::DesignerView
+    (":/synthclone/plugins/sampleloader/folderimportview.ui", parent)
+{
+    QWidget *widget = getRootWidget();
+
+    closeButton = synthclone::getChild<QPushButton>(widget, "closeButton");
+    connect(closeButton, SIGNAL(clicked()), SIGNAL(closeRequest()));
+
+    importButton = synthclone::getChild<QPushButton>(widget, "importButton");
+    connect(importButton, SIGNAL(clicked()), SIGNAL(importRequest()));
+
+    middleCOctaveComboBox = synthclone::getChild<QComboBox>
+        (widget, "middleCOctaveComboBox");
+    connect(middleCOctaveComboBox, SIGNAL(currentIndexChanged(int)),
+            SLOT(handleMiddleCOctaveChange(int)));
+
+    path = synthclone::getChild<QLineEdit>(widget, "path");
+    connect(path, SIGNAL(textEdited(const QString &)),
+            SIGNAL(pathChangeRequest(const QString &)));
+
+    pathLookupButton = synthclone::getChild<QPushButton>
+        (widget, "pathLookupButton");
+    connect(pathLookupButton, SIGNAL(clicked()), SIGNAL(pathLookupRequest()));
+
+    patterns = synthclone::getChild<QPlainTextEdit>(widget, "patterns");
+    connect(patterns, SIGNAL(textChanged()), SLOT(handlePatternsChange()));
+
+    recursive = synthclone::getChild<QCheckBox>(widget, "recursive");
+    connect(recursive, SIGNAL(clicked(bool)),
+            SIGNAL(recursiveChangeRequest(bool)));
+}
+
+FolderImportView::~FolderImportView()
+{
+    // Empty
+}
+
+void
+FolderImportView::handleMiddleCOctaveChange(int index)
+{
+    // The combo box lists middle C as C3 and C4.
+    emit middleCOctaveChangeRequest(index + 3);
+}
+
+void
+FolderImportView::handlePatternsChange()
+{
+    emit patternsChangeRequest(patterns->toPlainText().
+                               split('\n', QString::SkipEmptyParts));
+}
+
+void
+FolderImportView::setMiddleCOctave(int octave)
+{
+    middleCOctaveComboBox->setCurrentIndex(octave - 3);
+}
+
+void
+FolderImportView::setPath(const QString &path)
+{
+    this->path->setText(path);
+}
+
+void
+FolderImportView::setPatterns(const QStringList &patterns)
+{
+    QString text = patterns.join("\n");
+    if (this->patterns->toPlainText() != text) {
+        this->patterns->setPlainText(text);
+    }
+}
+
+void
+FolderImportView::setRecursive(bool recursive)
+{
+    this->recursive->setChecked(recursive);
+}
@@ -0,0 +1,96 @@
+/*
+ * libsynthclone_sampleloader - Sample file loading plugin for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __FOLDERIMPORTVIEW_H__
+#define __FOLDERIMPORTVIEW_H__
+
+#include <QtGui/QCheckBox>
+#include <QtGui/QComboBox>
+#include <QtGui/QLineEdit>
+#include <QtGui/QPlainTextEdit>
+#include <QtGui/QPushButton>
+
+#include <synthclone/designerview.h>
+
+class FolderImportView: public synthclone::DesignerView {
+
+    Q_OBJECT
+
+public:
+
+    explicit
+    FolderImportView(QObject *parent=0);
+
+    ~FolderImportView();
+
+public slots:
+
+    void
+    setMiddleCOctave(int octave);
+
+    void
+    setPath(const QString &path);
+
+    void
+    setPatterns(const QStringList &patterns);
+
+    void
+    setRecursive(bool recursive);
+
+signals:
+
+    void
+    importRequest();
+
+    void
+    middleCOctaveChangeRequest(int octave);
+
+    void
+    pathChangeRequest(const QString &path);
+
+    void
+    pathLookupRequest();
+
+    void
+    patternsChangeRequest(const QStringList &patterns);
+
+    void
+    recursiveChangeRequest(bool recursive);
+
+private slots:
+
+    void
+    handleMiddleCOctaveChange(int index);
+
+    void
+    handlePatternsChange();
+
+private:
+
+    QPushButton *closeButton;
+    QPushButton *importButton;
+    QComboBox *middleCOctaveComboBox;
+    QLineEdit *path;
+    QPushButton *pathLookupButton;
+    QPlainTextEdit *patterns;
+    QCheckBox *recursive;
+
+};
+
+#endif
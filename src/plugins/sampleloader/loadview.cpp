@@ -0,0 +1,59 @@
+/*
+ * libsynthclone_sampleloader - Sample file loading plugin for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cassert>
+
+#include <synthclone/util.h>
+
+#include "loadview.h"
+
+LoadView::LoadView(QObject *parent):
+    synthclone::DesignerView(":/synthclone/plugins/sampleloader/loadview.ui",
+                             parent)
+{
+    QWidget *widget = getRootWidget();
+
+    cancelButton = synthclone::getChild<QPushButton>(widget, "cancelButton");
+    connect(cancelButton, SIGNAL(clicked()), SIGNAL(cancelRequest()));
+
+    progressBar = synthclone::getChild<QProgressBar>(widget, "progressBar");
+
+    status = synthclone::getChild<QLabel>(widget, "status");
+
+    // Closing the view cancels the load.
+    connect(this, SIGNAL(closeRequest()), SIGNAL(cancelRequest()));
+}
+
+LoadView::~LoadView()
+{
+    // Empty
+}
+
+void
+LoadView::setProgress(float progress)
+{
+    assert((progress >= 0.0) && (progress <= 1.0));
+    progressBar->setValue(static_cast<int>(progress * 10000.0));
+}
+
+void
+LoadView::setStatus(const QString &status)
+{
+    this->status->setText(status);
+}
@@ -0,0 +1,61 @@
+/*
+ * libsynthclone_sampleloader - Sample file loading plugin for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __LOADVIEW_H__
+#define __LOADVIEW_H__
+
+#include <QtGui/QLabel>
+#include <QtGui/QProgressBar>
+#include <QtGui/QPushButton>
+
+#include <synthclone/designerview.h>
+
+class LoadView: public synthclone::DesignerView {
+
+    Q_OBJECT
+
+public:
+
+    explicit
+    LoadView(QObject *parent=0);
+
+    ~LoadView();
+
+public slots:
+
+    void
+    setProgress(float progress);
+
+    void
+    setStatus(const QString &status);
+
+signals:
+
+    void
+    cancelRequest();
+
+private:
+
+    QPushButton *cancelButton;
+    QProgressBar *progressBar;
+    QLabel *status;
+
+};
+
+#endif
@@ -17,6 +17,11 @@
  * Ave, Cambridge, MA 02139, USA.
  */
 
+#include <cassert>
+
+#include <QtCore/QDirIterator>
+#include <QtCore/QFileInfo>
+
 #include <synthclone/error.h>
 
 #include "participant.h"
@@ -24,9 +29,23 @@
 Participant::Participant(QObject *parent):
     synthclone::Participant(tr("Sample Loader"), 0, 0, 2, "Devin Anderson",
                             tr("Loads samples from the filesystem"), parent),
+    addFolderAction(tr("Add Sample Folder")),
     addSamplesAction(tr("Add Samples"))
 {
     context = 0;
+    folderMiddleCOctave = 4;
+    folderPatterns << "*_{note}_v{velocity}*" << "*_{note}*";
+    folderRecursive = true;
+    loadTaskGroup = 0;
+
+    folderImportView.setMiddleCOctave(folderMiddleCOctave);
+    folderImportView.setPatterns(folderPatterns);
+    folderImportView.setRecursive(folderRecursive);
+
+    folderSelectionView.setFilesVisible(false);
+    folderSelectionView.setOperation
+        (synthclone::FileSelectionView::OPERATION_OPEN);
+    folderSelectionView.setTitle(tr("Select Sample Folder"));
 
     sampleSelectionView.setOperation
         (synthclone::FileSelectionView::OPERATION_OPEN);
@@ -34,9 +53,39 @@ Participant::Participant(QObject *parent):
         (synthclone::FileSelectionView::SELECTIONFILTER_EXISTING_FILES);
     sampleSelectionView.setTitle(tr("Add Samples"));
 
+    connect(&addFolderAction, SIGNAL(triggered()),
+            SLOT(handleAddFolderRequest()));
+
     connect(&addSamplesAction, SIGNAL(triggered()),
             SLOT(handleAddSamplesRequest()));
 
+    connect(&folderImportView, SIGNAL(closeRequest()),
+            SLOT(handleFolderImportCloseRequest()));
+    connect(&folderImportView, SIGNAL(importRequest()),
+            SLOT(handleFolderImportRequest()));
+    connect(&folderImportView, SIGNAL(middleCOctaveChangeRequest(int)),
+            SLOT(setFolderMiddleCOctave(int)));
+    connect(&folderImportView, SIGNAL(pathChangeRequest(const QString &)),
+            SLOT(setFolderPath(const QString &)));
+    connect(&folderImportView, SIGNAL(pathLookupRequest()),
+            SLOT(handleFolderPathLookupRequest()));
+    connect(&folderImportView,
+            SIGNAL(patternsChangeRequest(const QStringList &)),
+            SLOT(setFolderPatterns(const QStringList &)));
+    connect(&folderImportView, SIGNAL(recursiveChangeRequest(bool)),
+            SLOT(setFolderRecursive(bool)));
+
+    connect(&folderSelectionView, SIGNAL(closeRequest()),
+            SLOT(handleFolderSelectionCloseRequest()));
+    connect(&folderSelectionView, SIGNAL(pathsSelected(const QStringList &)),
+            SLOT(handleFolderSelection(const QStringList &)));
+
+    loadTimer.setInterval(100);
+    connect(&loadTimer, SIGNAL(timeout()), SLOT(handleLoadTimeout()));
+
+    connect(&loadView, SIGNAL(cancelRequest()),
+            SLOT(handleLoadCancelRequest()));
+
     connect(&sampleSelectionView, SIGNAL(closeRequest()),
             SLOT(handleCloseRequest()));
     connect(&sampleSelectionView, SIGNAL(pathsSelected(const QStringList &)),
@@ -49,19 +98,142 @@ Participant::~Participant()
 }
 
 void
-Participant::activate(synthclone::Context &context, const QVariant &/*state*/)
+Participant::activate(synthclone::Context &context, const QVariant &state)
 {
+    if (state.isValid()) {
+        const QVariantMap map = state.toMap();
+        QVariant value = map.value("folderMiddleCOctave");
+        if (value.isValid()) {
+            int octave = value.toInt();
+            if ((octave == 3) || (octave == 4)) {
+                setFolderMiddleCOctave(octave);
+            }
+        }
+        value = map.value("folderPath");
+        if (value.isValid()) {
+            setFolderPath(value.toString());
+        }
+        value = map.value("folderPatterns");
+        if (value.isValid()) {
+            setFolderPatterns(value.toStringList());
+        }
+        value = map.value("folderRecursive");
+        if (value.isValid()) {
+            setFolderRecursive(value.toBool());
+        }
+    }
     context.addMenuAction(&addSamplesAction, synthclone::MENU_TOOLS);
+    context.addMenuAction(&addFolderAction, synthclone::MENU_TOOLS);
     this->context = &context;
 }
 
 void
 Participant::deactivate(synthclone::Context &/*context*/)
 {
+    if (loadTimer.isActive()) {
+        loadTaskGroup->cancel();
+        loadTimer.stop();
+        loadTaskGroup->wait();
+        finishLoad();
+    }
+    folderImportView.setVisible(false);
+    context->removeMenuAction(&addFolderAction);
     context->removeMenuAction(&addSamplesAction);
     this->context = 0;
 }
 
+void
+Participant::finishLoad()
+{
+    QStringList errors = loadErrors;
+    int count = sampleLoaders.count();
+    if (! loadTaskGroup->isCancelled()) {
+        loadView.setStatus(tr("Adding zones ..."));
+
+        // Insert new zones at the index of the first selected zone, or at the
+        // end if no zones are selected.  The zones are inserted in selection
+        // order.
+        int insertIndex = context->getSelectedZoneCount() ?
+            context->getZoneIndex(context->getSelectedZone(0)) :
+            context->getZoneCount();
+
+        for (int i = 0; i < count; i++) {
+            const SampleLoader *sampleLoader = sampleLoaders[i];
+            if (sampleLoader->hasError()) {
+                errors.append(sampleLoader->getErrorMessage());
+                continue;
+            }
+            // Create a new zone for this sample, and set the sample time, dry
+            // sample, and any MIDI parameters parsed from the sample filename.
+            // Make sure to remove the zone if an exception is thrown.
+            const FilenamePattern::Mapping &mapping =
+                sampleLoader->getMapping();
+            synthclone::Zone *zone = context->addZone(insertIndex);
+            try {
+                if (mapping.channel != synthclone::MIDI_VALUE_NOT_SET) {
+                    zone->setChannel(mapping.channel);
+                }
+                if (mapping.note != synthclone::MIDI_VALUE_NOT_SET) {
+                    zone->setNote(mapping.note);
+                }
+                if (mapping.velocity != synthclone::MIDI_VALUE_NOT_SET) {
+                    zone->setVelocity(mapping.velocity);
+                }
+                const synthclone::Zone::ControlMap &controlMap =
+                    mapping.controlMap;
+                synthclone::Zone::ControlMap::const_iterator end =
+                    controlMap.constEnd();
+                for (synthclone::Zone::ControlMap::const_iterator iter =
+                         controlMap.constBegin(); iter != end; iter++) {
+                    zone->setControlValue(iter.key(), iter.value());
+                }
+                zone->setSampleTime(sampleLoader->getTime());
+                zone->adoptDrySample(sampleLoader->takeSample());
+            } catch (synthclone::Error &e) {
+                context->removeZone(zone);
+                errors.append(tr("%1: %2").arg(sampleLoader->getPath(),
+                                               e.getMessage()));
+                continue;
+            }
+
+            // We've successfully added a zone with a sample from the hard
+            // drive.
+            insertIndex++;
+        }
+    }
+
+    // The task group owns the sample loaders.
+    delete loadTaskGroup;
+    loadTaskGroup = 0;
+    sampleLoaders.clear();
+    loadErrors.clear();
+    loadView.setVisible(false);
+    addFolderAction.setEnabled(true);
+    addSamplesAction.setEnabled(true);
+
+    // Report any errors that occurred during the operation.
+    if (errors.count()) {
+        context->reportError(errors.join("\n"));
+    }
+}
+
+QVariant
+Participant::getState() const
+{
+    QVariantMap map;
+    map["folderMiddleCOctave"] = folderMiddleCOctave;
+    map["folderPath"] = folderPath;
+    map["folderPatterns"] = folderPatterns;
+    map["folderRecursive"] = folderRecursive;
+    return map;
+}
+
+void
+Participant::handleAddFolderRequest()
+{
+    folderImportView.setVisible(true);
+}
+
 void
 Participant::handleAddSamplesRequest()
 {
@@ -75,76 +247,223 @@ Participant::handleCloseRequest()
 }
 
 void
-Participant::handleSampleSelection(const QStringList &paths)
+Participant::handleFolderImportCloseRequest()
 {
-    int count = paths.count();
-    QStringList errors;
+    folderImportView.setVisible(false);
+}
 
-    // Insert new zones at the index of the first selected zone, or at the end
-    // if no zones are selected.
-    int insertIndex = context->getSelectedZoneCount() ?
-        context->getZoneIndex(context->getSelectedZone(0)) :
-        context->getZoneCount();
+void
+Participant::handleFolderImportRequest()
+{
+    QDir directory(folderPath);
+    if (folderPath.isEmpty() || (! directory.exists())) {
+        context->reportError(tr("'%1': directory does not exist").
+                             arg(folderPath));
+        return;
+    }
 
-    for (int i = 0; i < count; i++) {
-        QString path = paths[i];
-        try {
+    // Compile the patterns up front, so that an invalid pattern is reported
+    // before any samples are loaded.
+    QList<FilenamePattern> patterns;
+    int patternCount = folderPatterns.count();
+    try {
+        for (int i = 0; i < patternCount; i++) {
+            patterns.append(FilenamePattern(folderPatterns[i],
+                                            folderMiddleCOctave));
+        }
+    } catch (synthclone::Error &e) {
+        context->reportError(e.getMessage());
+        return;
+    }
+    if (! patternCount) {
+        context->reportError(tr("no filename patterns are set"));
+        return;
+    }
 
-            // Make sure the object at the given path is a valid sample file.
-            // If the object isn't valid, then one of these constructors will
-            // raise a `synthclone::Error`.
-            synthclone::Sample sample(path);
-            synthclone::SampleInputStream stream(sample);
-
-            // Check the total time consumed by the sample.  If it isn't in the
-            // acceptable range for `synthclone` dry samples, then raise a
-            // `synthclone::Error`.
-            synthclone::SampleRate sampleRate = stream.getSampleRate();
-            synthclone::SampleTime time = stream.getFrames() /
-                static_cast<synthclone::SampleTime>(sampleRate);
-            QString message;
-            if (time > synthclone::SAMPLE_TIME_MAXIMUM) {
-                message = tr("%1: sample time is %2, which is greater than %3 "
-                             "seconds").
-                    arg(path).arg(time).arg(synthclone::SAMPLE_TIME_MAXIMUM);
-                throw synthclone::Error(message);
-            }
-            if (time < synthclone::SAMPLE_TIME_MINIMUM) {
-                message = tr("%1: sample time is %2, which is less than %3 "
-                             "seconds").
-                    arg(path).arg(time).arg(synthclone::SAMPLE_TIME_MINIMUM);
-                throw synthclone::Error(message);
-            }
+    // Collect the sample files in the folder.  The paths are sorted, so that
+    // zones are added in a predictable order.
+    QStringList nameFilters;
+    nameFilters << "*.aif" << "*.aifc" << "*.aiff" << "*.au" << "*.caf"
+                << "*.flac" << "*.ogg" << "*.rf64" << "*.snd" << "*.w64"
+                << "*.wav" << "*.wave";
+    QDirIterator iterator(directory.absolutePath(), nameFilters,
+                          QDir::Files | QDir::Readable,
+                          folderRecursive ? QDirIterator::Subdirectories :
+                          QDirIterator::NoIteratorFlags);
+    QStringList allPaths;
+    while (iterator.hasNext()) {
+        allPaths.append(iterator.next());
+    }
+    allPaths.sort();
 
-            // Create a new zone for this sample, and set the sample time and
-            // dry sample properties approriately.  Make sure to remove the
-            // zone if an exception is thrown, and propagate the exception to
-            // the outer catch.
-            synthclone::Zone *zone = context->addZone(insertIndex);
-            try {
-                zone->setSampleTime(time);
-                zone->setDrySample(&sample);
-            } catch (...) {
-                context->removeZone(zone);
-                throw;
+    // Map each file with the first pattern that matches its name.  Files that
+    // don't match any pattern are skipped.
+    QList<FilenamePattern::Mapping> mappings;
+    QStringList paths;
+    int pathCount = allPaths.count();
+    assert(loadErrors.isEmpty());
+    for (int i = 0; i < pathCount; i++) {
+        const QString &path = allPaths[i];
+        QString name = QFileInfo(path).completeBaseName();
+        FilenamePattern::Mapping mapping;
+        bool matched = false;
+        try {
+            for (int j = 0; j < patternCount; j++) {
+                if (patterns[j].match(name, mapping)) {
+                    matched = true;
+                    break;
+                }
             }
-
         } catch (synthclone::Error &e) {
+            loadErrors.append(tr("%1: %2").arg(path, e.getMessage()));
+            continue;
+        }
+        if (! matched) {
+            loadErrors.append(tr("%1: filename does not match any pattern").
+                              arg(path));
+            continue;
+        }
+        mappings.append(mapping);
+        paths.append(path);
+    }
+    if (paths.isEmpty()) {
+        QString message = tr("no sample files in '%1' match the filename "
+                             "patterns").arg(folderPath);
+        if (! loadErrors.isEmpty()) {
+            message += "\n" + loadErrors.join("\n");
+            loadErrors.clear();
+        }
+        context->reportError(message);
+        return;
+    }
+    folderImportView.setVisible(false);
+    startLoad(paths, mappings);
+}
 
-            // Record errors that occur.
-            errors.append(e.getMessage());
+void
+Participant::handleFolderPathLookupRequest()
+{
+    folderSelectionView.setDirectory(folderPath);
+    folderSelectionView.setVisible(true);
+}
 
-            continue;
+void
+Participant::handleFolderSelection(const QStringList &paths)
+{
+    assert(paths.count() == 1);
+    setFolderPath(paths[0]);
+    folderSelectionView.setVisible(false);
+}
+
+void
+Participant::handleFolderSelectionCloseRequest()
+{
+    folderSelectionView.setVisible(false);
+}
+
+void
+Participant::handleLoadCancelRequest()
+{
+    loadTaskGroup->cancel();
+    loadView.setStatus(tr("Cancelling ..."));
+}
+
+void
+Participant::handleLoadTimeout()
+{
+    int count = sampleLoaders.count();
+    int completedCount = loadTaskGroup->getFinishedCount();
+    if (! loadTaskGroup->isCancelled()) {
+        loadView.setProgress(static_cast<float>(completedCount) / count);
+        loadView.setStatus(tr("Loaded %1 of %2 samples ...").
+                           arg(completedCount).arg(count));
+    }
+    if (completedCount < count) {
+        return;
+    }
+    loadTimer.stop();
+    loadTaskGroup->wait();
+    finishLoad();
+}
+
+void
+Participant::handleSampleSelection(const QStringList &paths)
+{
+    int count = paths.count();
+    if (count) {
+        QList<FilenamePattern::Mapping> mappings;
+        for (int i = 0; i < count; i++) {
+            mappings.append(FilenamePattern::Mapping());
         }
+        startLoad(paths, mappings);
+    }
+}
 
-        // We've successfully added a zone with a sample from the hard drive.
-        insertIndex++;
+void
+Participant::setFolderMiddleCOctave(int octave)
+{
+    assert((octave == 3) || (octave == 4));
+    if (folderMiddleCOctave != octave) {
+        folderMiddleCOctave = octave;
+        folderImportView.setMiddleCOctave(octave);
+    }
+}
 
+void
+Participant::setFolderPath(const QString &path)
+{
+    if (folderPath != path) {
+        folderPath = path;
+        folderImportView.setPath(path);
     }
+}
 
-    // Report any errors that occurred during the operation.
-    if (errors.count()) {
-        context->reportError(errors.join("\n"));
+void
+Participant::setFolderPatterns(const QStringList &patterns)
+{
+    if (folderPatterns != patterns) {
+        folderPatterns = patterns;
+        folderImportView.setPatterns(patterns);
     }
+}
 
+void
+Participant::setFolderRecursive(bool recursive)
+{
+    if (folderRecursive != recursive) {
+        folderRecursive = recursive;
+        folderImportView.setRecursive(recursive);
+    }
+}
+
+void
+Participant::startLoad(const QStringList &paths,
+                       const QList<FilenamePattern::Mapping> &mappings)
+{
+    assert(! loadTaskGroup);
+    assert(sampleLoaders.isEmpty());
+    int count = paths.count();
+    assert(count);
+    assert(mappings.count() == count);
+
+    // The samples are probed, validated, and converted in the shared task
+    // pool.  The load view is modal, so the zone list can't change while
+    // samples are being loaded.
+    loadTaskGroup = new synthclone::TaskGroup(context->getTaskPool());
+    synthclone::SampleRate sampleRate = context->getSampleRate();
+    synthclone::SampleChannelCount channels =
+        context->getSampleChannelCount();
+    for (int i = 0; i < count; i++) {
+        SampleLoader *sampleLoader =
+            new SampleLoader(paths[i], context->createSampleFile(), sampleRate,
+                             channels, mappings[i]);
+        sampleLoaders.append(sampleLoader);
+        loadTaskGroup->start(sampleLoader);
+    }
+    addFolderAction.setEnabled(false);
+    addSamplesAction.setEnabled(false);
+    loadView.setProgress(0.0);
+    loadView.setStatus(tr("Loading %1 samples ...").arg(count));
+    loadView.setVisible(true);
+    loadTimer.start();
 }
@@ -20,8 +20,16 @@
 #ifndef __PARTICIPANT_H__
 #define __PARTICIPANT_H__
 
+#include <QtCore/QStringList>
+#include <QtCore/QTimer>
+
 #include <synthclone/fileselectionview.h>
 #include <synthclone/participant.h>
+#include <synthclone/taskgroup.h>
+
+#include "folderimportview.h"
+#include "loadview.h"
+#include "sampleloader.h"
 
 class Participant: public synthclone::Participant {
 
@@ -40,21 +48,79 @@ public:
     void
     deactivate(synthclone::Context &context);
 
+    QVariant
+    getState() const;
+
 private slots:
 
+    void
+    handleAddFolderRequest();
+
     void
     handleAddSamplesRequest();
 
     void
     handleCloseRequest();
 
+    void
+    handleFolderImportCloseRequest();
+
+    void
+    handleFolderImportRequest();
+
+    void
+    handleFolderPathLookupRequest();
+
+    void
+    handleFolderSelection(const QStringList &paths);
+
+    void
+    handleFolderSelectionCloseRequest();
+
+    void
+    handleLoadCancelRequest();
+
+    void
+    handleLoadTimeout();
+
     void
     handleSampleSelection(const QStringList &paths);
 
+    void
+    setFolderMiddleCOctave(int octave);
+
+    void
+    setFolderPath(const QString &path);
+
+    void
+    setFolderPatterns(const QStringList &patterns);
+
+    void
+    setFolderRecursive(bool recursive);
+
 private:
 
+    void
+    finishLoad();
+
+    void
+    startLoad(const QStringList &paths,
+              const QList<FilenamePattern::Mapping> &mappings);
+
+    synthclone::MenuAction addFolderAction;
     synthclone::MenuAction addSamplesAction;
     synthclone::Context *context;
+    FolderImportView folderImportView;
+    int folderMiddleCOctave;
+    QString folderPath;
+    QStringList folderPatterns;
+    bool folderRecursive;
+    synthclone::FileSelectionView folderSelectionView;
+    synthclone::TaskGroup *loadTaskGroup;
+    QTimer loadTimer;
+    QStringList loadErrors;
+    LoadView loadView;
+    QList<SampleLoader *> sampleLoaders;
     synthclone::FileSelectionView sampleSelectionView;
 
 };
@@ -0,0 +1,151 @@
+/*
+ * libsynthclone_sampleloader - Sample file loading plugin for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <QtCore/QCoreApplication>
+
+#include <synthclone/error.h>
+#include <synthclone/sampleconverter.h>
+#include <synthclone/sampleinputstream.h>
+#include <synthclone/sampleoutputstream.h>
+
+#include "sampleloader.h"
+
+SampleLoader::SampleLoader(const QString &path, const QString &samplePath,
+                           synthclone::SampleRate sampleRate,
+                           synthclone::SampleChannelCount channels,
+                           const FilenamePattern::Mapping &mapping)
+{
+    this->channels = channels;
+    error = false;
+    this->mapping = mapping;
+    this->path = path;
+
+    // The sample is temporary until it's adopted by a zone, so that the sample
+    // file is removed if the sample fails to load, or the load is cancelled.
+    sample.reset(new synthclone::Sample(samplePath, true));
+
+    this->sampleRate = sampleRate;
+    time = 0.0;
+}
+
+SampleLoader::~SampleLoader()
+{
+    // Empty
+}
+
+QString
+SampleLoader::getErrorMessage() const
+{
+    return errorMessage;
+}
+
+const FilenamePattern::Mapping &
+SampleLoader::getMapping() const
+{
+    return mapping;
+}
+
+QString
+SampleLoader::getPath() const
+{
+    return path;
+}
+
+synthclone::SampleTime
+SampleLoader::getTime() const
+{
+    return time;
+}
+
+bool
+SampleLoader::hasError() const
+{
+    return error;
+}
+
+void
+SampleLoader::load()
+{
+    // Make sure the object at the given path is a valid sample file.  If the
+    // object isn't valid, then one of these constructors will raise a
+    // `synthclone::Error`.
+    synthclone::Sample inputSample(path);
+    synthclone::SampleInputStream inputStream(inputSample);
+
+    // Check the total time consumed by the sample.  If it isn't in the
+    // acceptable range for `synthclone` dry samples, then raise a
+    // `synthclone::Error`.
+    synthclone::SampleRate inputSampleRate = inputStream.getSampleRate();
+    time = inputStream.getFrames() /
+        static_cast<synthclone::SampleTime>(inputSampleRate);
+    QString message;
+    if (time > synthclone::SAMPLE_TIME_MAXIMUM) {
+        message = QCoreApplication::translate
+            ("SampleLoader", "%1: sample time is %2, which is greater than %3 "
+             "seconds").
+            arg(path).arg(time).arg(synthclone::SAMPLE_TIME_MAXIMUM);
+        throw synthclone::Error(message);
+    }
+    if (time < synthclone::SAMPLE_TIME_MINIMUM) {
+        message = QCoreApplication::translate
+            ("SampleLoader", "%1: sample time is %2, which is less than %3 "
+             "seconds").
+            arg(path).arg(time).arg(synthclone::SAMPLE_TIME_MINIMUM);
+        throw synthclone::Error(message);
+    }
+    synthclone::SampleChannelCount inputChannels = inputStream.getChannels();
+    if (! synthclone::SampleConverter::canConvertChannels(inputChannels,
+                                                          channels)) {
+        message = QCoreApplication::translate
+            ("SampleLoader", "%1: can't convert %2 channels to %3 channels").
+            arg(path).arg(inputChannels).arg(channels);
+        throw synthclone::Error(message);
+    }
+
+    // Convert the sample to the session format in the session's samples
+    // directory, so that the zone can adopt the sample without copying it.  If
+    // the session sample rate isn't set yet, then the session will take the
+    // sample rate of the first sample that's added to it.
+    synthclone::SampleOutputStream outputStream
+        (*sample, sampleRate == synthclone::SAMPLE_RATE_NOT_SET ?
+         inputSampleRate : sampleRate, channels);
+    synthclone::SampleConverter converter;
+    converter.convert(inputStream, outputStream);
+    outputStream.close();
+}
+
+void
+SampleLoader::run()
+{
+    // Errors are reported per sample, so they aren't passed on to the task
+    // group.
+    try {
+        load();
+    } catch (synthclone::Error &e) {
+        errorMessage = e.getMessage();
+        error = true;
+        sample.reset();
+    }
+}
+
+synthclone::Sample *
+SampleLoader::takeSample()
+{
+    return sample.take();
+}
@@ -0,0 +1,88 @@
+/*
+ * libsynthclone_sampleloader - Sample file loading plugin for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __SAMPLELOADER_H__
+#define __SAMPLELOADER_H__
+
+#include <QtCore/QScopedPointer>
+
+#include <synthclone/sample.h>
+#include <synthclone/task.h>
+#include <synthclone/types.h>
+
+#include "filenamepattern.h"
+
+// Probes a sample file, validates the sample time, and converts the sample to
+// the session sample rate and channel count, writing the converted sample to
+// a file in the session's samples directory.  Sample loaders are run in the
+// shared task pool, so that the GUI thread only has to hand the converted
+// samples to new zones.
+
+class SampleLoader: public synthclone::Task {
+
+public:
+
+    SampleLoader(const QString &path, const QString &samplePath,
+                 synthclone::SampleRate sampleRate,
+                 synthclone::SampleChannelCount channels,
+                 const FilenamePattern::Mapping &mapping);
+
+    ~SampleLoader();
+
+    QString
+    getErrorMessage() const;
+
+    const FilenamePattern::Mapping &
+    getMapping() const;
+
+    QString
+    getPath() const;
+
+    synthclone::SampleTime
+    getTime() const;
+
+    bool
+    hasError() const;
+
+    void
+    run();
+
+    // Takes the converted sample from the loader, or returns NULL if the
+    // sample wasn't loaded.  The sample file is removed if the sample is never
+    // taken.
+    synthclone::Sample *
+    takeSample();
+
+private:
+
+    void
+    load();
+
+    synthclone::SampleChannelCount channels;
+    bool error;
+    QString errorMessage;
+    FilenamePattern::Mapping mapping;
+    QString path;
+    QScopedPointer<synthclone::Sample> sample;
+    synthclone::SampleRate sampleRate;
+    synthclone::SampleTime time;
+
+};
+
+#endif
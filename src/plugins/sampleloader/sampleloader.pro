@@ -4,11 +4,20 @@ include(../plugins.pri)
 # Build
 ################################################################################
 
-HEADERS += participant.h \
-    plugin.h
+HEADERS += filenamepattern.h \
+    folderimportview.h \
+    loadview.h \
+    participant.h \
+    plugin.h \
+    sampleloader.h
 MOC_DIR = $${MAKEDIR}/plugins/sampleloader
 OBJECTS_DIR = $${MAKEDIR}/plugins/sampleloader
 RCC_DIR = $${MAKEDIR}/plugins/sampleloader
-SOURCES += participant.cpp \
-    plugin.cpp
+RESOURCES += sampleloader.qrc
+SOURCES += filenamepattern.cpp \
+    folderimportview.cpp \
+    loadview.cpp \
+    participant.cpp \
+    plugin.cpp \
+    sampleloader.cpp
 TARGET = $$qtLibraryTarget(synthclone_sampleloader)
@@ -78,7 +78,7 @@ Participant::addControlLayer(int index, const ControlLayer *layer)
 Target *
 Participant::addTarget()
 {
-    Target *target = new Target(tr("SFZ"), this);
+    Target *target = new Target(tr("SFZ"), context->getTaskPool(), this);
     connect(target, SIGNAL(controlCrossfadeCurveChanged(CrossfadeCurve)),
             context, SLOT(setSessionModified()));
     connect(target, SIGNAL(controlLayerAdded(const ControlLayer *, int)),
@@ -0,0 +1,52 @@
+/*
+ * libsynthclone_sfz - SFZ target plugin for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <synthclone/samplecopier.h>
+#include <synthclone/sampleinputstream.h>
+#include <synthclone/sampleoutputstream.h>
+
+#include "samplewriter.h"
+
+SampleWriter::SampleWriter(const synthclone::Sample &sample,
+                           const QString &path,
+                           synthclone::SampleStream::Type type,
+                           synthclone::SampleStream::SubType subType):
+    sample(sample)
+{
+    this->path = path;
+    this->subType = subType;
+    this->type = type;
+}
+
+SampleWriter::~SampleWriter()
+{
+    // Empty
+}
+
+void
+SampleWriter::run()
+{
+    synthclone::Sample outSample(path);
+    synthclone::SampleInputStream inputStream(sample);
+    synthclone::SampleOutputStream outputStream
+        (outSample, inputStream.getSampleRate(), inputStream.getChannels(),
+         type, subType);
+    synthclone::SampleCopier copier;
+    copier.copy(inputStream, outputStream, inputStream.getFrames());
+}
@@ -0,0 +1,52 @@
+/*
+ * libsynthclone_sfz - SFZ target plugin for `synthclone`
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __SAMPLEWRITER_H__
+#define __SAMPLEWRITER_H__
+
+#include <synthclone/sample.h>
+#include <synthclone/samplestream.h>
+#include <synthclone/task.h>
+
+// Transcodes a zone sample to a file in the target directory.  Sample writers
+// are run in the shared task pool while the SFZ patch is written.
+
+class SampleWriter: public synthclone::Task {
+
+public:
+
+    SampleWriter(const synthclone::Sample &sample, const QString &path,
+                 synthclone::SampleStream::Type type,
+                 synthclone::SampleStream::SubType subType);
+
+    ~SampleWriter();
+
+    void
+    run();
+
+private:
+
+    QString path;
+    const synthclone::Sample &sample;
+    synthclone::SampleStream::SubType subType;
+    synthclone::SampleStream::Type type;
+
+};
+
+#endif
@@ -8,6 +8,7 @@ HEADERS += controllayer.h \
     controllayerdelegate.h \
     participant.h \
     plugin.h \
+    samplewriter.h \
     target.h \
     targetview.h \
     types.h
@@ -19,6 +20,7 @@ SOURCES += controllayer.cpp \
     controllayerdelegate.cpp \
     participant.cpp \
     plugin.cpp \
+    samplewriter.cpp \
     target.cpp \
     targetview.cpp
 TARGET = $$qtLibraryTarget(synthclone_sfz)
@@ -24,10 +24,12 @@
 #include <QtCore/QScopedPointer>
 #include <QtCore/QTextStream>
 
+#include <synthclone/buildmanifest.h>
 #include <synthclone/error.h>
-#include <synthclone/samplecopier.h>
+#include <synthclone/taskgroup.h>
 #include <synthclone/util.h>
 
+#include "samplewriter.h"
 #include "target.h"
 
 // Static data
@@ -87,8 +89,10 @@ struct ZoneMapDestructor {
 
 // Class implementation
 
-Target::Target(const QString &name, QObject *parent):
-    synthclone::Target(name, parent)
+Target::Target(const QString &name, synthclone::TaskPool &taskPool,
+               QObject *parent):
+    synthclone::Target(name, parent),
+    taskPool(taskPool)
 {
     controlCrossfadeCurve = CROSSFADECURVE_GAIN;
     drumKit = false;
@@ -123,7 +127,7 @@ Target::addControlLayer(synthclone::MIDIData control)
 void
 Target::build(const QList<synthclone::Zone *> &zones)
 {
-    emit progressChanged(0.0);
+    reportProgress(0.0);
     QString message;
     if (path.isEmpty()) {
         message = tr("the build path is not set");
@@ -136,6 +140,11 @@ Target::build(const QList<synthclone::Zone *> &zones)
         throw synthclone::Error(message);
     }
     QFile file(directory.absoluteFilePath("patch.sfz"));
+
+    // Samples written by a previous build are only rewritten if their source
+    // sample or the sample format has changed.
+    synthclone::BuildManifest
+        manifest(directory.absoluteFilePath("patch.sfz.manifest"));
     if (! file.open(QIODevice::WriteOnly)) {
         throw synthclone::Error(file.errorString());
     }
@@ -172,7 +181,7 @@ Target::build(const QList<synthclone::Zone *> &zones)
     // }
 
     for (int i = 0; i < zoneCount; i++) {
-        emit progressChanged((static_cast<float>(i) / zoneCount) * 0.5);
+        reportProgress((static_cast<float>(i) / zoneCount) * 0.25);
         synthclone::Zone *zone = zones[i];
         const synthclone::Sample *sample = zone->getWetSample();
         if (! sample) {
@@ -204,7 +213,7 @@ Target::build(const QList<synthclone::Zone *> &zones)
         }
         zoneList->append(zone);
     }
-    emit progressChanged(0.5);
+    reportProgress(0.25);
 
     synthclone::SampleStream::Type sampleStreamType;
     synthclone::SampleStream::SubType sampleStreamSubType;
@@ -249,6 +258,11 @@ Target::build(const QList<synthclone::Zone *> &zones)
     //         for each velocity associated with note do:
     //             write regions
 
+    // Samples are transcoded in the shared task pool while the regions are
+    // written.  The task group owns the sample writers, and waits for any
+    // running writers when it's destroyed.
+    synthclone::TaskGroup sampleWriters(taskPool);
+
     QTextStream stream(&file);
     QList<synthclone::MIDIData> channels = zoneMap.keys();
     int channelCount = channels.count();
@@ -431,17 +445,21 @@ Target::build(const QList<synthclone::Zone *> &zones)
                         sample = zone->getDrySample();
                         assert(sample);
                     }
-                    synthclone::Sample outSample
-                        (directory.absoluteFilePath(sampleName));
-                    synthclone::SampleInputStream inputStream(*sample);
-                    synthclone::SampleChannelCount channels =
-                        inputStream.getChannels();
-                    synthclone::SampleOutputStream outputStream
-                        (outSample, inputStream.getSampleRate(), channels,
-                         sampleStreamType, sampleStreamSubType);
-                    synthclone::SampleCopier copier;
-                    copier.copy(inputStream, outputStream,
-                                inputStream.getFrames());
+                    QVariant sampleData =
+                        synthclone::BuildManifest::getSampleData(*sample);
+                    QVariantList keyData;
+                    keyData << sampleData << static_cast<int>(sampleFormat);
+                    QByteArray sampleKey =
+                        synthclone::BuildManifest::getKey(keyData);
+                    if (! manifest.isFileCurrent(sampleName, sampleKey)) {
+                        QString samplePath =
+                            directory.absoluteFilePath(sampleName);
+                        sampleWriters.start
+                            (new SampleWriter(*sample, samplePath,
+                                              sampleStreamType,
+                                              sampleStreamSubType));
+                    }
+                    manifest.addFile(sampleName, sampleKey);
 
                     QStringList regionData = commonRegionData;
                     writeOpcode(regionData, "sample", sampleName);
@@ -458,13 +476,24 @@ Target::build(const QList<synthclone::Zone *> &zones)
                 }
 
                 zonesWritten += zoneList->count();
-                emit progressChanged(((static_cast<float>(zonesWritten) /
-                                       zoneCount) * 0.5) + 0.5);
+                reportProgress(((static_cast<float>(zonesWritten) /
+                                 zoneCount) * 0.25) + 0.25);
             }
         }
     }
     file.close();
-    emit progressChanged(0.0);
+
+    emit statusChanged(tr("Writing samples ..."));
+    while (! sampleWriters.waitForDone(100)) {
+        reportProgress((sampleWriters.getProgress() * 0.5) + 0.5);
+    }
+    sampleWriters.wait();
+
+    emit statusChanged(tr("Removing stale samples ..."));
+    manifest.removeStaleFiles();
+    manifest.save();
+
+    reportProgress(0.0);
     emit statusChanged("Idle.");
 }
 
@@ -21,6 +21,7 @@
 #define __TARGET_H__
 
 #include <synthclone/target.h>
+#include <synthclone/taskpool.h>
 #include <synthclone/types.h>
 
 #include "controllayer.h"
@@ -41,8 +42,8 @@ public:
 
     typedef QMap<synthclone::MIDIData, ZoneList *> ControlZoneMap;
 
-    explicit
-    Target(const QString &name, QObject *parent=0);
+    Target(const QString &name, synthclone::TaskPool &taskPool,
+           QObject *parent=0);
 
     ~Target();
 
@@ -161,6 +162,7 @@ private:
     CrossfadeCurve noteCrossfadeCurve;
     QString path;
     SampleFormat sampleFormat;
+    synthclone::TaskPool &taskPool;
     CrossfadeCurve velocityCrossfadeCurve;
 
 };
@@ -68,7 +68,7 @@ void
 Effect::handleCopyProgress(synthclone::SampleFrameCount current,
                            synthclone::SampleFrameCount total)
 {
-    emit progressChanged(static_cast<float>(current) / total);
+    reportProgress(static_cast<float>(current) / total);
 }
 
 void
@@ -112,7 +112,7 @@ Effect::process(const synthclone::Zone &/*zone*/,
  writeSample:
     inputStream.seek(start, synthclone::SampleStream::OFFSET_START);
     synthclone::SampleFrameCount newFrameCount = (end - start) + 1;
-    emit progressChanged(0.0);
+    reportProgress(0.0);
     emit statusChanged(tr("Writing sample ..."));
     synthclone::SampleCopier copier;
     connect(&copier,
@@ -122,7 +122,7 @@ Effect::process(const synthclone::Zone &/*zone*/,
                                     synthclone::SampleFrameCount)),
             Qt::DirectConnection);
     copier.copy(inputStream, outputStream, newFrameCount);
-    emit progressChanged(0.0);
+    reportProgress(0.0);
     emit statusChanged("");
 }
 
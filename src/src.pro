@@ -2,4 +2,7 @@ CONFIG += ordered
 SUBDIRS = lib \
     plugins \
     synthclone
+!isEmpty(BUILD_BENCH) {
+    SUBDIRS += bench
+}
 TEMPLATE = subdirs
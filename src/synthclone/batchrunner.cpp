@@ -0,0 +1,297 @@
+/*
+ * synthclone - Synthesizer-cloning software
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <QtCore/QLocale>
+#include <QtCore/QStringList>
+
+#include <synthclone/error.h>
+
+#include "batchrunner.h"
+
+BatchRunner::BatchRunner(Session &session, QObject *parent):
+    QObject(parent),
+    errorStream(stderr, QIODevice::WriteOnly),
+    outputStream(stdout, QIODevice::WriteOnly),
+    session(session)
+{
+    applyEffectsEnabled = false;
+    buildTargetsEnabled = false;
+    effectJobCount = 0;
+    effectJobsStarted = 0;
+    errorCount = 0;
+    lastProgress = -1;
+}
+
+BatchRunner::~BatchRunner()
+{
+    // Empty
+}
+
+void
+BatchRunner::applyEffects()
+{
+    if (! session.getEffectCount()) {
+        outputStream << tr("The session has no effects; skipping effect "
+                           "jobs.") << endl;
+        return;
+    }
+
+    // Effect jobs run in the session's effect job thread.  The event loop
+    // processes job completions until the effect job queue is empty.
+    effectJobCount = 0;
+    effectJobsStarted = 0;
+    int zoneCount = session.getZoneCount();
+    for (int i = 0; i < zoneCount; i++) {
+        if (session.getZone(i)->getDrySample()) {
+            effectJobCount++;
+        }
+    }
+    connect(&session,
+            SIGNAL(currentEffectJobChanged(const synthclone::EffectJob *)),
+            SLOT(handleCurrentEffectJobChange(const synthclone::EffectJob *)));
+    for (int i = 0; i < zoneCount; i++) {
+        synthclone::Zone *zone = session.getZone(i);
+        if (zone->getDrySample()) {
+            session.addEffectJob(zone);
+        }
+    }
+    if (session.getCurrentEffectJob() || session.getEffectJobCount()) {
+        eventLoop.exec();
+    }
+    disconnect(&session,
+               SIGNAL(currentEffectJobChanged(const synthclone::EffectJob *)),
+               this,
+               SLOT(handleCurrentEffectJobChange
+                    (const synthclone::EffectJob *)));
+    printProgress(1.0, tr("Applied effects to %1 zones.").
+                  arg(QLocale::system().toString(effectJobCount)));
+
+    // Wet samples are written to the session directory, so the session is
+    // saved to keep track of them.
+    if (session.getState() == synthclone::SESSIONSTATE_MODIFIED) {
+        outputStream << tr("Saving session ...") << endl;
+        session.save();
+    }
+}
+
+void
+BatchRunner::buildTargets()
+{
+    if (! session.getTargetCount()) {
+        reportError(tr("the session has no targets"));
+        return;
+    }
+    session.buildTargets();
+}
+
+void
+BatchRunner::handleCurrentEffectJobChange(const synthclone::EffectJob *job)
+{
+    if (job) {
+        printProgress(static_cast<float>(effectJobsStarted) / effectJobCount,
+                      tr("Applying effects to zone %1 of %2 ...").
+                      arg(effectJobsStarted + 1).arg(effectJobCount));
+        effectJobsStarted++;
+    } else if (! session.getEffectJobCount()) {
+        eventLoop.quit();
+    }
+}
+
+void
+BatchRunner::handleLoadWarning(int line, int column, const QString &message)
+{
+    errorStream << tr("Warning: line %1, column %2: %3").
+        arg(line).arg(column).arg(message) << endl;
+}
+
+void
+BatchRunner::handleProgressChange(float progress, const QString &status)
+{
+    printProgress(progress, status);
+}
+
+void
+BatchRunner::handleTargetBuild(const synthclone::Target *target)
+{
+    connect(target, SIGNAL(buildWarning(const QString &)),
+            SLOT(handleTargetBuildWarning(const QString &)));
+    connect(target, SIGNAL(progressChanged(float)),
+            SLOT(handleTargetProgressChange(float)));
+    connect(target, SIGNAL(statusChanged(const QString &)),
+            SLOT(handleTargetStatusChange(const QString &)));
+    lastProgress = -1;
+    lastStatus = "";
+    outputStream << tr("Building target '%1' ...").arg(target->getName())
+                 << endl;
+}
+
+void
+BatchRunner::handleTargetBuildCompletion(const synthclone::Target *target)
+{
+    disconnect(target, 0, this, 0);
+    outputStream << tr("Target '%1' built successfully.").
+        arg(target->getName()) << endl;
+}
+
+void
+BatchRunner::handleTargetBuildError(const synthclone::Target *target,
+                                    const QString &message)
+{
+    disconnect(target, 0, this, 0);
+    reportError(tr("target '%1' build failed: %2").
+                arg(target->getName(), message));
+}
+
+void
+BatchRunner::handleTargetBuildWarning(const QString &message)
+{
+    errorStream << tr("Warning: %1").arg(message) << endl;
+}
+
+void
+BatchRunner::handleTargetProgressChange(float progress)
+{
+    printProgress(progress, lastStatus);
+}
+
+void
+BatchRunner::handleTargetStatusChange(const QString &status)
+{
+    printProgress(lastProgress / 100.0, status);
+}
+
+bool
+BatchRunner::isApplyEffectsEnabled() const
+{
+    return applyEffectsEnabled;
+}
+
+bool
+BatchRunner::isBuildTargetsEnabled() const
+{
+    return buildTargetsEnabled;
+}
+
+void
+BatchRunner::printProgress(float progress, const QString &status)
+{
+    // Progress is only printed when the status or the whole percentage
+    // changes, so that components that report progress often don't flood the
+    // output.
+    int percentage = qBound(0, static_cast<int>(progress * 100.0), 100);
+    if ((percentage == lastProgress) && (status == lastStatus)) {
+        return;
+    }
+    lastProgress = percentage;
+    lastStatus = status;
+    outputStream << QString("[%1%] ").arg(percentage, 3) << status << endl;
+}
+
+void
+BatchRunner::reportError(const QString &message)
+{
+    errorStream << tr("Error: %1").arg(message) << endl;
+    errorCount++;
+}
+
+int
+BatchRunner::run(const QList<QDir> &directories)
+{
+    QLocale locale = QLocale::system();
+    int count = directories.count();
+    QStringList failedPaths;
+    for (int i = 0; i < count; i++) {
+        const QDir &directory = directories[i];
+        outputStream << tr("Session %1 of %2").
+            arg(locale.toString(i + 1), locale.toString(count)) << endl;
+        if (! runSession(directory)) {
+            failedPaths.append(directory.absolutePath());
+        }
+    }
+    if (count > 1) {
+        outputStream << tr("Processed %1 sessions; %2 failed.").
+            arg(locale.toString(count),
+                locale.toString(failedPaths.count())) << endl;
+        for (int i = 0; i < failedPaths.count(); i++) {
+            outputStream << tr("Failed: %1").arg(failedPaths[i]) << endl;
+        }
+    }
+    return failedPaths.isEmpty() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+bool
+BatchRunner::runSession(const QDir &directory)
+{
+    errorCount = 0;
+    lastProgress = -1;
+    lastStatus = "";
+
+    connect(&session, SIGNAL(buildingTarget(const synthclone::Target *)),
+            SLOT(handleTargetBuild(const synthclone::Target *)));
+    connect(&session, SIGNAL(loadWarning(int, int, QString)),
+            SLOT(handleLoadWarning(int, int, QString)));
+    connect(&session, SIGNAL(progressChanged(float, QString)),
+            SLOT(handleProgressChange(float, QString)));
+    connect(&session,
+            SIGNAL(targetBuildError(const synthclone::Target *, QString)),
+            SLOT(handleTargetBuildError(const synthclone::Target *,
+                                        QString)));
+    connect(&session, SIGNAL(targetBuilt(const synthclone::Target *)),
+            SLOT(handleTargetBuildCompletion(const synthclone::Target *)));
+
+    QString path = directory.absolutePath();
+    outputStream << tr("Loading session '%1' ...").arg(path) << endl;
+    try {
+        session.load(directory);
+        if (applyEffectsEnabled) {
+            applyEffects();
+        }
+        if (buildTargetsEnabled) {
+            buildTargets();
+        }
+    } catch (synthclone::Error &e) {
+        reportError(tr("session '%1': %2").arg(path, e.getMessage()));
+    }
+    session.unload();
+    disconnect(&session, 0, this, 0);
+
+    if (errorCount) {
+        outputStream << tr("Session '%1' finished with %2 errors.").
+            arg(path, QLocale::system().toString(errorCount)) << endl;
+        return false;
+    }
+    outputStream << tr("Session '%1' finished without errors.").arg(path)
+                 << endl;
+    return true;
+}
+
+void
+BatchRunner::setApplyEffectsEnabled(bool enabled)
+{
+    applyEffectsEnabled = enabled;
+}
+
+void
+BatchRunner::setBuildTargetsEnabled(bool enabled)
+{
+    buildTargetsEnabled = enabled;
+}
@@ -0,0 +1,127 @@
+/*
+ * synthclone - Synthesizer-cloning software
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __BATCHRUNNER_H__
+#define __BATCHRUNNER_H__
+
+#include <QtCore/QEventLoop>
+#include <QtCore/QList>
+#include <QtCore/QTextStream>
+
+#include "session.h"
+
+// Loads sessions without user interaction, applies effects to every zone that
+// has a dry sample, and builds the session targets.  Sessions are processed
+// one after the other in the same process, so plugins and their shared
+// resources are only loaded once.  Progress is written to stdout, and errors
+// and warnings are written to stderr.
+
+class BatchRunner: public QObject {
+
+    Q_OBJECT
+
+public:
+
+    explicit
+    BatchRunner(Session &session, QObject *parent=0);
+
+    ~BatchRunner();
+
+    bool
+    isApplyEffectsEnabled() const;
+
+    bool
+    isBuildTargetsEnabled() const;
+
+    // Runs the batch operations on the sessions in the given directories, and
+    // returns an exit status.  A session that fails doesn't stop the other
+    // sessions from being processed.
+    int
+    run(const QList<QDir> &directories);
+
+public slots:
+
+    void
+    reportError(const QString &message);
+
+    void
+    setApplyEffectsEnabled(bool enabled);
+
+    void
+    setBuildTargetsEnabled(bool enabled);
+
+private slots:
+
+    void
+    handleCurrentEffectJobChange(const synthclone::EffectJob *job);
+
+    void
+    handleLoadWarning(int line, int column, const QString &message);
+
+    void
+    handleProgressChange(float progress, const QString &status);
+
+    void
+    handleTargetBuild(const synthclone::Target *target);
+
+    void
+    handleTargetBuildCompletion(const synthclone::Target *target);
+
+    void
+    handleTargetBuildError(const synthclone::Target *target,
+                           const QString &message);
+
+    void
+    handleTargetBuildWarning(const QString &message);
+
+    void
+    handleTargetProgressChange(float progress);
+
+    void
+    handleTargetStatusChange(const QString &status);
+
+private:
+
+    void
+    applyEffects();
+
+    void
+    buildTargets();
+
+    void
+    printProgress(float progress, const QString &status);
+
+    bool
+    runSession(const QDir &directory);
+
+    bool applyEffectsEnabled;
+    bool buildTargetsEnabled;
+    int effectJobCount;
+    int effectJobsStarted;
+    int errorCount;
+    QTextStream errorStream;
+    QEventLoop eventLoop;
+    int lastProgress;
+    QString lastStatus;
+    QTextStream outputStream;
+    Session &session;
+
+};
+
+#endif
@@ -338,6 +338,13 @@ static QByteArray TARGETS_BUILT_SIGNAL =
     QMetaObject::normalizedSignature
     (SIGNAL(targetsBuilt()));
 
+static QByteArray STAGE_METRICS_ADDED_SIGNAL =
+    QMetaObject::normalizedSignature
+    (SIGNAL(stageMetricsAdded(const synthclone::StageMetrics &, int)));
+static QByteArray STAGE_METRICS_CLEARED_SIGNAL =
+    QMetaObject::normalizedSignature
+    (SIGNAL(stageMetricsCleared()));
+
 static QByteArray ACTIVATING_PARTICIPANT_SIGNAL =
     QMetaObject::normalizedSignature
     (SIGNAL(activatingParticipant(const synthclone::Participant *,
@@ -631,6 +638,11 @@ static SignalMap sessionSignalMap =
     SignalPair(QLatin1String(TARGETS_BUILT_SIGNAL),
                TARGETS_BUILT_SIGNAL) <<
 
+    SignalPair(QLatin1String(STAGE_METRICS_ADDED_SIGNAL),
+               STAGE_METRICS_ADDED_SIGNAL) <<
+    SignalPair(QLatin1String(STAGE_METRICS_CLEARED_SIGNAL),
+               STAGE_METRICS_CLEARED_SIGNAL) <<
+
     SignalPair(QLatin1String(AFTERTOUCH_PROPERTY_VISIBILITY_CHANGED_SIGNAL),
                AFTERTOUCH_PROPERTY_VISIBILITY_CHANGED_SIGNAL) <<
     SignalPair(QLatin1String
@@ -717,12 +729,24 @@ Context::~Context()
     assert(! targets.count());
 }
 
+void
+Context::abortCurrentEffectJob()
+{
+    session.abortCurrentEffectJob();
+}
+
 void
 Context::abortCurrentSamplerJob()
 {
     session.abortCurrentSamplerJob();
 }
 
+void
+Context::abortTargetBuild()
+{
+    session.abortTargetBuild();
+}
+
 void
 Context::activateParticipant(const synthclone::Participant *participant)
 {
@@ -892,6 +916,12 @@ Context::buildTargets()
     session.buildTargets();
 }
 
+void
+Context::clearStageMetrics()
+{
+    session.clearStageMetrics();
+}
+
 void
 Context::connectNotify(const char *signal)
 {
@@ -920,6 +950,12 @@ Context::connectNotify(const char *signal)
     }
 }
 
+QString
+Context::createSampleFile()
+{
+    return session.createSampleFile();
+}
+
 void
 Context::createSession(const QDir &directory, synthclone::SampleRate sampleRate,
                        synthclone::SampleChannelCount count)
@@ -1135,6 +1171,18 @@ Context::getSessionState() const
     return session.getState();
 }
 
+synthclone::StageMetrics
+Context::getStageMetrics(int index) const
+{
+    return session.getStageMetrics(index);
+}
+
+int
+Context::getStageMetricsCount() const
+{
+    return session.getStageMetricsCount();
+}
+
 const synthclone::Target *
 Context::getTarget(int index) const
 {
@@ -1153,6 +1201,12 @@ Context::getTargetIndex(const synthclone::Target *target) const
     return session.getTargetIndex(target);
 }
 
+synthclone::TaskPool &
+Context::getTaskPool()
+{
+    return controller.getTaskPool();
+}
+
 synthclone::Zone *
 Context::getZone(int index)
 {
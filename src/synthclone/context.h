@@ -130,6 +130,12 @@ public:
     synthclone::SessionState
     getSessionState() const;
 
+    synthclone::StageMetrics
+    getStageMetrics(int index) const;
+
+    int
+    getStageMetricsCount() const;
+
     const synthclone::Target *
     getTarget(int index) const;
 
@@ -139,6 +145,9 @@ public:
     int
     getTargetIndex(const synthclone::Target *target) const;
 
+    synthclone::TaskPool &
+    getTaskPool();
+
     synthclone::Zone *
     getZone(int index);
 
@@ -195,9 +204,15 @@ public:
 
 public slots:
 
+    void
+    abortCurrentEffectJob();
+
     void
     abortCurrentSamplerJob();
 
+    void
+    abortTargetBuild();
+
     void
     activateParticipant(const synthclone::Participant *participant);
 
@@ -264,6 +279,12 @@ public slots:
     void
     buildTargets();
 
+    void
+    clearStageMetrics();
+
+    QString
+    createSampleFile();
+
     void
     createSession(const QDir &directory, synthclone::SampleRate sampleRate,
                   synthclone::SampleChannelCount count);
@@ -23,8 +23,10 @@
 #include <QtCore/QDirIterator>
 #include <QtCore/QFSFileEngine>
 #include <QtCore/QMimeData>
+#include <QtCore/QThreadPool>
 #include <QtGui/QClipboard>
 
+#include <synthclone/cancellationtoken.h>
 #include <synthclone/error.h>
 
 #include "controller.h"
@@ -41,10 +43,12 @@ static const char *PLUGIN_PATH = XSTRINGIFY(SYNTHCLONE_PLUGIN_PATH);
 Controller::Controller(Application &application, QObject *parent):
     QObject(parent),
     application(application),
+    taskPool(QThreadPool::globalInstance()->maxThreadCount()),
     participantManager(*this),
     session(participantManager),
     settings(session),
-    menuManager(mainView, session)
+    menuManager(mainView, session),
+    targetBuildInputFilter(progressView.getRootWidget())
 {
     // Setup views
 
@@ -69,6 +73,8 @@ Controller::Controller(Application &application, QObject *parent):
     connect(&participantView, SIGNAL(closeRequest()),
             SLOT(handleParticipantViewCloseRequest()));
 
+    connect(&progressView, SIGNAL(cancelRequest()),
+            SLOT(handleProgressViewCancelRequest()));
     connect(&progressView, SIGNAL(closeRequest()),
             SLOT(handleProgressViewCloseRequest()));
 
@@ -184,6 +190,8 @@ Controller::Controller(Application &application, QObject *parent):
             &session, SLOT(setSampleTimePropertyVisible(bool)));
     connect(zoneViewlet, SIGNAL(statusPropertyVisibilityChangeRequest(bool)),
             &session, SLOT(setStatusPropertyVisible(bool)));
+    connect(zoneViewlet, SIGNAL(pipelineEnabledChangeRequest(bool)),
+            &session, SLOT(setPipelineEnabled(bool)));
     connect(zoneViewlet, SIGNAL(velocityPropertyVisibilityChangeRequest(bool)),
             &session, SLOT(setVelocityPropertyVisible(bool)));
     connect(zoneViewlet, SIGNAL(wetSamplePropertyVisibilityChangeRequest(bool)),
@@ -247,6 +255,8 @@ Controller::Controller(Application &application, QObject *parent):
             SLOT(handleZoneViewletVelocityChangeRequest(int,
                                                         synthclone::MIDIData)));
 
+    connect(zoneViewlet, SIGNAL(abortEffectJobRequest()),
+            &session, SLOT(abortCurrentEffectJob()));
     connect(zoneViewlet, SIGNAL(applyEffectsRequest()),
             SLOT(handleZoneViewletApplyEffectsRequest()));
     connect(zoneViewlet, SIGNAL(clearEffectJobsRequest()),
@@ -285,6 +295,7 @@ Controller::Controller(Application &application, QObject *parent):
     connect(zoneViewlet, SIGNAL(selectionChangeRequest(int, bool)),
             &session, SLOT(setZoneSelected(int, bool)));
 
+    zoneViewlet->setAbortEffectJobEnabled(false);
     zoneViewlet->setApplyEffectsEnabled(false);
     zoneViewlet->setBuildTargetsEnabled(false);
     zoneViewlet->setClearEffectJobsEnabled(false);
@@ -311,6 +322,7 @@ Controller::Controller(Application &application, QObject *parent):
     zoneViewlet->setDrySamplePropertyVisible
         (session.isDrySamplePropertyVisible());
     zoneViewlet->setNotePropertyVisible(session.isNotePropertyVisible());
+    zoneViewlet->setPipelineEnabled(session.isPipelineEnabled());
     zoneViewlet->setReleaseTimePropertyVisible
         (session.isReleaseTimePropertyVisible());
     zoneViewlet->setSampleTimePropertyVisible
@@ -373,6 +385,8 @@ Controller::Controller(Application &application, QObject *parent):
             zoneViewlet, SLOT(setDrySamplePropertyVisible(bool)));
     connect(&session, SIGNAL(notePropertyVisibilityChanged(bool)),
             zoneViewlet, SLOT(setNotePropertyVisible(bool)));
+    connect(&session, SIGNAL(pipelineEnabledChanged(bool)),
+            zoneViewlet, SLOT(setPipelineEnabled(bool)));
     connect(&session, SIGNAL(releaseTimePropertyVisibilityChanged(bool)),
             zoneViewlet, SLOT(setReleaseTimePropertyVisible(bool)));
     connect(&session, SIGNAL(sampleTimePropertyVisibilityChanged(bool)),
@@ -441,6 +455,8 @@ Controller::Controller(Application &application, QObject *parent):
             SLOT(handleSessionTargetBuild(const synthclone::Target *)));
     connect(&session, SIGNAL(buildingTargets()),
             SLOT(handleSessionTargetBuildOperation()));
+    connect(&session, SIGNAL(targetBuildAborted(const synthclone::Target *)),
+            SLOT(handleSessionTargetBuildAbort(const synthclone::Target *)));
     connect(&session,
             SIGNAL(targetBuildError(const synthclone::Target *, QString)),
             SLOT(handleSessionTargetBuildError(const synthclone::Target *,
@@ -467,8 +483,16 @@ Controller::Controller(Application &application, QObject *parent):
     connect(QApplication::clipboard(), SIGNAL(dataChanged()),
             SLOT(handleClipboardDataChange()));
 
+    batchMode = false;
     lastSessionState = synthclone::SESSIONSTATE_CURRENT;
 
+    session.setEffectCacheBudget(settings.getEffectCacheBudget());
+
+    // The retry count is read from a user-editable settings file, so it's
+    // clamped rather than trusted.
+    session.setSamplerJobRetryCount
+        (qMax(0, settings.getSamplerJobRetryCount()));
+
     // Load plugins
     QStringList scannedPaths;
     loadPlugins(getCorePluginDirectory(), scannedPaths);
@@ -575,6 +599,12 @@ Controller::getSession()
     return session;
 }
 
+synthclone::TaskPool &
+Controller::getTaskPool()
+{
+    return taskPool;
+}
+
 bool
 Controller::loadClipboardZoneList(QDomDocument &document)
 {
@@ -646,6 +676,20 @@ Controller::processQuitRequest()
     }
 }
 
+void
+Controller::processTargetBuildEvents()
+{
+    // User input is processed so that the build can be cancelled from the
+    // progress view.  Input to other windows is dropped by the target build
+    // input filter, so the session can't be changed inside the build.  Other
+    // event handlers must not see the build's cancellation token.
+    const synthclone::CancellationToken *token =
+        synthclone::CancellationToken::getCurrent();
+    synthclone::CancellationToken::setCurrent(0);
+    application.processEvents();
+    synthclone::CancellationToken::setCurrent(token);
+}
+
 void
 Controller::quit()
 {
@@ -781,8 +825,11 @@ Controller::removeSelectedZones()
 void
 Controller::reportError(const QString &message)
 {
-    errorView.setMessage(message);
-    errorView.setVisible(true);
+    // In batch mode, errors are handled by the batch runner.
+    if (! batchMode) {
+        errorView.setMessage(message);
+        errorView.setVisible(true);
+    }
     emit errorReported(message);
 }
 
@@ -807,6 +854,32 @@ Controller::run(const QDir *sessionDirectory)
     application.exec();
 }
 
+int
+Controller::runBatch(const QList<QDir> &sessionDirectories,
+                     bool applyEffects, bool buildTargets)
+{
+    batchMode = true;
+
+    // Pipelined sessions would build targets after every effect job, even if
+    // the batch doesn't build targets.
+    session.setPipelineSuspended(true);
+    BatchRunner runner(session);
+    runner.setApplyEffectsEnabled(applyEffects);
+    runner.setBuildTargetsEnabled(buildTargets);
+    connect(this, SIGNAL(errorReported(const QString &)),
+            &runner, SLOT(reportError(const QString &)));
+    int result = runner.run(sessionDirectories);
+    session.setPipelineSuspended(false);
+    batchMode = false;
+    return result;
+}
+
+void
+Controller::setBatchMode(bool batchMode)
+{
+    this->batchMode = batchMode;
+}
+
 void
 Controller::setSessionLoadViewCreationDefaults()
 {
@@ -1266,6 +1339,14 @@ Controller::handleParticipantViewletActivationChangeRequest(bool activate)
 // ProgressView signal handlers
 ////////////////////////////////////////////////////////////////////////////////
 
+void
+Controller::handleProgressViewCancelRequest()
+{
+    progressView.setCancelVisible(false);
+    progressView.setStatus(tr("Cancelling ..."));
+    session.abortTargetBuild();
+}
+
 void
 Controller::handleProgressViewCloseRequest()
 {
@@ -1364,8 +1445,9 @@ void
 Controller::
 handleSessionCurrentEffectJobChange(const synthclone::EffectJob *job)
 {
-    mainView.getComponentViewlet()->
-        setEffectEditingEnabled(! static_cast<bool>(job));
+    bool hasJob = static_cast<bool>(job);
+    mainView.getComponentViewlet()->setEffectEditingEnabled(! hasJob);
+    mainView.getZoneViewlet()->setAbortEffectJobEnabled(hasJob);
 }
 
 void
@@ -1580,6 +1662,10 @@ void
 Controller::handleSessionStateChange(synthclone::SessionState state,
                                      const QDir *directory)
 {
+    if (batchMode) {
+        lastSessionState = state;
+        return;
+    }
     bool enabled;
     SessionViewlet *viewlet = mainView.getSessionViewlet();
     switch (state) {
@@ -1662,6 +1748,19 @@ Controller::handleSessionTargetBuild(const synthclone::Target *target)
     application.processEvents(QEventLoop::ExcludeUserInputEvents);
 }
 
+void
+Controller::handleSessionTargetBuildAbort(const synthclone::Target *target)
+{
+    disconnect(target, SIGNAL(buildWarning(const QString &)),
+               this, SLOT(handleTargetBuildWarning(const QString &)));
+    disconnect(target, SIGNAL(progressChanged(float)),
+               this, SLOT(handleTargetBuildProgressChange(float)));
+    disconnect(target, SIGNAL(statusChanged(const QString &)),
+               this, SLOT(handleTargetBuildStatusChange(const QString &)));
+    progressView.addMessage(tr("Target '%1' build cancelled.").
+                            arg(target->getName()));
+}
+
 void
 Controller::
 handleSessionTargetBuildCompletion(const synthclone::Target *target)
@@ -1696,16 +1795,20 @@ Controller::handleSessionTargetBuildError(const synthclone::Target *target,
 void
 Controller::handleSessionTargetBuildOperation()
 {
+    application.installEventFilter(&targetBuildInputFilter);
     progressView.setCloseEnabled(false);
     progressView.setProgress(0.0);
+    progressView.setCancelVisible(true);
     progressView.setStatus(tr("Building targets ..."));
-    progressView.setVisible(true);
+    progressView.setVisible(! batchMode);
     application.processEvents(QEventLoop::ExcludeUserInputEvents);
 }
 
 void
 Controller::handleSessionTargetBuildOperationCompletion()
 {
+    application.removeEventFilter(&targetBuildInputFilter);
+    progressView.setCancelVisible(false);
     progressView.setCloseEnabled(true);
     progressView.setProgress(0.0);
     progressView.setStatus("");
@@ -1921,14 +2024,14 @@ void
 Controller::handleTargetBuildProgressChange(float progress)
 {
     progressView.setProgress(progress);
-    application.processEvents(QEventLoop::ExcludeUserInputEvents);
+    processTargetBuildEvents();
 }
 
 void
 Controller::handleTargetBuildStatusChange(const QString &status)
 {
     progressView.addMessage(status);
-    application.processEvents(QEventLoop::ExcludeUserInputEvents);
+    processTargetBuildEvents();
 }
 
 void
@@ -1936,7 +2039,7 @@ Controller::handleTargetBuildWarning(const QString &message)
 {
     targetBuildWarningCount++;
     progressView.addMessage(tr("WARN: %1").arg(message));
-    application.processEvents(QEventLoop::ExcludeUserInputEvents);
+    processTargetBuildEvents();
 }
 
 void
@@ -21,10 +21,13 @@
 #define __CONTROLLER_H__
 
 #include <synthclone/fileselectionview.h>
+#include <synthclone/taskpool.h>
 
 #include "aboutview.h"
 #include "application.h"
+#include "batchrunner.h"
 #include "errorview.h"
+#include "inputblockeventfilter.h"
 #include "mainview.h"
 #include "menumanager.h"
 #include "participantmanager.h"
@@ -57,6 +60,9 @@ public:
     Session &
     getSession();
 
+    synthclone::TaskPool &
+    getTaskPool();
+
 public slots:
 
     void
@@ -68,6 +74,16 @@ public slots:
     void
     run(const QDir *sessionDirectory);
 
+    int
+    runBatch(const QList<QDir> &sessionDirectories, bool applyEffects,
+             bool buildTargets);
+
+    // Batch mode keeps views hidden, and leaves error handling to whoever
+    // connects to 'errorReported()'.  'runBatch()' enables batch mode for the
+    // duration of the run.
+    void
+    setBatchMode(bool batchMode);
+
 signals:
 
     void
@@ -142,6 +158,9 @@ private slots:
     void
     handleParticipantViewletActivationChangeRequest(bool activate);
 
+    void
+    handleProgressViewCancelRequest();
+
     void
     handleProgressViewCloseRequest();
 
@@ -218,6 +237,9 @@ private slots:
     void
     handleSessionTargetBuild(const synthclone::Target *target);
 
+    void
+    handleSessionTargetBuildAbort(const synthclone::Target *target);
+
     void
     handleSessionTargetBuildCompletion(const synthclone::Target *target);
 
@@ -501,6 +523,9 @@ private:
     void
     processQuitRequest();
 
+    void
+    processTargetBuildEvents();
+
     void
     refreshZoneBuildTargetsAction();
 
@@ -532,6 +557,7 @@ private:
     verifySessionLoadViewOpen(const QString &path);
 
     Application &application;
+    bool batchMode;
     QString createSessionName;
     synthclone::SessionState lastSessionState;
     ParticipantViewletMap participantViewletMap;
@@ -544,6 +570,10 @@ private:
     int sessionLoadWarningCount;
     int targetBuildWarningCount;
 
+    // The task pool is constructed before, and destroyed after, the
+    // participants that use it.
+    synthclone::TaskPool taskPool;
+
     ParticipantManager participantManager;
 
     Session session;
@@ -561,6 +591,10 @@ private:
 
     MenuManager menuManager;
 
+    // Installed on the application while targets are being built, as user
+    // input is processed inside the build so that it can be cancelled.
+    InputBlockEventFilter targetBuildInputFilter;
+
 };
 
 #endif
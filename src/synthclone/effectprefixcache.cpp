@@ -0,0 +1,169 @@
+/*
+ * synthclone - Synthesizer-cloning software
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include <cassert>
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QFileInfo>
+#include <QtCore/QMutexLocker>
+
+#include <synthclone/util.h>
+
+#include "effectprefixcache.h"
+
+// Static functions
+
+QByteArray
+EffectPrefixCache::getInitialKey(const synthclone::Zone &zone)
+{
+    const synthclone::Sample *drySample = zone.getDrySample();
+    CONFIRM(drySample, tr("zone does not have a dry sample"));
+
+    // The key covers the identity of the dry sample, and the zone properties
+    // that are passed to Effect::process().
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    QString path = drySample->getPath();
+    QFileInfo info(path);
+    stream << path << info.size() << info.lastModified()
+           << zone.getAftertouch() << zone.getChannel()
+           << zone.getChannelPressure() << zone.getNote()
+           << zone.getReleaseTime() << zone.getSampleTime()
+           << zone.getVelocity();
+    const synthclone::Zone::ControlMap &controlMap = zone.getControlMap();
+    synthclone::Zone::ControlMap::const_iterator end = controlMap.constEnd();
+    for (synthclone::Zone::ControlMap::const_iterator iter =
+             controlMap.constBegin(); iter != end; iter++) {
+        stream << iter.key() << iter.value();
+    }
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+QByteArray
+EffectPrefixCache::getNextKey(const QByteArray &key,
+                              const synthclone::Effect &effect,
+                              const QString &participantName,
+                              const QVariant &state)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << key << participantName
+           << QString(effect.metaObject()->className()) << state;
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+// Class definition
+
+EffectPrefixCache::EffectPrefixCache(QObject *parent):
+    QObject(parent)
+{
+    budget = 0;
+    size = 0;
+}
+
+EffectPrefixCache::~EffectPrefixCache()
+{
+    clear();
+}
+
+void
+EffectPrefixCache::clear()
+{
+    QMutexLocker locker(&mutex);
+    evict(0);
+    assert(! entryMap.count());
+    assert(! size);
+}
+
+void
+EffectPrefixCache::evict(qint64 budget)
+{
+    while (size > budget) {
+        assert(keys.count());
+        Entry entry = entryMap.take(keys.takeFirst());
+        assert(entry.sample->isTemporary());
+        delete entry.sample;
+        size -= entry.size;
+    }
+}
+
+const synthclone::Sample *
+EffectPrefixCache::get(const QByteArray &key)
+{
+    QMutexLocker locker(&mutex);
+    EntryMap::const_iterator iter = entryMap.constFind(key);
+    if (iter == entryMap.constEnd()) {
+        return 0;
+    }
+
+    // Mark the entry as the most recently used entry.
+    bool removed = keys.removeOne(key);
+    assert(removed);
+    keys.append(key);
+
+    return iter.value().sample;
+}
+
+qint64
+EffectPrefixCache::getBudget() const
+{
+    QMutexLocker locker(&mutex);
+    return budget;
+}
+
+qint64
+EffectPrefixCache::getSize() const
+{
+    QMutexLocker locker(&mutex);
+    return size;
+}
+
+bool
+EffectPrefixCache::insert(const QByteArray &key, synthclone::Sample *sample)
+{
+    CONFIRM(sample, tr("sample is set to NULL"));
+    CONFIRM(sample->isTemporary(), tr("sample is not temporary"));
+
+    QMutexLocker locker(&mutex);
+    CONFIRM(! entryMap.contains(key), tr("key is already in cache"));
+    qint64 sampleSize = QFileInfo(sample->getPath()).size();
+    if (sampleSize > budget) {
+        return false;
+    }
+    evict(budget - sampleSize);
+    Entry entry;
+    entry.sample = sample;
+    entry.size = sampleSize;
+    entryMap.insert(key, entry);
+    keys.append(key);
+    size += sampleSize;
+    return true;
+}
+
+void
+EffectPrefixCache::setBudget(qint64 budget)
+{
+    CONFIRM(budget >= 0, tr("'%1': invalid cache budget").arg(budget));
+
+    QMutexLocker locker(&mutex);
+    evict(budget);
+    this->budget = budget;
+}
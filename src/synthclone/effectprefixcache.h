@@ -0,0 +1,104 @@
+/*
+ * synthclone - Synthesizer-cloning software
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __EFFECTPREFIXCACHE_H__
+#define __EFFECTPREFIXCACHE_H__
+
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+#include <QtCore/QMap>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QVariant>
+
+#include <synthclone/effect.h>
+#include <synthclone/sample.h>
+#include <synthclone/zone.h>
+
+// Caches the output of each effect chain prefix, so that an effect job only
+// needs to run the effects that follow the longest prefix that hasn't
+// changed.  Cached samples are temporary files; the total size of the cached
+// files is bounded by the cache budget, and the least recently used entries
+// are evicted first.
+
+class EffectPrefixCache: public QObject {
+
+    Q_OBJECT
+
+public:
+
+    static QByteArray
+    getInitialKey(const synthclone::Zone &zone);
+
+    static QByteArray
+    getNextKey(const QByteArray &key, const synthclone::Effect &effect,
+               const QString &participantName, const QVariant &state);
+
+    explicit
+    EffectPrefixCache(QObject *parent=0);
+
+    ~EffectPrefixCache();
+
+    // Returns the cached sample for the given key, or NULL if there is no such
+    // sample.  The sample is owned by the cache, and remains valid until the
+    // next call to 'clear()', 'insert()', or 'setBudget()'.
+    const synthclone::Sample *
+    get(const QByteArray &key);
+
+    qint64
+    getBudget() const;
+
+    qint64
+    getSize() const;
+
+    // Takes ownership of the sample and returns true, unless the sample is
+    // larger than the cache budget, in which case ownership stays with the
+    // caller and false is returned.
+    bool
+    insert(const QByteArray &key, synthclone::Sample *sample);
+
+public slots:
+
+    void
+    clear();
+
+    void
+    setBudget(qint64 budget);
+
+private:
+
+    struct Entry {
+        synthclone::Sample *sample;
+        qint64 size;
+    };
+
+    typedef QMap<QByteArray, Entry> EntryMap;
+
+    void
+    evict(qint64 budget);
+
+    qint64 budget;
+    EntryMap entryMap;
+    QList<QByteArray> keys;
+    mutable QMutex mutex;
+    qint64 size;
+
+};
+
+#endif
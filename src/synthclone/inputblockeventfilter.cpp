@@ -0,0 +1,60 @@
+/*
+ * synthclone - Synthesizer-cloning software
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "inputblockeventfilter.h"
+
+InputBlockEventFilter::InputBlockEventFilter(const QWidget *window,
+                                             QObject *parent):
+    QObject(parent)
+{
+    this->window = window;
+}
+
+InputBlockEventFilter::~InputBlockEventFilter()
+{
+    // Empty
+}
+
+bool
+InputBlockEventFilter::eventFilter(QObject *obj, QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::Close:
+    case QEvent::ContextMenu:
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::Shortcut:
+    case QEvent::ShortcutOverride:
+    case QEvent::Wheel:
+        {
+            // Action shortcuts are sent to the action, which isn't a widget.
+            QWidget *widget = qobject_cast<QWidget *>(obj);
+            if ((! widget) || (widget->window() != window)) {
+                return true;
+            }
+        }
+        break;
+    default:
+        ;
+    }
+    return QObject::eventFilter(obj, event);
+}
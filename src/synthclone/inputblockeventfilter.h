@@ -0,0 +1,52 @@
+/*
+ * synthclone - Synthesizer-cloning software
+ * Copyright (C) 2013 Devin Anderson
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program; if not, write to the Free Software Foundation, Inc., 675 Mass
+ * Ave, Cambridge, MA 02139, USA.
+ */
+
+#ifndef __INPUTBLOCKEVENTFILTER_H__
+#define __INPUTBLOCKEVENTFILTER_H__
+
+#include <QtCore/QEvent>
+#include <QtCore/QObject>
+#include <QtGui/QWidget>
+
+// Drops user input that's sent to any window other than the given window.
+// The filter is installed on the application while events are processed
+// inside a long running operation, so that event handlers can't start
+// operations that conflict with it.
+
+class InputBlockEventFilter: public QObject {
+
+    Q_OBJECT
+
+public:
+
+    explicit
+    InputBlockEventFilter(const QWidget *window, QObject *parent=0);
+
+    ~InputBlockEventFilter();
+
+    bool
+    eventFilter(QObject *obj, QEvent *event);
+
+private:
+
+    const QWidget *window;
+
+};
+
+#endif
@@ -22,12 +22,15 @@
 #include <exception>
 
 #include <QtCore/QDebug>
+#include <QtCore/QFile>
 #include <QtCore/QLibraryInfo>
 #include <QtCore/QLocale>
 #include <QtCore/QTextStream>
+#include <QtCore/QThreadPool>
 #include <QtCore/QTranslator>
 
 #include <synthclone/error.h>
+#include <synthclone/tracer.h>
 
 #include "controller.h"
 
@@ -54,27 +57,95 @@ main(int argc, char **argv)
     qDebug() << application.tr("Translations loaded.");
 
     // Command line arguments
-    bool loadSession;
+    bool applyEffects = false;
+    bool buildTargets = false;
+    int count = arguments.count();
+    int jobs;
+    bool ok = true;
     int result;
-    QDir sessionDirectory;
-    switch (arguments.count()) {
-    case 0:
-    case 1:
-        loadSession = false;
-        break;
-    case 2:
-        if (sessionDirectory.cd(arguments[1])) {
-            loadSession = true;
-            break;
+    QList<QDir> sessionDirectories;
+    QStringList sessionPaths;
+    QString tracePath;
+    synthclone::Tracer tracer;
+    for (int i = 1; ok && (i < count); i++) {
+        const QString &argument = arguments[i];
+        if (argument == "--apply-effects") {
+            applyEffects = true;
+        } else if (argument == "--build-targets") {
+            buildTargets = true;
+        } else if (argument == "--jobs") {
+            ok = ++i < count;
+            if (ok) {
+                jobs = arguments[i].toInt(&ok);
+                ok = ok && (jobs > 0);
+                if (ok) {
+                    QThreadPool::globalInstance()->setMaxThreadCount(jobs);
+                }
+            }
+        } else if (argument == "--session") {
+            ok = ++i < count;
+            if (ok) {
+                sessionPaths.append(arguments[i]);
+            }
+        } else if (argument == "--session-list") {
+
+            // Session lists contain one session directory per line.  Empty
+            // lines are ignored.
+            ok = ++i < count;
+            if (ok) {
+                QFile file(arguments[i]);
+                ok = file.open(QIODevice::ReadOnly);
+                if (ok) {
+                    QTextStream stream(&file);
+                    while (! stream.atEnd()) {
+                        QString line = stream.readLine().trimmed();
+                        if (! line.isEmpty()) {
+                            sessionPaths.append(line);
+                        }
+                    }
+                }
+            }
+        } else if (argument == "--trace") {
+            ok = ++i < count;
+            if (ok) {
+                tracePath = arguments[i];
+            }
+        } else if (argument.startsWith('-')) {
+            ok = false;
+        } else {
+            sessionPaths.append(argument);
+        }
+    }
+    for (int i = 0; ok && (i < sessionPaths.count()); i++) {
+        QDir sessionDirectory;
+        ok = sessionDirectory.cd(sessionPaths[i]);
+        if (ok) {
+            sessionDirectories.append(sessionDirectory);
         }
-        // Fallthrough on purpose
-    default:
+    }
+
+    // Effects and targets can only be batch processed if at least one session
+    // is given.  The user interface can only open one session.
+    bool batch = applyEffects || buildTargets;
+    if ((! ok) || (batch && sessionDirectories.isEmpty()) ||
+        ((! batch) && (sessionDirectories.count() > 1))) {
         QTextStream(stderr, QIODevice::WriteOnly) <<
-            application.tr("Usage: synthclone [qt-args] [session-dir]\n");
+            application.tr("Usage: synthclone [qt-args] [--trace file] "
+                           "[session-dir]\n"
+                           "       synthclone [qt-args] --session session-dir "
+                           "... [--session-list file] [--apply-effects] "
+                           "[--build-targets] [--jobs count] "
+                           "[--trace file]\n");
         result = EXIT_FAILURE;
         goto unloadTranslations;
     }
 
+    // The tracer records spans until the program exits.  The timeline can be
+    // viewed with 'chrome://tracing' or Perfetto.
+    if (! tracePath.isEmpty()) {
+        synthclone::Tracer::setActive(&tracer);
+    }
+
     try {
 
         // Controller
@@ -82,9 +153,18 @@ main(int argc, char **argv)
         Controller controller(application);
         qDebug() << application.tr("Core application objects created.");
 
-        // Run the program
+        // Run the program.  If effects or targets are batch processed, then
+        // the sessions are processed without showing the user interface, and
+        // the batch runner's exit status is used.
         qDebug() << application.tr("Running ...");
-        controller.run(loadSession ? &sessionDirectory : 0);
+        if (batch) {
+            result = controller.runBatch(sessionDirectories, applyEffects,
+                                         buildTargets);
+        } else {
+            controller.run(sessionDirectories.isEmpty() ? 0 :
+                           &(sessionDirectories[0]));
+            result = EXIT_SUCCESS;
+        }
 
     } catch (synthclone::Error &e) {
         errorMessage = e.getMessage();
@@ -94,13 +174,28 @@ main(int argc, char **argv)
 
     // Deal with errors.
     if (errorMessage.isEmpty()) {
-        qDebug() << application.tr("Exiting without errors ...");
-        result = EXIT_SUCCESS;
+        qDebug() << application.tr("Exiting with status %1 ...").arg(result);
     } else {
         QTextStream(stderr) << application.tr("Error: %1\n").arg(errorMessage);
         result = EXIT_FAILURE;
     }
 
+    // Write the timeline.
+    if (! tracePath.isEmpty()) {
+        synthclone::Tracer::setActive(0);
+        qDebug() << application.tr("Writing trace to '%1' ...").arg(tracePath);
+        QFile file(tracePath);
+        if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            tracer.write(file);
+        }
+        if (file.error() != QFile::NoError) {
+            QTextStream(stderr) << application.tr("Error: failed to write "
+                                                  "trace '%1': %2\n").
+                arg(tracePath, file.errorString());
+            result = EXIT_FAILURE;
+        }
+    }
+
 unloadTranslations:
     qDebug() << application.tr("Unloading translations ...");
     application.removeTranslator(&translator);
@@ -19,6 +19,8 @@
 
 #include <cassert>
 
+#include <QtGui/QKeyEvent>
+
 #include <synthclone/util.h>
 
 #include "progressview.h"
@@ -26,6 +28,9 @@
 ProgressView::ProgressView(QObject *parent):
     DialogView(":/synthclone/progressview.ui", parent)
 {
+    cancelButton = synthclone::getChild<QPushButton>(dialog, "cancelButton");
+    connect(cancelButton, SIGNAL(clicked()), SIGNAL(cancelRequest()));
+
     closeButton = synthclone::getChild<QPushButton>(dialog, "closeButton");
     connect(closeButton, SIGNAL(clicked()), SIGNAL(closeRequest()));
     connect(this, SIGNAL(closeEnabledChanged(bool)),
@@ -36,6 +41,10 @@ ProgressView::ProgressView(QObject *parent):
     progressBar = synthclone::getChild<QProgressBar>(dialog, "progressBar");
 
     status = synthclone::getChild<QLabel>(dialog, "status");
+
+    // QDialog rejects itself when Escape is pressed, which hides the dialog
+    // without going through the close request handling.
+    dialog->installEventFilter(this);
 }
 
 ProgressView::~ProgressView()
@@ -55,6 +64,26 @@ ProgressView::clearMessages()
     messages->clear();
 }
 
+bool
+ProgressView::eventFilter(QObject *obj, QEvent *event)
+{
+    if ((obj == dialog) && (event->type() == QEvent::KeyPress) &&
+        (static_cast<QKeyEvent *>(event)->key() == Qt::Key_Escape)) {
+        if (isCloseEnabled()) {
+            emit closeRequest();
+        }
+        return true;
+    }
+    return DialogView::eventFilter(obj, event);
+}
+
+void
+ProgressView::setCancelVisible(bool visible)
+{
+    cancelButton->setEnabled(true);
+    cancelButton->setVisible(visible);
+}
+
 void
 ProgressView::setProgress(float progress)
 {
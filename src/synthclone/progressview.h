@@ -44,14 +44,26 @@ public:
     void
     clearMessages();
 
+    bool
+    eventFilter(QObject *obj, QEvent *event);
+
+    void
+    setCancelVisible(bool visible);
+
     void
     setProgress(float progress);
 
     void
     setStatus(const QString &status);
 
+signals:
+
+    void
+    cancelRequest();
+
 private:
 
+    QPushButton *cancelButton;
     QPushButton *closeButton;
     QPlainTextEdit *messages;
     QProgressBar *progressBar;
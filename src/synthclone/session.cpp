@@ -20,12 +20,15 @@
 #include <cassert>
 #include <cctype>
 
+#include <QtCore/QFile>
 #include <QtCore/QFSFileEngine>
 #include <QtCore/QScopedPointer>
 #include <QtCore/QTemporaryFile>
 #include <QtCore/QtAlgorithms>
 
 #include <synthclone/error.h>
+#include <synthclone/stagemeter.h>
+#include <synthclone/tracer.h>
 #include <synthclone/util.h>
 
 #include "effectjob.h"
@@ -153,6 +156,8 @@ Session::Session(ParticipantManager &participantManager, QObject *parent):
     participantManager(participantManager),
     zoneIndexComparer(zones)
 {
+    connect(this, SIGNAL(effectJobThreadAbort()),
+            SLOT(handleEffectJobThreadAbort()));
     connect(this, SIGNAL(effectJobThreadCompletion()),
             SLOT(handleEffectJobThreadCompletion()));
     connect(this, SIGNAL(effectJobThreadError(QString)),
@@ -194,15 +199,21 @@ Session::Session(ParticipantManager &participantManager, QObject *parent):
     channelPropertyVisible = true;
     currentEffectJob = 0;
     currentEffectJobWetSample = 0;
+    currentEffectJobZoneIndex = -1;
     currentSamplerJob = 0;
     currentSamplerJobSample = 0;
     currentSamplerJobStream = 0;
+    currentSamplerJobZoneIndex = -1;
     directory = 0;
     drySamplePropertyVisible = true;
     focusedComponent = 0;
     notePropertyVisible = true;
+    pipelineEnabled = false;
+    pipelineSuspended = false;
+    pipelineTargetsStale = false;
     releaseTimePropertyVisible = true;
     sampler = 0;
+    samplerJobRetryCount = 0;
     samplerData.participant = 0;
     samplerData.registration = 0;
     sampleTimePropertyVisible = true;
@@ -223,6 +234,16 @@ Session::~Session()
     }
 }
 
+void
+Session::abortCurrentEffectJob()
+{
+    CONFIRM(currentEffectJob, tr("there isn't a current effect job"));
+
+    // The effect job thread notices the cancellation the next time sample
+    // data is read or written, or before the next effect is run.
+    currentEffectJobCancellation.cancel();
+}
+
 void
 Session::abortCurrentSamplerJob()
 {
@@ -230,6 +251,12 @@ Session::abortCurrentSamplerJob()
     sampler->abortJob();
 }
 
+void
+Session::abortTargetBuild()
+{
+    targetBuildCancellation.cancel();
+}
+
 const synthclone::Registration &
 Session::addEffect(synthclone::Effect *effect,
                    const synthclone::Participant *participant, int index)
@@ -310,6 +337,8 @@ Session::addSampler(synthclone::Sampler *sampler,
     connect(sampler, SIGNAL(jobAborted()), SLOT(handleSamplerJobAbort()));
     connect(sampler, SIGNAL(jobCompleted()),
             SLOT(handleSamplerJobCompletion()));
+    connect(sampler, SIGNAL(jobCompromised(const QString &)),
+            SLOT(handleSamplerJobCompromise(const QString &)));
     connect(sampler, SIGNAL(jobError(const QString &)),
             SLOT(handleSamplerJobError(const QString &)));
 
@@ -385,6 +414,14 @@ Session::addTarget(synthclone::Target *target,
     return *registration;
 }
 
+void
+Session::addStageMetrics(const synthclone::StageMetrics &metrics)
+{
+    int index = stageMetrics.count();
+    stageMetrics.append(metrics);
+    emit stageMetricsAdded(metrics, index);
+}
+
 synthclone::Zone *
 Session::addZone(int index)
 {
@@ -442,17 +479,45 @@ Session::buildTargets()
 
         zone->setStatus(synthclone::Zone::STATUS_TARGETS);
     }
+
+    // Targets are built in this thread, so the build cancellation token is
+    // made current here.  A cancelled build skips the remaining targets.
+    // Targets only save their build manifests after a successful build, so
+    // the next build redoes whatever was interrupted.
+    targetBuildCancellation.reset();
+    synthclone::CancellationToken::setCurrent(&targetBuildCancellation);
+    synthclone::TraceSpan buildSpan("target", "build targets");
     for (int i = 0; i < count; i++) {
         synthclone::Target *target = targets[i];
         emit buildingTarget(target);
+        synthclone::TraceSpan span("target", target->getName());
+        synthclone::StageMeter meter;
+        synthclone::StageMeter::setCurrent(&meter);
+        meter.start();
         try {
             target->build(zones);
         } catch (synthclone::Error &e) {
+            synthclone::StageMeter::setCurrent(0);
+            if (targetBuildCancellation.isCancelled()) {
+                emit targetBuildAborted(target);
+                break;
+            }
             emit targetBuildError(target, e.getMessage());
             continue;
         }
+        meter.stop();
+        synthclone::StageMeter::setCurrent(0);
+        synthclone::StageMetrics metrics
+            (synthclone::StageMetrics::STAGE_TARGET_BUILD, target->getName());
+        metrics.setMeasurements(meter);
+        addStageMetrics(metrics);
         emit targetBuilt(target);
+        if (targetBuildCancellation.isCancelled()) {
+            break;
+        }
     }
+    synthclone::CancellationToken::setCurrent(0);
+
     for (int i = 0; i < zones.count(); i++) {
         qobject_cast<Zone *>(zones[i])->
             setStatus(synthclone::Zone::STATUS_NORMAL);
@@ -460,6 +525,22 @@ Session::buildTargets()
     emit targetsBuilt();
 }
 
+void
+Session::clearStageMetrics()
+{
+    if (stageMetrics.count()) {
+        stageMetrics.clear();
+        emit stageMetricsCleared();
+    }
+}
+
+QString
+Session::createSampleFile()
+{
+    CONFIRM(directory, tr("no session currently loaded"));
+    return createUniqueSampleFile(*directory);
+}
+
 QString
 Session::createUniqueSampleFile(const QDir &sessionDirectory)
 {
@@ -660,6 +741,12 @@ Session::getSamplerJobIndex(const synthclone::SamplerJob *job) const
     return index;
 }
 
+int
+Session::getSamplerJobRetryCount() const
+{
+    return samplerJobRetryCount;
+}
+
 QDir
 Session::getSamplesDirectory(const QDir &sessionDirectory)
 {
@@ -702,6 +789,21 @@ Session::getSelectedZoneCount() const
     return selectedZones.count();
 }
 
+synthclone::StageMetrics
+Session::getStageMetrics(int index) const
+{
+    CONFIRM((index >= 0) && (index < stageMetrics.count()),
+            tr("'%1': index is out of range").arg(index));
+
+    return stageMetrics[index];
+}
+
+int
+Session::getStageMetricsCount() const
+{
+    return stageMetrics.count();
+}
+
 synthclone::SessionState
 Session::getState() const
 {
@@ -763,6 +865,16 @@ Session::getZoneIndex(const synthclone::Zone *zone) const
     return index;
 }
 
+void
+Session::handleEffectJobThreadAbort()
+{
+    EffectJob *job = qobject_cast<EffectJob *>(currentEffectJob);
+    job->getZone()->setStatus(synthclone::Zone::STATUS_NORMAL);
+    emit effectJobAborted(job);
+    recycleCurrentEffectJob();
+    updatePipeline();
+}
+
 void
 Session::handleEffectJobThreadCompletion()
 {
@@ -770,7 +882,14 @@ Session::handleEffectJobThreadCompletion()
     zone->setStatus(synthclone::Zone::STATUS_NORMAL);
     zone->setWetSample(currentEffectJobWetSample, false);
     assert(currentEffectJobWetSample == zone->getWetSample());
+    for (int i = 0; i < currentEffectJobMetrics.count(); i++) {
+        addStageMetrics(currentEffectJobMetrics[i]);
+    }
     recycleCurrentEffectJob();
+    if (isPipelineActive()) {
+        pipelineTargetsStale = true;
+    }
+    updatePipeline();
 }
 
 void
@@ -780,6 +899,7 @@ Session::handleEffectJobThreadError(const QString &message)
         setStatus(synthclone::Zone::STATUS_NORMAL);
     emit effectJobError(message);
     recycleCurrentEffectJob();
+    updatePipeline();
 }
 
 void
@@ -789,8 +909,11 @@ Session::handleSamplerJobAbort()
     // the session is unloaded while there's still a pending job.
     if (currentSamplerJob) {
         Zone *zone = qobject_cast<SamplerJob *>(currentSamplerJob)->getZone();
+        traceSamplerJob();
         recycleCurrentSamplerJob();
         zone->setStatus(synthclone::Zone::STATUS_NORMAL);
+        zoneRetryCountMap.remove(zone);
+        updatePipeline();
     }
 }
 
@@ -801,21 +924,72 @@ Session::handleSamplerJobCompletion()
     // the session is unloaded while there's still a pending job.
     if (currentSamplerJob) {
         Zone *zone = qobject_cast<SamplerJob *>(currentSamplerJob)->getZone();
+        recordSamplerJobMetrics();
+        traceSamplerJob();
+        zoneRetryCountMap.remove(zone);
         if (currentSamplerJob->getType() ==
             synthclone::SamplerJob::TYPE_SAMPLE) {
             currentSamplerJobStream->close();
-            if (zones.contains(zone)) {
+            bool sampled = zones.contains(zone);
+            if (sampled) {
                 zone->setStatus(synthclone::Zone::STATUS_NORMAL);
                 zone->setDrySample(currentSamplerJobSample, false);
                 assert(currentSamplerJobSample == zone->getDrySample());
                 currentSamplerJobSample = 0;
             }
             recycleCurrentSamplerJob();
+
+            // In pipeline mode, effects are applied to a zone as soon as it's
+            // sampled.
+            if (sampled && isPipelineActive()) {
+                if (effects.count()) {
+                    addEffectJob(zone);
+                }
+                pipelineTargetsStale = true;
+            }
         } else {
             recycleCurrentSamplerJob();
             zone->setStatus(synthclone::Zone::STATUS_NORMAL);
         }
+        updatePipeline();
+    }
+}
+
+void
+Session::handleSamplerJobCompromise(const QString &message)
+{
+    // There's a possibility that a sampler job object may not be available if
+    // the session is unloaded while there's still a pending job.
+    if (! currentSamplerJob) {
+        return;
+    }
+    assert(currentSamplerJob->getType() ==
+           synthclone::SamplerJob::TYPE_SAMPLE);
+    Zone *zone = qobject_cast<SamplerJob *>(currentSamplerJob)->getZone();
+    int retries = zoneRetryCountMap.value(zone, 0);
+    if ((! zones.contains(zone)) || (retries >= samplerJobRetryCount)) {
+        // Keep the take we have, but let the user know that it might contain
+        // a glitch.
+        if (zones.contains(zone)) {
+            emit samplerJobError(tr("zone %1: %2; keeping the sample after "
+                                    "%3 retries").
+                                 arg(zones.indexOf(zone) + 1).arg(message).
+                                 arg(retries));
+        }
+        handleSamplerJobCompletion();
+        return;
     }
+
+    // Discard the take, and requeue the zone ahead of the other sampler jobs.
+    // The current job is released without starting the next job, so that
+    // 'addSamplerJob()' resumes the queue with the requeued zone.
+    traceSamplerJob();
+    currentSamplerJobStream->close();
+    releaseCurrentSamplerJob();
+    zone->setStatus(synthclone::Zone::STATUS_NORMAL);
+    zoneRetryCountMap.insert(zone, retries + 1);
+    addSamplerJob(synthclone::SamplerJob::TYPE_SAMPLE, zone, 0);
+    updatePipeline();
 }
 
 void
@@ -827,8 +1001,11 @@ Session::handleSamplerJobError(const QString &message)
     // the session is unloaded while there's still a pending job.
     if (currentSamplerJob) {
         Zone *zone = qobject_cast<SamplerJob *>(currentSamplerJob)->getZone();
+        traceSamplerJob();
         recycleCurrentSamplerJob();
         zone->setStatus(synthclone::Zone::STATUS_NORMAL);
+        zoneRetryCountMap.remove(zone);
+        updatePipeline();
     }
 }
 
@@ -905,6 +1082,18 @@ Session::isNotePropertyVisible() const
     return notePropertyVisible;
 }
 
+bool
+Session::isPipelineActive() const
+{
+    return pipelineEnabled && (! pipelineSuspended);
+}
+
+bool
+Session::isPipelineEnabled() const
+{
+    return pipelineEnabled;
+}
+
 bool
 Session::isReleaseTimePropertyVisible() const
 {
@@ -953,6 +1142,9 @@ Session::isZoneSelected(int index) const
 void
 Session::load(const QDir &directory)
 {
+    synthclone::TraceSpan span("session", "load session");
+    QScopedPointer<synthclone::TraceSpan>
+        phaseSpan(new synthclone::TraceSpan("session", "read session"));
     QDomDocument document;
     if (! loadXML(directory, document)) {
         throw synthclone::Error(tr("'%1' is not a valid session directory").
@@ -1046,12 +1238,16 @@ Session::load(const QDir &directory)
         setControlPropertyVisible(i, visible);
     }
 
+    setPipelineEnabled(verifyBooleanAttribute(documentElement,
+                                              "pipeline-enabled", false));
+
     int elementCount;
     int i;
     float progress;
 
     // Zones
     emit progressChanged(0.0, tr("Loading zones ..."));
+    phaseSpan.reset(new synthclone::TraceSpan("session", "load zones"));
     QDomElement element = documentElement.firstChildElement("zones");
     if (element.isNull()) {
         message = tr("root element doesn't contain 'zones' child");
@@ -1070,6 +1266,7 @@ Session::load(const QDir &directory)
 
     // Participants
     emit progressChanged(0.6, tr("Loading participants ..."));
+    phaseSpan.reset(new synthclone::TraceSpan("session", "load participants"));
     element = documentElement.firstChildElement("participants");
     if (element.isNull()) {
         message = tr("root element doesn't contain 'participants' child");
@@ -1118,6 +1315,7 @@ Session::load(const QDir &directory)
 
     // Sampler
     emit progressChanged(0.7, tr("Checking for sampler ..."));
+    phaseSpan.reset(new synthclone::TraceSpan("session", "load sampler"));
     element = documentElement.firstChildElement("sampler");
     if (element.isNull()) {
         message = tr("root element doesn't contain 'sampler' child");
@@ -1134,6 +1332,7 @@ Session::load(const QDir &directory)
 
     // Effects
     emit progressChanged(0.8, tr("Loading effects ..."));
+    phaseSpan.reset(new synthclone::TraceSpan("session", "load effects"));
     element = documentElement.firstChildElement("effects");
     if (element.isNull()) {
         message = tr("root element doesn't contain 'effects' child");
@@ -1158,6 +1357,7 @@ Session::load(const QDir &directory)
 
     // Targets
     emit progressChanged(0.9, tr("Loading targets ..."));
+    phaseSpan.reset(new synthclone::TraceSpan("session", "load targets"));
     element = documentElement.firstChildElement("targets");
     if (element.isNull()) {
         message = tr("root element doesn't contain 'targets' child");
@@ -1179,6 +1379,7 @@ Session::load(const QDir &directory)
             }
         }
     }
+    phaseSpan.reset();
     effectJobThread.start();
 
     emit progressChanged(1.0, tr("Loaded."));
@@ -1294,6 +1495,33 @@ Session::readXMLVariant(const QDomElement &element)
     return QVariant();
 }
 
+void
+Session::recordSamplerJobMetrics()
+{
+    // Samplers stream sample data in their own threads, so the sample data is
+    // counted here instead of with a meter.  The sampler threads aren't
+    // measured, so there's no CPU time.
+    synthclone::StageMetrics metrics
+        (synthclone::StageMetrics::STAGE_SAMPLER_JOB, sampler->getName(),
+         currentSamplerJobZoneIndex);
+    metrics.setTimes(currentSamplerJobStartTime,
+                     currentSamplerJobTimer.nsecsElapsed() / 1000);
+    synthclone::SampleFrameCount frames;
+    try {
+        frames = currentSamplerJobStream->getFrames();
+    } catch (synthclone::Error &) {
+        frames = 0;
+    }
+    qint64 bytes = frames * currentSamplerJobStream->getChannels() *
+        static_cast<qint64>(sizeof(float));
+    if (currentSamplerJob->getType() == synthclone::SamplerJob::TYPE_SAMPLE) {
+        metrics.setCounts(0, bytes, 0, frames);
+    } else {
+        metrics.setCounts(bytes, 0, frames, 0);
+    }
+    addStageMetrics(metrics);
+}
+
 void
 Session::recycleCurrentEffectJob()
 {
@@ -1307,6 +1535,13 @@ Session::recycleCurrentEffectJob()
 
 void
 Session::recycleCurrentSamplerJob()
+{
+    releaseCurrentSamplerJob();
+    updateSamplerJobs();
+}
+
+void
+Session::releaseCurrentSamplerJob()
 {
     if (currentSamplerJobStream) {
         delete qobject_cast<QObject *>(currentSamplerJobStream);
@@ -1323,7 +1558,6 @@ Session::recycleCurrentSamplerJob()
     delete qobject_cast<SamplerJob *>(currentSamplerJob);
     currentSamplerJob = 0;
     emit currentSamplerJobChanged(0);
-    updateSamplerJobs();
 }
 
 void
@@ -1401,6 +1635,8 @@ Session::removeSampler()
                this, SLOT(handleSamplerJobAbort()));
     disconnect(sampler, SIGNAL(jobCompleted()),
                this, SLOT(handleSamplerJobCompletion()));
+    disconnect(sampler, SIGNAL(jobCompromised(const QString &)),
+               this, SLOT(handleSamplerJobCompromise(const QString &)));
     disconnect(sampler, SIGNAL(jobError(const QString &)),
                this, SLOT(handleSamplerJobError(const QString &)));
 
@@ -1428,6 +1664,7 @@ Session::removeSamplerJob(int index)
     Zone *zone = job->getZone();
     bool removed = zoneSamplerJobMap.remove(zone);
     assert(removed);
+    zoneRetryCountMap.remove(zone);
     zone->setStatus(synthclone::Zone::STATUS_NORMAL);
     delete job;
     setModified();
@@ -1479,6 +1716,7 @@ Session::removeZone(int index)
     setZoneSelected(index, false);
     emit removingZone(zone, index);
     zones.removeAt(index);
+    zoneRetryCountMap.remove(zone);
     emit zoneRemoved(zone, index);
     delete qobject_cast<Zone *>(zone);
     setModified();
@@ -1487,81 +1725,124 @@ Session::removeZone(int index)
 void
 Session::runEffectJobs()
 {
+    synthclone::CancellationToken::setCurrent(&currentEffectJobCancellation);
     for (;;) {
         effectJobSemaphore.acquire();
         if (! currentEffectJob) {
             // Session is being unloaded.
             break;
         }
+        synthclone::TraceSpan jobSpan("effect", "effect job",
+                                      currentEffectJobZoneIndex);
         int count = effects.count();
         QString path;
         Zone *zone = qobject_cast<EffectJob *>(currentEffectJob)->getZone();
         const synthclone::Sample *drySample = zone->getDrySample();
         assert(drySample);
+        assert(currentEffectJobKeys.count() == count);
         QScopedPointer<synthclone::Sample> wetSamplePtr;
+
+        // The meter is declared outside of the 'try' block so that it's still
+        // alive when the error handler stops it from being current.
+        synthclone::StageMeter meter;
         try {
-            if (! count) {
-                // Simple case - just copy the file.
+
+            // Resume from the longest effect chain prefix that has been
+            // cached.
+            const synthclone::Sample *inputSample = drySample;
+            int first = 0;
+            for (int i = count; i > 0; i--) {
+                const synthclone::Sample *cachedSample =
+                    effectPrefixCache.get(currentEffectJobKeys[i - 1]);
+                if (cachedSample) {
+                    inputSample = cachedSample;
+                    first = i;
+                    break;
+                }
+            }
+
+            if (first == count) {
+                // Simple case - no effects, or the output of the whole chain
+                // is cached.  Just copy the file.
                 path = createUniqueSampleFile(*directory);
                 currentEffectJobWetSample =
-                    new synthclone::Sample(*drySample, path);
-                wetSamplePtr.reset(currentEffectJobWetSample);
-            } else if (count == 1) {
-                // Simple case - one input stream and one output stream.
-                path = createUniqueSampleFile(*directory);
-                currentEffectJobWetSample = new synthclone::Sample(path);
+                    new synthclone::Sample(*inputSample, path);
                 wetSamplePtr.reset(currentEffectJobWetSample);
-                synthclone::SampleInputStream inputStream(*drySample);
-                synthclone::SampleOutputStream
-                    outputStream(*currentEffectJobWetSample,
-                                 inputStream.getSampleRate(),
-                                 inputStream.getChannels());
-                effects[0]->process(*zone, inputStream, outputStream);
             } else {
-                // Complex case - 2 or more effects.
-                synthclone::Sample *tempWetSample = new synthclone::Sample();
-                wetSamplePtr.reset(tempWetSample);
-                synthclone::SampleInputStream firstInputStream(*drySample);
-                synthclone::SampleChannelCount channelCount =
-                    firstInputStream.getChannels();
-                synthclone::SampleRate sampleRate =
-                    firstInputStream.getSampleRate();
-                synthclone::SampleOutputStream
-                    firstOutputStream(*tempWetSample, sampleRate,
-                                      channelCount);
-                effects[0]->process(*zone, firstInputStream,
-                                    firstOutputStream);
-                firstInputStream.close();
-                firstOutputStream.close();
-                synthclone::Sample *tempDrySample = tempWetSample;
-                QScopedPointer<synthclone::Sample>
-                    tempDrySamplePtr(tempDrySample);
-                wetSamplePtr.take();
-                for (int i = 1; i < (count - 1); i++) {
-                    tempWetSample = new synthclone::Sample();
-                    wetSamplePtr.reset(tempWetSample);
-                    synthclone::SampleInputStream
-                        tempInputStream(*tempDrySample);
+                // Intermediate samples that couldn't be handed to the cache
+                // are owned by 'inputSamplePtr'.
+                QScopedPointer<synthclone::Sample> inputSamplePtr;
+                for (int i = first; i < count; i++) {
+                    currentEffectJobCancellation.check();
+                    bool last = i == (count - 1);
+                    synthclone::Sample *outputSample;
+                    if (last) {
+                        path = createUniqueSampleFile(*directory);
+                        outputSample = new synthclone::Sample(path);
+                    } else {
+                        outputSample = new synthclone::Sample();
+                    }
+                    QScopedPointer<synthclone::Sample>
+                        outputSamplePtr(outputSample);
+                    synthclone::SampleInputStream inputStream(*inputSample);
                     synthclone::SampleOutputStream
-                        tempOutputStream(*tempWetSample, sampleRate,
-                                         channelCount);
-                    effects[i]->process(*zone, tempInputStream,
-                                        tempOutputStream);
-                    tempDrySample = tempWetSample;
-                    tempDrySamplePtr.reset(tempDrySample);
-                    wetSamplePtr.take();
+                        outputStream(*outputSample,
+                                     inputStream.getSampleRate(),
+                                     inputStream.getChannels());
+                    synthclone::StageMeter::setCurrent(&meter);
+                    meter.start();
+                    {
+                        synthclone::TraceSpan span("effect",
+                                                   effects[i]->getName());
+                        effects[i]->process(*zone, inputStream, outputStream);
+                    }
+                    inputStream.close();
+                    outputStream.close();
+                    meter.stop();
+                    synthclone::StageMeter::setCurrent(0);
+                    synthclone::StageMetrics metrics
+                        (synthclone::StageMetrics::STAGE_EFFECT,
+                         effects[i]->getName(), currentEffectJobZoneIndex);
+                    metrics.setMeasurements(meter);
+                    currentEffectJobMetrics.append(metrics);
+                    if (last) {
+                        currentEffectJobWetSample = outputSamplePtr.take();
+                        wetSamplePtr.reset(currentEffectJobWetSample);
+
+                        // The session sample file can't be owned by the cache,
+                        // so the cache gets a copy.
+                        if (effectPrefixCache.getBudget()) {
+                            synthclone::Sample *cachedSample =
+                                new synthclone::Sample
+                                (*currentEffectJobWetSample);
+                            if (! effectPrefixCache.insert
+                                (currentEffectJobKeys[i], cachedSample)) {
+                                delete cachedSample;
+                            }
+                        }
+                    } else if (effectPrefixCache.insert
+                               (currentEffectJobKeys[i], outputSample)) {
+                        outputSamplePtr.take();
+                        inputSamplePtr.reset();
+                    } else {
+                        inputSamplePtr.reset(outputSamplePtr.take());
+                    }
+                    inputSample = outputSample;
                 }
-                path = createUniqueSampleFile(*directory);
-                currentEffectJobWetSample = new synthclone::Sample(path);
-                wetSamplePtr.reset(currentEffectJobWetSample);
-                synthclone::SampleInputStream inputStream(*tempDrySample);
-                synthclone::SampleOutputStream
-                    outputStream(*currentEffectJobWetSample, sampleRate,
-                                 channelCount);
-                effects[count - 1]->process(*zone, inputStream, outputStream);
             }
         } catch (synthclone::Error &e) {
-            emit effectJobThreadError(e.getMessage());
+            synthclone::StageMeter::setCurrent(0);
+
+            // Discard the partially written wet sample.
+            wetSamplePtr.reset();
+            if ((! path.isEmpty()) && QFile::exists(path)) {
+                QFile::remove(path);
+            }
+            if (currentEffectJobCancellation.isCancelled()) {
+                emit effectJobThreadAbort();
+            } else {
+                emit effectJobThreadError(e.getMessage());
+            }
             continue;
         }
         wetSamplePtr.take();
@@ -1580,6 +1861,7 @@ Session::save()
 void
 Session::save(const QDir &directory)
 {
+    synthclone::TraceSpan span("session", "save session");
     initializeDirectory(directory);
     synthclone::SessionState oldState = state;
     state = synthclone::SESSIONSTATE_SAVING;
@@ -1645,8 +1927,14 @@ Session::save(const QDir &directory)
                                       "false");
             }
 
+            writer.writeAttribute("pipeline-enabled",
+                                  pipelineEnabled ? "true" : "false");
+
             // Zones
             emit progressChanged(0.0, tr("Saving zones ..."));
+            QScopedPointer<synthclone::TraceSpan>
+                phaseSpan(new synthclone::TraceSpan("session",
+                                                    "save zones"));
             writer.writeStartElement("zones");
             int count = zones.count();
             int i;
@@ -1662,6 +1950,8 @@ Session::save(const QDir &directory)
 
             // Participants
             emit progressChanged(0.6, "Saving participants ...");
+            phaseSpan.reset(new synthclone::TraceSpan("session",
+                                                      "save participants"));
             writer.writeStartElement("participants");
             writeXMLParticipantList(writer, 0);
             writer.writeEndElement();
@@ -1669,6 +1959,8 @@ Session::save(const QDir &directory)
             const synthclone::Participant *participant;
 
             // Sampler
+            phaseSpan.reset(new synthclone::TraceSpan("session",
+                                                      "save sampler"));
             writer.writeStartElement("sampler");
             if (sampler) {
                 emit progressChanged(0.7, "Saving sampler ...");
@@ -1680,6 +1972,8 @@ Session::save(const QDir &directory)
 
             // Effects
             emit progressChanged(0.8, tr("Saving effects ..."));
+            phaseSpan.reset(new synthclone::TraceSpan("session",
+                                                      "save effects"));
             writer.writeStartElement("effects");
             count = effects.count();
             for (i = 0; i < count; i++) {
@@ -1700,6 +1994,8 @@ Session::save(const QDir &directory)
 
             // Targets
             emit progressChanged(0.9, tr("Saving targets ..."));
+            phaseSpan.reset(new synthclone::TraceSpan("session",
+                                                      "save targets"));
             writer.writeStartElement("targets");
             count = targets.count();
             for (i = 0; i < count; i++) {
@@ -1724,6 +2020,7 @@ Session::save(const QDir &directory)
             writer.writeEndDocument();
 
             file.close();
+            phaseSpan.reset();
         } catch (...) {
             delete this->directory;
             this->directory = oldDirectoryPtr.take();
@@ -1833,6 +2130,12 @@ Session::setDrySamplePropertyVisible(bool visible)
     }
 }
 
+void
+Session::setEffectCacheBudget(qint64 budget)
+{
+    effectPrefixCache.setBudget(budget);
+}
+
 void
 Session::setFocusedComponent(const synthclone::Component *component)
 {
@@ -1883,6 +2186,25 @@ Session::setNotePropertyVisible(bool visible)
     }
 }
 
+void
+Session::setPipelineEnabled(bool enabled)
+{
+    if (pipelineEnabled != enabled) {
+        pipelineEnabled = enabled;
+        emit pipelineEnabledChanged(enabled);
+        setModified();
+    }
+}
+
+void
+Session::setPipelineSuspended(bool suspended)
+{
+    pipelineSuspended = suspended;
+    if (suspended) {
+        pipelineTargetsStale = false;
+    }
+}
+
 void
 Session::setReleaseTimePropertyVisible(bool visible)
 {
@@ -1904,6 +2226,13 @@ Session::setSampleRate(synthclone::SampleRate sampleRate)
     sessionSampleData.setSampleRate(sampleRate);
 }
 
+void
+Session::setSamplerJobRetryCount(int count)
+{
+    CONFIRM(count >= 0, tr("'%1': invalid retry count").arg(count));
+    samplerJobRetryCount = count;
+}
+
 void
 Session::setSampleTimePropertyVisible(bool visible)
 {
@@ -2065,6 +2394,34 @@ Session::takeSamplerJob(int index)
     return job;
 }
 
+void
+Session::traceSamplerJob()
+{
+    // The sampler traces the states of the job itself.  The session traces
+    // the whole job, so that the job is tagged with the zone index.
+    synthclone::Tracer *tracer = synthclone::Tracer::getActive();
+    if (! tracer) {
+        return;
+    }
+    QString name;
+    switch (currentSamplerJob->getType()) {
+    case synthclone::SamplerJob::TYPE_PLAY_DRY_SAMPLE:
+        name = "play dry sample";
+        break;
+    case synthclone::SamplerJob::TYPE_PLAY_WET_SAMPLE:
+        name = "play wet sample";
+        break;
+    case synthclone::SamplerJob::TYPE_SAMPLE:
+        name = "sample";
+        break;
+    default:
+        assert(false);
+    }
+    qint64 duration = currentSamplerJobTimer.nsecsElapsed() / 1000;
+    tracer->addSpan("sampler", name, tracer->getTime() - duration, duration,
+                    currentSamplerJobZoneIndex);
+}
+
 void
 Session::unload()
 {
@@ -2122,6 +2479,9 @@ Session::unload()
         }
 
         sessionSampleData.setSampleDirectory(0);
+        effectPrefixCache.clear();
+        pipelineTargetsStale = false;
+        clearStageMetrics();
         delete directory;
         directory = 0;
 
@@ -2141,6 +2501,7 @@ Session::unload()
         assert(! targetDataMap.count());
         assert(! zones.count());
         assert(! zoneEffectJobMap.count());
+        assert(! zoneRetryCountMap.count());
         assert(! zoneSamplerJobMap.count());
 
         state = synthclone::SESSIONSTATE_CURRENT;
@@ -2154,12 +2515,54 @@ Session::updateEffectJobs()
     if ((! currentEffectJob) && (effectJobs.count())) {
         EffectJob *job = qobject_cast<EffectJob *>(takeEffectJob(0));
         currentEffectJob = job;
+
+        // Effect states are gathered here, as participants expect to be
+        // queried in the main thread.
+        currentEffectJobKeys.clear();
+        currentEffectJobMetrics.clear();
+        currentEffectJobZoneIndex = zones.indexOf(job->getZone());
+        QByteArray key = EffectPrefixCache::getInitialKey(*(job->getZone()));
+        for (int i = 0; i < effects.count(); i++) {
+            synthclone::Effect *effect = effects[i];
+            const synthclone::Participant *participant =
+                effectDataMap.value(effect)->participant;
+            key = EffectPrefixCache::getNextKey
+                (key, *effect, participant->getName(),
+                 participant->getState(effect));
+            currentEffectJobKeys.append(key);
+        }
+
         emit currentEffectJobChanged(job);
         job->getZone()->setStatus(synthclone::Zone::STATUS_EFFECTS);
+        currentEffectJobCancellation.reset();
         effectJobSemaphore.release();
     }
 }
 
+void
+Session::updatePipeline()
+{
+    // A target build needs every zone, so pipelined target builds wait until
+    // the sampler and effect job queues are empty.  Targets use build
+    // manifests, so only the files affected by new samples are rebuilt.
+    if ((! isPipelineActive()) || (! pipelineTargetsStale) ||
+        (! targets.count()) || currentSamplerJob || samplerJobs.count() ||
+        currentEffectJob || effectJobs.count()) {
+        return;
+    }
+    if ((state != synthclone::SESSIONSTATE_CURRENT) &&
+        (state != synthclone::SESSIONSTATE_MODIFIED)) {
+        return;
+    }
+    for (int i = zones.count() - 1; i >= 0; i--) {
+        if (zones[i]->getStatus() != synthclone::Zone::STATUS_NORMAL) {
+            return;
+        }
+    }
+    pipelineTargetsStale = false;
+    buildTargets();
+}
+
 void
 Session::updateSamplerJobs()
 {
@@ -2210,7 +2613,10 @@ Session::updateSamplerJobs()
             }
             currentSamplerJob = job;
             currentSamplerJobSample = sample;
+            currentSamplerJobStartTime = QDateTime::currentDateTime();
             currentSamplerJobStream = stream;
+            currentSamplerJobTimer.start();
+            currentSamplerJobZoneIndex = zones.indexOf(zone);
             emit currentSamplerJobChanged(job);
             zone->setStatus(status);
             sampler->startJob(*job, *stream);
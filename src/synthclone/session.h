@@ -22,19 +22,24 @@
 
 #include <limits>
 
+#include <QtCore/QDateTime>
 #include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QSemaphore>
 #include <QtCore/QXmlStreamWriter>
 #include <QtXml/QDomDocument>
 
+#include <synthclone/cancellationtoken.h>
 #include <synthclone/effect.h>
 #include <synthclone/sampleoutputstream.h>
 #include <synthclone/sampler.h>
 #include <synthclone/samplerjob.h>
+#include <synthclone/stagemetrics.h>
 #include <synthclone/target.h>
 #include <synthclone/zonecomparer.h>
 
 #include "effectjobthread.h"
+#include "effectprefixcache.h"
 #include "participantmanager.h"
 #include "zone.h"
 #include "zoneindexcomparer.h"
@@ -118,6 +123,9 @@ public:
     int
     getSamplerJobIndex(const synthclone::SamplerJob *job) const;
 
+    int
+    getSamplerJobRetryCount() const;
+
     synthclone::SampleRate
     getSampleRate() const;
 
@@ -133,6 +141,12 @@ public:
     int
     getSelectedZoneCount() const;
 
+    synthclone::StageMetrics
+    getStageMetrics(int index) const;
+
+    int
+    getStageMetricsCount() const;
+
     synthclone::SessionState
     getState() const;
 
@@ -172,6 +186,9 @@ public:
     bool
     isNotePropertyVisible() const;
 
+    bool
+    isPipelineEnabled() const;
+
     bool
     isReleaseTimePropertyVisible() const;
 
@@ -195,9 +212,15 @@ public:
 
 public slots:
 
+    void
+    abortCurrentEffectJob();
+
     void
     abortCurrentSamplerJob();
 
+    void
+    abortTargetBuild();
+
     const synthclone::Registration &
     addEffect(synthclone::Effect *effect,
               const synthclone::Participant *participant, int index=-1);
@@ -223,6 +246,12 @@ public slots:
     void
     buildTargets();
 
+    void
+    clearStageMetrics();
+
+    QString
+    createSampleFile();
+
     void
     load(const QDir &directory);
 
@@ -295,6 +324,9 @@ public slots:
     void
     setDrySamplePropertyVisible(bool visible);
 
+    void
+    setEffectCacheBudget(qint64 budget);
+
     void
     setFocusedComponent(const synthclone::Component *component);
 
@@ -304,6 +336,15 @@ public slots:
     void
     setNotePropertyVisible(bool visible);
 
+    void
+    setPipelineEnabled(bool enabled);
+
+    // Suspends pipelining without changing the session's pipeline setting.
+    // Batch runs apply effects and build targets explicitly, so they suspend
+    // pipelining.
+    void
+    setPipelineSuspended(bool suspended);
+
     void
     setReleaseTimePropertyVisible(bool visible);
 
@@ -313,6 +354,9 @@ public slots:
     void
     setSampleRate(synthclone::SampleRate sampleRate);
 
+    void
+    setSamplerJobRetryCount(int count);
+
     void
     setSampleTimePropertyVisible(bool visible);
 
@@ -400,6 +444,9 @@ signals:
     void
     effectAdded(const synthclone::Effect *effect, int index);
 
+    void
+    effectJobAborted(const synthclone::EffectJob *job);
+
     void
     effectJobAdded(const synthclone::EffectJob *job, int index);
 
@@ -413,6 +460,9 @@ signals:
     void
     effectJobRemoved(const synthclone::EffectJob *job, int index);
 
+    void
+    effectJobThreadAbort();
+
     void
     effectJobThreadCompletion();
 
@@ -451,6 +501,9 @@ signals:
     void
     notePropertyVisibilityChanged(bool visible);
 
+    void
+    pipelineEnabledChanged(bool enabled);
+
     void
     progressChanged(float progress, const QString &status);
 
@@ -509,6 +562,12 @@ signals:
     void
     selectedTargetChanged(const synthclone::Target *target, int index);
 
+    void
+    stageMetricsAdded(const synthclone::StageMetrics &metrics, int index);
+
+    void
+    stageMetricsCleared();
+
     void
     stateChanged(synthclone::SessionState state, const QDir *directory);
 
@@ -518,6 +577,9 @@ signals:
     void
     targetAdded(const synthclone::Target *target, int index);
 
+    void
+    targetBuildAborted(const synthclone::Target *target);
+
     void
     targetBuildError(const synthclone::Target *target, const QString &message);
 
@@ -553,6 +615,9 @@ signals:
 
 private slots:
 
+    void
+    handleEffectJobThreadAbort();
+
     void
     handleEffectJobThreadCompletion();
 
@@ -565,6 +630,9 @@ private slots:
     void
     handleSamplerJobCompletion();
 
+    void
+    handleSamplerJobCompromise(const QString &message);
+
     void
     handleSamplerJobError(const QString &message);
 
@@ -588,6 +656,7 @@ private:
     typedef QMap<const synthclone::Target *, ComponentData *> TargetDataMap;
     typedef QMap<const synthclone::Zone *,
                  synthclone::EffectJob *> ZoneEffectJobMap;
+    typedef QMap<const synthclone::Zone *, int> ZoneRetryCountMap;
     typedef QMap<const synthclone::Zone *,
                  synthclone::SamplerJob *> ZoneSamplerJobMap;
 
@@ -601,6 +670,9 @@ private:
     static bool
     loadXML(const QDir &directory, QDomDocument &document);
 
+    void
+    addStageMetrics(const synthclone::StageMetrics &metrics);
+
     QString
     createUniqueSampleFile(const QDir &sessionDirectory);
 
@@ -616,12 +688,18 @@ private:
     void
     insertSelectedZone(synthclone::Zone *zone);
 
+    bool
+    isPipelineActive() const;
+
     QVariant
     readXMLState(const QDomElement &element);
 
     QVariant
     readXMLVariant(const QDomElement &element);
 
+    void
+    recordSamplerJobMetrics();
+
     void
     recycleCurrentEffectJob();
 
@@ -631,6 +709,9 @@ private:
     void
     refreshWetSample(Zone *zone);
 
+    void
+    releaseCurrentSamplerJob();
+
     void
     runEffectJobs();
 
@@ -647,9 +728,15 @@ private:
     synthclone::SamplerJob *
     takeSamplerJob(int index);
 
+    void
+    traceSamplerJob();
+
     void
     updateEffectJobs();
 
+    void
+    updatePipeline();
+
     void
     updateSamplerJobs();
 
@@ -679,31 +766,45 @@ private:
     bool channelPropertyVisible;
     bool controlPropertiesVisible[0x80];
     synthclone::EffectJob *currentEffectJob;
+    synthclone::CancellationToken currentEffectJobCancellation;
+    QList<QByteArray> currentEffectJobKeys;
+    QList<synthclone::StageMetrics> currentEffectJobMetrics;
     synthclone::Sample *currentEffectJobWetSample;
+    int currentEffectJobZoneIndex;
     synthclone::SamplerJob *currentSamplerJob;
     synthclone::Sample *currentSamplerJobSample;
+    QDateTime currentSamplerJobStartTime;
     synthclone::SampleStream *currentSamplerJobStream;
+    QElapsedTimer currentSamplerJobTimer;
+    int currentSamplerJobZoneIndex;
     QDir *directory;
     bool drySamplePropertyVisible;
     EffectDataMap effectDataMap;
     EffectJobList effectJobs;
     QSemaphore effectJobSemaphore;
     EffectJobThread effectJobThread;
+    EffectPrefixCache effectPrefixCache;
     EffectList effects;
     const synthclone::Component *focusedComponent;
     bool notePropertyVisible;
     ParticipantManager &participantManager;
+    bool pipelineEnabled;
+    bool pipelineSuspended;
+    bool pipelineTargetsStale;
     bool releaseTimePropertyVisible;
     synthclone::Sampler *sampler;
     ComponentData samplerData;
+    int samplerJobRetryCount;
     SamplerJobList samplerJobs;
     bool sampleTimePropertyVisible;
     const synthclone::Effect *selectedEffect;
     const synthclone::Target *selectedTarget;
     ZoneList selectedZones;
     SessionSampleData sessionSampleData;
+    QList<synthclone::StageMetrics> stageMetrics;
     synthclone::SessionState state;
     bool statusPropertyVisible;
+    synthclone::CancellationToken targetBuildCancellation;
     TargetList targets;
     TargetDataMap targetDataMap;
     bool velocityPropertyVisible;
@@ -711,6 +812,7 @@ private:
     ZoneList zones;
     ZoneEffectJobMap zoneEffectJobMap;
     ZoneIndexComparer zoneIndexComparer;
+    ZoneRetryCountMap zoneRetryCountMap;
     ZoneSamplerJobMap zoneSamplerJobMap;
 
 };
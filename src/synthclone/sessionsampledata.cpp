@@ -133,7 +133,6 @@ SessionSampleData::updateSample(synthclone::Sample &sample, bool forceCopy,
     }
 
     bool sampleConversionRequired = inputSampleRate != sampleRate;
-    QString newPath = createUniqueFile(sampleDirectory);
     if ((channelConvertAlgorithm == CHANNELCONVERTALGORITHM_NONE) &&
         (! sampleConversionRequired) && (! forceCopy)) {
         if (sampleDirectory) {
@@ -149,6 +148,8 @@ SessionSampleData::updateSample(synthclone::Sample &sample, bool forceCopy,
     // being moved from outside the sample directory into the sample directory,
     // or a forced copy was requested.
 
+    QString newPath = createUniqueFile(sampleDirectory);
+
     float *channelBuffer;
 
     // For some reason, the empty QScopedArrayPointer constructor is not
@@ -23,6 +23,14 @@
 
 #include "settings.h"
 
+// Intermediate effect chain output is cached in up to 512 MB of temporary
+// files by default.  A budget of 0 disables the cache.
+static const qint64 DEFAULT_EFFECT_CACHE_BUDGET = Q_INT64_C(512) * 1024 * 1024;
+
+// A zone whose capture is compromised by an xrun or a buffer overflow is
+// sampled again up to 2 times by default.  A count of 0 keeps the first take.
+static const int DEFAULT_SAMPLER_JOB_RETRY_COUNT = 2;
+
 Settings::Settings(Session &session, QObject *parent):
     QObject(parent),
     settings("synthclone.googlecode.com", "synthclone")
@@ -52,6 +60,14 @@ Settings::addPluginPath(const QString &path)
     }
 }
 
+qint64
+Settings::getEffectCacheBudget()
+{
+    // The settings file is user-editable, so negative budgets are clamped.
+    return qMax(read("effectCacheBudget", DEFAULT_EFFECT_CACHE_BUDGET).
+                toLongLong(), static_cast<qint64>(0));
+}
+
 QStringList
 Settings::getPluginPaths()
 {
@@ -64,6 +80,13 @@ Settings::getRecentSessionPaths()
     return read("recentSessionPaths").toStringList();
 }
 
+int
+Settings::getSamplerJobRetryCount()
+{
+    return read("samplerJobRetryCount", DEFAULT_SAMPLER_JOB_RETRY_COUNT).
+        toInt();
+}
+
 void
 Settings::handleStateChange(synthclone::SessionState state,
                             const QDir *directory)
@@ -99,6 +122,12 @@ Settings::removePluginPath(const QString &path)
     }
 }
 
+void
+Settings::setSamplerJobRetryCount(int count)
+{
+    write("samplerJobRetryCount", count);
+}
+
 void
 Settings::verifyReadStatus() const
 {
@@ -39,15 +39,24 @@ public:
     void
     addPluginPath(const QString &path);
 
+    qint64
+    getEffectCacheBudget();
+
     QStringList
     getPluginPaths();
 
     QStringList
     getRecentSessionPaths();
 
+    int
+    getSamplerJobRetryCount();
+
     void
     removePluginPath(const QString &path);
 
+    void
+    setSamplerJobRetryCount(int count);
+
 private slots:
 
     void
@@ -0,0 +1,107 @@
+# Application sources, shared by the `synthclone` executable and the
+# benchmark program in `../bench`.  The executable adds `main.cpp`.
+
+HEADERS += aboutview.h \
+    application.h \
+    batchrunner.h \
+    componentviewlet.h \
+    context.h \
+    contextmenueventfilter.h \
+    controller.h \
+    dialogview.h \
+    effectjob.h \
+    effectjobthread.h \
+    effectprefixcache.h \
+    errorview.h \
+    helpviewlet.h \
+    inputblockeventfilter.h \
+    mainview.h \
+    menuactionviewlet.h \
+    menuitemviewlet.h \
+    menuleafviewlet.h \
+    menumanager.h \
+    menuseparatorviewlet.h \
+    menuviewlet.h \
+    participantmanager.h \
+    participantview.h \
+    participantviewlet.h \
+    pluginmanager.h \
+    progressbardelegate.h \
+    progressview.h \
+    registration.h \
+    sampleprofile.h \
+    samplerateconverter.h \
+    samplerjob.h \
+    savechangesview.h \
+    savewarningview.h \
+    session.h \
+    sessionloadview.h \
+    sessionsampledata.h \
+    sessionviewlet.h \
+    settings.h \
+    signalmap.h \
+    signalpair.h \
+    standarditem.h \
+    toolviewlet.h \
+    types.h \
+    util.h \
+    viewviewlet.h \
+    zone.h \
+    zonecomparer.h \
+    zonecomparerproxy.h \
+    zoneindexcomparer.h \
+    zonelistloader.h \
+    zonetabledelegate.h \
+    zonetablemodel.h \
+    zoneviewlet.h
+SOURCES += aboutview.cpp \
+    application.cpp \
+    batchrunner.cpp \
+    componentviewlet.cpp \
+    context.cpp \
+    contextmenueventfilter.cpp \
+    controller.cpp \
+    dialogview.cpp \
+    effectjob.cpp \
+    effectjobthread.cpp \
+    effectprefixcache.cpp \
+    errorview.cpp \
+    helpviewlet.cpp \
+    inputblockeventfilter.cpp \
+    mainview.cpp \
+    menuactionviewlet.cpp \
+    menuitemviewlet.cpp \
+    menuleafviewlet.cpp \
+    menumanager.cpp \
+    menuseparatorviewlet.cpp \
+    menuviewlet.cpp \
+    participantmanager.cpp \
+    participantview.cpp \
+    participantviewlet.cpp \
+    pluginmanager.cpp \
+    progressbardelegate.cpp \
+    progressview.cpp \
+    registration.cpp \
+    sampleprofile.cpp \
+    samplerateconverter.cpp \
+    samplerjob.cpp \
+    savechangesview.cpp \
+    savewarningview.cpp \
+    session.cpp \
+    sessionloadview.cpp \
+    sessionsampledata.cpp \
+    sessionviewlet.cpp \
+    settings.cpp \
+    signalmap.cpp \
+    standarditem.cpp \
+    toolviewlet.cpp \
+    util.cpp \
+    viewviewlet.cpp \
+    zone.cpp \
+    zonecomparer.cpp \
+    zonecomparerproxy.cpp \
+    zoneindexcomparer.cpp \
+    zonelistloader.cpp \
+    zonetabledelegate.cpp \
+    zonetablemodel.cpp \
+    zoneviewlet.cpp
@@ -1,4 +1,5 @@
 include(../../synthclone.pri)
+include(sources.pri)
 
 ################################################################################
 # Build
@@ -31,110 +32,12 @@ DEFINES += SYNTHCLONE_MAJOR_VERSION=$${MAJOR_VERSION} \
     SYNTHCLONE_PLUGIN_PATH=$${SYNTHCLONE_PLUGIN_INSTALL_PATH} \
     SYNTHCLONE_REVISION=$${REVISION}
 DESTDIR = $${BUILDDIR}/$${SYNTHCLONE_APP_SUFFIX}
-HEADERS += aboutview.h \
-    application.h \
-    componentviewlet.h \
-    context.h \
-    contextmenueventfilter.h \
-    controller.h \
-    dialogview.h \
-    effectjob.h \
-    effectjobthread.h \
-    errorview.h \
-    helpviewlet.h \
-    mainview.h \
-    menuactionviewlet.h \
-    menuitemviewlet.h \
-    menuleafviewlet.h \
-    menumanager.h \
-    menuseparatorviewlet.h \
-    menuviewlet.h \
-    participantmanager.h \
-    participantview.h \
-    participantviewlet.h \
-    pluginmanager.h \
-    progressbardelegate.h \
-    progressview.h \
-    registration.h \
-    sampleprofile.h \
-    samplerateconverter.h \
-    samplerjob.h \
-    savechangesview.h \
-    savewarningview.h \
-    session.h \
-    sessionloadview.h \
-    sessionsampledata.h \
-    sessionviewlet.h \
-    settings.h \
-    signalmap.h \
-    signalpair.h \
-    standarditem.h \
-    toolviewlet.h \
-    types.h \
-    util.h \
-    viewviewlet.h \
-    zone.h \
-    zonecomparer.h \
-    zonecomparerproxy.h \
-    zoneindexcomparer.h \
-    zonelistloader.h \
-    zonetabledelegate.h \
-    zonetablemodel.h \
-    zoneviewlet.h
 INCLUDEPATH += ../include
 MOC_DIR = $${MAKEDIR}/synthclone
 OBJECTS_DIR = $${MAKEDIR}/synthclone
 RCC_DIR = $${MAKEDIR}/synthclone
 RESOURCES += synthclone.qrc
-SOURCES += aboutview.cpp \
-    application.cpp \
-    componentviewlet.cpp \
-    context.cpp \
-    contextmenueventfilter.cpp \
-    controller.cpp \
-    dialogview.cpp \
-    effectjob.cpp \
-    effectjobthread.cpp \
-    errorview.cpp \
-    helpviewlet.cpp \
-    main.cpp \
-    mainview.cpp \
-    menuactionviewlet.cpp \
-    menuitemviewlet.cpp \
-    menuleafviewlet.cpp \
-    menumanager.cpp \
-    menuseparatorviewlet.cpp \
-    menuviewlet.cpp \
-    participantmanager.cpp \
-    participantview.cpp \
-    participantviewlet.cpp \
-    pluginmanager.cpp \
-    progressbardelegate.cpp \
-    progressview.cpp \
-    registration.cpp \
-    sampleprofile.cpp \
-    samplerateconverter.cpp \
-    samplerjob.cpp \
-    savechangesview.cpp \
-    savewarningview.cpp \
-    session.cpp \
-    sessionloadview.cpp \
-    sessionsampledata.cpp \
-    sessionviewlet.cpp \
-    settings.cpp \
-    signalmap.cpp \
-    standarditem.cpp \
-    toolviewlet.cpp \
-    util.cpp \
-    viewviewlet.cpp \
-    zone.cpp \
-    zonecomparer.cpp \
-    zonecomparerproxy.cpp \
-    zoneindexcomparer.cpp \
-    zonelistloader.cpp \
-    zonetabledelegate.cpp \
-    zonetablemodel.cpp \
-    zoneviewlet.cpp
+SOURCES += main.cpp
 TARGET = synthclone
 TEMPLATE = app
 VERSION = $${SYNTHCLONE_VERSION}
@@ -19,6 +19,8 @@
 
 #include <cassert>
 
+#include <QtCore/QScopedPointer>
+
 #include <synthclone/error.h>
 #include <synthclone/util.h>
 
@@ -62,6 +64,20 @@ Zone::~Zone()
     }
 }
 
+void
+Zone::adoptDrySample(synthclone::Sample *sample)
+{
+    QScopedPointer<synthclone::Sample> samplePtr(sample);
+    CONFIRM(status == STATUS_NORMAL, tr("zone is being used by session"));
+    setDrySample(sample, false);
+
+    // The session sample data only copies the sample if it isn't already in
+    // the session's sample format and samples directory.
+    if (drySample == sample) {
+        samplePtr.take();
+    }
+}
+
 synthclone::MIDIData
 Zone::getAftertouch() const
 {
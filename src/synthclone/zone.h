@@ -81,6 +81,9 @@ public:
 
 public slots:
 
+    void
+    adoptDrySample(synthclone::Sample *sample);
+
     void
     setAftertouch(synthclone::MIDIData aftertouch);
 
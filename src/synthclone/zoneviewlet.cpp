@@ -32,6 +32,11 @@ ZoneViewlet::ZoneViewlet(QMainWindow *mainWindow, QObject *parent):
 
     zonesMenu = synthclone::getChild<QMenu>(mainWindow, "zonesMenu");
 
+    abortEffectJobAction = synthclone::getChild<QAction>
+        (mainWindow, "abortEffectJobAction");
+    connect(abortEffectJobAction, SIGNAL(triggered()),
+            SIGNAL(abortEffectJobRequest()));
+
     applyEffectsAction = synthclone::getChild<QAction>
         (mainWindow, "applyEffectsZonesAction");
     connect(applyEffectsAction, SIGNAL(triggered()),
@@ -84,6 +89,11 @@ ZoneViewlet::ZoneViewlet(QMainWindow *mainWindow, QObject *parent):
     pasteAction = synthclone::getChild<QAction>(mainWindow, "pasteZonesAction");
     connect(pasteAction, SIGNAL(triggered()), SIGNAL(pasteRequest()));
 
+    pipelineAction = synthclone::getChild<QAction>
+        (mainWindow, "pipelineZonesAction");
+    connect(pipelineAction, SIGNAL(triggered(bool)),
+            SIGNAL(pipelineEnabledChangeRequest(bool)));
+
     playDrySampleAction = synthclone::getChild<QAction>
         (mainWindow, "playDrySampleZonesAction");
     connect(playDrySampleAction, SIGNAL(triggered()),
@@ -496,6 +506,12 @@ ZoneViewlet::removeZone(int index)
     assert(removed);
 }
 
+void
+ZoneViewlet::setAbortEffectJobEnabled(bool enabled)
+{
+    abortEffectJobAction->setEnabled(enabled);
+}
+
 void
 ZoneViewlet::setAftertouch(int index, synthclone::MIDIData aftertouch)
 {
@@ -705,6 +721,12 @@ ZoneViewlet::setPasteEnabled(bool enabled)
     pasteAction->setEnabled(enabled);
 }
 
+void
+ZoneViewlet::setPipelineEnabled(bool enabled)
+{
+    pipelineAction->setChecked(enabled);
+}
+
 void
 ZoneViewlet::setPlayDrySampleEnabled(bool enabled)
 {
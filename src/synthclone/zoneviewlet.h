@@ -61,6 +61,9 @@ public slots:
     void
     removeZone(int index);
 
+    void
+    setAbortEffectJobEnabled(bool enabled);
+
     void
     setAftertouch(int index, synthclone::MIDIData aftertouch);
 
@@ -134,6 +137,9 @@ public slots:
     void
     setPasteEnabled(bool enabled);
 
+    void
+    setPipelineEnabled(bool enabled);
+
     void
     setPlayDrySampleEnabled(bool enabled);
 
@@ -190,6 +196,9 @@ public slots:
 
 signals:
 
+    void
+    abortEffectJobRequest();
+
     void
     aftertouchChangeRequest(int index, synthclone::MIDIData aftertouch);
 
@@ -276,6 +285,9 @@ signals:
     void
     pasteRequest();
 
+    void
+    pipelineEnabledChangeRequest(bool enabled);
+
     void
     playDrySampleRequest();
 
@@ -384,6 +396,7 @@ private:
     setModelData(int row, int column, const QVariant &value,
                  int role=Qt::EditRole);
 
+    QAction *abortEffectJobAction;
     QAction *applyEffectsAction;
     QAction *buildTargetsAction;
     QAction *clearEffectJobsAction;
@@ -401,6 +414,7 @@ private:
     StandardItem *itemPrototype;
     MenuViewlet *menuViewlet;
     QAction *pasteAction;
+    QAction *pipelineAction;
     QAction *playDrySampleAction;
     QAction *playWetSampleAction;
     QAction *removeEffectJobAction;